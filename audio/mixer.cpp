@@ -19,8 +19,11 @@
  *
  */
 
+#include <atomic>
+
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -37,12 +40,25 @@ namespace Audio {
 #pragma mark -
 
 
+/**
+ * Snapshot of the values needed to compute the elapsed time of a channel.
+ */
+struct ChannelTiming {
+	uint32 samplesConsumed;
+	uint32 mixerTimeStamp;
+	uint32 pauseStartTime;
+	uint32 pauseTime;
+	bool paused;
+};
+
+static Timestamp computeElapsedTime(const ChannelTiming &timing, uint rate);
+
 /**
  * Channel used by the default Mixer implementation.
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerQuality quality);
 	~Channel();
 
 	/**
@@ -145,6 +161,11 @@ public:
 	 */
 	Timestamp getElapsedTime();
 
+	/**
+	 * Returns the values getElapsedTime() is computed from.
+	 */
+	ChannelTiming getTiming() const;
+
 	/**
 	 * Replaces the channel's stream with a version that loops indefinitely.
 	 */
@@ -192,22 +213,320 @@ private:
 	Common::DisposablePtr<AudioStream> _stream;
 };
 
+#pragma mark -
+#pragma mark --- Non-blocking mode ---
+#pragma mark -
+
+namespace {
+
+enum {
+	kFreeSlot = 0xFFFFFFFF
+};
+
+enum CommandType {
+	kCommandInsert,
+	kCommandPause,
+	kCommandSetVolume,
+	kCommandSetBalance,
+	kCommandSetRate,
+	kCommandResetRate,
+	kCommandLoop,
+	kCommandSoundTypeChanged
+};
+
+} // End of anonymous namespace
+
+struct MixerImpl::Command {
+	byte type;
+	byte index;
+	uint32 handle;
+	int32 arg;
+	Channel *channel;
+};
+
+/**
+ * The state of a channel slot as seen from the engine side.
+ *
+ * The handle and the timing values are also written by the mixer thread,
+ * when a channel finishes or has been mixed, so they are atomics. The timing
+ * values are published through a sequence lock, so that readers always see a
+ * consistent snapshot. The remaining fields mirror what the engine requested
+ * and are only accessed with the state mutex held.
+ */
+struct MixerImpl::ChannelState {
+	ChannelState() : handle(kFreeSlot), sequence(0), timingHandle(kFreeSlot), samplesConsumed(0),
+		mixerTimeStamp(0), pauseStartTime(0), pauseTime(0), paused(0), type(kPlainSoundType),
+		id(-1), permanent(false), volume(kMaxChannelVolume), balance(0), rate(0), streamRate(0) {}
+
+	std::atomic<uint32> handle;
+
+	std::atomic<uint32> sequence;
+	std::atomic<uint32> timingHandle;
+	std::atomic<uint32> samplesConsumed;
+	std::atomic<uint32> mixerTimeStamp;
+	std::atomic<uint32> pauseStartTime;
+	std::atomic<uint32> pauseTime;
+	std::atomic<uint32> paused;
+
+	SoundType type;
+	int id;
+	bool permanent;
+	byte volume;
+	int8 balance;
+	uint32 rate;
+	uint32 streamRate;
+
+	bool isActive() const { return handle.load(std::memory_order_acquire) != kFreeSlot; }
+
+	/** Called by the mixer thread only. */
+	void publishTiming(uint32 chanHandle, const ChannelTiming &timing) {
+		const uint32 seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		timingHandle.store(chanHandle, std::memory_order_relaxed);
+		samplesConsumed.store(timing.samplesConsumed, std::memory_order_relaxed);
+		mixerTimeStamp.store(timing.mixerTimeStamp, std::memory_order_relaxed);
+		pauseStartTime.store(timing.pauseStartTime, std::memory_order_relaxed);
+		pauseTime.store(timing.pauseTime, std::memory_order_relaxed);
+		paused.store(timing.paused, std::memory_order_relaxed);
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	/**
+	 * Reads the last published timing of the slot. Returns false if it does
+	 * not belong to the given handle yet.
+	 */
+	bool readTiming(uint32 chanHandle, ChannelTiming &timing) const {
+		uint32 seq, owner;
+		do {
+			seq = sequence.load(std::memory_order_acquire);
+			owner = timingHandle.load(std::memory_order_relaxed);
+			timing.samplesConsumed = samplesConsumed.load(std::memory_order_relaxed);
+			timing.mixerTimeStamp = mixerTimeStamp.load(std::memory_order_relaxed);
+			timing.pauseStartTime = pauseStartTime.load(std::memory_order_relaxed);
+			timing.pauseTime = pauseTime.load(std::memory_order_relaxed);
+			timing.paused = paused.load(std::memory_order_relaxed) != 0;
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while ((seq & 1) || seq != sequence.load(std::memory_order_relaxed));
+
+		return owner == chanHandle;
+	}
+};
+
+/**
+ * Single-producer/single-consumer ring of commands. The engine threads push
+ * with the state mutex held, so there is only one producer at a time; the
+ * consumer always holds the mixer mutex.
+ *
+ * When the ring is full, e.g. because audio output is stalled, commands go to
+ * the overflow list instead, and keep going there until the consumer took
+ * them. This is the only time the mixer thread takes the state mutex.
+ */
+class MixerImpl::CommandQueue {
+public:
+	enum {
+		kSize = 256
+	};
+
+	CommandQueue() : overflowed(false), _readPos(0), _writePos(0) {}
+
+	bool push(const Command &cmd) {
+		const uint32 writePos = _writePos.load(std::memory_order_relaxed);
+		if (writePos - _readPos.load(std::memory_order_acquire) == kSize)
+			return false;
+
+		_commands[writePos % kSize] = cmd;
+		_writePos.store(writePos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(Command &cmd) {
+		const uint32 readPos = _readPos.load(std::memory_order_relaxed);
+		if (readPos == _writePos.load(std::memory_order_acquire))
+			return false;
+
+		cmd = _commands[readPos % kSize];
+		_readPos.store(readPos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** The commands which did not fit into the ring, guarded by the state mutex. */
+	Common::Array<Command> overflow;
+	/** Set while the overflow list is not empty. */
+	std::atomic<bool> overflowed;
+	/** The overflowed commands being applied by the consumer. */
+	Common::Array<Command> processing;
+
+private:
+	Command _commands[kSize];
+	std::atomic<uint32> _readPos;
+	std::atomic<uint32> _writePos;
+};
+
 #pragma mark -
 #pragma mark --- Mixer ---
 #pragma mark -
 
-MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize, bool nonBlocking)
+	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _resamplerQuality(kResamplerLinear),
+	  _soundTypeSettings(), _channelStates(nullptr), _commands(nullptr) {
 
 	assert(sampleRate > 0);
 
+	if (ConfMan.hasKey("audio_resampling_quality"))
+		_resamplerQuality = (ResamplerQuality)CLIP<int>(ConfMan.getInt("audio_resampling_quality"), kResamplerLinear, kResamplerSincBest);
+
+	// Build the resampling filters now rather than when the first sound is
+	// started, with the mixer locked
+	prepareRateConverters(_resamplerQuality);
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = nullptr;
+
+	if (nonBlocking) {
+		_channelStates = new ChannelState[NUM_CHANNELS];
+		_commands = new CommandQueue();
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// Channels which are still queued for insertion are owned by the queue
+	if (_commands)
+		processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	delete _commands;
+	delete[] _channelStates;
+}
+
+int MixerImpl::findActiveSlot(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (_channelStates[index].handle.load(std::memory_order_acquire) != handle._val)
+		return -1;
+	return index;
+}
+
+bool MixerImpl::isStateIDActive(int id) const {
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channelStates[i].isActive() && _channelStates[i].id == id)
+			return true;
+	}
+	return false;
+}
+
+void MixerImpl::pushCommand(int command, int index, uint32 handle, int32 arg, Channel *chan) {
+	Command cmd;
+	cmd.type = command;
+	cmd.index = index;
+	cmd.handle = handle;
+	cmd.arg = arg;
+	cmd.channel = chan;
+
+	// Once a command overflowed, the following ones must not overtake it
+	if (_commands->overflow.empty() && _commands->push(cmd))
+		return;
+
+	_commands->overflow.push_back(cmd);
+	_commands->overflowed.store(true, std::memory_order_release);
+}
+
+void MixerImpl::processCommands() {
+	Command cmd;
+	while (_commands->pop(cmd))
+		applyCommand(cmd);
+
+	if (!_commands->overflowed.load(std::memory_order_acquire))
+		return;
+
+	{
+		// Commands pushed to the ring before the overflow started come first
+		Common::StackLock lock(_stateMutex);
+		while (_commands->pop(cmd))
+			_commands->processing.push_back(cmd);
+		for (uint c = 0; c < _commands->overflow.size(); c++)
+			_commands->processing.push_back(_commands->overflow[c]);
+		_commands->overflow.resize(0);
+		_commands->overflowed.store(false, std::memory_order_relaxed);
+	}
+
+	for (uint c = 0; c < _commands->processing.size(); c++)
+		applyCommand(_commands->processing[c]);
+
+	// Keep the storage around for the next overflow
+	_commands->processing.resize(0);
+}
+
+void MixerImpl::flushCommands() {
+	Command cmd;
+	while (_commands->pop(cmd))
+		applyCommand(cmd);
+
+	for (uint c = 0; c < _commands->overflow.size(); c++)
+		applyCommand(_commands->overflow[c]);
+	_commands->overflow.resize(0);
+	_commands->overflowed.store(false, std::memory_order_relaxed);
+}
+
+void MixerImpl::applyCommand(const Command &cmd) {
+	if (cmd.type == kCommandInsert) {
+		// The previous occupant was stopped or has finished before the
+		// slot got handed out again, so the slot is free by now.
+		delete _channels[cmd.index];
+		_channels[cmd.index] = cmd.channel;
+		// The sound type volume may have changed while the channel was
+		// being set up
+		cmd.channel->notifyGlobalVolChange();
+		return;
+	}
+
+	if (cmd.type == kCommandSoundTypeChanged) {
+		for (int i = 0; i != NUM_CHANNELS; ++i) {
+			if (_channels[i] && _channels[i]->getType() == cmd.arg)
+				_channels[i]->notifyGlobalVolChange();
+		}
+		return;
+	}
+
+	Channel *chan = _channels[cmd.index];
+	if (!chan || chan->getHandle()._val != cmd.handle)
+		return;
+
+	switch (cmd.type) {
+	case kCommandPause:
+		chan->pause(cmd.arg != 0);
+		break;
+	case kCommandSetVolume:
+		chan->setVolume(cmd.arg);
+		break;
+	case kCommandSetBalance:
+		chan->setBalance(cmd.arg);
+		break;
+	case kCommandSetRate:
+		chan->setRate(cmd.arg);
+		break;
+	case kCommandResetRate:
+		chan->resetRate();
+		break;
+	case kCommandLoop:
+		chan->loop();
+		break;
+	default:
+		break;
+	}
+}
+
+void MixerImpl::publishChannelStates() {
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i])
+			_channelStates[i].publishTiming(_channels[i]->getHandle()._val, _channels[i]->getTiming());
+	}
+}
+
+void MixerImpl::setResamplerQuality(ResamplerQuality quality) {
+	prepareRateConverters(quality);
+	_resamplerQuality = quality;
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -231,7 +550,7 @@ uint MixerImpl::getOutputBufSize() const {
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == nullptr) {
+		if (_channelStates ? !_channelStates[i].isActive() : _channels[i] == nullptr) {
 			index = i;
 			break;
 		}
@@ -242,8 +561,6 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
 	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
 
@@ -251,6 +568,20 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	if (_channelStates) {
+		ChannelState &state = _channelStates[index];
+		state.type = chan->getType();
+		state.id = chan->getId();
+		state.permanent = chan->isPermanent();
+		state.volume = chan->getVolume();
+		state.balance = chan->getBalance();
+		state.rate = state.streamRate = chan->getRate();
+		state.handle.store(chanHandle._val, std::memory_order_release);
+		pushCommand(kCommandInsert, index, chanHandle._val, 0, chan);
+	} else {
+		_channels[index] = chan;
+	}
 }
 
 void MixerImpl::playStream(
@@ -261,6 +592,11 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
+	if (_channelStates) {
+		playStreamNonBlocking(type, handle, stream, id, volume, balance, autofreeStream, permanent, reverseStereo);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	if (stream == nullptr) {
@@ -292,9 +628,56 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _resamplerQuality);
+	chan->setVolume(volume);
+	chan->setBalance(balance);
+	insertChannel(handle, chan);
+}
+
+void MixerImpl::playStreamNonBlocking(
+			SoundType type,
+			SoundHandle *handle,
+			AudioStream *stream,
+			int id, byte volume, int8 balance,
+			DisposeAfterUse::Flag autofreeStream,
+			bool permanent,
+			bool reverseStereo) {
+	if (stream == nullptr) {
+		warning("stream is 0");
+		return;
+	}
+
+	assert(_mixerReady);
+
+	// Prevent duplicate sounds, see playStream()
+	if (id != -1) {
+		Common::StackLock lock(_stateMutex);
+		if (isStateIDActive(id)) {
+			if (autofreeStream == DisposeAfterUse::YES)
+				delete stream;
+			return;
+		}
+	}
+
+#ifdef AUDIO_REVERSE_STEREO
+	reverseStereo = !reverseStereo;
+#endif
+
+	// Create the channel without holding any lock, since setting up its
+	// rate converter may take a while
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _resamplerQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
+
+	Common::StackLock lock(_stateMutex);
+
+	// Another thread may have started the same sound in the meantime. The
+	// channel frees the stream if it owns it.
+	if (id != -1 && isStateIDActive(id)) {
+		delete chan;
+		return;
+	}
+
 	insertChannel(handle, chan);
 }
 
@@ -308,6 +691,9 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
+	if (_commands)
+		processCommands();
+
 	//  zero the buf
 	memset(buf, 0, len);
 
@@ -325,6 +711,11 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
+				if (_channelStates) {
+					// Release the slot, unless the engine already did
+					uint32 chanHandle = _channels[i]->getHandle()._val;
+					_channelStates[i].handle.compare_exchange_strong(chanHandle, kFreeSlot, std::memory_order_release);
+				}
 				delete _channels[i];
 				_channels[i] = nullptr;
 			} else if (!_channels[i]->isPaused()) {
@@ -335,11 +726,33 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 			}
 		}
 
+	if (_channelStates)
+		publishChannelStates();
+
 	return res;
 }
 
+void MixerImpl::stopSlot(int index) {
+	delete _channels[index];
+	_channels[index] = nullptr;
+	_channelStates[index].handle.store(kFreeSlot, std::memory_order_release);
+}
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
+
+	// Stopping is not queued, even in non-blocking mode: callers may free
+	// the data of the stream as soon as we return.
+	if (_channelStates) {
+		Common::StackLock stateLock(_stateMutex);
+		flushCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channelStates[i].isActive() && !_channelStates[i].permanent)
+				stopSlot(i);
+		}
+		return;
+	}
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && !_channels[i]->isPermanent()) {
 			delete _channels[i];
@@ -350,6 +763,17 @@ void MixerImpl::stopAll() {
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
+
+	if (_channelStates) {
+		Common::StackLock stateLock(_stateMutex);
+		flushCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channelStates[i].isActive() && _channelStates[i].id == id)
+				stopSlot(i);
+		}
+		return;
+	}
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
 			delete _channels[i];
@@ -361,6 +785,16 @@ void MixerImpl::stopID(int id) {
 void MixerImpl::stopHandle(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
+	if (_channelStates) {
+		Common::StackLock stateLock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		if (index != -1) {
+			flushCommands();
+			stopSlot(index);
+		}
+		return;
+	}
+
 	// Simply ignore stop requests for handles of sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -374,6 +808,12 @@ void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
 	_soundTypeSettings[type].mute = mute;
 
+	if (_commands) {
+		Common::StackLock lock(_stateMutex);
+		pushCommand(kCommandSoundTypeChanged, 0, kFreeSlot, type);
+		return;
+	}
+
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
 			_channels[i]->notifyGlobalVolChange();
@@ -386,6 +826,16 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		if (index != -1) {
+			_channelStates[index].volume = volume;
+			pushCommand(kCommandSetVolume, index, handle._val, volume);
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -396,6 +846,12 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		return (index != -1) ? _channelStates[index].volume : 0;
+	}
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -404,6 +860,16 @@ byte MixerImpl::getChannelVolume(SoundHandle handle) {
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		if (index != -1) {
+			_channelStates[index].balance = balance;
+			pushCommand(kCommandSetBalance, index, handle._val, balance);
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -414,6 +880,12 @@ void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		return (index != -1) ? _channelStates[index].balance : 0;
+	}
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -422,6 +894,16 @@ int8 MixerImpl::getChannelBalance(SoundHandle handle) {
 }
 
 void MixerImpl::setChannelRate(SoundHandle handle, uint32 rate) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		if (index != -1) {
+			_channelStates[index].rate = rate;
+			pushCommand(kCommandSetRate, index, handle._val, rate);
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -432,6 +914,12 @@ void MixerImpl::setChannelRate(SoundHandle handle, uint32 rate) {
 }
 
 uint32 MixerImpl::getChannelRate(SoundHandle handle) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		return (index != -1) ? _channelStates[index].rate : 0;
+	}
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -440,6 +928,16 @@ uint32 MixerImpl::getChannelRate(SoundHandle handle) {
 }
 
 void MixerImpl::resetChannelRate(SoundHandle handle) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		if (index != -1) {
+			_channelStates[index].rate = _channelStates[index].streamRate;
+			pushCommand(kCommandResetRate, index, handle._val);
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -454,6 +952,15 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
+	if (_channelStates) {
+		ChannelTiming timing;
+		const int index = findActiveSlot(handle);
+		if (index == -1 || !_channelStates[index].readTiming(handle._val, timing))
+			return Timestamp(0, _sampleRate);
+
+		return computeElapsedTime(timing, _sampleRate);
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -464,6 +971,14 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 }
 
 void MixerImpl::loopChannel(SoundHandle handle) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		if (index != -1)
+			pushCommand(kCommandLoop, index, handle._val);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -474,6 +989,15 @@ void MixerImpl::loopChannel(SoundHandle handle) {
 }
 
 void MixerImpl::pauseAll(bool paused) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channelStates[i].isActive())
+				pushCommand(kCommandPause, i, _channelStates[i].handle.load(std::memory_order_relaxed), paused);
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr) {
@@ -483,6 +1007,17 @@ void MixerImpl::pauseAll(bool paused) {
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channelStates[i].isActive() && _channelStates[i].id == id) {
+				pushCommand(kCommandPause, i, _channelStates[i].handle.load(std::memory_order_relaxed), paused);
+				return;
+			}
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
@@ -493,6 +1028,14 @@ void MixerImpl::pauseID(int id, bool paused) {
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		if (index != -1)
+			pushCommand(kCommandPause, index, handle._val, paused);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
@@ -504,12 +1047,17 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		return isStateIDActive(id);
+	}
+
+	Common::StackLock lock(_mutex);
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
@@ -517,6 +1065,12 @@ bool MixerImpl::isSoundIDActive(int id) {
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		const int index = findActiveSlot(handle);
+		return (index != -1) ? _channelStates[index].id : 0;
+	}
+
 	Common::StackLock lock(_mutex);
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
@@ -525,17 +1079,28 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
+	if (_channelStates)
+		return findActiveSlot(handle) != -1;
+
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
 	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
+	if (_channelStates) {
+		Common::StackLock lock(_stateMutex);
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (_channelStates[i].isActive() && _channelStates[i].type == type)
+				return true;
+		return false;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
@@ -552,6 +1117,13 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
+	if (_commands) {
+		Common::StackLock lock(_stateMutex);
+		_soundTypeSettings[type].volume = volume;
+		pushCommand(kCommandSoundTypeChanged, 0, kFreeSlot, type);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].volume = volume;
 
@@ -567,13 +1139,12 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 	return _soundTypeSettings[type].volume;
 }
 
-
 #pragma mark -
 #pragma mark --- Channel implementations ---
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerQuality quality)
 	: _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
 	  _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
 	  _pauseStartTime(0), _pauseTime(0), _converter(nullptr), _volL(0), _volR(0),
@@ -582,7 +1153,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
@@ -670,23 +1241,36 @@ void Channel::pause(bool paused) {
 	}
 }
 
+ChannelTiming Channel::getTiming() const {
+	ChannelTiming timing;
+	timing.samplesConsumed = _samplesConsumed;
+	timing.mixerTimeStamp = _mixerTimeStamp;
+	timing.pauseStartTime = _pauseStartTime;
+	timing.pauseTime = _pauseTime;
+	timing.paused = isPaused();
+	return timing;
+}
+
 Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
+	return computeElapsedTime(getTiming(), _mixer->getOutputRate());
+}
+
+static Timestamp computeElapsedTime(const ChannelTiming &timing, uint rate) {
 	uint32 delta = 0;
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	if (timing.mixerTimeStamp == 0)
 		return ts;
 
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
+	if (timing.paused)
+		delta = timing.pauseStartTime - timing.mixerTimeStamp;
 	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
+		delta = g_system->getMillis(true) - timing.mixerTimeStamp - timing.pauseTime;
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(timing.samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -23,8 +23,10 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -49,6 +51,19 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * Optionally, the mixer can be created in non-blocking mode. In that mode most
+ * of the engine-facing API does not wait for mixCallback() to finish mixing:
+ * state changes (starting and pausing channels, volume changes...) are pushed
+ * into a single-producer/single-consumer command ring which mixCallback()
+ * drains at the start of every buffer without taking any lock, and the
+ * channel state engines query (whether a handle is active, its elapsed
+ * time...) is published through atomics.
+ *
+ * This does not make mixCallback() lock-free. It still holds mutex() while
+ * mixing, so engine code which uses it to guard the state of its own audio
+ * streams keeps working unchanged, and stopping channels takes mutex() too,
+ * since callers may free the data of a stream right after stopping it.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -61,6 +76,10 @@ private:
 		NUM_CHANNELS = 32
 	};
 
+	struct ChannelState;
+	struct Command;
+	class CommandQueue;
+
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
@@ -68,6 +87,7 @@ private:
 	const uint _outBufSize;
 	bool _mixerReady;
 	uint32 _handleSeed;
+	ResamplerQuality _resamplerQuality;
 
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
@@ -79,10 +99,24 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * State used only in non-blocking mode: the engine-side view of every
+	 * channel slot and the queued commands. Both are nullptr otherwise.
+	 */
+	ChannelState *_channelStates;
+	CommandQueue *_commands;
+
+	/**
+	 * Serializes the engine threads in non-blocking mode, and guards the
+	 * engine-side fields of _channelStates and the overflow list of
+	 * _commands. The mixer thread only takes it when the command ring has
+	 * overflowed. When both mutexes are needed, _mutex must be taken first.
+	 */
+	Common::Mutex _stateMutex;
 
 public:
 
-	MixerImpl(uint sampleRate, bool stereo = true, uint outBufSize = 0);
+	MixerImpl(uint sampleRate, bool stereo = true, uint outBufSize = 0, bool nonBlocking = false);
 	~MixerImpl();
 
 	virtual bool isReady() const { Common::StackLock lock(_mutex); return _mixerReady; }
@@ -139,7 +173,70 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	void playStreamNonBlocking(
+		SoundType type,
+		SoundHandle *handle,
+		AudioStream *input,
+		int id, byte volume, int8 balance,
+		DisposeAfterUse::Flag autofreeStream,
+		bool permanent,
+		bool reverseStereo);
+
+	/**
+	 * Returns the slot of the given handle in non-blocking mode, or -1 if
+	 * it is not active. Needs no lock.
+	 */
+	int findActiveSlot(SoundHandle handle) const;
+
+	/**
+	 * Non-blocking mode helpers, called with _stateMutex held.
+	 */
+	bool isStateIDActive(int id) const;
+	void pushCommand(int command, int index, uint32 handle, int32 arg = 0, Channel *chan = nullptr);
+
+	/**
+	 * Deletes the channel in the given slot and frees the slot. Must be
+	 * called with both _mutex and _stateMutex held.
+	 */
+	void stopSlot(int index);
+
+	/**
+	 * Applies all queued commands to the channels. Must be called with
+	 * _mutex held, and takes _stateMutex only if the ring has overflowed.
+	 */
+	void processCommands();
+
+	/**
+	 * Applies all queued commands to the channels. Must be called with both
+	 * _mutex and _stateMutex held.
+	 */
+	void flushCommands();
+
+	/**
+	 * Applies a single command. Must be called with _mutex held.
+	 */
+	void applyCommand(const Command &cmd);
+
+	/**
+	 * Publishes the timing of all channels for the engine-side queries.
+	 * Must be called with _mutex held.
+	 */
+	void publishChannelStates();
+
 public:
+	/**
+	 * Set the resampling algorithm used by channels started from now on.
+	 * By default, it is taken from the audio_resampling_quality config key.
+	 * This builds the tables of the algorithm if needed, so it must not be
+	 * called with mutex() held.
+	 */
+	void setResamplerQuality(ResamplerQuality quality);
+
+	/**
+	 * Queries whether the mixer runs in non-blocking mode.
+	 */
+	bool isNonBlocking() const { return _commands != nullptr; }
+
 	/**
 	 * The mixer callback function, to be called at regular intervals by
 	 * the backend (e.g. from an audio mixing thread). All the actual mixing
@@ -29,7 +29,9 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_intern.h"
 #include "audio/mixer.h"
+#include "common/system.h"
 #include "common/util.h"
 
 namespace Audio {
@@ -45,6 +47,40 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+void StereoMix::mixGeneric(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	for (uint i = 0; i < numFrames; i++) {
+		clampedAdd(dst[0], (st_sample_t)((src[0] * (int)volL) / Audio::Mixer::kMaxMixerVolume));
+		clampedAdd(dst[1], (st_sample_t)((src[1] * (int)volR) / Audio::Mixer::kMaxMixerVolume));
+		dst += 2;
+		src += 2;
+	}
+}
+
+// Initialize this to nullptr at the start
+StereoMix::MixFunc StereoMix::mixFunc = nullptr;
+
+StereoMix::MixFunc StereoMix::getMixFunc() {
+	// If no function has been selected yet, detect and select
+	if (!mixFunc) {
+		MixFunc func = mixGeneric;
+		// The SIMD variants only handle signed output
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) func = mixNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) func = mixSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) func = mixAVX2;
+#endif
+#endif
+		mixFunc = func;
+	}
+
+	return mixFunc;
+}
+
 template<bool inStereo, bool outStereo, bool reverseStereo>
 class RateConverter_Impl : public RateConverter {
 private:
@@ -76,9 +112,22 @@ private:
 	/** Current sample(s) in the input stream (left/right channel) */
 	st_sample_t _inCurL, _inCurR;
 
-	int copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
-	int simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
-	int interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+	/** Function used to scale and mix the resampled frames */
+	StereoMix::MixFunc _mixFunc;
+
+	/**
+	 * The conversion functions write unscaled stereo frames into @p frames,
+	 * in output channel order, and return the number of frames written.
+	 */
+	int copyConvert(AudioStream &input, st_sample_t *frames, st_size_t numFrames);
+	int simpleConvert(AudioStream &input, st_sample_t *frames, st_size_t numFrames);
+	int interpolateConvert(AudioStream &input, st_sample_t *frames, st_size_t numFrames);
+
+	static inline void storeFrame(st_sample_t *&frames, st_sample_t inL, st_sample_t inR) {
+		frames[reverseStereo    ] = inL;
+		frames[reverseStereo ^ 1] = inR;
+		frames += 2;
+	}
 
 public:
 	RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate);
@@ -96,62 +145,45 @@ public:
 };
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
-	st_sample_t *outStart, *outEnd;
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStream &input, st_sample_t *frames, st_size_t numFrames) {
+	st_sample_t *framesStart, *framesEnd;
 
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+	framesStart = frames;
+	framesEnd = frames + numFrames * 2;
 
-	while (outBuffer < outEnd) {
+	while (frames < framesEnd) {
 		// Check if we have to refill the buffer
 		if (_bufferSize == 0) {
 			_bufferPos = _buffer;
 			_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
 			if (_bufferSize <= 0)
-				return (outBuffer - outStart) / (outStereo ? 2 : 1);
+				return (frames - framesStart) / 2;
 		}
 
-		// Mix the data into the output buffer
+		// Copy the data into the frame buffer
 		st_sample_t inL, inR;
 		inL = *_bufferPos++;
 		inR = (inStereo ? *_bufferPos++ : inL);
 		_bufferSize -= (inStereo ? 2 : 1);
 
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-		if (outStereo) {
-			// Output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// Output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
-
-			outBuffer += 2;
-		} else {
-			// Output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
-
-			outBuffer += 1;
-		}
+		storeFrame(frames, inL, inR);
 	}
 
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+	return (frames - framesStart) / 2;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioStream &input, st_sample_t *frames, st_size_t numFrames) {
 	// How much to increment _outPos by
 	frac_t outPos_inc = _inRate / _outRate;
 
-	st_sample_t *outStart, *outEnd;
+	st_sample_t *framesStart, *framesEnd;
 
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+	framesStart = frames;
+	framesEnd = frames + numFrames * 2;
 
-	while (outBuffer < outEnd) {
+	while (frames < framesEnd) {
 		// Read enough input samples so that _outPos >= 0
 		do {
 			// Check if we have to refill the buffer
@@ -160,7 +192,7 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
 				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
+					return (frames - framesStart) / 2;
 			}
 
 			_bufferSize -= (inStereo ? 2 : 1);
@@ -178,38 +210,21 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 		// Increment output position
 		_outPos += outPos_inc;
 
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-		if (outStereo) {
-			// output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
-
-			outBuffer += 2;
-		} else {
-			// output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
-
-			outBuffer += 1;
-		}
+		storeFrame(frames, inL, inR);
 	}
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+	return (frames - framesStart) / 2;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(AudioStream &input, st_sample_t *frames, st_size_t numFrames) {
 	// How much to increment _outPosFrac by
 	frac_t outPos_inc = (_inRate << FRAC_BITS_LOW) / _outRate;
 
-	st_sample_t *outStart, *outEnd;
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+	st_sample_t *framesStart, *framesEnd;
+	framesStart = frames;
+	framesEnd = frames + numFrames * 2;
 
-	while (outBuffer < outEnd) {
+	while (frames < framesEnd) {
 		// Read enough input samples so that _outPosFrac < 0
 		while ((frac_t)FRAC_ONE_LOW <= _outPosFrac) {
 			// Check if we have to refill the buffer
@@ -218,7 +233,7 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
 				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
+					return (frames - framesStart) / 2;
 			}
 
 			_bufferSize -= (inStereo ? 2 : 1);
@@ -234,8 +249,8 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 		}
 
 		// Loop as long as the _outPos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && outBuffer < outEnd) {
+		// still space in the frame buffer.
+		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && frames < framesEnd) {
 			// Interpolate
 			st_sample_t inL, inR;
 			inL = (st_sample_t)(_inLastL + (((_inCurL - _inLastL) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
@@ -243,30 +258,13 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 						(st_sample_t)(_inLastR + (((_inCurR - _inLastR) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
 						inL);
 
-			st_sample_t outL, outR;
-			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-			if (outStereo) {
-				// Output left channel
-				clampedAdd(outBuffer[reverseStereo    ], outL);
-
-				// Output right channel
-				clampedAdd(outBuffer[reverseStereo ^ 1], outR);
-
-				outBuffer += 2;
-			} else {
-				// Output mono channel
-				clampedAdd(outBuffer[0], (outL + outR) / 2);
-
-				outBuffer += 1;
-			}
+			storeFrame(frames, inL, inR);
 
 			// Increment output position
 			_outPosFrac += outPos_inc;
 		}
 	}
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+	return (frames - framesStart) / 2;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
@@ -280,24 +278,58 @@ RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_ra
 	_inCurL(0),
 	_inCurR(0),
 	_bufferSize(0),
-	_bufferPos(nullptr) {}
+	_bufferPos(nullptr),
+	_mixFunc(StereoMix::getMixFunc()) {}
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
 int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
 	assert(input.isStereo() == inStereo);
 
-	if (_inRate == _outRate) {
-		return copyConvert(input, outBuffer, numSamples, volL, volR);
-	} else {
-		if ((_inRate % _outRate) == 0 && (_inRate < 65536)) {
-			return simpleConvert(input, outBuffer, numSamples, volL, volR);
+	// The frames are stored in output channel order, so swap the volumes too
+	const st_volume_t vol0 = reverseStereo ? volR : volL;
+	const st_volume_t vol1 = reverseStereo ? volL : volR;
+
+	st_sample_t frames[MIX_CHUNK_FRAMES * 2];
+	int total = 0;
+
+	while (numSamples > 0) {
+		const st_size_t chunk = MIN<st_size_t>(numSamples, MIX_CHUNK_FRAMES);
+		int count;
+
+		if (_inRate == _outRate) {
+			count = copyConvert(input, frames, chunk);
 		} else {
-			return interpolateConvert(input, outBuffer, numSamples, volL, volR);
+			if ((_inRate % _outRate) == 0 && (_inRate < 65536)) {
+				count = simpleConvert(input, frames, chunk);
+			} else {
+				count = interpolateConvert(input, frames, chunk);
+			}
 		}
+
+		mixFrames<outStereo>(outBuffer, frames, count, vol0, vol1, volL, volR, _mixFunc);
+		outBuffer += count * (outStereo ? 2 : 1);
+
+		total += count;
+		numSamples -= count;
+
+		// Stop once the input stream ran dry
+		if ((st_size_t)count < chunk)
+			break;
 	}
+
+	return total;
 }
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo) {
+void prepareRateConverters(ResamplerQuality quality) {
+	if (quality != kResamplerLinear)
+		prepareSincRateConverters(quality);
+}
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality) {
+	// Nothing to filter when the rates match
+	if (quality != kResamplerLinear && inRate != outRate)
+		return makeSincRateConverter(inRate, outRate, inStereo, outStereo, reverseStereo, quality);
+
 	if (inStereo) {
 		if (outStereo) {
 			if (reverseStereo)
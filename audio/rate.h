@@ -104,7 +104,28 @@ public:
 	virtual bool needsDraining() const = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo);
+/**
+ * Resampling algorithms, trading CPU time for quality.
+ */
+enum ResamplerQuality {
+	kResamplerLinear = 0,   ///< Linear interpolation (default, cheapest)
+	kResamplerSincFast = 1, ///< Band-limited polyphase filter with short kernels
+	kResamplerSincBest = 2  ///< Band-limited polyphase filter with long kernels
+};
+
+/**
+ * Create a rate converter for the given stream and output configuration.
+ *
+ * @param quality	The resampling algorithm used when the rates differ.
+ */
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality = kResamplerLinear);
+
+/**
+ * Build the tables used by the rate converters of the given quality, unless
+ * this was done already. This can take a while, so it should be done before
+ * any sound is started. Otherwise, creating the first converter does it.
+ */
+void prepareRateConverters(ResamplerQuality quality);
 
 /** @} */
 } // End of namespace Audio
@@ -0,0 +1,84 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/rate_intern.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Audio {
+
+// Divides by Mixer::kMaxMixerVolume, rounding towards zero like C does
+static FORCEINLINE __m256i avx2_div256(__m256i a) {
+	return _mm256_srai_epi32(_mm256_add_epi32(a, _mm256_and_si256(_mm256_srai_epi32(a, 31), _mm256_set1_epi32(255))), 8);
+}
+
+void StereoMix::mixAVX2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set1_epi32(((uint32)volR << 16) | volL);
+
+	// Eight stereo frames per iteration. Unpacking and packing both work
+	// within 128-bit lanes, so the sample order is preserved.
+	uint i = 0;
+	for (; i + 8 <= numFrames; i += 8) {
+		__m256i in = _mm256_loadu_si256((const __m256i *)(src + i * 2));
+		__m256i out = _mm256_loadu_si256((const __m256i *)(dst + i * 2));
+
+		__m256i lo = _mm256_mullo_epi16(in, vol);
+		__m256i hi = _mm256_mulhi_epi16(in, vol);
+		__m256i scaled = _mm256_packs_epi32(avx2_div256(_mm256_unpacklo_epi16(lo, hi)), avx2_div256(_mm256_unpackhi_epi16(lo, hi)));
+
+		out = _mm256_adds_epi16(out, scaled);
+		_mm256_storeu_si256((__m256i *)(dst + i * 2), out);
+	}
+
+	mixGeneric(dst + i * 2, src + i * 2, numFrames - i, volL, volR);
+}
+
+int32 SincFilter::dotAVX2(const int16 *a, const int16 *b, uint len) {
+	__m256i sum256 = _mm256_setzero_si256();
+	uint i = 0;
+	for (; i + 16 <= len; i += 16)
+		sum256 = _mm256_add_epi32(sum256, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+
+	__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sum256), _mm256_extracti128_si256(sum256, 1));
+	if (i < len)
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+} // End of namespace Audio
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
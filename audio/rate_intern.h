@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_RATE_INTERN_H
+#define AUDIO_RATE_INTERN_H
+
+#include "audio/rate.h"
+#include "audio/mixer.h"
+
+namespace Audio {
+
+/**
+ * Scaling and mixing of resampled stereo frames into the output buffer.
+ *
+ * The actual implementation is picked at runtime depending on the SIMD
+ * features supported by the CPU. The SIMD variants produce bit-identical
+ * results to the generic one.
+ */
+class StereoMix {
+public:
+	/**
+	 * Scales a buffer of interleaved stereo frames by the given left/right
+	 * volumes (in the range 0 - Mixer::kMaxMixerVolume) and adds the result
+	 * to the output buffer, clamping each sample like clampedAdd() does.
+	 */
+	typedef void (*MixFunc)(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+
+	/** The selected implementation, nullptr until getMixFunc() is first called. */
+	static MixFunc mixFunc;
+
+	/** Returns the mix function, detecting the CPU features if needed. */
+	static MixFunc getMixFunc();
+
+	static void mixGeneric(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+#ifdef SCUMMVM_NEON
+	static void mixNEON(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void mixSSE2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void mixAVX2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+#endif
+};
+
+/**
+ * Number of frames resampled at once before they get scaled and mixed
+ * into the output buffer.
+ */
+enum {
+	MIX_CHUNK_FRAMES = 256
+};
+
+/**
+ * Scales and mixes @p count resampled stereo frames into the output buffer.
+ * The frames must already be stored in output channel order, with @p vol0 and
+ * @p vol1 being the matching volumes. For mono output, the frames are
+ * downmixed with @p volL and @p volR.
+ */
+template<bool outStereo>
+inline void mixFrames(st_sample_t *outBuffer, const st_sample_t *frames, int count, st_volume_t vol0, st_volume_t vol1, st_volume_t volL, st_volume_t volR, StereoMix::MixFunc mixFunc) {
+	if (outStereo) {
+		mixFunc(outBuffer, frames, count, vol0, vol1);
+	} else {
+		// Output mono channel
+		for (int i = 0; i < count; i++) {
+			st_sample_t outL, outR;
+			outL = (frames[2 * i    ] * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+			outR = (frames[2 * i + 1] * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+			clampedAdd(outBuffer[i], (outL + outR) / 2);
+		}
+	}
+}
+
+/**
+ * Dot products of the polyphase resampler, i.e. the sum of a[i] * b[i].
+ *
+ * Like StereoMix, the implementation is picked at runtime and the SIMD
+ * variants produce bit-identical results to the generic one. The length
+ * must be a multiple of 8.
+ */
+class SincFilter {
+public:
+	typedef int32 (*DotFunc)(const int16 *a, const int16 *b, uint len);
+
+	/** The selected implementation, nullptr until getDotFunc() is first called. */
+	static DotFunc dotFunc;
+
+	/** Returns the dot product function, detecting the CPU features if needed. */
+	static DotFunc getDotFunc();
+
+	static int32 dotGeneric(const int16 *a, const int16 *b, uint len);
+#ifdef SCUMMVM_NEON
+	static int32 dotNEON(const int16 *a, const int16 *b, uint len);
+#endif
+#ifdef SCUMMVM_SSE2
+	static int32 dotSSE2(const int16 *a, const int16 *b, uint len);
+#endif
+#ifdef SCUMMVM_AVX2
+	static int32 dotAVX2(const int16 *a, const int16 *b, uint len);
+#endif
+};
+
+/**
+ * Creates a band-limited polyphase rate converter. The filter banks are
+ * shared between all converters of the same quality, and built by
+ * prepareSincRateConverters(), or along with the first of them.
+ */
+RateConverter *makeSincRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality);
+
+/**
+ * Builds the filter banks of the given quality, unless they exist already.
+ */
+void prepareSincRateConverters(ResamplerQuality quality);
+
+} // End of namespace Audio
+
+#endif
@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "audio/rate_intern.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace Audio {
+
+// Scales by the volume and divides by Mixer::kMaxMixerVolume, rounding
+// towards zero like C does
+static FORCEINLINE int16x4_t neon_scale(int16x4_t in, int16x4_t vol) {
+	int32x4_t a = vmull_s16(in, vol);
+	a = vaddq_s32(a, vandq_s32(vshrq_n_s32(a, 31), vdupq_n_s32(255)));
+	return vqmovn_s32(vshrq_n_s32(a, 8));
+}
+
+void StereoMix::mixNEON(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	const int16_t volArray[4] = { (int16_t)volL, (int16_t)volR, (int16_t)volL, (int16_t)volR };
+	const int16x4_t vol = vld1_s16(volArray);
+
+	// Four stereo frames per iteration
+	uint i = 0;
+	for (; i + 4 <= numFrames; i += 4) {
+		int16x8_t in = vld1q_s16(src + i * 2);
+		int16x8_t out = vld1q_s16(dst + i * 2);
+
+		int16x8_t scaled = vcombine_s16(neon_scale(vget_low_s16(in), vol), neon_scale(vget_high_s16(in), vol));
+
+		out = vqaddq_s16(out, scaled);
+		vst1q_s16(dst + i * 2, out);
+	}
+
+	mixGeneric(dst + i * 2, src + i * 2, numFrames - i, volL, volR);
+}
+
+int32 SincFilter::dotNEON(const int16 *a, const int16 *b, uint len) {
+	int32x4_t sum = vdupq_n_s32(0);
+	for (uint i = 0; i < len; i += 8) {
+		int16x8_t va = vld1q_s16(a + i);
+		int16x8_t vb = vld1q_s16(b + i);
+		sum = vmlal_s16(sum, vget_low_s16(va), vget_low_s16(vb));
+		sum = vmlal_s16(sum, vget_high_s16(va), vget_high_s16(vb));
+	}
+
+	int32x2_t pair = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(pair, pair), 0);
+}
+
+} // End of namespace Audio
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,457 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate_intern.h"
+#include "common/algorithm.h"
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/system.h"
+#include "common/util.h"
+
+#include <math.h>
+
+namespace Audio {
+
+enum {
+	/** Fixed-point precision of the filter coefficients */
+	SINC_COEF_BITS = 14,
+
+	/** Longest filter kernel, used when downsampling by large factors */
+	SINC_MAX_TAPS = 128,
+
+	/** Number of input frames buffered beyond the filter kernel */
+	SINC_HISTORY_FRAMES = 512 + SINC_MAX_TAPS
+};
+
+int32 SincFilter::dotGeneric(const int16 *a, const int16 *b, uint len) {
+	int32 sum = 0;
+	for (uint i = 0; i < len; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+// Initialize this to nullptr at the start
+SincFilter::DotFunc SincFilter::dotFunc = nullptr;
+
+SincFilter::DotFunc SincFilter::getDotFunc() {
+	// If no function has been selected yet, detect and select
+	if (!dotFunc) {
+		DotFunc func = dotGeneric;
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) func = dotNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) func = dotSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) func = dotAVX2;
+#endif
+		dotFunc = func;
+	}
+
+	return dotFunc;
+}
+
+/**
+ * A bank of windowed-sinc filters for the conversion ratios of one ratio
+ * class, with the kernels of a fixed number of fractional positions (phases)
+ * between two input frames.
+ */
+struct SincFilterBank {
+	uint numPhases;
+	uint numTaps;
+	int16 *coefs;
+
+	SincFilterBank(double ratio, ResamplerQuality quality);
+	~SincFilterBank() { delete[] coefs; }
+
+	/** Returns the kernel of the phase closest to the fractional position frac / denominator. */
+	const int16 *getKernel(uint32 frac, uint32 denominator) const {
+		const uint phase = (uint)(((uint64)frac * numPhases + denominator / 2) / denominator);
+		return coefs + phase * numTaps;
+	}
+};
+
+static double besselI0(double x) {
+	// Power series, converges quickly for the window parameters used here
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+SincFilterBank::SincFilterBank(double ratio, ResamplerQuality quality) {
+	const bool best = (quality == kResamplerSincBest);
+	const double beta = best ? 9.0 : 6.0;
+
+	// When downsampling, the cutoff frequency has to be lowered to the new
+	// Nyquist frequency, and the kernel stretched accordingly.
+	const double cutoff = ratio * (best ? 0.95 : 0.90);
+
+	// One more phase for the position right at the next input frame, which
+	// the rounding in getKernel() can pick
+	numPhases = best ? 1024 : 256;
+	numTaps = (uint)((best ? 32 : 16) / ratio);
+	numTaps = MIN<uint>((numTaps + 7) & ~7, SINC_MAX_TAPS);
+	coefs = new int16[(numPhases + 1) * numTaps];
+
+	const double halfWidth = numTaps / 2.0;
+	const double windowScale = 1.0 / besselI0(beta);
+
+	for (uint phase = 0; phase <= numPhases; phase++) {
+		const double offset = (double)phase / numPhases;
+		double kernel[SINC_MAX_TAPS];
+		double sum = 0.0;
+
+		for (uint tap = 0; tap < numTaps; tap++) {
+			// Distance between the output position and this input sample
+			const double x = (double)tap - (halfWidth - 1) - offset;
+			const double arg = x / halfWidth;
+			double value = 0.0;
+
+			if (arg > -1.0 && arg < 1.0) {
+				const double window = besselI0(beta * sqrt(1.0 - arg * arg)) * windowScale;
+				const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+				value = cutoff * sinc * window;
+			}
+
+			kernel[tap] = value;
+			sum += value;
+		}
+
+		// Normalize every phase to unity gain, so that there is no ripple
+		// between phases for constant signals
+		int16 *dst = coefs + phase * numTaps;
+		for (uint tap = 0; tap < numTaps; tap++)
+			dst[tap] = (int16)CLIP<double>(floor(kernel[tap] / sum * (1 << SINC_COEF_BITS) + 0.5), -32768, 32767);
+	}
+}
+
+/**
+ * The filter banks, shared between all channels.
+ *
+ * Building a bank takes a while, so all the banks of a quality are built at
+ * once by prepareSincRateConverters(). The mixer calls it when it is set up
+ * or its quality is changed, without holding any of its locks; otherwise,
+ * the first converter of the quality builds them. Converters only ever pick
+ * one of them afterwards, so changing the rates of a channel (e.g. pitch
+ * sweeps) never stalls the mixer thread.
+ *
+ * Upsampling uses a single bank. Downsampling ratios are rounded down to
+ * ratio classes a quarter octave apart, which only lowers the cutoff
+ * frequency by up to 16%. Ratios below the last class use its bank, where
+ * the kernel is at its longest anyway.
+ */
+class SincFilterCache : public Common::Singleton<SincFilterCache> {
+public:
+	enum {
+		kNumRatioClasses = 13 // down to 1/8
+	};
+
+	void prepare(ResamplerQuality quality) {
+		Common::StackLock lock(_mutex);
+
+		SincFilterBank **banks = _banks[quality == kResamplerSincBest];
+		if (banks[0])
+			return;
+
+		for (int i = 0; i < kNumRatioClasses; i++)
+			banks[i] = new SincFilterBank(_ratios[i], quality);
+	}
+
+	/** Returns the bank for the given rates. The quality has to be prepared. */
+	const SincFilterBank *getBank(st_rate_t inRate, st_rate_t outRate, ResamplerQuality quality) const {
+		const double ratio = (double)outRate / inRate;
+		int ratioClass = 0;
+		while (ratioClass < kNumRatioClasses - 1 && _ratios[ratioClass] > ratio)
+			ratioClass++;
+
+		const SincFilterBank *bank = _banks[quality == kResamplerSincBest][ratioClass];
+		assert(bank);
+		return bank;
+	}
+
+	~SincFilterCache() {
+		for (int q = 0; q < 2; q++) {
+			for (int i = 0; i < kNumRatioClasses; i++)
+				delete _banks[q][i];
+		}
+	}
+
+private:
+	friend class Common::Singleton<SincFilterCache>;
+	SincFilterCache() {
+		for (int i = 0; i < kNumRatioClasses; i++)
+			_ratios[i] = pow(2.0, -i / 4.0);
+		memset(_banks, 0, sizeof(_banks));
+	}
+
+	Common::Mutex _mutex;
+	double _ratios[kNumRatioClasses];
+	SincFilterBank *_banks[2][kNumRatioClasses];
+};
+
+} // End of namespace Audio
+
+namespace Common {
+DECLARE_SINGLETON(Audio::SincFilterCache);
+}
+
+namespace Audio {
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+class SincRateConverter_Impl : public RateConverter {
+private:
+	/** Input and output rates */
+	st_rate_t _inRate, _outRate;
+
+	ResamplerQuality _quality;
+
+	/** Rates the conversion factors and the filter bank were chosen for */
+	st_rate_t _bankInRate, _bankOutRate;
+
+	/** The conversion ratio reduced to lowest terms: outRate / inRate = _upFactor / _downFactor */
+	uint32 _upFactor, _downFactor;
+
+	/** Filter bank matching the current rates */
+	const SincFilterBank *_bank;
+
+	/**
+	 * Input history, one array per channel. The filter kernel is applied
+	 * to the frames starting at _historyPos.
+	 */
+	int16 _historyL[SINC_HISTORY_FRAMES];
+	int16 _historyR[SINC_HISTORY_FRAMES];
+	int _historyPos;
+	int _historySize;
+
+	/** Fractional position of the output stream in input stream unit, over _upFactor */
+	uint32 _frac;
+
+	/** Whether the end of the stream has been padded with silence already */
+	bool _flushed;
+
+	StereoMix::MixFunc _mixFunc;
+	SincFilter::DotFunc _dotFunc;
+
+	void updateRates();
+	bool fillHistory(AudioStream &input);
+	int resample(AudioStream &input, st_sample_t *frames, st_size_t numFrames);
+
+public:
+	SincRateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate, ResamplerQuality quality);
+	virtual ~SincRateConverter_Impl() {}
+
+	int convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) override;
+
+	void setInputRate(st_rate_t inputRate) override { _inRate = inputRate; }
+	void setOutputRate(st_rate_t outputRate) override { _outRate = outputRate; }
+
+	st_rate_t getInputRate() const override { return _inRate; }
+	st_rate_t getOutputRate() const override { return _outRate; }
+
+	bool needsDraining() const override { return !_flushed || _historySize - _historyPos >= (int)_bank->numTaps; }
+};
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::SincRateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate, ResamplerQuality quality) :
+	_inRate(inputRate),
+	_outRate(outputRate),
+	_quality(quality),
+	_bankInRate(0),
+	_bankOutRate(0),
+	_upFactor(0),
+	_downFactor(0),
+	_bank(nullptr),
+	_historyPos(0),
+	_historySize(0),
+	_frac(0),
+	_flushed(false),
+	_mixFunc(StereoMix::getMixFunc()),
+	_dotFunc(SincFilter::getDotFunc()) {
+	SincFilterCache::instance().prepare(quality);
+	updateRates();
+
+	// Center the first kernel on the first input frame
+	_historySize = _bank->numTaps / 2 - 1;
+	memset(_historyL, 0, _historySize * sizeof(int16));
+	memset(_historyR, 0, _historySize * sizeof(int16));
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::updateRates() {
+	const uint32 divisor = Common::gcd<uint32>(_inRate, _outRate);
+	const uint32 upFactor = _outRate / divisor;
+
+	// Keep the fractional position when the rates get changed
+	if (_upFactor)
+		_frac = (uint32)(((uint64)_frac * upFactor) / _upFactor);
+
+	_upFactor = upFactor;
+	_downFactor = _inRate / divisor;
+	_bankInRate = _inRate;
+	_bankOutRate = _outRate;
+	_bank = SincFilterCache::instance().getBank(_inRate, _outRate, _quality);
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+bool SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::fillHistory(AudioStream &input) {
+	// Move the remaining frames to the start of the history
+	if (_historyPos > 0) {
+		// The position can overshoot the history for extreme downsampling
+		// ratios, where the kernel length is capped. The overshoot is kept
+		// so that the frames get skipped once they are read.
+		const int consumed = MIN<int>(_historyPos, _historySize);
+		const int remaining = _historySize - consumed;
+		memmove(_historyL, _historyL + consumed, remaining * sizeof(int16));
+		if (inStereo)
+			memmove(_historyR, _historyR + consumed, remaining * sizeof(int16));
+		_historySize = remaining;
+		_historyPos -= consumed;
+	}
+
+	st_sample_t buffer[SINC_HISTORY_FRAMES * (inStereo ? 2 : 1)];
+	const int wanted = (SINC_HISTORY_FRAMES - _historySize) * (inStereo ? 2 : 1);
+	const int read = (wanted > 0 && !_flushed) ? input.readBuffer(buffer, wanted) : 0;
+
+	if (read > 0) {
+		if (inStereo) {
+			for (int i = 0; i < read / 2; i++) {
+				_historyL[_historySize + i] = buffer[2 * i];
+				_historyR[_historySize + i] = buffer[2 * i + 1];
+			}
+			_historySize += read / 2;
+		} else {
+			memcpy(_historyL + _historySize, buffer, read * sizeof(int16));
+			_historySize += read;
+		}
+		return true;
+	}
+
+	// Once the stream has ended, pad it with silence so that the last
+	// frames make it through the filter.
+	if (!_flushed && input.endOfStream()) {
+		const int padding = MIN<int>(_bank->numTaps / 2, SINC_HISTORY_FRAMES - _historySize);
+		memset(_historyL + _historySize, 0, padding * sizeof(int16));
+		memset(_historyR + _historySize, 0, padding * sizeof(int16));
+		_historySize += padding;
+		_flushed = true;
+		return padding > 0;
+	}
+
+	return false;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::resample(AudioStream &input, st_sample_t *frames, st_size_t numFrames) {
+	if (_bankInRate != _inRate || _bankOutRate != _outRate)
+		updateRates();
+
+	const int numTaps = _bank->numTaps;
+	const uint32 upFactor = _upFactor;
+	const uint32 downFactor = _downFactor;
+	const int round = 1 << (SINC_COEF_BITS - 1);
+
+	st_size_t count = 0;
+	while (count < numFrames) {
+		// Make sure the whole kernel is covered by the history
+		if (_historySize - _historyPos < numTaps && !fillHistory(input))
+			break;
+		if (_historySize - _historyPos < numTaps)
+			continue;
+
+		const int16 *kernel = _bank->getKernel(_frac, upFactor);
+		const int32 sumL = _dotFunc(kernel, _historyL + _historyPos, numTaps);
+		const int32 sumR = inStereo ? _dotFunc(kernel, _historyR + _historyPos, numTaps) : sumL;
+		const st_sample_t outL = (st_sample_t)CLIP<int32>((sumL + round) >> SINC_COEF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+		const st_sample_t outR = (st_sample_t)CLIP<int32>((sumR + round) >> SINC_COEF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+
+		frames[reverseStereo    ] = outL;
+		frames[reverseStereo ^ 1] = outR;
+		frames += 2;
+		count++;
+
+		// Advance the output position
+		_frac += downFactor;
+		_historyPos += _frac / upFactor;
+		_frac %= upFactor;
+	}
+
+	return count;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int SincRateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	assert(input.isStereo() == inStereo);
+
+	// The frames are stored in output channel order, so swap the volumes too
+	const st_volume_t vol0 = reverseStereo ? volR : volL;
+	const st_volume_t vol1 = reverseStereo ? volL : volR;
+
+	st_sample_t frames[MIX_CHUNK_FRAMES * 2];
+	int total = 0;
+
+	while (numSamples > 0) {
+		const st_size_t chunk = MIN<st_size_t>(numSamples, MIX_CHUNK_FRAMES);
+		const int count = resample(input, frames, chunk);
+
+		mixFrames<outStereo>(outBuffer, frames, count, vol0, vol1, volL, volR, _mixFunc);
+		outBuffer += count * (outStereo ? 2 : 1);
+
+		total += count;
+		numSamples -= count;
+
+		// Stop once the input stream ran dry
+		if ((st_size_t)count < chunk)
+			break;
+	}
+
+	return total;
+}
+
+void prepareSincRateConverters(ResamplerQuality quality) {
+	SincFilterCache::instance().prepare(quality);
+}
+
+RateConverter *makeSincRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality) {
+	if (inStereo) {
+		if (outStereo) {
+			if (reverseStereo)
+				return new SincRateConverter_Impl<true, true, true>(inRate, outRate, quality);
+			else
+				return new SincRateConverter_Impl<true, true, false>(inRate, outRate, quality);
+		} else
+			return new SincRateConverter_Impl<true, false, false>(inRate, outRate, quality);
+	} else {
+		if (outStereo) {
+			return new SincRateConverter_Impl<false, true, false>(inRate, outRate, quality);
+		} else
+			return new SincRateConverter_Impl<false, false, false>(inRate, outRate, quality);
+	}
+}
+
+} // End of namespace Audio
@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/rate_intern.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Audio {
+
+// Divides by Mixer::kMaxMixerVolume, rounding towards zero like C does
+static FORCEINLINE __m128i sse2_div256(__m128i a) {
+	return _mm_srai_epi32(_mm_add_epi32(a, _mm_and_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(255))), 8);
+}
+
+void StereoMix::mixSSE2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	// Four stereo frames per iteration
+	uint i = 0;
+	for (; i + 4 <= numFrames; i += 4) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(src + i * 2));
+		__m128i out = _mm_loadu_si128((const __m128i *)(dst + i * 2));
+
+		__m128i lo = _mm_mullo_epi16(in, vol);
+		__m128i hi = _mm_mulhi_epi16(in, vol);
+		__m128i scaled = _mm_packs_epi32(sse2_div256(_mm_unpacklo_epi16(lo, hi)), sse2_div256(_mm_unpackhi_epi16(lo, hi)));
+
+		out = _mm_adds_epi16(out, scaled);
+		_mm_storeu_si128((__m128i *)(dst + i * 2), out);
+	}
+
+	mixGeneric(dst + i * 2, src + i * 2, numFrames - i, volL, volR);
+}
+
+int32 SincFilter::dotSSE2(const int16 *a, const int16 *b, uint len) {
+	__m128i sum = _mm_setzero_si128();
+	for (uint i = 0; i < len; i += 8)
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+} // End of namespace Audio
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
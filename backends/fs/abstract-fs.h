@@ -172,6 +172,18 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the last modification time of the file referred
+	 * by this node without opening it. The modification time uses an
+	 * unspecified, backend specific unit and is only meant to be compared
+	 * against earlier values for the same node.
+	 *
+	 * The default implementation reports the information as unavailable.
+	 *
+	 * @return bool true if the information could be retrieved, false otherwise.
+	 */
+	virtual bool getFileStats(int64 &size, int64 &modificationTime) const;
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -192,6 +204,15 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStreamForAltStream(Common::AltStreamType altStreamType);
 
+	/**
+	 * Creates a SeekableReadStream instance for the file referred by this
+	 * node by mapping it into memory. Backends without support for memory
+	 * mapped files return 0, in which case a regular stream is used.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream();
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -34,6 +34,7 @@
 #include "backends/fs/posix/posix-fs.h"
 #include "backends/fs/posix/posix-iostream.h"
 #include "common/algorithm.h"
+#include "common/memstream.h"
 
 #include <sys/param.h>
 #include <sys/stat.h>
@@ -49,6 +50,9 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#ifdef HAS_MMAP
+#include <sys/mman.h>
+#endif
 
 #ifdef __OS2__
 #define INCL_DOS
@@ -67,6 +71,16 @@ bool POSIXFilesystemNode::isWritable() const {
 	return access(_path.c_str(), W_OK) == 0;
 }
 
+bool POSIXFilesystemNode::getFileStats(int64 &size, int64 &modificationTime) const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0)
+		return false;
+
+	size = st.st_size;
+	modificationTime = st.st_mtime;
+	return true;
+}
+
 void POSIXFilesystemNode::setFlags() {
 	struct stat st;
 
@@ -280,6 +294,41 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStreamForAltStream(Co
 	return nullptr;
 }
 
+#ifdef HAS_MMAP
+namespace {
+
+struct MunmapDeleter {
+	size_t _size;
+	MunmapDeleter(size_t size) : _size(size) {}
+	void operator()(const byte *ptr) { munmap(const_cast<byte *>(ptr), _size); }
+};
+
+} // End of anonymous namespace
+
+Common::SeekableReadStream *POSIXFilesystemNode::createMappedReadStream() {
+	int fd = open(_path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	// Empty files cannot be mapped, and MemoryReadStream is limited to 32-bit sizes
+	struct stat st;
+	if (fstat(fd, &st) == -1 || st.st_size <= 0 || (uint64)st.st_size > 0xFFFFFFFF) {
+		close(fd);
+		return nullptr;
+	}
+
+	size_t size = st.st_size;
+	void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid once the descriptor is closed
+	close(fd);
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	Common::SharedPtr<const byte> mapping((const byte *)data, MunmapDeleter(size));
+	return new Common::MappedFileReadStream(mapping, size);
+}
+#endif
+
 Common::SeekableWriteStream *POSIXFilesystemNode::createWriteStream() {
 	return PosixIoStream::makeFromPath(getPath(), true);
 }
@@ -119,7 +119,11 @@ void SdlMixerManager::init() {
 	if (_obtained.channels != 1 && _obtained.channels != 2)
 		error("SDL mixer output requires mono or stereo output device");
 
-	_mixer = new Audio::MixerImpl(_obtained.freq, _obtained.channels >= 2, desired.samples);
+	const bool nonBlocking = ConfMan.hasKey("mixer_nonblocking") && ConfMan.getBool("mixer_nonblocking");
+	if (nonBlocking)
+		debug(1, "Using non-blocking mixer");
+
+	_mixer = new Audio::MixerImpl(_obtained.freq, _obtained.channels >= 2, desired.samples, nonBlocking);
 	assert(_mixer);
 	_mixer->setReady(true);
 
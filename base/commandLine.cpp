@@ -96,6 +96,7 @@ static const char HELP_STRING1[] =
 	"  --auto-detect            Display a list of games from current or specified directory\n"
 	"                           and start the first one. Use --path=PATH to specify a directory.\n"
 	"  --recursive              In combination with --add or --detect recurse down all subdirectories\n"
+	"  --clear-detection-cache  Remove the cached checksums of game files used to speed up detection\n"
 	"  --no-exit                In combination with commands that exit after running, like --add or --list-engines,\n"
 	"                           open the launcher instead of exiting\n"
 #if defined(WIN32)
@@ -714,6 +715,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_COMMAND("list-saves")
 			END_COMMAND
 
+			DO_LONG_COMMAND("clear-detection-cache")
+			END_COMMAND
+
 			DO_OPTION('c', "config")
 			END_OPTION
 
@@ -1473,10 +1477,10 @@ static void dumpAllDetectionEntries() {
 }
 
 /** Display all games in the given directory, or current directory if empty */
-static DetectedGames getGameList(const Common::FSNode &dir) {
-	Common::FSList files;
-
-	// Collect all files from directory
+static DetectedGames getGameList(const Common::FSNode &dir, Common::FSList &files) {
+	// Collect all files from directory. The list is also used by the callers
+	// to recurse into the subdirectories, so that every directory is only
+	// listed once.
 	if (!dir.getChildren(files, Common::FSNode::kListAll)) {
 		printf("Path %s does not exist or is not a directory.\n", dir.getPath().toString(Common::Path::kNativeSeparator).c_str());
 		return DetectedGames();
@@ -1494,12 +1498,14 @@ static DetectedGames getGameList(const Common::FSNode &dir) {
 }
 
 static DetectedGames recListGames(const Common::FSNode &dir, const Common::String &engineId, const Common::String &gameId, bool recursive) {
-	DetectedGames list = getGameList(dir);
+	Common::FSList files;
+	DetectedGames list = getGameList(dir, files);
 
 	if (recursive) {
-		Common::FSList files;
-		dir.getChildren(files, Common::FSNode::kListDirectoriesOnly);
 		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+			if (!file->isDirectory())
+				continue;
+
 			DetectedGames rec = recListGames(*file, engineId, gameId, recursive);
 			for (DetectedGames::const_iterator game = rec.begin(); game != rec.end(); ++game) {
 				if ((game->engineId == engineId && game->gameId == gameId)
@@ -1517,7 +1523,9 @@ static Common::String detectGames(const Common::Path &path, const Common::String
 	bool noPath = path.empty();
 	//Current directory
 	Common::FSNode dir(path);
+	const uint32 startTime = g_system->getMillis();
 	DetectedGames candidates = recListGames(dir, engineId, gameId, recursive);
+	debug(1, "Detection finished in %u ms", g_system->getMillis() - startTime);
 
 	if (candidates.empty()) {
 		printf("WARNING: ScummVM could not find any game in %s\n", dir.getPath().toString(Common::Path::kNativeSeparator).c_str());
@@ -1544,7 +1552,8 @@ static Common::String detectGames(const Common::Path &path, const Common::String
 
 static int recAddGames(const Common::FSNode &dir, const Common::String &engineId, const Common::String &gameId, bool recursive) {
 	int count = 0;
-	DetectedGames list = getGameList(dir);
+	Common::FSList files;
+	DetectedGames list = getGameList(dir, files);
 	for (DetectedGames::const_iterator v = list.begin(); v != list.end(); ++v) {
 		if ((v->engineId != engineId || v->gameId != gameId)
 		    && !gameId.empty()) {
@@ -1571,11 +1580,9 @@ static int recAddGames(const Common::FSNode &dir, const Common::String &engineId
 	}
 
 	if (recursive) {
-		Common::FSList files;
-		if (dir.getChildren(files, Common::FSNode::kListDirectoriesOnly)) {
-			for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+			if (file->isDirectory())
 				count += recAddGames(*file, engineId, gameId, recursive);
-			}
 		}
 	}
 
@@ -1660,7 +1667,9 @@ static void calcMD5Mac(Common::Path &filePath, int32 length) {
 static bool addGames(const Common::Path &path, const Common::String &engineId, const Common::String &gameId, bool recursive) {
 	//Current directory
 	Common::FSNode dir(path);
+	const uint32 startTime = g_system->getMillis();
 	int added = recAddGames(dir, engineId, gameId, recursive);
+	debug(1, "Detection finished in %u ms", g_system->getMillis() - startTime);
 	printf("Added %d games\n", added);
 	if (added == 0 && !recursive) {
 		printf("Consider using --recursive to search inside subdirectories\n");
@@ -1926,6 +1935,12 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 	} else if (command == "list-themes") {
 		listThemes();
 		return cmdDoExit;
+	} else if (command == "clear-detection-cache") {
+		if (ADCacheMan.clearPersistentCache())
+			printf("Detection cache cleared\n");
+		else
+			err = Common::kWritingFailed;
+		return cmdDoExit;
 	} else if (command == "list-audio-devices") {
 		listAudioDevices();
 		return cmdDoExit;
@@ -290,6 +290,7 @@ void SearchSet::add(const String &name, Archive *archive, int priority, bool aut
 	if (find(name) == _list.end()) {
 		Node node(priority, name, archive, autoFree);
 		insert(node);
+		invalidateIndex();
 	} else {
 		if (autoFree)
 			delete archive;
@@ -374,6 +375,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		invalidateIndex();
 	}
 }
 
@@ -397,6 +399,7 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	invalidateIndex();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -413,16 +416,76 @@ void SearchSet::setPriority(const String &name, int priority) {
 	_list.erase(it);
 	node._priority = priority;
 	insert(node);
+	invalidateIndex();
+}
+
+void SearchSet::enablePathIndex(bool enable) {
+	_indexEnabled = enable;
+	invalidateIndex();
+}
+
+void SearchSet::buildIndex() const {
+	_index.clear();
+
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for (; it != _list.end(); ++it) {
+		ArchiveMemberList members;
+		if (!it->_arc->listMembers(members))
+			break;
+
+		for (ArchiveMemberList::const_iterator m = members.begin(); m != members.end(); ++m) {
+			// Keep the archive with the highest priority
+			Path path = (*m)->getPathInArchive();
+			if (!_index.contains(path))
+				_index[path] = it;
+		}
+	}
+
+	_indexEnd = it;
+	_indexValid = true;
+}
+
+SearchSet::ArchiveNodeList::const_iterator SearchSet::findFirstCandidate(const Path &path) const {
+	if (!_indexEnabled)
+		return _list.begin();
+
+	if (!_indexValid)
+		buildIndex();
+
+	PathIndex::const_iterator i = _index.find(path);
+	if (i != _index.end())
+		return i->_value;
+
+	return _indexEnd;
+}
+
+void SearchSet::getLookupStats(LookupStatsList &list) const {
+	for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it) {
+		LookupStats stats;
+		stats.name = it->_name;
+		stats.lookups = it->_lookups;
+		stats.misses = it->_misses;
+		list.push_back(stats);
+	}
+}
+
+void SearchSet::resetLookupStats() {
+	for (ArchiveNodeList::iterator it = _list.begin(); it != _list.end(); ++it) {
+		it->_lookups = 0;
+		it->_misses = 0;
+	}
 }
 
 bool SearchSet::hasFile(const Path &path) const {
 	if (path.empty())
 		return false;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
+	ArchiveNodeList::const_iterator it = findFirstCandidate(path);
 	for (; it != _list.end(); ++it) {
+		it->_lookups++;
 		if (it->_arc->hasFile(path))
 			return true;
+		it->_misses++;
 	}
 
 	return false;
@@ -489,14 +552,16 @@ const ArchiveMemberPtr SearchSet::getMember(const Path &path, Archive **containe
 	if (path.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
+	ArchiveNodeList::const_iterator it = findFirstCandidate(path);
 	for (; it != _list.end(); ++it) {
+		it->_lookups++;
 		if (it->_arc->hasFile(path)) {
 			if (container) {
 				*container = it->_arc;
 			}
 			return it->_arc->getMember(path);
 		}
+		it->_misses++;
 	}
 
 	return ArchiveMemberPtr();
@@ -510,11 +575,13 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const Path &path) const
 	if (path.empty())
 		return nullptr;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
+	ArchiveNodeList::const_iterator it = findFirstCandidate(path);
 	for (; it != _list.end(); ++it) {
+		it->_lookups++;
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(path);
 		if (stream)
 			return stream;
+		it->_misses++;
 	}
 
 	return nullptr;
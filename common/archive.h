@@ -23,6 +23,7 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/error.h"
+#include "common/flat-hashmap.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
 #include "common/list.h"
@@ -315,8 +316,10 @@ class SearchSet : public Archive {
 		String	_name;
 		Archive	*_arc;
 		bool	_autoFree;
+		mutable uint32	_lookups;	//!< Number of times this archive was asked for a file.
+		mutable uint32	_misses;	//!< Number of those requests the archive could not satisfy.
 		Node(int priority, const String &name, Archive *arc, bool autoFree)
-			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree) {
+			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree), _lookups(0), _misses(0) {
 		}
 	};
 	typedef List<Node> ArchiveNodeList;
@@ -329,8 +332,27 @@ class SearchSet : public Archive {
 
 	bool _ignoreClashes;
 
+	/**
+	 * Maps every member path to the first archive (in priority order) listing it.
+	 * Only the archives in front of _indexEnd are part of the index.
+	 */
+	typedef FlatHashMap<Path, ArchiveNodeList::const_iterator, Path::IgnoreCaseAndMac_Hash, Path::IgnoreCaseAndMac_EqualTo> PathIndex;
+	mutable PathIndex _index;
+	mutable ArchiveNodeList::const_iterator _indexEnd;
+	mutable bool _indexValid;
+	bool _indexEnabled;
+
+	void invalidateIndex() { _indexValid = false; _index.clear(); }
+	void buildIndex() const;
+
+	/**
+	 * Return the first archive which may contain the given path. All
+	 * archives in front of it are known not to contain it.
+	 */
+	ArchiveNodeList::const_iterator findFirstCandidate(const Path &path) const;
+
 public:
-	SearchSet() : _ignoreClashes(false) { }
+	SearchSet() : _ignoreClashes(false), _indexValid(false), _indexEnabled(false) { }
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -455,6 +477,39 @@ public:
 	 * in @ref FSDirectory documentation.
 	 */
 	void setIgnoreClashes(bool ignoreClashes) { _ignoreClashes = ignoreClashes; }
+
+	/**
+	 * Enable or disable the path index.
+	 *
+	 * Once the set of archives is complete, enabling the index makes
+	 * hasFile, getMember and createReadStreamForMember resolve a path with
+	 * a single hash lookup instead of asking every archive in turn. The
+	 * index is built from the members listed by each archive on the first
+	 * lookup, and rebuilt after archives are added, removed or reordered.
+	 *
+	 * Archives which do not list any member are never indexed. Those,
+	 * and all archives with a lower priority, are searched the usual way.
+	 * Changes to the contents of the archives themselves are not tracked.
+	 */
+	void enablePathIndex(bool enable = true);
+
+	struct LookupStats {
+		String name;	//!< Name of the archive in the set.
+		uint32 lookups;	//!< Number of times the archive was asked for a file.
+		uint32 misses;	//!< Number of those requests which failed.
+	};
+	typedef List<LookupStats> LookupStatsList;
+
+	/**
+	 * Get the per-archive lookup statistics of hasFile, getMember and
+	 * createReadStreamForMember, in search order.
+	 */
+	void getLookupStats(LookupStatsList &list) const;
+
+	/**
+	 * Reset all lookup statistics to zero.
+	 */
+	void resetLookupStats();
 };
 
 
@@ -136,6 +136,25 @@ static inline bool inflateClickteam(byte *dst, uint  dstLen, const byte *src, ui
 SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped,
 		DisposeAfterUse::Flag disposeParent = DisposeAfterUse::YES, uint64 knownSize = 0);
 
+/**
+ * Same as wrapCompressedReadStream(), but meant for streams which are seeked
+ * around in. While decompressing, the returned stream saves its state about
+ * every checkpointInterval bytes, so that seeking backwards resumes from the
+ * closest checkpoint instead of decompressing everything from the start
+ * again. Each checkpoint takes a bit more than 32 KB. Once maxMemory is used
+ * up, every other checkpoint is dropped and the interval is doubled.
+ *
+ * Without zlib 1.2.8 or newer, this is the same as wrapCompressedReadStream().
+ *
+ * @param toBeWrapped	the stream to be wrapped (if it is in gzip-format)
+ * @param checkpointInterval	number of decompressed bytes between checkpoints
+ * @param maxMemory	memory to use for the checkpoints at most
+ * @param knownSize	a supplied length of the uncompressed data (if not available directly)
+ */
+SeekableReadStream *wrapIndexedCompressedReadStream(SeekableReadStream *toBeWrapped,
+		uint32 checkpointInterval = 256 * 1024, uint32 maxMemory = 4 * 1024 * 1024,
+		DisposeAfterUse::Flag disposeParent = DisposeAfterUse::YES, uint64 knownSize = 0);
+
 /**
  * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
  * provides transparent on-the-fly decompression. Assumes the data it
@@ -151,6 +170,23 @@ SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped,
 		DisposeAfterUse::Flag disposeParent = DisposeAfterUse::YES, uint64 knownSize = 0,
 		const byte *dict = nullptr, uint dictLen = 0);
 
+/**
+ * Same as wrapCompressedReadStream(), but always uses the decompressor
+ * built into ScummVM, even when zlib is available. This is what
+ * wrapCompressedReadStream() does when ScummVM is built without zlib.
+ */
+SeekableReadStream *wrapBuiltinCompressedReadStream(SeekableReadStream *toBeWrapped,
+		DisposeAfterUse::Flag disposeParent = DisposeAfterUse::YES, uint64 knownSize = 0);
+
+/**
+ * Same as wrapDeflateReadStream(), but always uses the decompressor built
+ * into ScummVM, even when zlib is available. This is what
+ * wrapDeflateReadStream() does when ScummVM is built without zlib.
+ */
+SeekableReadStream *wrapBuiltinDeflateReadStream(SeekableReadStream *toBeWrapped,
+		DisposeAfterUse::Flag disposeParent = DisposeAfterUse::YES, uint64 knownSize = 0,
+		const byte *dict = nullptr, uint dictLen = 0);
+
 /**
  * Take an arbitrary SeekableReadStream and wrap it in a custom stream which
  * provides transparent on-the-fly decompression. Assumes the data it
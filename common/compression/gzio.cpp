@@ -63,7 +63,7 @@ namespace Common {
 
 typedef unsigned char uch;
 typedef unsigned short ush;
-typedef unsigned long ulg;
+typedef uint64 ulg;
 
 
 
@@ -209,7 +209,17 @@ static const ush mask_bits[] =
 };
 
 
-#define NEEDBITS(n) do {while(k<(n)){b|=((ulg)parentGetByte())<<k;k+=8;}} while (0)
+/* The bit buffer is 64 bits wide.  As long as there are at least eight
+   bytes left in the input buffer, REFILLBITS tops it up to 56..63 bits with
+   a single unaligned load instead of going byte by byte.  The bits above k
+   are then the low bits of the next unread byte, which is harmless since
+   NEEDBITS or REFILLBITS will OR the very same bits there again.  Bytes
+   which were pulled into the bit buffer but not used by the codes are given
+   back to stored blocks before reading any more input, see
+   init_stored_block() and inflate_window(). */
+
+#define REFILLBITS() do {b|=READ_LE_UINT64(_inbuf+_inbufD)<<k;_inbufD+=(63-k)>>3;k|=56;} while (0)
+#define NEEDBITS(n) do {if(k<(n)){if(_inbufD+8<=_inbufSize)REFILLBITS();else while(k<(n)){b|=((ulg)parentGetByte())<<k;k+=8;}}} while (0)
 #define DUMPBITS(n) do {b>>=(n);k-=(n);} while (0)
 
 /* The state stored in filesystem-specific data.  */
@@ -274,7 +284,7 @@ private:
 	/* The index of a copy.  */
 	unsigned _inflateD;
 	/* The bit buffer.  */
-	unsigned long _bb;
+	ulg _bb;
 	/* The bits in the bit buffer.  */
 	unsigned _bk;
 	/* The sliding window in uncompressed data.  */
@@ -289,6 +299,9 @@ private:
 	int _bl;
 	/* The lookup bits for the distance code table.  */
 	int _bd;
+	/* Pairs of literals decoded by a single lookup in the literal/length
+	   code table, see build_literal_pairs().  */
+	uint32 _pairs[1 << lbits];
 	/* The original offset value.  */
 	int64 _savedOffset;
 
@@ -307,6 +320,7 @@ private:
 	byte parentGetByte();
 	void parentSeek(int64 off);
 	void init_fixed_block();
+	void build_literal_pairs();
 	int inflate_codes_in_window();
 	void init_dynamic_block ();
 	void init_stored_block ();
@@ -582,6 +596,9 @@ GzioReadStream::inflate_codes_in_window()
   unsigned w;			/* current window position */
   struct huft *t;		/* pointer to table entry */
   unsigned ml, md;		/* masks for bl and bd bits */
+  uint32 pair;			/* pair of literals */
+  uch *out;			/* output and input of a match copy */
+  const uch *in;
   ulg b;			/* bit buffer */
   unsigned k;			/* number of bits in bit buffer */
 
@@ -605,6 +622,106 @@ GzioReadStream::inflate_codes_in_window()
 	      return 1;
 	    }
 
+	  /* As long as the input buffer holds enough bytes for a whole
+	     length/distance pair and the window has room for the longest
+	     match, decode without checking for either after every code.
+	     The window must not fill up here, as the slow path below only
+	     notices a full window right after writing its last byte.  */
+	  while (w < WSIZE - 258 && _inbufD + 8 <= _inbufSize)
+	    {
+	      REFILLBITS ();
+
+	      pair = _pairs[(unsigned) b & ml];
+	      if (pair)		/* two literals in a single lookup */
+		{
+		  _slide[w] = (uch) pair;
+		  _slide[w + 1] = (uch) (pair >> 8);
+		  w += 2;
+		  DUMPBITS (pair >> 16);
+		  continue;
+		}
+
+	      if ((e = (t = _tl + ((unsigned) b & ml))->e) > 16)
+		do
+		  {
+		    if (e == 99)
+		      {
+			_err = true;
+			return 1;
+		      }
+		    DUMPBITS (t->b);
+		    e -= 16;
+		  }
+		while ((e = (t = t->v.t + ((unsigned) b & mask_bits[e]))->e) > 16);
+	      DUMPBITS (t->b);
+
+	      if (e == 16)	/* literal */
+		{
+		  _slide[w++] = (uch) t->v.n;
+		  continue;
+		}
+
+	      if (e == 15)	/* end of block */
+		{
+		  _blockLen = 0;
+		  break;
+		}
+
+	      /* get length of block to copy */
+	      n = t->v.n + ((unsigned) b & mask_bits[e]);
+	      DUMPBITS (e);
+
+	      if (_td == NULL)
+		{
+		  _err = true;
+		  return 1;
+		}
+
+	      /* decode distance of block to copy */
+	      if ((e = (t = _td + ((unsigned) b & md))->e) > 16)
+		do
+		  {
+		    if (e == 99)
+		      {
+			_err = true;
+			return 1;
+		      }
+		    DUMPBITS (t->b);
+		    e -= 16;
+		  }
+		while ((e = (t = t->v.t + ((unsigned) b & mask_bits[e]))->e) > 16);
+	      DUMPBITS (t->b);
+	      d = t->v.n + ((unsigned) b & mask_bits[e]);
+	      DUMPBITS (e);
+
+	      /* do the copy, eight bytes at a time whenever source and
+		 destination are far enough apart */
+	      if (d <= w)
+		{
+		  out = _slide + w;
+		  in = out - d;
+		  w += n;
+		  if (d >= 8)
+		    for (; n >= 8; n -= 8, out += 8, in += 8)
+		      memcpy (out, in, 8);
+		  else if (d == 1)
+		    {
+		      memset (out, *in, n);
+		      n = 0;
+		    }
+		  for (; n; n--)
+		    *out++ = *in++;
+		}
+	      else
+		/* the match starts in the previous round of the window */
+		{
+		  for (d = w - d; n; n--)
+		    _slide[w++] = _slide[d++ & (WSIZE - 1)];
+		}
+	    }
+	  if (! _blockLen)
+	    break;
+
 	  NEEDBITS ((unsigned) _bl);
 	  if ((e = (t = _tl + ((unsigned) b & ml))->e) > 16)
 	    do
@@ -718,6 +835,36 @@ GzioReadStream::inflate_codes_in_window()
 }
 
 
+/* Fill _pairs, which tells for each index into the first level literal/
+   length table whether its bits hold two complete literal codes, so that
+   both can be written at once.  An entry holds the first literal in bits
+   0..7, the second one in bits 8..15 and the total code length above that,
+   or zero if the index does not start with two literals. */
+
+void
+GzioReadStream::build_literal_pairs ()
+{
+  unsigned i;
+  unsigned ml = mask_bits[_bl];
+  const struct huft *t1, *t2;
+
+  assert (_bl <= lbits);
+  for (i = 0; i <= ml; i++)
+    {
+      _pairs[i] = 0;
+      t1 = _tl + i;
+      if (t1->e != 16)
+	continue;
+      /* Whatever bits follow the first code, the entry of the remaining
+	 ones in the first level table is the same as long as the second
+	 code fits.  */
+      t2 = _tl + (i >> t1->b);
+      if (t2->e == 16 && t1->b + t2->b <= (unsigned) _bl)
+	_pairs[i] = t1->v.n | (t2->v.n << 8) | ((t1->b + t2->b) << 16);
+    }
+}
+
+
 /* get header for an inflated type 0 (stored) block. */
 
 void
@@ -744,6 +891,10 @@ GzioReadStream::init_stored_block ()
     DUMPBITS (16);
   }
 
+  /* drop the bits of the next unread byte which REFILLBITS may have left
+     above the whole bytes inflate_window() still has to take from here */
+  b &= ((ulg) 1 << k) - 1;
+
   /* restore global variables */
   _bb = b;
   _bk = k;
@@ -787,6 +938,7 @@ GzioReadStream::init_fixed_block ()
       _tl = 0;
       return;
     }
+  build_literal_pairs ();
 
   /* indicate we're now working on a block */
   _codeState = 0;
@@ -939,6 +1091,7 @@ GzioReadStream::init_dynamic_block ()
       _err = true;
       return;
     }
+  build_literal_pairs ();
 
   /* indicate we're now working on a block */
   _codeState = 0;
@@ -1034,7 +1187,7 @@ GzioReadStream::inflate_window ()
 	  if (_lastBlock)
 	    break;
 
-	  if (_inbufD == _inbufSize && _input->eos())
+	  if (_inbufD == _inbufSize && _bk < 8 && _input->eos())
 	    {
 	      /* No buffer anymore on a block boundary */
 	      _lastBlock = true;
@@ -1056,17 +1209,38 @@ GzioReadStream::inflate_window ()
       if (_blockType == INFLATE_STORED)
 	{
 	  int w = _wp;
+	  int len;
 
 	  /*
 	   *  This is basically a glorified pass-through
 	   */
 
-	  while (_blockLen && w < WSIZE && !_err)
+	  /* whole bytes still in the bit buffer come first */
+	  while (_blockLen && w < WSIZE && _bk >= 8)
 	    {
-	      _slide[w++] = parentGetByte ();
+	      _slide[w++] = (uch) _bb;
+	      _bb >>= 8;
+	      _bk -= 8;
 	      _blockLen--;
 	    }
 
+	  while (_blockLen && w < WSIZE && !_err)
+	    {
+	      len = MIN (MIN (_blockLen, WSIZE - w), _inbufSize - _inbufD);
+	      if (len > 0)
+		{
+		  memcpy (_slide + w, _inbuf + _inbufD, len);
+		  _inbufD += len;
+		  w += len;
+		  _blockLen -= len;
+		}
+	      else
+		{
+		  _slide[w++] = parentGetByte ();
+		  _blockLen--;
+		}
+	    }
+
 	  _wp = w;
 
 	  continue;
@@ -1325,8 +1499,7 @@ bool GzioReadStream::seek(int64 offs, int whence) {
 	return true;
 }
 
-#ifndef USE_ZLIB
-SeekableReadStream* wrapCompressedReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 knownSize) {
+SeekableReadStream* wrapBuiltinCompressedReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 knownSize) {
 	if (!parent)
 		return nullptr;
 
@@ -1373,7 +1546,7 @@ SeekableReadStream* wrapCompressedReadStream(Common::SeekableReadStream *parent,
 	return gzio;
 }
 
-SeekableReadStream* wrapDeflateReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 knownSize, const byte *dict, uint dictLen) {
+SeekableReadStream* wrapBuiltinDeflateReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 knownSize, const byte *dict, uint dictLen) {
 	if (!parent)
 		return nullptr;
 
@@ -1383,6 +1556,21 @@ SeekableReadStream* wrapDeflateReadStream(Common::SeekableReadStream *parent, Di
 	return gzio;
 }
 
+#ifndef USE_ZLIB
+SeekableReadStream* wrapCompressedReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 knownSize) {
+	return wrapBuiltinCompressedReadStream(parent, disposeParent, knownSize);
+}
+
+SeekableReadStream* wrapIndexedCompressedReadStream(Common::SeekableReadStream *parent, uint32 checkpointInterval, uint32 maxMemory, DisposeAfterUse::Flag disposeParent, uint64 knownSize) {
+	// Seeking back only restarts from the beginning when it has to go
+	// back more than the 32 KB the window holds
+	return wrapBuiltinCompressedReadStream(parent, disposeParent, knownSize);
+}
+
+SeekableReadStream* wrapDeflateReadStream(Common::SeekableReadStream *parent, DisposeAfterUse::Flag disposeParent, uint64 knownSize, const byte *dict, uint dictLen) {
+	return wrapBuiltinDeflateReadStream(parent, disposeParent, knownSize, dict, dictLen);
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 	// Not supported, return stream itself to write uncompressed data
 	return toBeWrapped;
@@ -91,10 +91,12 @@ typedef Byte Bytef;
 #include "common/crc.h"
 #endif
 
+#include "common/bufferedstream.h"
 #include "common/fs.h"
 #include "common/compression/deflate.h"
 #include "common/compression/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -237,6 +239,12 @@ Common::SharedArchiveContents unzOpenCurrentFile(unzFile file
   If there is no error, the return value is UNZ_OK.
 */
 
+Common::SeekableReadStream *unzOpenCurrentFileStream(unzFile file);
+/*
+  Open a stream reading the current file directly from the zipfile.
+  Return NULL if the file should rather be read with unzOpenCurrentFile.
+*/
+
 int unzCloseCurrentFile(unzFile file);
 /*
   Close the file in zip opened with unzOpenCurrentFile
@@ -284,6 +292,12 @@ int unzGetLocalExtrafield(unzFile file, voidp buf, unsigned len);
 #define UNZ_MAXFILENAMEINZIP (256)
 #endif
 
+/* files at least this big are streamed from the zipfile instead of being
+   read into memory at once */
+#ifndef UNZ_MINSTREAMSIZE
+#define UNZ_MINSTREAMSIZE (65536)
+#endif
+
 #define SIZECENTRALDIRITEM (0x2e)
 #define SIZEZIPLOCALHEADER (0x1e)
 
@@ -316,15 +330,31 @@ typedef struct {
 	uLong current_file_ok;			/* flag about the usability of the current file*/
 	unz_file_info cur_file_info;					/* public info about the current file in zip*/
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
+	uLong pos_data;					/* pos of the data of the file, 0 until its local header was checked */
 } cached_file_in_zip;
 
 typedef Common::HashMap<Common::Path, cached_file_in_zip, Common::Path::IgnoreCase_Hash,
 	Common::Path::IgnoreCase_EqualTo> ZipHash;
 
+/* unz_shared_stream owns the zipfile stream. It is shared with the streams
+   reading files straight from the zipfile, which may outlive the unz_s and
+   be used from other threads.
+*/
+struct unz_shared_stream {
+	Common::ScopedPtr<Common::SeekableReadStream> _stream;
+	Common::Mutex _mutex;	/* to be held while using _stream */
+	bool _mapped;			/* whether _stream is a MappedFileReadStream */
+
+	unz_shared_stream(Common::SeekableReadStream *stream) : _stream(stream),
+		_mapped(dynamic_cast<Common::MappedFileReadStream *>(stream) != nullptr) {
+	}
+};
+
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<unz_shared_stream> _shared;	/* owner of _stream */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -338,6 +368,7 @@ typedef struct {
 
 	unz_file_info cur_file_info;					/* public info about the current file in zip*/
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
+	cached_file_in_zip *cur_cached_file;			/* hash entry of the current file, if located */
 
 	ZipHash _hash;
 } unz_s;
@@ -518,6 +549,8 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 	us->byte_before_the_zipfile = central_pos -
 		                    (us->offset_central_dir + us->size_central_dir);
 	us->central_pos = central_pos;
+	us->cur_cached_file = nullptr;
+	us->_shared = Common::SharedPtr<unz_shared_stream>(new unz_shared_stream(stream));
 
 	err = unzGoToFirstFile((unzFile)us);
 
@@ -534,6 +567,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 		fe.current_file_ok = us->current_file_ok;
 		fe.cur_file_info = us->cur_file_info;
 		fe.cur_file_info_internal = us->cur_file_info_internal;
+		fe.pos_data = 0;
 
 		bool isDirectory = false;
 		if (*szCurrentFileName) {
@@ -600,7 +634,7 @@ int unzClose(unzFile file) {
 		return UNZ_PARAMERROR;
 	s = (unz_s *)file;
 
-	delete s->_stream;
+	// The stream is deleted along with the last stream reading from it
 	delete s;
 	return UNZ_OK;
 }
@@ -792,6 +826,7 @@ int unzGoToFirstFile(unzFile file) {
 	s = (unz_s *)file;
 	s->pos_in_central_dir=s->offset_central_dir;
 	s->num_file = 0;
+	s->cur_cached_file = nullptr;
 	err = unzlocal_GetCurrentFileInfoInternal(file , &s->cur_file_info,
 											 &s->cur_file_info_internal,
 											 nullptr, 0, nullptr, 0, nullptr, 0);
@@ -820,6 +855,7 @@ int unzGoToNextFile(unzFile file) {
 	s->pos_in_central_dir += SIZECENTRALDIRITEM + s->cur_file_info.size_filename +
 			s->cur_file_info.size_file_extra + s->cur_file_info.size_file_comment;
 	s->num_file++;
+	s->cur_cached_file = nullptr;
 	err = unzlocal_GetCurrentFileInfoInternal(file, &s->cur_file_info,
 											   &s->cur_file_info_internal,
 											   nullptr, 0, nullptr, 0, nullptr, 0);
@@ -857,6 +893,7 @@ int unzLocateFile(unzFile file, const Common::Path &szFileName, int iCaseSensiti
 	s->current_file_ok = fe.current_file_ok;
 	s->cur_file_info = fe.cur_file_info;
 	s->cur_file_info_internal = fe.cur_file_info_internal;
+	s->cur_cached_file = &fe;
 
 	return UNZ_OK;
 }
@@ -952,6 +989,32 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s *s, uInt *piSizeVar,
 	return err;
 }
 
+/*
+  Get the position of the data of the current file in the zipfile, checking
+  its local header first. The position is kept in the hash, so that opening
+  the same file again does not need to read the local header.
+  Return 0 if the local header is not valid.
+*/
+static uLong unzlocal_GetCurrentFileDataPos(unz_s *s) {
+	if (s->cur_cached_file && s->cur_cached_file->pos_data)
+		return s->cur_cached_file->pos_data;
+
+	uInt iSizeVar;
+	uLong offset_local_extrafield;  /* offset of the local extra field */
+	uInt  size_local_extrafield;    /* size of the local extra field */
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
+				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
+		return 0;
+
+	uLong pos_data = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER +
+			iSizeVar + s->byte_before_the_zipfile;
+	if (s->cur_cached_file)
+		s->cur_cached_file->pos_data = pos_data;
+
+	return pos_data;
+}
+
 /*
   Open for reading data the current file in the zipfile.
   If there is no error and the file is opened, the return value is UNZ_OK.
@@ -961,10 +1024,8 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 		, const Common::CRC32 &crc
 #endif
 		) {
-	uInt iSizeVar;
 	unz_s *s;
-	uLong offset_local_extrafield;  /* offset of the local extra field */
-	uInt  size_local_extrafield;    /* size of the local extra field */
+	uLong pos_data;
 
 	if (file == nullptr)
 		return Common::SharedArchiveContents();
@@ -972,8 +1033,8 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	if (!s->current_file_ok)
 		return Common::SharedArchiveContents();
 
-	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
-				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
+	pos_data = unzlocal_GetCurrentFileDataPos(s);
+	if (pos_data == 0)
 		return Common::SharedArchiveContents();
 
 	if (s->cur_file_info.compression_method != 0 && s->cur_file_info.compression_method != Z_DEFLATED) {
@@ -984,7 +1045,7 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	uint32 crc32_wait = s->cur_file_info.crc;
 
 	byte *compressedBuffer = new byte[s->cur_file_info.compressed_size];
-	s->_stream->seek(s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar);
+	s->_stream->seek(pos_data);
 	s->_stream->read(compressedBuffer, s->cur_file_info.compressed_size);
 	byte *uncompressedBuffer = nullptr;
 
@@ -1018,6 +1079,262 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	return Common::SharedArchiveContents(uncompressedBuffer, s->cur_file_info.uncompressed_size);
 }
 
+/*
+  Read stream over a range of the zipfile. It reseeks the zipfile stream
+  before each read, and keeps the zipfile stream alive.
+*/
+class unz_range_stream : public Common::SeekableReadStream {
+	Common::SharedPtr<unz_shared_stream> _shared;
+	uint32 _begin;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+public:
+	unz_range_stream(const Common::SharedPtr<unz_shared_stream> &shared, uint32 begin, uint32 size) :
+		_shared(shared), _begin(begin), _size(size), _pos(0), _eos(false), _err(false) {
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		Common::StackLock lock(_shared->_mutex);
+		Common::SeekableReadStream *stream = _shared->_stream.get();
+		if (!stream->seek(_begin + _pos)) {
+			_err = true;
+			return 0;
+		}
+		uint32 bytesRead = stream->read(dataPtr, dataSize);
+		if (bytesRead < dataSize)
+			_err = true;
+		_pos += bytesRead;
+		return bytesRead;
+	}
+
+	bool eos() const override { return _eos; }
+	bool err() const override { return _err; }
+	void clearErr() override { _eos = false; _err = false; }
+
+	int64 pos() const override { return _pos; }
+	int64 size() const override { return _size; }
+
+	bool seek(int64 offset, int whence = SEEK_SET) override {
+		switch (whence) {
+		case SEEK_END:
+			offset += _size;
+			break;
+		case SEEK_CUR:
+			offset += _pos;
+			break;
+		default:
+			break;
+		}
+
+		if (offset < 0 || offset > _size)
+			return false;
+
+		_pos = offset;
+		_eos = false;
+		return true;
+	}
+};
+
+/*
+  Read stream over a deflated member. The member is inflated as it is read,
+  and its CRC32 is checked once the end is reached, like for members which
+  are read into memory at once. Forward seeks skip through the data so that
+  it is still checked. A backward seek would restart the inflation, which
+  gets quadratic for consumers seeking back and forth; so the first one
+  inflates the whole member into memory and later seeks are served from it.
+*/
+class unz_deflate_stream : public Common::SeekableReadStream {
+	Common::SeekableReadStream *_stream;
+	byte *_buffer;
+	uint32 _size;
+	uint32 _pos;
+	uint32 _crcWait;
+	uint32 _crcData;
+	bool _eos;
+	bool _err;
+#ifndef USE_ZLIB
+	Common::CRC32 _crc;
+#endif
+
+	void updateCrc(const byte *data, uint32 dataSize) {
+#ifndef USE_ZLIB
+		for (uint32 i = 0; i < dataSize; i++)
+			_crcData = _crc.processByte(data[i], _crcData);
+#else
+		_crcData = crc32(_crcData, data, dataSize);
+#endif
+	}
+
+	void checkCrc() {
+#ifndef USE_ZLIB
+		_crcData = _crc.finalize(_crcData);
+#endif
+		if (_crcData != _crcWait) {
+			warning("CRC32 mismatch: %08x, %08x", _crcData, _crcWait);
+			_err = true;
+		}
+	}
+
+	bool inflateWhole() {
+		_buffer = new byte[_size];
+		if (!_stream->seek(0) || _stream->read(_buffer, _size) != _size) {
+			_err = true;
+			return false;
+		}
+		delete _stream;
+		_stream = nullptr;
+
+		// Check the whole member, the data read so far may not have been
+		if (_pos < _size) {
+#ifndef USE_ZLIB
+			_crcData = _crc.getInitRemainder();
+#else
+			_crcData = 0;
+#endif
+			updateCrc(_buffer, _size);
+			checkCrc();
+		}
+		return true;
+	}
+
+public:
+	unz_deflate_stream(Common::SeekableReadStream *stream, uint32 size, uint32 crc) :
+		_stream(stream), _buffer(nullptr), _size(size), _pos(0), _crcWait(crc), _eos(false), _err(false) {
+#ifndef USE_ZLIB
+		_crcData = _crc.getInitRemainder();
+#else
+		_crcData = 0;
+#endif
+	}
+
+	~unz_deflate_stream() override {
+		delete _stream;
+		delete[] _buffer;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		if (_buffer) {
+			memcpy(dataPtr, _buffer + _pos, dataSize);
+			_pos += dataSize;
+			return dataSize;
+		}
+
+		uint32 count = _stream->read(dataPtr, dataSize);
+		if (count < dataSize)
+			_err = true;
+
+		bool complete = _pos < _size && _pos + count == _size;
+		updateCrc((const byte *)dataPtr, count);
+		_pos += count;
+		if (complete)
+			checkCrc();
+		return count;
+	}
+
+	bool eos() const override { return _eos; }
+	bool err() const override { return _err; }
+	void clearErr() override { _eos = false; _err = false; }
+
+	int64 pos() const override { return _pos; }
+	int64 size() const override { return _size; }
+
+	bool seek(int64 offset, int whence = SEEK_SET) override {
+		switch (whence) {
+		case SEEK_END:
+			offset += _size;
+			break;
+		case SEEK_CUR:
+			offset += _pos;
+			break;
+		default:
+			break;
+		}
+
+		if (offset < 0 || offset > _size)
+			return false;
+
+		if (!_buffer && offset < _pos && !inflateWhole())
+			return false;
+
+		if (_buffer) {
+			_pos = offset;
+		} else {
+			byte skip[4096];
+			while (_pos < offset) {
+				uint32 count = MIN<int64>(sizeof(skip), offset - _pos);
+				if (read(skip, count) != count)
+					return false;
+			}
+		}
+
+		_eos = false;
+		return true;
+	}
+};
+
+Common::SeekableReadStream *unzOpenCurrentFileStream(unzFile file) {
+	unz_s *s;
+	uLong pos_data;
+
+	if (file == nullptr)
+		return nullptr;
+	s = (unz_s *)file;
+	if (!s->current_file_ok)
+		return nullptr;
+
+	const unz_file_info &info = s->cur_file_info;
+	bool mapped = s->_shared->_mapped;
+
+	// Small compressed files are cheaper to inflate at once. Stored files are only worth streaming if they are big, or
+	// if the zipfile is mapped into memory and the stream becomes a view.
+	if (info.compression_method == Z_DEFLATED) {
+		if (info.uncompressed_size < UNZ_MINSTREAMSIZE)
+			return nullptr;
+	} else if (info.compression_method == 0) {
+		if (info.uncompressed_size < UNZ_MINSTREAMSIZE && !mapped)
+			return nullptr;
+		if (info.compressed_size != info.uncompressed_size)
+			return nullptr;
+	} else {
+		return nullptr;
+	}
+
+	pos_data = unzlocal_GetCurrentFileDataPos(s);
+	if (pos_data == 0 || info.compressed_size == 0)
+		return nullptr;
+
+	Common::SeekableReadStream *stream;
+	if (mapped) {
+		// Both the mapping and the views into it are immutable, so the
+		// view needs no locking.
+		s->_stream->seek(pos_data);
+		stream = s->_stream->readStream(info.compressed_size);
+	} else {
+		stream = new unz_range_stream(s->_shared, pos_data, info.compressed_size);
+		if (info.compression_method == 0)
+			stream = Common::wrapBufferedSeekableReadStream(stream, 4096, DisposeAfterUse::YES);
+	}
+
+	if (info.compression_method == Z_DEFLATED)
+		stream = new unz_deflate_stream(Common::wrapDeflateReadStream(stream, DisposeAfterUse::YES, info.uncompressed_size),
+		                                info.uncompressed_size, info.crc);
+
+	return stream;
+}
+
 
 namespace Common {
 
@@ -1079,6 +1396,7 @@ bool ZipArchive::isPathDirectory(const Path &path) const {
 	if (unzLocateFile(_zipFile, path, 2) != UNZ_OK)
 		return false;
 
+	StackLock lock(((const unz_s *)_zipFile)->_shared->_mutex);
 	unz_file_info fi;
 	if (unzGetCurrentFileInfo(_zipFile, &fi, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
 		return false;
@@ -1109,6 +1427,11 @@ const ArchiveMemberPtr ZipArchive::getMember(const Path &path) const {
 Common::SharedArchiveContents ZipArchive::readContentsForPath(const Common::Path &path) const {
 	if (unzLocateFile(_zipFile, path, 2) != UNZ_OK)
 		return Common::SharedArchiveContents();
+
+	StackLock lock(((const unz_s *)_zipFile)->_shared->_mutex);
+	SeekableReadStream *stream = unzOpenCurrentFileStream(_zipFile);
+	if (stream)
+		return Common::SharedArchiveContents::bypass(stream);
 #ifndef USE_ZLIB
 	return unzOpenCurrentFile(_zipFile, _crc);
 #else
@@ -1121,7 +1444,8 @@ Archive *makeZipArchive(const Path &name, bool flattenTree) {
 }
 
 Archive *makeZipArchive(const FSNode &node, bool flattenTree) {
-	return makeZipArchive(node.createReadStream(), flattenTree);
+	// Stored files of a mapped zipfile are returned as views into the mapping
+	return makeZipArchive(node.createReadStream(kReadStreamMapped), flattenTree);
 }
 
 Archive *makeZipArchive(SeekableReadStream *stream, bool flattenTree) {
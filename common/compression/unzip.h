@@ -59,7 +59,9 @@ Archive *makeZipArchive(const FSNode &node, bool flattenTree = false);
  * This factory method creates an Archive instance corresponding to the content
  * of the given ZIP compressed datastream.
  * This takes ownership of the stream,  in particular, it is deleted when the
- * ZipArchive is deleted.
+ * ZipArchive and all the streams reading members straight from it are deleted.
+ * If the stream is a MappedFileReadStream, stored members are returned as
+ * views into the mapping.
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
@@ -33,6 +33,7 @@
 
 #include "common/compression/deflate.h"
 
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -87,15 +88,35 @@ bool inflateZlibHeaderless(byte *dst, uint *dstLen, const byte *src, uint srcLen
 static bool _shownBackwardSeekingWarning = false;
 #endif
 
+// inflateGetDictionary() is needed to save the window of a checkpoint
+#if ZLIB_VERNUM >= 0x1280
+#define GZIP_CHECKPOINTS
+#endif
+
 /**
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
  * Assumes the compressed data to be in gzip format.
+ *
+ * Optionally, the decompressor state is saved at deflate block boundaries
+ * about every checkpoint interval bytes while decompressing, so that seeking
+ * backwards can resume from the closest checkpoint instead of starting all
+ * over again.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINDOWSIZE = 32768
+	};
+
+	struct Checkpoint {
+		uint32 pos;         ///< Position in the decompressed data.
+		uint64 parentPos;   ///< Position of the next compressed byte in the wrapped stream.
+		int bits;           ///< Number of bits of the previous compressed byte not yet used.
+		byte lastByte;      ///< The previous compressed byte.
+		uint windowSize;
+		byte *window;       ///< The last up to 32 KB of decompressed data.
 	};
 
 	byte	_buf[BUFSIZE];
@@ -103,14 +124,19 @@ protected:
 	DisposablePtr<SeekableReadStream> _wrapped;
 	z_stream _stream;
 	int _zlibErr;
+	int _windowBits;
 	uint64 _parentPos;
 	uint32 _pos;
 	uint32 _origSize;
 	bool _eos;
 
+	Array<Checkpoint> _checkpoints;
+	uint32 _checkpointInterval;
+	uint _maxCheckpoints;
+
 public:
 
-	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize) : _wrapped(w, disposeParent), _stream() {
+	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize) : _wrapped(w, disposeParent), _stream(), _checkpointInterval(0), _maxCheckpoints(0) {
 		assert(w != nullptr);
 
 		_parentPos = w->pos();
@@ -137,7 +163,8 @@ public:
 		// the compressed file. This feature was added in zlib 1.2.0.4,
 		// released 10 August 2003.
 		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		_windowBits = MAX_WBITS + 32;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -146,7 +173,7 @@ public:
 		_stream.avail_in = 0;
 	}
 
-	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize, const byte *dict, uint dictLen) : _wrapped(w, disposeParent), _stream() {
+	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize, const byte *dict, uint dictLen) : _wrapped(w, disposeParent), _stream(), _checkpointInterval(0), _maxCheckpoints(0) {
 		assert(w != nullptr);
 
 		_parentPos = w->pos();
@@ -157,7 +184,8 @@ public:
 		_pos = 0;
 		_eos = false;
 
-		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		_windowBits = -MAX_WBITS;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -175,6 +203,22 @@ public:
 
 	~GZipReadStream() {
 		inflateEnd(&_stream);
+		for (uint i = 0; i < _checkpoints.size(); i++)
+			delete[] _checkpoints[i].window;
+	}
+
+	/**
+	 * Save a checkpoint about every interval bytes, using at most maxMemory
+	 * bytes for all of them. Once that is used up, every other checkpoint is
+	 * dropped and the interval doubled.
+	 */
+	void enableCheckpoints(uint32 interval, uint32 maxMemory) {
+#ifdef GZIP_CHECKPOINTS
+		_checkpointInterval = MAX<uint32>(interval, WINDOWSIZE);
+		_maxCheckpoints = maxMemory / (WINDOWSIZE + sizeof(Checkpoint));
+		if (_maxCheckpoints < 2)
+			_maxCheckpoints = 0;
+#endif
 	}
 
 	bool err() const override { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -187,6 +231,10 @@ public:
 		_stream.next_out = (byte *)dataPtr;
 		_stream.avail_out = dataSize;
 
+		// With checkpoints, stop at each block boundary to see whether
+		// the next one is due
+		int flush = _maxCheckpoints ? Z_BLOCK : Z_NO_FLUSH;
+
 		// Keep going while we get no error
 		while (_zlibErr == Z_OK && _stream.avail_out) {
 			if (_stream.avail_in == 0 && !_wrapped->eos()) {
@@ -194,7 +242,10 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+			_zlibErr = inflate(&_stream, flush);
+
+			if (flush == Z_BLOCK && _zlibErr == Z_OK && (_stream.data_type & 128) && !(_stream.data_type & 64))
+				addCheckpoint(_pos + dataSize - _stream.avail_out);
 		}
 
 		// Update the position counter
@@ -234,7 +285,13 @@ public:
 
 		assert(newPos >= 0);
 
-		if ((uint32)newPos < _pos) {
+		// Resume from the closest checkpoint before the new position, if
+		// that skips any data
+		const Checkpoint *checkpoint = findCheckpoint(newPos);
+		if (checkpoint && (checkpoint->pos > _pos || (uint32)newPos < _pos)) {
+			if (!restoreCheckpoint(*checkpoint))
+				return false;
+		} else if ((uint32)newPos < _pos) {
 			// To search backward, we have to restart the whole decompression
 			// from the start of the file. A rather wasteful operation, best
 			// to avoid it. :/
@@ -251,7 +308,12 @@ public:
 
 			_pos = 0;
 			_wrapped->seek(_parentPos, SEEK_SET);
+#ifdef GZIP_CHECKPOINTS
+			// Restoring a checkpoint switched to raw deflate data
+			_zlibErr = inflateReset2(&_stream, _windowBits);
+#else
 			_zlibErr = inflateReset(&_stream);
+#endif
 			if (_zlibErr != Z_OK)
 				return false; // FIXME: STREAM REWRITE
 			_stream.next_in = _buf;
@@ -271,6 +333,81 @@ public:
 		_eos = false;
 		return true; // FIXME: STREAM REWRITE
 	}
+
+private:
+	void addCheckpoint(uint32 pos) {
+#ifdef GZIP_CHECKPOINTS
+		uint32 last = _checkpoints.empty() ? 0 : _checkpoints.back().pos;
+		if (pos < last + _checkpointInterval)
+			return;
+
+		Checkpoint checkpoint;
+		checkpoint.bits = _stream.data_type & 7;
+		if (checkpoint.bits && _stream.next_in == _buf)
+			return; // The previous byte is gone already
+		checkpoint.lastByte = checkpoint.bits ? _stream.next_in[-1] : 0;
+		checkpoint.pos = pos;
+		checkpoint.parentPos = _wrapped->pos() - _stream.avail_in;
+
+		checkpoint.window = new byte[WINDOWSIZE];
+		uInt windowSize = WINDOWSIZE;
+		inflateGetDictionary(&_stream, checkpoint.window, &windowSize);
+		checkpoint.windowSize = windowSize;
+
+		if (_checkpoints.size() >= _maxCheckpoints) {
+			// Keep every other checkpoint, the new one takes the place of
+			// the last dropped one
+			uint kept = 0;
+			for (uint i = 0; i < _checkpoints.size(); i++) {
+				if (i & 1)
+					delete[] _checkpoints[i].window;
+				else
+					_checkpoints[kept++] = _checkpoints[i];
+			}
+			_checkpoints.resize(kept);
+			_checkpointInterval *= 2;
+		}
+		_checkpoints.push_back(checkpoint);
+#endif
+	}
+
+	const Checkpoint *findCheckpoint(uint32 pos) const {
+		// The checkpoints are sorted by position
+		const Checkpoint *found = nullptr;
+		uint first = 0, last = _checkpoints.size();
+		while (first < last) {
+			uint middle = (first + last) / 2;
+			if (_checkpoints[middle].pos <= pos) {
+				found = &_checkpoints[middle];
+				first = middle + 1;
+			} else {
+				last = middle;
+			}
+		}
+		return found;
+	}
+
+	bool restoreCheckpoint(const Checkpoint &checkpoint) {
+#ifdef GZIP_CHECKPOINTS
+		// Checkpoints are at block boundaries, from where it's just raw
+		// deflate data
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr == Z_OK && checkpoint.bits)
+			_zlibErr = inflatePrime(&_stream, checkpoint.bits, checkpoint.lastByte >> (8 - checkpoint.bits));
+		if (_zlibErr == Z_OK)
+			_zlibErr = inflateSetDictionary(&_stream, checkpoint.window, checkpoint.windowSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_wrapped->seek(checkpoint.parentPos, SEEK_SET);
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_pos = checkpoint.pos;
+		return true;
+#else
+		return false;
+#endif
+	}
 };
 
 /**
@@ -406,6 +543,13 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, Di
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapIndexedCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 checkpointInterval, uint32 maxMemory, DisposeAfterUse::Flag disposeParent, uint64 knownSize) {
+	SeekableReadStream *stream = wrapCompressedReadStream(toBeWrapped, disposeParent, knownSize);
+	if (stream && stream != toBeWrapped)
+		static_cast<GZipReadStream *>(stream)->enableCheckpoints(checkpointInterval, maxMemory);
+	return stream;
+}
+
 SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, DisposeAfterUse::Flag disposeParent, uint64 knownSize, const byte *dict, uint dictLen) {
 	if (!toBeWrapped) {
 		return nullptr;
@@ -0,0 +1,583 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// The hash map implementation in this file uses open addressing with
+// Robin Hood linear probing and backward shift deletion, so it never
+// needs tombstones for erased entries.
+
+#ifndef COMMON_FLAT_HASHMAP_H
+#define COMMON_FLAT_HASHMAP_H
+
+#include "common/hashmap.h"
+
+namespace Common {
+
+/**
+ * @addtogroup common_hashmap
+ * @{
+ */
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in alternative to HashMap<Key,Val> which
+ * stores the keys and values inline in a single array instead of allocating
+ * a node for every entry. Next to it, one metadata byte per slot records how
+ * far the entry is away from its preferred slot; lookups stop as soon as
+ * they reach an entry which is closer to its own preferred slot than the key
+ * being searched would be.
+ *
+ * The hash and equality functors are the same as for HashMap. The hash is
+ * scrambled with a multiplicative step before use, so identity hashes of
+ * integer keys with a common stride are spread over the table.
+ *
+ * Unlike HashMap, inserting or erasing entries moves other entries around.
+ * Any insertion or erasure therefore invalidates all iterators as well as
+ * references to values stored in the map.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+	struct Node {
+		Key _key;	///< Must not be modified through an iterator.
+		Val _value;
+		explicit Node(const Key &key) : _key(key), _value() {}
+		Node(const Key &key, const Val &value) : _key(key), _value(value) {}
+	};
+
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// Robin Hood probing keeps the probe sequences short even with
+		// a high load factor.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 7,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 8,
+
+		// The largest probe distance which can be stored in a metadata
+		// byte. Longer distances saturate at it and are recomputed from
+		// the hash of the key, which only happens with degenerate hashes.
+		FLATHASHMAP_MAX_DISTANCE = 255
+	};
+
+	static const size_type NOT_FOUND = (size_type)-1;
+
+	/** Default value, returned by the const getVal. */
+	Val _defaultVal;
+
+	Node *_nodes;		///< Inline storage of size _mask + 1, only slots with a non-zero distance are constructed.
+	byte *_distances;	///< Probe distance plus one of every slot, saturated at FLATHASHMAP_MAX_DISTANCE, zero for empty slots.
+	size_type _mask;	///< Capacity of the map minus one; the capacity must be a power of two.
+	size_type _shift;	///< Shift which maps a scrambled hash to a slot index.
+	size_type _size;
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	size_type homeSlot(const Key &key) const {
+		return (size_type)(_hash(key) * 2654435769U) >> _shift;
+	}
+
+	uint distanceAt(size_type idx) const {
+		const uint distance = _distances[idx];
+		if (distance < FLATHASHMAP_MAX_DISTANCE)
+			return distance;
+		return ((idx - homeSlot(_nodes[idx]._key)) & _mask) + 1;
+	}
+
+	void setDistance(size_type idx, uint distance) {
+		_distances[idx] = (byte)MIN<uint>(distance, FLATHASHMAP_MAX_DISTANCE);
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	size_type insertNew(const Key &key);
+	void expandStorage(size_type newCapacity);
+	void eraseSlot(size_type idx);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != nullptr);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->_distances[_idx] != 0);
+			return &_hashmap->_nodes[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(nullptr) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx <= _hashmap->_mask && _hashmap->_distances[_idx] == 0);
+			if (_idx > _hashmap->_mask)
+				_idx = NOT_FOUND;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		clear();
+		freeStorage();
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const {
+		return lookup(key) != NOT_FOUND;
+	}
+
+	Val &operator[](const Key &key) { return getOrCreateVal(key); }
+	const Val &operator[](const Key &key) const { return getVal(key); }
+
+	Val &getOrCreateVal(const Key &key);
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getValOrDefault(const Key &key) const { return getValOrDefault(key, _defaultVal); }
+	const Val &getValOrDefault(const Key &key, const Val &defaultVal) const;
+	bool tryGetVal(const Key &key, Val &out) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	/**
+	 * Reserve space for at least @p count entries, so that they can be
+	 * inserted without growing the table.
+	 */
+	void reserve(size_type count);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_distances[ctr])
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator	end() {
+		return iterator(NOT_FOUND, this);
+	}
+
+	const_iterator	begin() const {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_distances[ctr])
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator	end() const {
+		return const_iterator(NOT_FOUND, this);
+	}
+
+	iterator	find(const Key &key) {
+		return iterator(lookup(key), this);
+	}
+
+	const_iterator	find(const Key &key) const {
+		return const_iterator(lookup(key), this);
+	}
+
+	/** Return true if hashmap is empty. */
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	clear();
+	freeStorage();
+}
+
+/**
+ * Internal method for allocating empty storage for @p capacity slots,
+ * which must be a power of two.
+ *
+ * @note The previous storage is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	assert(capacity >= FLATHASHMAP_MIN_CAPACITY && (capacity & (capacity - 1)) == 0);
+
+	_nodes = (Node *)malloc(capacity * sizeof(Node));
+	_distances = (byte *)calloc(capacity, sizeof(byte));
+	if (!_nodes || !_distances)
+		error("FlatHashMap: Failure to allocate %u slots", capacity);
+
+	_mask = capacity - 1;
+	_shift = 32;
+	while (capacity > 1) {
+		capacity >>= 1;
+		_shift--;
+	}
+	_size = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	free(_nodes);
+	free(_distances);
+	_nodes = nullptr;
+	_distances = nullptr;
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one. As both maps use the same capacity, the entries keep
+ * their slots.
+ *
+ * @note The previous storage is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocStorage(map._mask + 1);
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (map._distances[ctr]) {
+			new (&_nodes[ctr]) Node(map._nodes[ctr]);
+			_distances[ctr] = map._distances[ctr];
+		}
+	}
+	_size = map._size;
+}
+
+/**
+ * Clear all values in the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_distances[ctr])
+			_nodes[ctr].~Node();
+	}
+
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+	} else {
+		memset(_distances, 0, _mask + 1);
+		_size = 0;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
+	assert(newCapacity > _mask + 1);
+
+	const size_type oldSize = _size;
+	const size_type oldMask = _mask;
+	Node *oldNodes = _nodes;
+	byte *oldDistances = _distances;
+
+	allocStorage(newCapacity);
+
+	// Rehash all the old entries. Since all keys are known to be unique,
+	// they can be inserted without comparing them.
+	for (size_type ctr = 0; ctr <= oldMask; ++ctr) {
+		if (!oldDistances[ctr])
+			continue;
+
+		const size_type idx = insertNew(oldNodes[ctr]._key);
+		_nodes[idx]._value = Common::move(oldNodes[ctr]._value);
+		oldNodes[ctr].~Node();
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	assert(_size == oldSize);
+
+	free(oldNodes);
+	free(oldDistances);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::reserve(size_type count) {
+	size_type capacity = _mask + 1;
+	while (count * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		capacity *= 2;
+	if (capacity > _mask + 1)
+		expandStorage(capacity);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	size_type ctr = homeSlot(key);
+	for (uint distance = 1; ; distance++) {
+		const uint entryDistance = distanceAt(ctr);
+		if (entryDistance < distance)
+			return NOT_FOUND;
+
+		// An entry with a different distance cannot have the same home
+		// slot, so its key does not need to be compared.
+		if (entryDistance == distance && _equal(_nodes[ctr]._key, key))
+			return ctr;
+		ctr = (ctr + 1) & _mask;
+	}
+}
+
+/**
+ * Internal method for inserting a key which is known not to be part of the
+ * map yet. Returns the slot of the new entry.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::insertNew(const Key &key) {
+	// Skip all entries which are at least as far from their home slot
+	// as the new key; the first entry closer to its home slot is where
+	// the new key belongs.
+	size_type pos = homeSlot(key);
+	uint distance = 1;
+	while (distanceAt(pos) >= distance) {
+		pos = (pos + 1) & _mask;
+		distance++;
+	}
+
+	// The entries from there up to the next free slot move one slot
+	// further away from their home slots to make room.
+	size_type last = pos;
+	while (_distances[last])
+		last = (last + 1) & _mask;
+
+	while (last != pos) {
+		const size_type prev = (last - 1) & _mask;
+		setDistance(last, distanceAt(prev) + 1);
+		new (&_nodes[last]) Node(Common::move(_nodes[prev]));
+		_nodes[prev].~Node();
+		last = prev;
+	}
+
+	new (&_nodes[pos]) Node(key);
+	setDistance(pos, distance);
+	_size++;
+	return pos;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		return ctr;
+
+	// Keep the load factor below a certain threshold.
+	const size_type capacity = _mask + 1;
+	if ((_size + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		expandStorage(capacity * 2);
+
+	return insertNew(key);
+}
+
+/**
+ * Internal method for removing the entry in slot @p idx. The following
+ * entries of the probe sequence move back one slot, so no marker for the
+ * erased entry is needed.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type idx) {
+	assert(_distances[idx] != 0);
+	_nodes[idx].~Node();
+
+	size_type next = (idx + 1) & _mask;
+	while (_distances[next] > 1) {
+		setDistance(idx, distanceAt(next) - 1);
+		new (&_nodes[idx]) Node(Common::move(_nodes[next]));
+		_nodes[next].~Node();
+		idx = next;
+		next = (next + 1) & _mask;
+	}
+
+	_distances[idx] = 0;
+	_size--;
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getOrCreateVal(const Key &key) {
+	// The lookup may reallocate the storage, so it has to happen first
+	size_type ctr = lookupAndCreateIfMissing(key);
+	return _nodes[ctr]._value;
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		return _nodes[ctr]._value;
+	else
+		// See the comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		return _nodes[ctr]._value;
+	else
+		// See the comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+/**
+ * Get a value from the hashmap. If the key is not present, then return @p defaultVal.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getValOrDefault(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		return _nodes[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::tryGetVal(const Key &key, Val &out) const {
+	size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND) {
+		out = _nodes[ctr]._value;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Assign an element specified by @p key to a value @p val.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	_nodes[ctr]._value = val;
+}
+
+/**
+ * Erase an entry referred to by an iterator.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	assert(entry._idx <= _mask);
+	eraseSlot(entry._idx);
+}
+
+/**
+ * Erase an entry specified by @p key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != NOT_FOUND)
+		eraseSlot(ctr);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -56,6 +56,14 @@ class SeekableWriteStream;
  */
 class FSList : public Array<FSNode> {};
 
+/**
+ * Hints on how a stream created by FSNode::createReadStream is going to be used.
+ */
+enum ReadStreamHint {
+	kReadStreamDefault,	///< Regular buffered file access.
+	kReadStreamMapped	///< Random access to a large file: map it into memory if the backend supports it.
+};
+
 /**
  * FSNode, short for "File System Node", provides an abstraction for file
  * paths, allowing for portable file system browsing. This means, for example,
@@ -252,6 +260,16 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieve the size and the last modification time of the file referred
+	 * by this node without opening it. The modification time is only meaningful
+	 * when compared against an earlier value for the same file.
+	 *
+	 * @return True if successful, false if the node does not exist or the
+	 *         backend cannot provide this information.
+	 */
+	bool getFileStats(int64 &size, int64 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -261,6 +279,19 @@ public:
 	 */
 	SeekableReadStream *createReadStream() const override;
 
+	/**
+	 * Create a SeekableReadStream instance corresponding to the file
+	 * referred by this node, using the access method suggested by @p hint.
+	 *
+	 * With kReadStreamMapped, the file is mapped into memory when the backend
+	 * supports it. The returned stream is then a MappedFileReadStream, whose
+	 * readStream() method returns views into the mapping instead of copies.
+	 * Otherwise, a regular stream is returned.
+	 *
+	 * @return Pointer to the stream object, nullptr in case of a failure.
+	 */
+	SeekableReadStream *createReadStream(ReadStreamHint hint) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to an alternate stream
 	 * of the file referred by this node. This assumes that the node actually
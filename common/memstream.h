@@ -41,7 +41,7 @@ namespace Common {
  * a plain memory block.
  */
 class MemoryReadStream : virtual public SeekableReadStream {
-private:
+protected:
 	struct CastFreeDeleter {
 		inline void operator()(const byte *object) {
 			free(const_cast<byte *>(object));
@@ -95,6 +95,31 @@ public:
 	bool seek(int64 offs, int whence = SEEK_SET);
 };
 
+/**
+ * MemoryReadStream over a file mapped into memory by the backend.
+ *
+ * The mapping is reference counted: readStream() returns views into the
+ * same mapping instead of copying the data, and the mapping is released
+ * once this stream and all of its views are gone.
+ */
+class MappedFileReadStream : public MemoryReadStream {
+private:
+	SharedPtr<const byte> _mapping;
+	uint32 _offset;
+
+public:
+	/**
+	 * Create a stream over @p dataSize bytes of @p mapping, starting at
+	 * @p offset. The deleter of @p mapping has to release the mapping.
+	 */
+	MappedFileReadStream(const SharedPtr<const byte> &mapping, uint32 dataSize, uint32 offset = 0) :
+		MemoryReadStream(mapping.get() + offset, dataSize),
+		_mapping(mapping),
+		_offset(offset) {}
+
+	SeekableReadStream *readStream(uint32 dataSize) override;
+};
+
 
 /**
  * This is a MemoryReadStream subclass which adds non-endian
@@ -124,6 +124,20 @@ uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
 	return dataSize;
 }
 
+SeekableReadStream *MappedFileReadStream::readStream(uint32 dataSize) {
+	// Hand out a view into the mapping rather than a copy
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+	assert(dataSize > 0);
+
+	SeekableReadStream *view = new MappedFileReadStream(_mapping, dataSize, _offset + _pos);
+	_ptr += dataSize;
+	_pos += dataSize;
+	return view;
+}
+
 bool MemoryReadStream::seek(int64 offs, int whence) {
 	// Pre-Condition
 	assert(_pos <= _size);
@@ -407,6 +407,7 @@ Common::Error AdvancedMetaEngineDetectionBase::identifyGame(DetectedGame &game,
 
 	// Detection is done, no need to keep archives in memory anymore
 	ADCacheMan.clearArchives();
+	ADCacheMan.savePersistentCache();
 
 	if (!agdDesc.desc)
 		return Common::kNoGameDataFoundError;
@@ -434,18 +435,18 @@ void AdvancedMetaEngineDetectionBase::composeFileHashMap(FileMap &allFiles, cons
 		return;
 
 	for (Common::FSList::const_iterator file = fslist.begin(); file != fslist.end(); ++file) {
-		Common::String efname = Common::punycode_encodefilename(file->getName());
+		Common::String efname = ADCacheMan.getEncodedFileName(file->getName());
 		Common::Path tstr = ((_flags & kADFlagMatchFullPaths) ? parentName : Common::Path()).appendComponent(efname);
 
 		if (file->isDirectory()) {
 			if (!_globsMap.contains(efname))
 				continue;
 
-			Common::FSList files;
-			if (!file->getChildren(files, Common::FSNode::kListAll))
+			const Common::FSList *files = ADCacheMan.getDirectoryChildren(*file);
+			if (!files)
 				continue;
 
-			composeFileHashMap(allFiles, files, depth - 1, tstr);
+			composeFileHashMap(allFiles, *files, depth - 1, tstr);
 			continue;
 		}
 
@@ -468,6 +469,197 @@ namespace Common {
 	DECLARE_SINGLETON(AdvancedDetectorCacheManager);
 }
 
+namespace {
+
+const uint32 kDetectionCacheTag = MKTAG('A', 'D', 'C', 'H');
+const uint32 kDetectionCacheVersion = 1;
+const char *const kDetectionCacheFileName = "detection-cache.dat";
+
+// Minimum time between two writes of the persistent cache, unless forced
+const uint32 kDetectionCacheSaveInterval = 10000;
+
+void writeCacheString(Common::WriteStream &stream, const Common::String &str) {
+	stream.writeUint32LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+bool readCacheString(Common::SeekableReadStream &stream, Common::String &str) {
+	const uint32 size = stream.readUint32LE();
+	if (stream.err() || size > stream.size() - stream.pos())
+		return false;
+
+	char *buffer = new char[size];
+	stream.read(buffer, size);
+	str = Common::String(buffer, size);
+	delete[] buffer;
+	return !stream.err();
+}
+
+} // End of anonymous namespace
+
+AdvancedDetectorCacheManager::~AdvancedDetectorCacheManager() {
+	savePersistentCache(true);
+	clearArchives();
+}
+
+const Common::String &AdvancedDetectorCacheManager::getEncodedFileName(const Common::String &name) {
+	EncodedNameHashMap::const_iterator i = encodedNameHashMap.find(name);
+	if (i != encodedNameHashMap.end())
+		return i->_value;
+
+	Common::String &encoded = encodedNameHashMap.getOrCreateVal(name);
+	encoded = Common::punycode_encodefilename(name);
+	return encoded;
+}
+
+const Common::FSList *AdvancedDetectorCacheManager::getDirectoryChildren(const Common::FSNode &dir) {
+	DirectoryHashMap::const_iterator i = directoryHashMap.find(dir.getPath());
+	if (i != directoryHashMap.end())
+		return &i->_value;
+
+	// Failed listings are not kept, they are rare enough to simply retry
+	Common::FSList files;
+	if (!dir.getChildren(files, Common::FSNode::kListAll))
+		return nullptr;
+
+	Common::FSList &listing = directoryHashMap.getOrCreateVal(dir.getPath());
+	listing = files;
+	return &listing;
+}
+
+Common::Path AdvancedDetectorCacheManager::getPersistentCachePath() {
+	// Keep the cache next to the configuration file
+	Common::Path configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	return configFile.getParent().appendComponent(kDetectionCacheFileName);
+}
+
+void AdvancedDetectorCacheManager::loadPersistentCache() {
+	if (persistentLoaded)
+		return;
+	persistentLoaded = true;
+
+	Common::FSNode node(getPersistentCachePath());
+	Common::File file;
+	if (!node.exists() || !file.open(node))
+		return;
+
+	if (file.readUint32BE() != kDetectionCacheTag || file.readUint32LE() != kDetectionCacheVersion) {
+		debugC(2, kDebugGlobalDetection, "Ignoring outdated detection cache %s", node.getPath().toString(Common::Path::kNativeSeparator).c_str());
+		return;
+	}
+
+	const uint32 count = file.readUint32LE();
+	for (uint32 i = 0; i < count; i++) {
+		Common::String key;
+		PersistentEntry entry;
+
+		bool valid = readCacheString(file, key);
+		entry.fileSize = file.readSint64LE();
+		entry.modificationTime = file.readSint64LE();
+		entry.props.size = file.readSint64LE();
+		entry.props.md5prop = (MD5Properties)file.readUint32LE();
+		valid = valid && readCacheString(file, entry.props.md5);
+
+		if (!valid || file.err()) {
+			warning("Detection cache %s is corrupt, ignoring it", node.getPath().toString(Common::Path::kNativeSeparator).c_str());
+			persistentHashMap.clear(true);
+			return;
+		}
+
+		persistentHashMap.setVal(key, entry);
+	}
+
+	debugC(2, kDebugGlobalDetection, "Loaded %u entries from the detection cache", count);
+}
+
+void AdvancedDetectorCacheManager::savePersistentCache(bool force) {
+	if (!persistentDirty)
+		return;
+
+	const uint32 time = g_system->getMillis();
+	if (!force && persistentSaveTime && time - persistentSaveTime < kDetectionCacheSaveInterval)
+		return;
+
+	persistentDirty = false;
+	persistentSaveTime = time ? time : 1;
+
+	Common::DumpFile file;
+	if (!file.open(getPersistentCachePath(), true)) {
+		debugC(2, kDebugGlobalDetection, "Unable to write the detection cache");
+		return;
+	}
+
+	file.writeUint32BE(kDetectionCacheTag);
+	file.writeUint32LE(kDetectionCacheVersion);
+	file.writeUint32LE(persistentHashMap.size());
+	for (PersistentHashMap::const_iterator i = persistentHashMap.begin(); i != persistentHashMap.end(); ++i) {
+		writeCacheString(file, i->_key);
+		file.writeSint64LE(i->_value.fileSize);
+		file.writeSint64LE(i->_value.modificationTime);
+		file.writeSint64LE(i->_value.props.size);
+		file.writeUint32LE(i->_value.props.md5prop);
+		writeCacheString(file, i->_value.props.md5);
+	}
+
+	if (!file.flush() || file.err())
+		warning("Failed to write the detection cache");
+	file.close();
+}
+
+bool AdvancedDetectorCacheManager::clearPersistentCache() {
+	persistentHashMap.clear(true);
+	persistentLoaded = true;
+	persistentDirty = false;
+
+	Common::FSNode node(getPersistentCachePath());
+	if (!node.exists())
+		return true;
+
+	// There is no portable way to delete a file, so truncate the cache
+	// to an empty one instead.
+	Common::DumpFile file;
+	if (!file.open(node))
+		return false;
+	file.writeUint32BE(kDetectionCacheTag);
+	file.writeUint32LE(kDetectionCacheVersion);
+	file.writeUint32LE(0);
+	return file.flush() && !file.err();
+}
+
+bool AdvancedDetectorCacheManager::getPersistentProperties(const Common::String &key, const Common::FSNode &node, FileProperties &fileProps) {
+	loadPersistentCache();
+
+	PersistentHashMap::const_iterator entry = persistentHashMap.find(key);
+	if (entry == persistentHashMap.end())
+		return false;
+
+	int64 fileSize, modificationTime;
+	if (!node.getFileStats(fileSize, modificationTime) ||
+	        fileSize != entry->_value.fileSize || modificationTime != entry->_value.modificationTime) {
+		// The file changed since, so the entry is useless now
+		persistentHashMap.erase(key);
+		persistentDirty = true;
+		return false;
+	}
+
+	fileProps = entry->_value.props;
+	return true;
+}
+
+void AdvancedDetectorCacheManager::setPersistentProperties(const Common::String &key, const Common::FSNode &node, const FileProperties &fileProps) {
+	PersistentEntry entry;
+	if (!node.getFileStats(entry.fileSize, entry.modificationTime))
+		return;
+
+	loadPersistentCache();
+	entry.props = fileProps;
+	persistentHashMap.setVal(key, entry);
+	persistentDirty = true;
+}
+
 
 static MD5Properties gameFileToMD5Props(const ADGameFileDescription *fileEntry, uint32 gameFlags) {
 	MD5Properties ret = kMD5Head;
@@ -545,11 +737,36 @@ bool AdvancedMetaEngineDetectionBase::getFileProperties(const FileMap &allFiles,
 		return true;
 	}
 
+	// The persistent cache is keyed by the file on disk the properties are
+	// computed from, which is the archive for files inside of archives.
+	Common::Path nodeName = fname;
+	if (md5prop & kMD5Archive) {
+		Common::StringTokenizer tok(fname.toString(), ":");
+		tok.nextToken();
+		nodeName = Common::Path(tok.nextToken());
+	}
+
+	Common::FSNode node;
+	Common::String persistentKey;
+	if (allFiles.tryGetVal(nodeName, node)) {
+		persistentKey = Common::String::format("%s:%d:%s:%s", md5PropToCachePrefix(md5prop).c_str(), _md5Bytes,
+		                                       node.getPath().toString('/').c_str(), fname.toString('/').c_str());
+
+		if (ADCacheMan.getPersistentProperties(persistentKey, node, fileProps)) {
+			ADCacheMan.setMD5(hashname, fileProps.md5);
+			ADCacheMan.setSize(hashname, fileProps.size);
+			return true;
+		}
+	}
+
 	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, md5prop, fname, fileProps);
 
 	if (res) {
 		ADCacheMan.setMD5(hashname, fileProps.md5);
 		ADCacheMan.setSize(hashname, fileProps.size);
+
+		if (!persistentKey.empty())
+			ADCacheMan.setPersistentProperties(persistentKey, node, fileProps);
 	}
 
 	return res;
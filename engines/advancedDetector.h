@@ -731,6 +731,11 @@ private:
 
 /**
  * Singleton Cache Storage for Computed MD5s and Open Archives
+ *
+ * Besides the per-run caches, the computed file properties are also kept in
+ * a persistent cache next to the configuration file. Its entries are keyed by
+ * the full path and the detection mode, and are only trusted as long as the
+ * size and the modification time of the file on disk did not change.
  */
 class AdvancedDetectorCacheManager : public Common::Singleton<AdvancedDetectorCacheManager> {
 public:
@@ -771,10 +776,47 @@ public:
 		return archiveHashMap.getValOrDefault(node.getPath(), nullptr);
 	}
 
-	AdvancedDetectorCacheManager() {
+	/**
+	 * Get the punycode encoded form of a file name, as used for matching the
+	 * detection entries. All engines encode the same names of a directory, so
+	 * the result is shared for the rest of the detection run.
+	 */
+	const Common::String &getEncodedFileName(const Common::String &name);
+
+	/**
+	 * List the children of a directory, sharing the listing with the other
+	 * engines for the rest of the detection run.
+	 *
+	 * @return The listing, or nullptr if the directory cannot be listed.
+	 */
+	const Common::FSList *getDirectoryChildren(const Common::FSNode &dir);
+
+	/**
+	 * Look up the properties of a file in the persistent cache. @p node is the
+	 * file on disk the properties were computed from, and has to have the
+	 * same size and modification time as when the entry was stored.
+	 */
+	bool getPersistentProperties(const Common::String &key, const Common::FSNode &node, FileProperties &fileProps);
+
+	/** Store the properties of a file in the persistent cache. */
+	void setPersistentProperties(const Common::String &key, const Common::FSNode &node, const FileProperties &fileProps);
+
+	/**
+	 * Write the persistent cache to disk if it changed. Unless @p force is
+	 * set, this is skipped if the cache was written only shortly before, so
+	 * that scanning many directories in a row does not rewrite it each time.
+	 */
+	void savePersistentCache(bool force = false);
+
+	/** Remove all entries of the persistent cache, in memory and on disk. */
+	bool clearPersistentCache();
+
+	AdvancedDetectorCacheManager() : persistentLoaded(false), persistentDirty(false), persistentSaveTime(0) {
 		clear();
 	}
 
+	~AdvancedDetectorCacheManager();
+
 	void clearArchives() {
 		for (auto &entry : archiveHashMap) {
 			delete entry._value;
@@ -785,6 +827,8 @@ public:
 	void clear() {
 		md5HashMap.clear(true);
 		sizeHashMap.clear(true);
+		encodedNameHashMap.clear(true);
+		directoryHashMap.clear(true);
 		clearArchives();
 	}
 
@@ -794,9 +838,27 @@ private:
 	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileHashMap;
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	typedef Common::HashMap<Common::Path, Common::Archive *, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> ArchiveHashMap;
+	typedef Common::HashMap<Common::String, Common::String> EncodedNameHashMap;
+	typedef Common::HashMap<Common::Path, Common::FSList, Common::Path::Hash, Common::Path::EqualTo> DirectoryHashMap;
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
 	ArchiveHashMap archiveHashMap;
+	EncodedNameHashMap encodedNameHashMap;
+	DirectoryHashMap directoryHashMap;
+
+	struct PersistentEntry {
+		int64 fileSize;          ///< Size of the file on disk when the entry was stored.
+		int64 modificationTime;  ///< Modification time of the file on disk when the entry was stored.
+		FileProperties props;
+	};
+	typedef Common::HashMap<Common::String, PersistentEntry> PersistentHashMap;
+	PersistentHashMap persistentHashMap;
+	bool persistentLoaded;
+	bool persistentDirty;
+	uint32 persistentSaveTime;
+
+	static Common::Path getPersistentCachePath();
+	void loadPersistentCache();
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
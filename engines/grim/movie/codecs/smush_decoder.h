@@ -61,6 +61,8 @@ protected:
 	void init();
 	void close() override;
 	const Graphics::Surface *decodeNextFrame() override;
+	// handleFrame() has to run before every frame
+	bool canDecodeAhead() const override { return false; }
 	class SmushVideoTrack : public FixedRateVideoTrack {
 	public:
 		SmushVideoTrack(int width, int height, int fps, int numFrames, bool is16Bit);
@@ -33,6 +33,7 @@
 #include "sci/engine/selector.h"
 #include "sci/engine/savegame.h"
 #include "sci/engine/gc.h"
+#include "sci/engine/kpathing.h"
 #include "sci/engine/features.h"
 #include "sci/engine/scriptdebug.h"
 #include "sci/sound/midiparser_sci.h"
@@ -54,6 +55,7 @@
 #include "sci/video/seq_decoder.h"
 #ifdef ENABLE_SCI32
 #include "common/memstream.h"
+#include "sci/graphics/celobj32.h"
 #include "sci/graphics/frameout.h"
 #include "sci/graphics/paint32.h"
 #include "sci/graphics/palette32.h"
@@ -85,6 +87,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	// Variables
 	registerVar("sleeptime_factor",	&g_debug_sleeptime_factor);
 	registerVar("gc_interval",		&engine->_gamestate->scriptGCInterval);
+	registerVar("gc_incremental",		&engine->_gamestate->incrementalGC);
+	registerVar("vm_predecode",		&engine->_gamestate->predecodeScripts);
 	registerVar("simulated_key",		&g_debug_simulated_key);
 	registerVar("track_mouse_clicks",	&g_debug_track_mouse_clicks);
 	registerCmd("speed_throttle",   WRAP_METHOD(Console, cmdSpeedThrottle));
@@ -150,6 +154,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("vpi",                WRAP_METHOD(Console, cmdVisiblePlaneItemList));	// alias
 	registerCmd("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	registerCmd("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
+	registerCmd("cel_cache",          WRAP_METHOD(Console, cmdCelCache));
 	// Segments
 	registerCmd("segment_table",		WRAP_METHOD(Console, cmdPrintSegmentTable));
 	registerCmd("segtable",			WRAP_METHOD(Console, cmdPrintSegmentTable));	// alias
@@ -163,6 +168,10 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
+	// Pathfinding
+	registerCmd("avoidpath_cache",	WRAP_METHOD(Console, cmdAvoidPathCache));
+	registerCmd("avoidpath_bench",	WRAP_METHOD(Console, cmdAvoidPathBench));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -242,6 +251,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("vmvarlist",			WRAP_METHOD(Console, cmdVMVarlist));				// alias
 	registerCmd("vl",					WRAP_METHOD(Console, cmdVMVarlist));				// alias
 	registerCmd("vm_vars",			WRAP_METHOD(Console, cmdVMVars));
+	registerCmd("vm_bench",			WRAP_METHOD(Console, cmdVMBench));
 	registerCmd("vmvars",				WRAP_METHOD(Console, cmdVMVars));					// alias
 	registerCmd("vv",					WRAP_METHOD(Console, cmdVMVars));					// alias
 	registerCmd("locals",				WRAP_METHOD(Console, cmdLocalVars));
@@ -319,6 +329,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("---------\n");
 	debugPrintf("sleeptime_factor: Factor to multiply with wait times in kWait()\n");
 	debugPrintf("gc_interval: Number of kernel calls in between garbage collections\n");
+	debugPrintf("gc_incremental: Spreads the garbage collections over several kernel calls\n");
+	debugPrintf("vm_predecode: Keeps the decoded instructions of the scripts\n");
 	debugPrintf("simulated_key: Add a key with the specified scan code to the event list\n");
 	debugPrintf("track_mouse_clicks: Toggles mouse click tracking to the console\n");
 	debugPrintf("speed_throttle: Displays or changes kGameIsRestarting maximum delay\n");
@@ -386,6 +398,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" visible_plane_items / vpi - Shows a list of all items for a plane in the visible draw list (SCI2+)\n");
 	debugPrintf(" saved_bits - List saved bits on the hunk\n");
 	debugPrintf(" show_saved_bits - Display saved bits\n");
+	debugPrintf(" cel_cache - Shows the usage of the cel cache (SCI2+)\n");
 	debugPrintf("\n");
 	debugPrintf("Segments:\n");
 	debugPrintf(" segment_table / segtable - Lists all segments\n");
@@ -398,6 +411,11 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows the pause times and freed memory of the garbage collections\n");
+	debugPrintf("\n");
+	debugPrintf("Pathfinding:\n");
+	debugPrintf(" avoidpath_cache - Shows the use of the cached visibility graphs of kAvoidPath\n");
+	debugPrintf(" avoidpath_bench - Runs the last kAvoidPath calls without and with the cached visibility graphs\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -452,6 +470,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" script_said - Shows all said - strings inside a specified script\n");
 	debugPrintf(" vm_varlist / vmvarlist / vl - Shows the addresses of variables in the VM\n");
 	debugPrintf(" vm_vars / vmvars / vv - Displays or changes variables in the VM\n");
+	debugPrintf(" vm_bench - Compares decoding the executed instructions with looking them up\n");
 	debugPrintf(" locals / l - Displays or changes local variables in the VM\n");
 	debugPrintf(" stack / st - Lists the specified number of stack elements\n");
 	debugPrintf(" value_type - Determines the type of a value\n");
@@ -2420,6 +2439,22 @@ bool Console::cmdParseGrammar(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdCelCache(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	const CelCache *cache = CelObj::getCache();
+	if (cache) {
+		const CelCache::Stats &stats = cache->getStats();
+		debugPrintf("Cel cache: %u of %u cels\n", cache->size(), cache->getMaxSize());
+		debugPrintf("%u hits, %u misses, %u evictions\n", stats.hits, stats.misses, stats.evictions);
+	} else {
+		debugPrintf("This SCI version does not have a cel cache\n");
+	}
+#else
+	debugPrintf("SCI32 isn't included in this compiled executable\n");
+#endif
+	return true;
+}
+
 bool Console::cmdPrintSegmentTable(int argc, const char **argv) {
 	debugPrintf("Segment table:\n");
 
@@ -2938,6 +2973,64 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	const EngineState *s = _engine->_gamestate;
+	const GCStats &stats = s->_gc->getStats();
+
+	debugPrintf("Mode: %s, every %d kernel calls\n", s->incrementalGC ? "incremental" : "full", s->scriptGCInterval);
+	if (s->_gc->isRunning(s->_segMan))
+		debugPrintf("A collection is running\n");
+	debugPrintf("Collections: %u\n", stats.collections);
+	if (!stats.collections)
+		return true;
+
+	debugPrintf("Last collection: %u slices, longest %u ms, %u ms in total\n", stats.lastSlices, stats.lastPause, stats.lastTime);
+	debugPrintf("Last collection freed %u entries, %u bytes\n", stats.lastFreed, stats.lastFreedBytes);
+	debugPrintf("Longest pause: %u ms\n", stats.maxPause);
+	debugPrintf("Freed in total: %u bytes\n", stats.totalFreedBytes);
+	return true;
+}
+
+bool Console::cmdAvoidPathCache(int argc, const char **argv) {
+	const AvoidPathCache *cache = _engine->_gamestate->_avoidPathCache;
+	const AvoidPathCache::Stats &stats = cache->getStats();
+
+	debugPrintf("Graphs: %u of %d\n", cache->getGraphCount(), AvoidPathCache::kMaxGraphs);
+	debugPrintf("Calls: %u with a known polygon set, %u with a new one, %u uncached\n", stats.hits, stats.misses, stats.uncached);
+	debugPrintf("Recorded calls: %u\n", cache->getRecordedCallCount());
+	return true;
+}
+
+bool Console::cmdAvoidPathBench(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Runs the last kAvoidPath calls without and with the cached visibility graphs,\n");
+		debugPrintf("and compares the paths. Calls are recorded while the Pathfinding debug channel is enabled\n");
+		debugPrintf("Usage: %s [<repetitions>]\n", argv[0]);
+		return true;
+	}
+
+	int repetitions = 100;
+	if (argc == 2 && (!parseInteger(argv[1], repetitions) || repetitions <= 0)) {
+		debugPrintf("Invalid number of repetitions\n");
+		return true;
+	}
+
+	AvoidPathCache *cache = _engine->_gamestate->_avoidPathCache;
+	if (!cache->getRecordedCallCount()) {
+		debugPrintf("No kAvoidPath calls have been recorded yet\n");
+		debugPrintf("Calls are only recorded while the Pathfinding debug channel is enabled\n");
+		return true;
+	}
+
+	const AvoidPathCache::BenchmarkResult result = cache->benchmark(repetitions);
+	debugPrintf("%u calls, %d times each\n", result.calls, repetitions);
+	debugPrintf("Without the graphs: %u ms\n", result.uncachedTime);
+	debugPrintf("With the graphs: %u ms\n", result.cachedTime);
+	if (result.mismatches)
+		debugPrintf("%u calls returned different paths!\n", result.mismatches);
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
@@ -2953,6 +3046,75 @@ bool Console::cmdVMVarlist(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdVMBench(int argc, const char **argv) {
+	if (argc > 2) {
+		debugPrintf("Decodes the instructions executed with vm_predecode set, both from the\n");
+		debugPrintf("script buffers and from the decoded instructions, and compares them\n");
+		debugPrintf("Usage: %s [<repetitions>]\n", argv[0]);
+		return true;
+	}
+
+	int repetitions = 1000;
+	if (argc == 2 && (!parseInteger(argv[1], repetitions) || repetitions <= 0)) {
+		debugPrintf("Invalid number of repetitions\n");
+		return true;
+	}
+
+	SegManager *segMan = _engine->_gamestate->_segMan;
+	uint instructions = 0, mismatches = 0;
+	uint32 readTime = 0, lookupTime = 0;
+
+	for (uint segmentNr = 0; segmentNr < segMan->_heap.size(); segmentNr++) {
+		SegmentObj *segmentObj = segMan->_heap[segmentNr];
+		if (!segmentObj || segmentObj->getType() != SEG_TYPE_SCRIPT)
+			continue;
+
+		Script *script = (Script *)segmentObj;
+		const Common::Array<uint32> offsets = script->getDecodedInstructionOffsets();
+		byte extOpcode = 0;
+		int16 opparams[4];
+		uint32 checksum = 0;
+
+		uint32 start = g_system->getMillis();
+		for (int r = 0; r < repetitions; r++) {
+			for (uint i = 0; i < offsets.size(); i++)
+				checksum += readPMachineInstruction(script->getBuf(offsets[i]), extOpcode, opparams);
+		}
+		readTime += g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		for (int r = 0; r < repetitions; r++) {
+			for (uint i = 0; i < offsets.size(); i++)
+				checksum -= script->getInstruction(offsets[i]).size;
+		}
+		lookupTime += g_system->getMillis() - start;
+
+		for (uint i = 0; i < offsets.size(); i++) {
+			const PMachineInstruction &instruction = script->getInstruction(offsets[i]);
+			const uint size = readPMachineInstruction(script->getBuf(offsets[i]), extOpcode, opparams);
+
+			if (size != instruction.size || extOpcode != instruction.extOpcode || memcmp(opparams, instruction.opparams, sizeof(opparams)))
+				mismatches++;
+		}
+
+		instructions += offsets.size();
+		if (checksum)
+			mismatches++;
+	}
+
+	if (!instructions) {
+		debugPrintf("No decoded instructions, set vm_predecode and let the game run first\n");
+		return true;
+	}
+
+	debugPrintf("%u instructions, %d times each\n", instructions, repetitions);
+	debugPrintf("Reading from the scripts: %u ms\n", readTime);
+	debugPrintf("Looking up the decoded instructions: %u ms\n", lookupTime);
+	if (mismatches)
+		debugPrintf("%u instructions were decoded differently!\n", mismatches);
+	return true;
+}
+
 bool Console::cmdVMVars(int argc, const char **argv) {
 	if (argc < 2) {
 		debugPrintf("Displays or changes variables in the VM\n");
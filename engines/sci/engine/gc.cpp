@@ -21,6 +21,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -62,6 +63,13 @@ void WorklistManager::push(reg_t reg) {
 	_worklist.push_back(reg);
 }
 
+void WorklistManager::pushNew(reg_t reg) {
+	debugC(kDebugLevelGC, "[GC] Adding new %04x:%04x", PRINT_REG(reg));
+
+	_map.setVal(reg, true);
+	_worklist.push_back(reg);
+}
+
 void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 	for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it)
 		push(*it);
@@ -83,26 +91,44 @@ static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_
 	return normal_map;
 }
 
-static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap) {
+/**
+ * Scans the entries of the work list for their outgoing references.
+ * @param maxReferences	the number of entries to scan, or 0 for all of them
+ * @param skipFreed		whether to skip entries freed since they were pushed,
+ *						which happens while an incremental collection is marking
+ * @return true if the work list is empty
+ */
+static bool processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap, uint maxReferences = 0, bool skipFreed = false) {
 	SegmentId stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
+	uint count = 0;
 	while (!wm._worklist.empty()) {
+		if (maxReferences && count++ == maxReferences)
+			return false;
+
 		reg_t reg = wm._worklist.back();
 		wm._worklist.pop_back();
 		if (reg.getSegment() != stackSegment) { // No need to repeat this one
 			debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
 			if (reg.getSegment() < heap.size() && heap[reg.getSegment()]) {
+				SegmentObj *mobj = heap[reg.getSegment()];
+				if (skipFreed && mobj->getType() != SEG_TYPE_SCRIPT && !mobj->isValidOffset(reg.getOffset()))
+					continue;
+
 				// Valid heap object? Find its outgoing references!
-				wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
+				wm.pushArray(mobj->listAllOutgoingReferences(reg));
 			}
 		}
 	}
+	return true;
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+/**
+ * Pushes the root set: the registers, the stacks and the explicitly loaded
+ * scripts.
+ */
+static void pushRootReferences(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -169,8 +195,13 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
+
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
 
-	processWorkList(s->_segMan, wm, heap);
+	pushRootReferences(s, wm);
+	processWorkList(s->_segMan, wm, s->_segMan->getSegments());
 
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
@@ -178,11 +209,12 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
-	SegManager *segMan = s->_segMan;
-
-	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
+/**
+ * Frees all deallocatable entries which are not in the set of active references.
+ * @param freed			set to the number of freed entries
+ * @param freedBytes	set to the number of freed bytes
+ */
+static void freeUnreachable(SegManager *segMan, const AddrSet &activeRefs, uint &freed, uint32 &freedBytes) {
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
@@ -190,8 +222,8 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
+	freed = 0;
+	freedBytes = 0;
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
@@ -210,8 +242,10 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
+					freed++;
+					freedBytes += mobj->getAllocatedSize(addr);
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
 #ifdef GC_DEBUG_CODE
@@ -223,8 +257,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -234,4 +266,107 @@ void run_gc(EngineState *s) {
 #endif
 }
 
+void run_gc(EngineState *s) {
+	const uint32 start = g_system->getMillis();
+
+	// This collection does everything a running incremental one would do
+	s->_gc->cancel(s->_segMan);
+
+	debugC(kDebugLevelGC, "[GC] Running...");
+
+	// Compute the set of all segments references currently in use.
+	AddrSet *activeRefs = findAllActiveReferences(s);
+
+	uint freed;
+	uint32 freedBytes;
+	freeUnreachable(s->_segMan, *activeRefs, freed, freedBytes);
+
+	delete activeRefs;
+
+	const uint32 time = g_system->getMillis() - start;
+	s->_gc->addCollection(1, time, time, freed, freedBytes);
+}
+
+GarbageCollector::GarbageCollector() : _stats(), _slices(0), _pause(0), _time(0) {
+}
+
+void GarbageCollector::step(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	const uint32 start = g_system->getMillis();
+
+	if (!isRunning(segMan)) {
+		debugC(kDebugLevelGC, "[GC] Starting incremental collection");
+		_wm._worklist.clear();
+		_wm._map.clear();
+		_slices = 0;
+		_pause = 0;
+		_time = 0;
+
+		segMan->_gcWorklist = &_wm;
+		pushRootReferences(s, _wm);
+	}
+
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	bool finished = false;
+	uint freed = 0;
+	uint32 freedBytes = 0;
+
+	if (processWorkList(segMan, _wm, heap, kReferencesPerStep, true)) {
+		debugC(kDebugLevelGC, "[GC] Finishing incremental collection");
+
+		// The roots have changed since the marking started, and unlike
+		// the heap they are not behind the write barrier
+		pushRootReferences(s, _wm);
+		processWorkList(segMan, _wm, heap, 0, true);
+
+		if (g_sci->_gfxPorts)
+			g_sci->_gfxPorts->processEngineHunkList(_wm);
+
+		segMan->_gcWorklist = nullptr;
+
+		AddrSet *activeRefs = normalizeAddresses(segMan, _wm._map);
+		freeUnreachable(segMan, *activeRefs, freed, freedBytes);
+		delete activeRefs;
+
+		_wm._worklist.clear();
+		_wm._map.clear();
+		finished = true;
+	}
+
+	const uint32 time = g_system->getMillis() - start;
+	_slices++;
+	_pause = MAX(_pause, time);
+	_time += time;
+
+	if (finished)
+		addCollection(_slices, _pause, _time, freed, freedBytes);
+}
+
+bool GarbageCollector::isRunning(const SegManager *segMan) const {
+	return segMan->_gcWorklist == &_wm;
+}
+
+void GarbageCollector::cancel(SegManager *segMan) {
+	if (isRunning(segMan)) {
+		debugC(kDebugLevelGC, "[GC] Aborting incremental collection");
+		segMan->_gcWorklist = nullptr;
+	}
+
+	_wm._worklist.clear();
+	_wm._map.clear();
+}
+
+void GarbageCollector::addCollection(uint slices, uint32 pause, uint32 time, uint freed, uint32 freedBytes) {
+	_stats.collections++;
+	_stats.lastSlices = slices;
+	_stats.lastPause = pause;
+	_stats.lastTime = time;
+	_stats.lastFreed = freed;
+	_stats.lastFreedBytes = freedBytes;
+	_stats.maxPause = MAX(_stats.maxPause, pause);
+	_stats.totalFreedBytes += freedBytes;
+
+	debugC(kDebugLevelGC, "[GC] Freed %u entries (%u bytes) in %u slices, %u ms", freed, freedBytes, slices, time);
+}
+
 } // End of namespace Sci
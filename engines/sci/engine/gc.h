@@ -59,9 +59,77 @@ struct WorklistManager {
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
 
 	void push(reg_t reg);
+	void pushNew(reg_t reg); // also pushes addresses which were already dealt with
 	void pushArray(const Common::Array<reg_t> &tmp);
 };
 
+/**
+ * Statistics of the garbage collections, shown by the gc_stats debugger
+ * command. All times are in milliseconds.
+ */
+struct GCStats {
+	uint collections;       /**< Number of finished collections */
+	uint lastSlices;        /**< Number of slices of the last collection */
+	uint32 lastPause;       /**< Longest slice of the last collection */
+	uint32 lastTime;        /**< Time spent in all slices of the last collection */
+	uint lastFreed;         /**< Number of entries freed by the last collection */
+	uint32 lastFreedBytes;  /**< Number of bytes freed by the last collection */
+	uint32 maxPause;        /**< Longest slice of all collections */
+	uint32 totalFreedBytes; /**< Number of bytes freed by all collections */
+};
+
+/**
+ * Collects the garbage of an engine state, either at once with run_gc() or
+ * incrementally, with the marking spread over several calls to step().
+ *
+ * While an incremental collection is marking, the segment manager passes
+ * the references stored in the heap to its work list (see
+ * SegManager::gcWriteBarrier()), so that entries which become reachable
+ * from already scanned ones are not freed. The last slice marks from the
+ * roots again and frees the unreachable entries; anything which became
+ * unreachable during the marking is freed by the next collection.
+ */
+class GarbageCollector {
+public:
+	enum {
+		kReferencesPerStep = 1000 /**< Number of references scanned by each slice */
+	};
+
+	GarbageCollector();
+
+	/**
+	 * Runs a slice of an incremental collection, starting a new one if
+	 * none is running.
+	 */
+	void step(EngineState *s);
+
+	/**
+	 * Checks whether an incremental collection is marking. Collections
+	 * are dropped when the segments are reset.
+	 */
+	bool isRunning(const SegManager *segMan) const;
+
+	/**
+	 * Drops the running incremental collection, if any.
+	 */
+	void cancel(SegManager *segMan);
+
+	/**
+	 * Adds a finished collection to the statistics.
+	 */
+	void addCollection(uint slices, uint32 pause, uint32 time, uint freed, uint32 freedBytes);
+
+	const GCStats &getStats() const { return _stats; }
+
+private:
+	WorklistManager _wm;
+	GCStats _stats;
+
+	uint _slices;  /**< Number of slices of the running collection */
+	uint32 _pause; /**< Longest slice of the running collection */
+	uint32 _time;  /**< Time spent in the running collection */
+};
+
 
 } // End of namespace Sci
 
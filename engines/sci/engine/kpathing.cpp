@@ -23,6 +23,7 @@
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
 #include "sci/engine/kernel.h"
+#include "sci/engine/kpathing.h"
 #include "sci/graphics/paint16.h"
 #include "sci/graphics/palette.h"
 #include "sci/graphics/screen.h"
@@ -116,10 +117,14 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// Index in the visibility graph, or -1 if not part of it
+	int id;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
 		path_prev = nullptr;
+		id = -1;
 	}
 };
 
@@ -219,6 +224,14 @@ public:
 	}
 };
 
+/**
+ * Returns the bounding box of a line segment, with the right and bottom
+ * edges included.
+ */
+static Common::Rect segment_bounds(const Common::Point &a, const Common::Point &b) {
+	return Common::Rect(MIN(a.x, b.x), MIN(a.y, b.y), MAX(a.x, b.x) + 1, MAX(a.y, b.y) + 1);
+}
+
 struct Polygon {
 	// SCI polygon type
 	int type;
@@ -226,10 +239,21 @@ struct Polygon {
 	// Circular list of vertices
 	CircularVertexList vertices;
 
+	// Bounding box of the vertices, with the right and bottom edges
+	// included. Only set for the polygons used for pathfinding.
+	Common::Rect bounds;
+
 public:
 	Polygon(int t) : type(t) {
 	}
 
+	void updateBounds() {
+		Vertex *vertex;
+		bounds = segment_bounds(vertices.first()->v, vertices.first()->v);
+		CLIST_FOREACH(vertex, &vertices)
+			bounds.extend(segment_bounds(vertex->v, vertex->v));
+	}
+
 	~Polygon() {
 		while (!vertices.empty()) {
 			Vertex *vertex = vertices.first();
@@ -241,6 +265,29 @@ public:
 
 typedef Common::List<Polygon *> PolygonList;
 
+/**
+ * The visibility between the vertices of a polygon set, computed as the
+ * pathfinding needs it.
+ */
+struct VisibilityGraph {
+	enum {
+		kUnknown = 0,
+		kVisible = 1,
+		kHidden = 2
+	};
+
+	uint32 hash;
+
+	// The vertices of all polygons, polygon after polygon
+	Common::Array<Common::Point> points;
+
+	// The number of vertices of each polygon
+	Common::Array<uint> sizes;
+
+	// The visibility of each vertex from each vertex
+	Common::Array<byte> visibility;
+};
+
 // Pathfinding state
 struct PathfindingState {
 	// List of all polygons
@@ -262,6 +309,9 @@ struct PathfindingState {
 	// Screen size
 	int _width, _height;
 
+	// Known visibility between the vertices, or NULL
+	VisibilityGraph *_graph;
+
 	PathfindingState(int width, int height) : _width(width), _height(height) {
 		vertex_start = nullptr;
 		vertex_end = nullptr;
@@ -269,6 +319,7 @@ struct PathfindingState {
 		_prependPoint = nullptr;
 		_appendPoint = nullptr;
 		vertices = 0;
+		_graph = nullptr;
 	}
 
 	~PathfindingState() {
@@ -698,6 +749,50 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 	return 0;
 }
 
+/**
+ * Determines whether or not a vertex is visible from another one
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex to look from
+ * @param vertex		the vertex to look at
+ * @return true if vertex is visible from vertex_cur, false otherwise
+ */
+static bool is_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
+
+	// Check for intersecting edges. Edges outside of the bounding box of
+	// the line can neither touch nor cross it.
+	const Common::Rect lineBounds = segment_bounds(vertex_cur->v, vertex->v);
+
+	for (PolygonList::iterator it = s->polygons.begin(); it != s->polygons.end(); ++it) {
+		Polygon *polygon = *it;
+		Vertex *edge;
+
+		if (!polygon->bounds.intersects(lineBounds))
+			continue;
+
+		CLIST_FOREACH(edge, &polygon->vertices) {
+			if (!VERTEX_HAS_EDGES(edge) || !segment_bounds(edge->v, CLIST_NEXT(edge)->v).intersects(lineBounds))
+				continue;
+
+			if (between(vertex_cur->v, vertex->v, edge->v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
+					return false;
+
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
+
+			if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 /**
  * Returns a list of all vertices that are visible from a particular vertex.
  * @param s				the pathfinding state
@@ -706,34 +801,24 @@ static int inside(const Common::Point &p, Vertex *vertex) {
  */
 static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
 	VertexList *visVerts = new VertexList();
+	VisibilityGraph *graph = (vertex_cur->id >= 0) ? s->_graph : nullptr;
 
 	for (int i = 0; i < s->vertices; i++) {
 		Vertex *vertex = s->vertex_index[i];
-
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
-			continue;
-
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
-
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
+		bool visible;
+
+		if (graph && vertex->id >= 0) {
+			// Between the vertices of the polygons, look the visibility
+			// up in the graph, or compute it for the next calls
+			byte &known = graph->visibility[vertex_cur->id * graph->points.size() + vertex->id];
+			if (known == VisibilityGraph::kUnknown)
+				known = is_visible(s, vertex_cur, vertex) ? VisibilityGraph::kVisible : VisibilityGraph::kHidden;
+			visible = (known == VisibilityGraph::kVisible);
+		} else {
+			visible = is_visible(s, vertex_cur, vertex);
 		}
 
-		if (j == s->vertices)
+		if (visible)
 			visVerts->push_front(vertex);
 	}
 
@@ -901,11 +986,17 @@ static int nearest_intersection(PathfindingState *s, const Common::Point &p, con
 	FloatPoint isec;
 	Polygon *ipolygon = nullptr;
 	uint32 dist = HUGE_DISTANCE;
+	const Common::Rect lineBounds = segment_bounds(p, q);
 
 	for (PolygonList::iterator it = s->polygons.begin(); it != s->polygons.end(); ++it) {
 		polygon = *it;
 		Vertex *vertex;
 
+		// Polygons outside of the bounding box of the line segment can
+		// neither touch nor cross it
+		if (!polygon->bounds.intersects(lineBounds))
+			continue;
+
 		CLIST_FOREACH(vertex, &polygon->vertices) {
 			uint32 new_dist;
 			FloatPoint new_isec;
@@ -1155,6 +1246,7 @@ static Vertex *merge_point(PathfindingState *s, const Common::Point &v) {
 	// Add point as single-vertex polygon
 	polygon = new Polygon(POLY_BARRED_ACCESS);
 	polygon->vertices.insertHead(v_new);
+	polygon->updateBounds();
 	s->polygons.push_front(polygon);
 
 	return v_new;
@@ -1236,39 +1328,19 @@ static void change_polygons_opt_0(PathfindingState *s) {
 }
 
 /**
- * Converts the SCI input data for pathfinding
- * Parameters: (EngineState *) s: The game state
- *             (reg_t) poly_list: Polygon list
+ * Prepares the converted polygons for pathfinding
+ * Parameters: (PathfindingState *) pf_s: The pathfinding state with the polygons
  *             (Common::Point) start: The start point
  *             (Common::Point) end: The end point
  *             (int) opt: Optimization level (0, 1 or 2)
- * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
- *                            NULL otherwise
+ *             (AvoidPathCache *) cache: The cache of visibility graphs, or NULL
+ * Returns   : (bool) true on success, false otherwise
  */
-static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
-	SegManager *segMan = s->_segMan;
+static bool prepare_polygon_set(PathfindingState *pf_s, Common::Point start, Common::Point end, int opt, AvoidPathCache *cache) {
 	Polygon *polygon;
-	int count = 0;
-	PathfindingState *pf_s = new PathfindingState(width, height);
-
-	// Convert all polygons
-	if (poly_list.getSegment()) {
-		List *list = s->_segMan->lookupList(poly_list);
-		Node *node = s->_segMan->lookupNode(list->first);
-
-		while (node) {
-			// The node value might be null, in which case there's no polygon to parse.
-			// Happens in LB2 floppy - refer to bug #5195
-			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : nullptr;
-
-			if (polygon) {
-				pf_s->polygons.push_back(polygon);
-				count += readSelectorValue(segMan, node->value, SELECTOR(size));
-			}
 
-			node = s->_segMan->lookupNode(node->succ);
-		}
-	}
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+		(*it)->updateBounds();
 
 	if (opt == 0)
 		change_polygons_opt_0(pf_s);
@@ -1277,8 +1349,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 
 	if (!new_start) {
 		warning("AvoidPath: Couldn't fixup start position for pathfinding");
-		delete pf_s;
-		return nullptr;
+		return false;
 	}
 
 	Common::Point *new_end = fixup_end_point(pf_s, end);
@@ -1286,8 +1357,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	if (!new_end) {
 		warning("AvoidPath: Couldn't fixup end position for pathfinding");
 		delete new_start;
-		delete pf_s;
-		return nullptr;
+		return false;
 	}
 
 	if (opt == 0) {
@@ -1309,8 +1379,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 				warning("AvoidPath: error finding nearest intersection");
 				delete new_start;
 				delete new_end;
-				delete pf_s;
-				return nullptr;
+				return false;
 			}
 
 			if (err == PF_OK)
@@ -1319,13 +1388,30 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	} else {
 		// WORKAROUND LSL5 room 660. Priority glitch due to us choosing a different path
 		// than SSCI. Happens when Patti walks to the control room.
-		if (g_sci->getGameId() == GID_LSL5 && (s->currentRoomNumber() == 660) && (Common::Point(67, 131) == *new_start) && (Common::Point(229, 101) == *new_end)) {
+		if (g_sci->getGameId() == GID_LSL5 && (g_sci->getEngineState()->currentRoomNumber() == 660) && (Common::Point(67, 131) == *new_start) && (Common::Point(229, 101) == *new_end)) {
 			debug(1, "[avoidpath] Applying fix for priority problem in LSL5, room 660");
 			pf_s->_prependPoint = new_start;
 			new_start = new Common::Point(77, 107);
 		}
 	}
 
+	// Number the vertices of the remaining polygons, for the visibility graph
+	Common::Array<Common::Point> graphPoints;
+	Common::Array<uint> graphSizes;
+
+	if (cache) {
+		for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+			polygon = *it;
+			Vertex *vertex;
+
+			CLIST_FOREACH(vertex, &polygon->vertices) {
+				vertex->id = graphPoints.size();
+				graphPoints.push_back(vertex->v);
+			}
+			graphSizes.push_back(polygon->vertices.size());
+		}
+	}
+
 	// Merge start and end points into polygon set
 	pf_s->vertex_start = merge_point(pf_s, *new_start);
 	pf_s->vertex_end = merge_point(pf_s, *new_end);
@@ -1333,8 +1419,25 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_start;
 	delete new_end;
 
+	if (cache) {
+		// New vertices on the edges of the polygons change the visibility
+		// between their vertices, new single-vertex polygons do not
+		const bool splitEdge = (pf_s->vertex_start->id < 0 && VERTEX_HAS_EDGES(pf_s->vertex_start))
+		                    || (pf_s->vertex_end->id < 0 && VERTEX_HAS_EDGES(pf_s->vertex_end));
+
+		if (splitEdge)
+			cache->addUncachedCall();
+		else
+			pf_s->_graph = cache->getGraph(graphPoints, graphSizes);
+	}
+
 	// Allocate and build vertex index
-	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
+	int count = 0;
+
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+		count += (*it)->vertices.size();
+
+	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * count);
 
 	count = 0;
 
@@ -1349,6 +1452,67 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 
 	pf_s->vertices = count;
 
+	return true;
+}
+
+/**
+ * Converts the SCI input data for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (reg_t) poly_list: Polygon list
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
+ *                            NULL otherwise
+ */
+static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
+	Polygon *polygon;
+	PathfindingState *pf_s = new PathfindingState(width, height);
+	AvoidPathCall call;
+	// Only keep the input for avoidpath_bench when pathfinding is debugged
+	const bool recordCall = DebugMan.isDebugChannelEnabled(kDebugLevelAvoidPath);
+
+	// Convert all polygons
+	if (poly_list.getSegment()) {
+		List *list = s->_segMan->lookupList(poly_list);
+		Node *node = s->_segMan->lookupNode(list->first);
+
+		while (node) {
+			// The node value might be null, in which case there's no polygon to parse.
+			// Happens in LB2 floppy - refer to bug #5195
+			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : nullptr;
+
+			if (polygon) {
+				pf_s->polygons.push_back(polygon);
+
+				if (recordCall) {
+					AvoidPathPolygon polygonCall;
+					Vertex *vertex;
+					polygonCall.type = polygon->type;
+					CLIST_FOREACH(vertex, &polygon->vertices)
+						polygonCall.points.push_back(vertex->v);
+					call.polygons.push_back(polygonCall);
+				}
+			}
+
+			node = s->_segMan->lookupNode(node->succ);
+		}
+	}
+
+	if (recordCall) {
+		call.start = start;
+		call.end = end;
+		call.width = width;
+		call.height = height;
+		call.opt = opt;
+		s->_avoidPathCache->recordCall(call);
+	}
+
+	if (!prepare_polygon_set(pf_s, start, end, opt, s->_avoidPathCache)) {
+		delete pf_s;
+		return nullptr;
+	}
+
 	return pf_s;
 }
 
@@ -1469,65 +1633,79 @@ static reg_t allocateOutputArray(SegManager *segMan, int size) {
 }
 
 /**
- * Stores the final path in newly allocated dynmem
+ * Collects the points of the final path
  * Parameters: (PathfindingState *) p: The pathfinding state
- *             (EngineState *) s: The game state
- * Returns   : (reg_t) Pointer to dynmem containing path
+ *             (Common::Array<Common::Point> &) path: Set to the points of the path,
+ *                                                    without the sentinel
+ * Returns   : (int) The number of vertices of the shortest path, or 0 if the
+ *                   end point is unreachable
  */
-static reg_t output_path(PathfindingState *p, EngineState *s) {
+static int get_path(PathfindingState *p, Common::Array<Common::Point> &path) {
 	int path_len = 0;
-	reg_t output;
 	Vertex *vertex = p->vertex_end;
 	int unreachable = vertex->path_prev == nullptr;
 
-	if (!unreachable) {
-		while (vertex) {
-			// Compute path length
-			path_len++;
-			vertex = vertex->path_prev;
-		}
-	}
-
-	// Allocate memory for path, plus 3 extra for appended point, prepended point and sentinel
-	output = allocateOutputArray(s->_segMan, path_len + 3);
-	SegmentRef arrayRef = s->_segMan->dereference(output);
-	assert(arrayRef.isValid() && !arrayRef.skipByte);
+	path.clear();
 
 	if (unreachable) {
 		// If pathfinding failed we only return the path up to vertex_start
-
 		if (p->_prependPoint)
-			writePoint(arrayRef, 0, *p->_prependPoint);
+			path.push_back(*p->_prependPoint);
 		else
-			writePoint(arrayRef, 0, p->vertex_start->v);
+			path.push_back(p->vertex_start->v);
 
-		writePoint(arrayRef, 1, p->vertex_start->v);
-		writePoint(arrayRef, 2, Common::Point(POLY_LAST_POINT, POLY_LAST_POINT));
+		path.push_back(p->vertex_start->v);
+		return 0;
+	}
 
-		return output;
+	while (vertex) {
+		// Compute path length
+		path_len++;
+		vertex = vertex->path_prev;
 	}
 
 	int offset = 0;
 
 	if (p->_prependPoint) {
-		writePoint(arrayRef, offset, *p->_prependPoint);
+		path.push_back(*p->_prependPoint);
 		offset++;
 	}
 
+	path.resize(offset + path_len);
 	vertex = p->vertex_end;
 	for (int i = path_len - 1; i >= 0; i--) {
-		writePoint(arrayRef, offset + i, vertex->v);
+		path[offset + i] = vertex->v;
 		vertex = vertex->path_prev;
 	}
-	offset += path_len;
 
 	if (p->_appendPoint)
-		writePoint(arrayRef, offset++, *p->_appendPoint);
+		path.push_back(*p->_appendPoint);
+
+	return path_len;
+}
+
+/**
+ * Stores the final path in newly allocated dynmem
+ * Parameters: (PathfindingState *) p: The pathfinding state
+ *             (EngineState *) s: The game state
+ * Returns   : (reg_t) Pointer to dynmem containing path
+ */
+static reg_t output_path(PathfindingState *p, EngineState *s) {
+	Common::Array<Common::Point> path;
+	int path_len = get_path(p, path);
+
+	// Allocate memory for path, plus 3 extra for appended point, prepended point and sentinel
+	reg_t output = allocateOutputArray(s->_segMan, path_len + 3);
+	SegmentRef arrayRef = s->_segMan->dereference(output);
+	assert(arrayRef.isValid() && !arrayRef.skipByte);
+
+	for (uint i = 0; i < path.size(); i++)
+		writePoint(arrayRef, i, path[i]);
 
 	// Sentinel
-	writePoint(arrayRef, offset, Common::Point(POLY_LAST_POINT, POLY_LAST_POINT));
+	writePoint(arrayRef, path.size(), Common::Point(POLY_LAST_POINT, POLY_LAST_POINT));
 
-	if (DebugMan.isDebugChannelEnabled(kDebugLevelAvoidPath)) {
+	if (path_len && DebugMan.isDebugChannelEnabled(kDebugLevelAvoidPath)) {
 		debug("\nReturning path:");
 
 		SegmentRef outputList = s->_segMan->dereference(output);
@@ -1536,7 +1714,7 @@ static reg_t output_path(PathfindingState *p, EngineState *s) {
 			return output;
 		}
 
-		for (int i = 0; i < offset; i++) {
+		for (uint i = 0; i < path.size(); i++) {
 			Common::Point pt = readPoint(outputList, i);
 			debugN(-1, " (%i, %i)", pt.x, pt.y);
 		}
@@ -1644,6 +1822,131 @@ reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 	}
 }
 
+AvoidPathCache::AvoidPathCache() : _nextCall(0), _stats() {
+}
+
+AvoidPathCache::~AvoidPathCache() {
+	clear();
+}
+
+static uint32 hash_polygons(const Common::Array<Common::Point> &points, const Common::Array<uint> &sizes) {
+	uint32 hash = sizes.size();
+
+	for (uint i = 0; i < points.size(); i++)
+		hash = hash * 31 + ((uint16)points[i].x | ((uint32)(uint16)points[i].y << 16));
+	for (uint i = 0; i < sizes.size(); i++)
+		hash = hash * 31 + sizes[i];
+
+	return hash;
+}
+
+VisibilityGraph *AvoidPathCache::getGraph(const Common::Array<Common::Point> &points, const Common::Array<uint> &sizes) {
+	if (points.size() > kMaxGraphVertices) {
+		_stats.uncached++;
+		return nullptr;
+	}
+
+	const uint32 hash = hash_polygons(points, sizes);
+
+	for (Common::List<VisibilityGraph *>::iterator it = _graphs.begin(); it != _graphs.end(); ++it) {
+		VisibilityGraph *graph = *it;
+
+		if (graph->hash == hash && graph->points == points && graph->sizes == sizes) {
+			_stats.hits++;
+			_graphs.erase(it);
+			_graphs.push_front(graph);
+			return graph;
+		}
+	}
+
+	_stats.misses++;
+
+	if (_graphs.size() >= kMaxGraphs) {
+		delete _graphs.back();
+		_graphs.pop_back();
+	}
+
+	VisibilityGraph *graph = new VisibilityGraph();
+	graph->hash = hash;
+	graph->points = points;
+	graph->sizes = sizes;
+	graph->visibility.resize(points.size() * points.size(), VisibilityGraph::kUnknown);
+	_graphs.push_front(graph);
+
+	return graph;
+}
+
+void AvoidPathCache::recordCall(const AvoidPathCall &call) {
+	if (_calls.size() < kMaxRecordedCalls) {
+		_calls.push_back(call);
+	} else {
+		_calls[_nextCall] = call;
+		_nextCall = (_nextCall + 1) % kMaxRecordedCalls;
+	}
+}
+
+/**
+ * Runs the pathfinding for a recorded kAvoidPath call
+ * Parameters: (const AvoidPathCall &) call: The call
+ *             (AvoidPathCache *) cache: The cache of visibility graphs, or NULL
+ *             (Common::Array<Common::Point> &) path: Set to the points of the path
+ */
+static void replay_call(const AvoidPathCall &call, AvoidPathCache *cache, Common::Array<Common::Point> &path) {
+	PathfindingState *p = new PathfindingState(call.width, call.height);
+
+	for (uint i = 0; i < call.polygons.size(); i++) {
+		Polygon *polygon = new Polygon(call.polygons[i].type);
+
+		for (uint j = 0; j < call.polygons[i].points.size(); j++)
+			polygon->vertices.insertAtEnd(new Vertex(call.polygons[i].points[j]));
+
+		p->polygons.push_back(polygon);
+	}
+
+	path.clear();
+
+	if (prepare_polygon_set(p, call.start, call.end, call.opt, cache)) {
+		AStar(p);
+		get_path(p, path);
+	}
+
+	delete p;
+}
+
+AvoidPathCache::BenchmarkResult AvoidPathCache::benchmark(uint repetitions) {
+	BenchmarkResult result = {};
+	const Stats stats = _stats;
+
+	for (uint i = 0; i < _calls.size(); i++) {
+		Common::Array<Common::Point> uncachedPath, cachedPath;
+
+		uint32 start = g_system->getMillis();
+		for (uint r = 0; r < repetitions; r++)
+			replay_call(_calls[i], nullptr, uncachedPath);
+		result.uncachedTime += g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		for (uint r = 0; r < repetitions; r++)
+			replay_call(_calls[i], this, cachedPath);
+		result.cachedTime += g_system->getMillis() - start;
+
+		result.calls++;
+		if (uncachedPath != cachedPath)
+			result.mismatches++;
+	}
+
+	// The replayed calls are not counted
+	_stats = stats;
+
+	return result;
+}
+
+void AvoidPathCache::clear() {
+	for (Common::List<VisibilityGraph *>::iterator it = _graphs.begin(); it != _graphs.end(); ++it)
+		delete *it;
+	_graphs.clear();
+}
+
 static bool PointInRect(const Common::Point &point, int16 rectX1, int16 rectY1, int16 rectX2, int16 rectY2) {
 	int16 top = MIN<int16>(rectY1, rectY2);
 	int16 left = MIN<int16>(rectX1, rectX2);
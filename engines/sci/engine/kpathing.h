@@ -0,0 +1,128 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCI_ENGINE_KPATHING_H
+#define SCI_ENGINE_KPATHING_H
+
+#include "common/array.h"
+#include "common/list.h"
+#include "common/rect.h"
+
+namespace Sci {
+
+struct VisibilityGraph;
+
+/**
+ * A polygon of a kAvoidPath call, with its vertices in the order used for
+ * pathfinding.
+ */
+struct AvoidPathPolygon {
+	int type;
+	Common::Array<Common::Point> points;
+};
+
+/**
+ * The input of a kAvoidPath call, recorded for benchmarking.
+ */
+struct AvoidPathCall {
+	Common::Array<AvoidPathPolygon> polygons;
+	Common::Point start, end;
+	int width, height;
+	int opt;
+};
+
+/**
+ * Keeps the visibility graphs of the polygon sets passed to kAvoidPath.
+ *
+ * Scripts pass the same polygons again and again while actors walk, and
+ * only the start and end points change. Unless one of these points splits
+ * an edge of a polygon, the visibility between the polygon vertices stays
+ * the same, so it is remembered for the next calls. The visibility of the
+ * start and end points is computed for each call.
+ */
+class AvoidPathCache {
+public:
+	enum {
+		kMaxGraphs = 8,        /**< Number of polygon sets to keep the graphs of */
+		kMaxGraphVertices = 1024,
+		kMaxRecordedCalls = 32 /**< Number of calls kept for benchmark() */
+	};
+
+	struct Stats {
+		uint hits;     /**< Calls with a known polygon set */
+		uint misses;   /**< Calls with a new polygon set */
+		uint uncached; /**< Calls where the start or end point split an edge */
+	};
+
+	struct BenchmarkResult {
+		uint calls;
+		uint mismatches;      /**< Calls with different paths with and without the cache */
+		uint32 uncachedTime;  /**< Time of the calls without the cache, in milliseconds */
+		uint32 cachedTime;    /**< Time of the calls with the cache, in milliseconds */
+	};
+
+	AvoidPathCache();
+	~AvoidPathCache();
+
+	/**
+	 * Returns the graph of the given polygon set, creating it if needed.
+	 * @param points	the vertices of all polygons, polygon after polygon
+	 * @param sizes		the number of vertices of each polygon
+	 * @return the graph, or null if there are too many vertices
+	 */
+	VisibilityGraph *getGraph(const Common::Array<Common::Point> &points, const Common::Array<uint> &sizes);
+
+	/** Counts a call that could not use a graph. */
+	void addUncachedCall() { _stats.uncached++; }
+
+	/**
+	 * Remembers the input of a kAvoidPath call for benchmark(). Calls are
+	 * only recorded while the Pathfinding debug channel is enabled.
+	 */
+	void recordCall(const AvoidPathCall &call);
+
+	/**
+	 * Runs the recorded calls without and with the visibility graphs, and
+	 * compares the paths.
+	 * @param repetitions	the number of times to run each call
+	 */
+	BenchmarkResult benchmark(uint repetitions);
+
+	/** Drops all graphs. */
+	void clear();
+
+	uint getGraphCount() const { return _graphs.size(); }
+	uint getRecordedCallCount() const { return _calls.size(); }
+	const Stats &getStats() const { return _stats; }
+
+private:
+	/** The graphs, the most recently used one first. */
+	Common::List<VisibilityGraph *> _graphs;
+
+	Common::Array<AvoidPathCall> _calls;
+	uint _nextCall;
+
+	Stats _stats;
+};
+
+} // End of namespace Sci
+
+#endif // SCI_ENGINE_KPATHING_H
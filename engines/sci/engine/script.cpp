@@ -27,6 +27,7 @@
 #include "sci/engine/state.h"
 #include "sci/engine/kernel.h"
 #include "sci/engine/script.h"
+#include "sci/engine/vm.h"
 
 #include "common/util.h"
 
@@ -74,6 +75,25 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	_instructions.clear();
+}
+
+const PMachineInstruction &Script::decodeInstruction(uint32 offset) {
+	PMachineInstruction &instruction = _instructions.getOrCreateVal(offset);
+	instruction.size = readPMachineInstruction(getBuf(offset), instruction.extOpcode, instruction.opparams);
+
+	return instruction;
+}
+
+Common::Array<uint32> Script::getDecodedInstructionOffsets() const {
+	Common::Array<uint32> offsets;
+	offsets.reserve(_instructions.size());
+
+	for (InstructionMap::const_iterator it = _instructions.begin(); it != _instructions.end(); ++it)
+		offsets.push_back(it->_key);
+
+	return offsets;
 }
 
 enum {
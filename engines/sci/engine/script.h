@@ -68,6 +68,18 @@ struct offsetLookupArrayEntry {
 
 typedef Common::Array<offsetLookupArrayEntry> offsetLookupArrayType;
 
+/**
+ * A PMachine instruction with its operands read, as returned by
+ * readPMachineInstruction().
+ */
+struct PMachineInstruction {
+	uint16 size;        /**< Length of the instruction in bytes */
+	byte extOpcode;     /**< "Extended" opcode, the lower bit selects the operand size */
+	int16 opparams[4];  /**< The operands */
+};
+
+typedef Common::HashMap<uint32, PMachineInstruction> InstructionMap;
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -93,6 +105,8 @@ private:
 
 	ObjMap _objects;	/**< Table for objects, contains property variables */
 
+	InstructionMap _instructions; /**< The instructions decoded by getInstruction(), by offset */
+
 protected:
 	offsetLookupArrayType _offsetLookupArray; // Table of all elements of currently loaded script, that may get pointed to
 
@@ -126,6 +140,25 @@ public:
 	ObjMap &getObjectMap() { return _objects; }
 	const ObjMap &getObjectMap() const { return _objects; }
 
+	/**
+	 * Returns the instruction at the given offset, decoding it the first
+	 * time. Scripts do not modify their code, so the instructions are kept
+	 * until the script is freed.
+	 */
+	const PMachineInstruction &getInstruction(uint32 offset) {
+		// speed optimization: inline due to frequent calling
+		InstructionMap::const_iterator it = _instructions.find(offset);
+		if (it != _instructions.end())
+			return it->_value;
+		return decodeInstruction(offset);
+	}
+
+	/** Returns the number of instructions decoded by getInstruction(). */
+	uint getDecodedInstructionCount() const { return _instructions.size(); }
+
+	/** Returns the offsets of the instructions decoded by getInstruction(). */
+	Common::Array<uint32> getDecodedInstructionOffsets() const;
+
 	// speed optimization: inline due to frequent calling
 	bool offsetIsObject(uint32 offset) const {
 		return _buf->getUint16SEAt(offset + SCRIPT_OBJECT_MAGIC_OFFSET) == SCRIPT_OBJECT_MAGIC_NUMBER;
@@ -142,6 +175,9 @@ public:
 	SegmentRef dereference(reg_t pointer) override;
 	reg_t findCanonicAddress(SegManager *segMan, reg_t sub_addr) const override;
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override;
+	uint getAllocatedSize(reg_t sub_addr) const override {
+		return _markedAsDeleted ? getBufSize() : 0;
+	}
 	Common::Array<reg_t> listAllDeallocatable(SegmentId segId) const override;
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
@@ -326,6 +362,8 @@ private:
 
 	bool relocateLocal(SegmentId segment, int location, uint32 offset);
 
+	const PMachineInstruction &decodeInstruction(uint32 offset);
+
 #ifdef ENABLE_SCI32
 	/**
 	 * Gets a pointer to the beginning of the objects in a SCI3 script
@@ -21,6 +21,7 @@
 
 #include "sci/sci.h"
 #include "sci/engine/seg_manager.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
 #ifdef ENABLE_SCI32
@@ -34,6 +35,8 @@ SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
 	: _resMan(resMan), _scriptPatcher(scriptPatcher) {
 	_heap.push_back(0);
 
+	_gcWorklist = nullptr;
+
 	_clonesSegId = 0;
 	_listsSegId = 0;
 	_nodesSegId = 0;
@@ -55,6 +58,9 @@ SegManager::~SegManager() {
 }
 
 void SegManager::resetSegMan() {
+	// Drop the running incremental collection, its entries are gone
+	_gcWorklist = nullptr;
+
 	// Free memory
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (_heap[i])
@@ -467,6 +473,7 @@ reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
 	h.size = size;
 	h.type = hunk_type;
 
+	gcAllocationBarrier(addr);
 	return addr;
 }
 
@@ -494,6 +501,7 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_clonesSegId, offset);
+	gcAllocationBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -510,6 +518,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_listsSegId, offset);
+	gcAllocationBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -526,6 +535,7 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_nodesSegId, offset);
+	gcAllocationBarrier(*addr);
 	return &table->at(offset);
 }
 
@@ -952,6 +962,7 @@ SciArray *SegManager::allocateArray(SciArrayType type, uint16 size, reg_t *addr)
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_arraysSegId, offset);
+	gcAllocationBarrier(*addr);
 
 	SciArray *array = &table->at(offset);
 	array->setType(type);
@@ -1008,6 +1019,7 @@ SciBitmap *SegManager::allocateBitmap(reg_t *addr, const int16 width, const int1
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_bitmapSegId, offset);
+	gcAllocationBarrier(*addr);
 	SciBitmap &bitmap = table->at(offset);
 
 	bitmap.create(width, height, skipColor, originX, originY, xResolution, yResolution, paletteSize, remap, gc);
@@ -1182,4 +1194,12 @@ void SegManager::uninstantiateScriptSci0(int script_nr) {
 	}
 }
 
+void SegManager::gcShade(reg_t value) {
+	_gcWorklist->push(value);
+}
+
+void SegManager::gcShadeNew(reg_t addr) {
+	_gcWorklist->pushNew(addr);
+}
+
 } // End of namespace Sci
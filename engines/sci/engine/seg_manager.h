@@ -44,6 +44,7 @@ enum ScriptLoadType {
 };
 
 class Script;
+struct WorklistManager;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
@@ -460,7 +461,42 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	// 10. Garbage collection
+
+	/**
+	 * Tells the garbage collector about a reference which is stored in the
+	 * heap. Needed for all such stores while an incremental collection is
+	 * marking, so that it does not miss entries only referenced from already
+	 * scanned ones.
+	 * @param value		the stored reference
+	 */
+	void gcWriteBarrier(reg_t value) {
+		if (_gcWorklist && value.getSegment())
+			gcShade(value);
+	}
+
+	/**
+	 * Tells the garbage collector about a newly allocated entry. Unlike
+	 * stored references, the entry is always scanned, even if the collector
+	 * already saw its address: the slot may have been freed and reused
+	 * since then.
+	 * @param addr		the address of the new entry
+	 */
+	void gcAllocationBarrier(reg_t addr) {
+		if (_gcWorklist)
+			gcShadeNew(addr);
+	}
+
+	/**
+	 * The work list of the running incremental collection, or null if none
+	 * is marking. Set by the GarbageCollector.
+	 */
+	WorklistManager *_gcWorklist;
+
 private:
+	void gcShade(reg_t value);
+	void gcShadeNew(reg_t addr);
+
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
@@ -122,6 +122,13 @@ public:
 	 */
 	virtual void freeAtAddress(SegManager *segMan, reg_t sub_addr) {}
 
+	/**
+	 * Returns the number of bytes that freeAtAddress() releases.
+	 * Used by the garbage collector for its statistics.
+	 * @param sub_addr		address (within the given segment) to check
+	 */
+	virtual uint getAllocatedSize(reg_t sub_addr) const { return 0; }
+
 	/**
 	 * Iterates over and reports all addresses within the segment.
 	 * Used by the garbage collector.
@@ -320,6 +327,9 @@ struct CloneTable : public SegmentObjTable<Clone> {
 	CloneTable() : SegmentObjTable<Clone>(SEG_TYPE_CLONES) {}
 
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override;
+	uint getAllocatedSize(reg_t sub_addr) const override {
+		return sizeof(Clone) + at(sub_addr.getOffset()).getVarCount() * sizeof(reg_t);
+	}
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
@@ -333,6 +343,9 @@ struct NodeTable : public SegmentObjTable<Node> {
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override {
 		freeEntry(sub_addr.getOffset());
 	}
+	uint getAllocatedSize(reg_t sub_addr) const override {
+		return sizeof(Node);
+	}
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
@@ -346,6 +359,9 @@ struct ListTable : public SegmentObjTable<List> {
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override {
 		freeEntry(sub_addr.getOffset());
 	}
+	uint getAllocatedSize(reg_t sub_addr) const override {
+		return sizeof(List);
+	}
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
@@ -375,6 +391,10 @@ struct HunkTable : public SegmentObjTable<Hunk> {
 	void freeAtAddress(SegManager *segMan, reg_t sub_addr) override {
 		freeEntry(sub_addr.getOffset());
 	}
+	uint getAllocatedSize(reg_t sub_addr) const override {
+		const Hunk &hunk = at(sub_addr.getOffset());
+		return hunk.mem ? hunk.size : 0;
+	}
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
 };
@@ -906,6 +926,9 @@ struct ArrayTable : public SegmentObjTable<SciArray> {
 	ArrayTable() : SegmentObjTable<SciArray>(SEG_TYPE_ARRAY) {}
 
 	Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const override;
+	uint getAllocatedSize(reg_t sub_addr) const override {
+		return at(sub_addr.getOffset()).byteSize();
+	}
 
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
 	SegmentRef dereference(reg_t pointer) override;
@@ -1190,6 +1213,10 @@ public:
 struct BitmapTable : public SegmentObjTable<SciBitmap> {
 	BitmapTable() : SegmentObjTable<SciBitmap>(SEG_TYPE_BITMAP) {}
 
+	uint getAllocatedSize(reg_t sub_addr) const override {
+		return at(sub_addr.getOffset()).getRawSize();
+	}
+
 	SegmentRef dereference(reg_t pointer) override {
 		SegmentRef ret;
 		ret.isRaw = true;
@@ -285,6 +285,7 @@ void writeSelector(SegManager *segMan, reg_t object, Selector selectorId, reg_t
 	}
 
 	*address.getPointer(segMan) = value;
+	segMan->gcWriteBarrier(value);
 #ifdef ENABLE_SCI32
 	updateInfoFlagViewVisible(segMan->getObject(object), address.varindex);
 #endif
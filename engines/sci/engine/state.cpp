@@ -24,8 +24,10 @@
 #include "sci/debug.h"	// for g_debug_sleeptime_factor
 #include "sci/engine/features.h"
 #include "sci/engine/file.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/guest_additions.h"
 #include "sci/engine/kernel.h"
+#include "sci/engine/kpathing.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
 #include "sci/engine/vm.h"
@@ -69,13 +71,19 @@ static const uint16 s_halfWidthSJISMap[256] = {
 EngineState::EngineState(SegManager *segMan) :
 	_segMan(segMan),
 	_msgState(nullptr),
-	_dirseeker() {
+	_dirseeker(),
+	incrementalGC(false),
+	predecodeScripts(false),
+	_gc(new GarbageCollector()),
+	_avoidPathCache(new AvoidPathCache()) {
 
 	reset(false);
 }
 
 EngineState::~EngineState() {
 	delete _msgState;
+	delete _gc;
+	delete _avoidPathCache;
 }
 
 void EngineState::reset(bool isRestoring) {
@@ -104,6 +112,7 @@ void EngineState::reset(bool isRestoring) {
 	lastWaitTime = 0;
 
 	gcCountDown = 0;
+	_gc->cancel(_segMan);
 
 	_eventCounter = 0;
 	_paletteSetIntensityCounter = 0;
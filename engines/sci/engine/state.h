@@ -44,7 +44,9 @@ namespace Sci {
 
 class FileHandle;
 class DirSeeker;
+class AvoidPathCache;
 class EventManager;
+class GarbageCollector;
 class MessageState;
 class SoundCommandParser;
 class VirtualIndexFile;
@@ -188,6 +190,11 @@ struct EngineState : public Common::Serializable {
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	bool incrementalGC; /**< Whether gcs are spread over several kernel calls */
+	bool predecodeScripts; /**< Whether run_vm() keeps the decoded instructions of the scripts */
+	GarbageCollector *_gc;
+
+	AvoidPathCache *_avoidPathCache; /**< Visibility graphs of the kAvoidPath polygons */
 
 	MessageState *_msgState;
 	void initMessageState();
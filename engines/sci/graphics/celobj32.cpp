@@ -88,9 +88,13 @@ bool CelObj::_drawBlackLines = false;
 void CelObj::init() {
 	CelObj::deinit();
 	_drawBlackLines = false;
-	_nextCacheId = 1;
 	_scaler = new CelScaler();
-	_cache = new CelCache(100);
+
+	uint cacheSize = kDefaultCacheSize;
+	if (ConfMan.hasKey("cel_cache_size")) {
+		cacheSize = CLIP<int>(ConfMan.getInt("cel_cache_size"), 1, kMaxCacheSize);
+	}
+	_cache = new CelCache(cacheSize);
 }
 
 void CelObj::deinit() {
@@ -698,45 +702,78 @@ void CelObj::submitPalette() const {
 #pragma mark -
 #pragma mark CelObj - Caching
 
-int CelObj::_nextCacheId = 1;
 CelCache *CelObj::_cache = nullptr;
 
-int CelObj::searchCache(const CelInfo32 &celInfo, int *const nextInsertIndex) const {
-	*nextInsertIndex = -1;
-	int oldestId = _nextCacheId + 1;
-	int oldestIndex = 0;
+CelCache::CelCache(const uint maxSize) :
+	_maxSize(maxSize) {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
 
-	for (int i = 0, len = _cache->size(); i < len; ++i) {
-		CelCacheEntry &entry = (*_cache)[i];
+CelCache::~CelCache() {
+	clear();
+}
 
-		if (entry.celObj == nullptr) {
-			if (*nextInsertIndex == -1) {
-				*nextInsertIndex = i;
-			}
-		} else if (entry.celObj->_info == celInfo) {
-			entry.id = ++_nextCacheId;
-			return i;
-		} else if (oldestId > entry.id) {
-			oldestId = entry.id;
-			oldestIndex = i;
-		}
+const CelObj *CelCache::find(const CelInfo32 &celInfo) {
+	EntryMap::iterator it = _entries.find(celInfo);
+	if (it == _entries.end()) {
+		++_stats.misses;
+		return nullptr;
+	}
+
+	++_stats.hits;
+	Entry &entry = it->_value;
+	if (entry.lruPosition != _lru.begin()) {
+		_lru.erase(entry.lruPosition);
+		_lru.push_front(celInfo);
+		entry.lruPosition = _lru.begin();
 	}
+	return entry.celObj;
+}
 
-	if (*nextInsertIndex == -1) {
-		*nextInsertIndex = oldestIndex;
+void CelCache::insert(const CelObj &celObj) {
+	EntryMap::iterator it = _entries.find(celObj._info);
+	if (it != _entries.end()) {
+		delete it->_value.celObj;
+		_lru.erase(it->_value.lruPosition);
+		_entries.erase(it);
 	}
 
-	return -1;
+	_lru.push_front(celObj._info);
+
+	Entry &entry = _entries[celObj._info];
+	entry.celObj = celObj.duplicate();
+	entry.lruPosition = _lru.begin();
+
+	while (_entries.size() > _maxSize) {
+		evictOldest();
+	}
+}
+
+void CelCache::evictOldest() {
+	EntryMap::iterator it = _entries.find(_lru.back());
+	assert(it != _entries.end());
+	delete it->_value.celObj;
+	_entries.erase(it);
+	_lru.pop_back();
+	++_stats.evictions;
 }
 
-void CelObj::putCopyInCache(const int cacheIndex) const {
-	if (cacheIndex == -1) {
-		error("Invalid cache index");
+void CelCache::clear() {
+	for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		delete it->_value.celObj;
 	}
+	_entries.clear();
+	_lru.clear();
+}
+
+const CelObj *CelObj::searchCache(const CelInfo32 &celInfo) const {
+	return _cache->find(celInfo);
+}
 
-	CelCacheEntry &entry = (*_cache)[cacheIndex];
-	entry.celObj.reset(duplicate());
-	entry.id = ++_nextCacheId;
+void CelObj::putCopyInCache() const {
+	_cache->insert(*this);
 }
 
 #pragma mark -
@@ -983,16 +1020,13 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 	_compressionType = kCelCompressionInvalid;
 	_transparent = true;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjView *const cachedCelObj = dynamic_cast<CelObjView *>(entry.celObj.get());
+	const CelObj *const cachedCel = searchCache(_info);
+	if (cachedCel != nullptr) {
+		const CelObjView *const cachedCelObj = dynamic_cast<const CelObjView *>(cachedCel);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjView in cache slot %d", cacheIndex);
+			error("Expected a CelObjView in cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1090,7 +1124,7 @@ CelObjView::CelObjView(const GuiResourceId viewId, const int16 loopNo, const int
 		_remap = analyzeForRemap();
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjView::analyzeUncompressedForRemap() const {
@@ -1191,16 +1225,13 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 	_transparent = true;
 	_remap = false;
 
-	int cacheInsertIndex;
-	const int cacheIndex = searchCache(_info, &cacheInsertIndex);
-	if (cacheIndex != -1) {
-		CelCacheEntry &entry = (*_cache)[cacheIndex];
-		const CelObjPic *const cachedCelObj = dynamic_cast<CelObjPic *>(entry.celObj.get());
+	const CelObj *const cachedCel = searchCache(_info);
+	if (cachedCel != nullptr) {
+		const CelObjPic *const cachedCelObj = dynamic_cast<const CelObjPic *>(cachedCel);
 		if (cachedCelObj == nullptr) {
-			error("Expected a CelObjPic in cache slot %d", cacheIndex);
+			error("Expected a CelObjPic in cache for %s", _info.toString().c_str());
 		}
 		*this = *cachedCelObj;
-		entry.id = ++_nextCacheId;
 		return;
 	}
 
@@ -1264,7 +1295,7 @@ CelObjPic::CelObjPic(const GuiResourceId picId, const int16 celNo) {
 		}
 	}
 
-	putCopyInCache(cacheInsertIndex);
+	putCopyInCache();
 }
 
 bool CelObjPic::analyzeUncompressedForSkip() const {
@@ -22,6 +22,8 @@
 #ifndef SCI_GRAPHICS_CELOBJ32_H
 #define SCI_GRAPHICS_CELOBJ32_H
 
+#include "common/hashmap.h"
+#include "common/list.h"
 #include "common/rational.h"
 #include "common/rect.h"
 #include "sci/resource/resource.h"
@@ -105,7 +107,7 @@ struct CelInfo32 {
 
 	// This is the equivalence criteria used by CelObj::searchCache in at least
 	// SSCI SQ6. Notably, it does not check the color field.
-	inline bool operator==(const CelInfo32 &other) {
+	inline bool operator==(const CelInfo32 &other) const {
 		return (
 			type == other.type &&
 			resourceId == other.resourceId &&
@@ -115,10 +117,18 @@ struct CelInfo32 {
 		);
 	}
 
-	inline bool operator!=(const CelInfo32 &other) {
+	inline bool operator!=(const CelInfo32 &other) const {
 		return !(*this == other);
 	}
 
+	/**
+	 * A hash of the fields compared by the equivalence criteria.
+	 */
+	inline uint hash() const {
+		return ((uint)type << 28) ^ ((uint)resourceId << 12) ^ ((uint)(uint16)loopNo << 6) ^ (uint)(uint16)celNo ^
+		       ((uint)bitmap.getSegment() << 16) ^ bitmap.getOffset();
+	}
+
 	inline Common::String toString() const {
 		switch (type) {
 		case kCelTypeView:
@@ -135,18 +145,80 @@ struct CelInfo32 {
 	}
 };
 
+struct CelInfo32Hash : public Common::UnaryFunction<CelInfo32, uint> {
+	uint operator()(const CelInfo32 &val) const { return val.hash(); }
+};
+
 class CelObj;
-struct CelCacheEntry {
+
+/**
+ * A cache of cel objects, indexed by their CelInfo32. The cached cel objects
+ * do not hold any pixels, so the cache holds many more of them than the 100
+ * entries of SSCI, which high resolution games go through quickly. The least
+ * recently used cels are evicted first.
+ */
+class CelCache {
+public:
+	struct Stats {
+		uint32 hits;
+		uint32 misses;
+		uint32 evictions;
+	};
+
+	CelCache(uint maxSize);
+	~CelCache();
+
 	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
+	 * Returns the cached cel object matching the given CelInfo32, or nullptr
+	 * if there is none. A found cel becomes the most recently used one.
 	 */
-	int id;
-	Common::ScopedPtr<CelObj> celObj;
-	CelCacheEntry() : id(0) {}
-};
+	const CelObj *find(const CelInfo32 &celInfo);
+
+	/**
+	 * Puts a copy of the given cel object into the cache, evicting the least
+	 * recently used cel if the cache is full.
+	 */
+	void insert(const CelObj &celObj);
 
-typedef Common::Array<CelCacheEntry> CelCache;
+	/**
+	 * Removes all the cels from the cache.
+	 */
+	void clear();
+
+	uint size() const { return _entries.size(); }
+	uint getMaxSize() const { return _maxSize; }
+	const Stats &getStats() const { return _stats; }
+
+private:
+	typedef Common::List<CelInfo32> LRUList;
+
+	struct Entry {
+		CelObj *celObj;
+		/** The position of the cel in the LRU list. */
+		LRUList::iterator lruPosition;
+	};
+
+	typedef Common::HashMap<CelInfo32, Entry, CelInfo32Hash> EntryMap;
+
+	void evictOldest();
+
+	/**
+	 * The cached cels.
+	 */
+	EntryMap _entries;
+
+	/**
+	 * The cached cels, from the most to the least recently used one.
+	 */
+	LRUList _lru;
+
+	/**
+	 * The maximum number of cached cels.
+	 */
+	uint _maxSize;
+
+	Stats _stats;
+};
 
 #pragma mark -
 #pragma mark CelScaler
@@ -449,13 +521,20 @@ private:
 
 #pragma mark -
 #pragma mark CelObj - Caching
-protected:
+public:
 	/**
-	 * A monotonically increasing cache ID used to identify the least recently
-	 * used item in the cache for replacement.
+	 * The default maximum number of cached cels. The `cel_cache_size` config
+	 * key overrides it, up to kMaxCacheSize.
 	 */
-	static int _nextCacheId;
+	static const uint kDefaultCacheSize = 4096;
+	static const uint kMaxCacheSize = 65536;
 
+	/**
+	 * Returns the cache of cel objects, for the debugger.
+	 */
+	static const CelCache *getCache() { return _cache; }
+
+protected:
 	/**
 	 * A cache of cel objects used to avoid reinitialisation overhead for cels
 	 * with the same CelInfo32.
@@ -464,16 +543,14 @@ protected:
 
 	/**
 	 * Searches the cel cache for a CelObj matching the provided CelInfo32. If
-	 * not found, -1 is returned. `nextInsertIndex` will receive the index of
-	 * the oldest item in the cache, which can be used to replace the oldest
-	 * item with a newer item.
+	 * not found, nullptr is returned.
 	 */
-	int searchCache(const CelInfo32 &celInfo, int *nextInsertIndex) const;
+	const CelObj *searchCache(const CelInfo32 &celInfo) const;
 
 	/**
-	 * Puts a copy of this CelObj into the cache at the given cache index.
+	 * Puts a copy of this CelObj into the cache.
 	 */
-	void putCopyInCache(int index) const;
+	void putCopyInCache() const;
 };
 
 #pragma mark -
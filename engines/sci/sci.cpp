@@ -569,6 +569,8 @@ bool SciEngine::initGame() {
 
 	_gamestate->initMessageState();
 	_gamestate->gcCountDown = GC_INTERVAL - 1;
+	_gamestate->incrementalGC = ConfMan.hasKey("incremental_gc") && ConfMan.getBool("incremental_gc");
+	_gamestate->predecodeScripts = ConfMan.hasKey("predecode_scripts") && ConfMan.getBool("predecode_scripts");
 
 	// Script 0 should always be at segment 1
 	if (script0Segment != 1) {
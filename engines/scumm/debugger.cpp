@@ -80,6 +80,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	registerCmd("matrix",    WRAP_METHOD(ScummDebugger, Cmd_PrintBoxMatrix));
 	registerCmd("camera",    WRAP_METHOD(ScummDebugger, Cmd_Camera));
 	registerCmd("room",      WRAP_METHOD(ScummDebugger, Cmd_Room));
+	registerCmd("stripcache", WRAP_METHOD(ScummDebugger, Cmd_StripCache));
 	registerCmd("objects",   WRAP_METHOD(ScummDebugger, Cmd_PrintObjects));
 	registerCmd("object",    WRAP_METHOD(ScummDebugger, Cmd_Object));
 	registerCmd("script",    WRAP_METHOD(ScummDebugger, Cmd_Script));
@@ -379,6 +380,14 @@ bool ScummDebugger::Cmd_Room(int argc, const char **argv) {
 	}
 }
 
+bool ScummDebugger::Cmd_StripCache(int argc, const char **argv) {
+	const Gdi::StripCacheStats &stats = _vm->_gdi->getStripCacheStats();
+
+	debugPrintf("Room strips: %u decoded, %u copied from the cache\n", stats.decoded, stats.cached);
+	debugPrintf("Cache size: %u of %u bytes\n", _vm->_gdi->getStripCacheSize(), Gdi::kStripCacheMaxSize);
+	return true;
+}
+
 bool ScummDebugger::Cmd_LoadGame(int argc, const char **argv) {
 	if (argc > 1) {
 		int slot = atoi(argv[1]);
@@ -216,22 +216,34 @@ Gdi::Gdi(ScummEngine *vm) : _vm(vm) {
 	_zbufferDisabled = false;
 	_objectMode = false;
 	_distaff = false;
+
+	_stripCache.room = nullptr;
+	_stripCache.height = 0;
+	_stripCache.numZBuffers = 0;
+	memset(_stripCache.roomPalette, 0, sizeof(_stripCache.roomPalette));
+	_stripCache.size = 0;
+	_stripCacheEnabled = true;
+	memset(&_stripCacheStats, 0, sizeof(_stripCacheStats));
 }
 
 Gdi::~Gdi() {
+	clearStripCache();
 }
 
 GdiHE::GdiHE(ScummEngine *vm) : Gdi(vm), _tmskPtr(nullptr) {
+	_stripCacheEnabled = false;
 }
 
 
 GdiNES::GdiNES(ScummEngine *vm) : Gdi(vm) {
 	memset(&_NES, 0, sizeof(_NES));
+	_stripCacheEnabled = false;
 }
 
 #ifdef USE_RGB_COLOR
 GdiPCEngine::GdiPCEngine(ScummEngine *vm) : Gdi(vm) {
 	memset(&_PCE, 0, sizeof(_PCE));
+	_stripCacheEnabled = false;
 }
 
 GdiPCEngine::~GdiPCEngine() {
@@ -243,6 +255,7 @@ GdiPCEngine::~GdiPCEngine() {
 
 GdiV1::GdiV1(ScummEngine *vm) : Gdi(vm) {
 	memset(&_V1, 0, sizeof(_V1));
+	_stripCacheEnabled = false;
 }
 
 void GdiV1::setRenderModeColorMap(const byte *map) {
@@ -256,6 +269,7 @@ byte GdiV1::remapColorToRenderMode(byte col) const {
 
 GdiV2::GdiV2(ScummEngine *vm) : Gdi(vm) {
 	_roomStrips = nullptr;
+	_stripCacheEnabled = false;
 }
 
 GdiV2::~GdiV2() {
@@ -285,6 +299,7 @@ void Gdi::init() {
 }
 
 void Gdi::roomChanged(byte *roomptr) {
+	clearStripCache();
 }
 
 void GdiNES::roomChanged(byte *roomptr) {
@@ -1172,7 +1187,7 @@ void ScummEngine::redrawBGStrip(int start, int num) {
 	else
 		room = getResourceAddress(rtRoom, _roomResource);
 
-	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, 0);
+	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, Gdi::dbRoomBackground);
 }
 
 void ScummEngine::restoreBackground(Common::Rect rect, byte backColor) {
@@ -2345,6 +2360,11 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	_objectMode = (flag & dbObjectMode) == dbObjectMode;
 	prepareDrawBitmap(ptr, vs, x, y, width, height, stripnr, numstrip);
 
+	// The strips of the room image are decoded once, and copied afterwards
+	const bool useStripCache = _stripCacheEnabled && (flag & dbRoomBackground) && vs->format.bytesPerPixel == 1;
+	if (useStripCache)
+		prepareStripCache(ptr, height, numzbuf);
+
 	sx = x - vs->xstart / 8;
 	if (sx < 0) {
 		numstrip -= -sx;
@@ -2377,7 +2397,22 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 		else
 			dstPtr = (byte *)vs->getBasePtr(x * 8, y);
 
-		transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+		const byte *cachedStrip = nullptr;
+		if (useStripCache && stripnr < (int)_stripCache.strips.size())
+			cachedStrip = _stripCache.strips[stripnr];
+
+		if (cachedStrip) {
+			loadCachedStrip(cachedStrip, dstPtr, vs->pitch, x, y, height, numzbuf, zplane_list);
+			_stripCacheStats.cached++;
+			transpStrip = false;
+		} else {
+			transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+			if (useStripCache)
+				_stripCacheStats.decoded++;
+		}
+
+		// Transparent strips keep the pixels below them, so they are not cached
+		const bool storeStrip = useStripCache && !cachedStrip && !transpStrip;
 
 		// COMI and HE games only uses flag value
 		if (_vm->_game.version == 8 || _vm->_game.heversion >= 60)
@@ -2391,7 +2426,11 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 				clear8Col(frontBuf, vs->pitch, height, vs->format.bytesPerPixel);
 		}
 
-		decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
+		if (!cachedStrip)
+			decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
+
+		if (storeStrip)
+			storeCachedStrip(stripnr, dstPtr, vs->pitch, x, y, height, numzbuf, zplane_list);
 
 #if 0
 		// HACK: blit mask(s) onto normal screen. Useful to debug masking
@@ -2419,6 +2458,82 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	}
 }
 
+void Gdi::clearStripCache() {
+	for (uint i = 0; i < _stripCache.strips.size(); i++)
+		free(_stripCache.strips[i]);
+	_stripCache.strips.clear();
+	_stripCache.room = nullptr;
+	_stripCache.size = 0;
+}
+
+/**
+ * Makes sure that the cached strips were decoded from the given room image,
+ * with the same height, z-planes and room palette map. Otherwise drops them.
+ */
+void Gdi::prepareStripCache(const byte *room, int height, int numzbuf) {
+	if (_stripCache.room == room && _stripCache.height == height && _stripCache.numZBuffers == numzbuf &&
+		!memcmp(_stripCache.roomPalette, _vm->_roomPalette, sizeof(_stripCache.roomPalette)))
+		return;
+
+	clearStripCache();
+	_stripCache.room = room;
+	_stripCache.height = height;
+	_stripCache.numZBuffers = numzbuf;
+	memcpy(_stripCache.roomPalette, _vm->_roomPalette, sizeof(_stripCache.roomPalette));
+}
+
+void Gdi::loadCachedStrip(const byte *cachedStrip, byte *dstPtr, int dstPitch, int x, int y, int height,
+						  int numzbuf, const byte *zplane_list[9]) {
+	for (int h = 0; h < height; h++) {
+		memcpy(dstPtr, cachedStrip, 8);
+		dstPtr += dstPitch;
+		cachedStrip += 8;
+	}
+
+	for (int i = 1; i < numzbuf; i++) {
+		if (!zplane_list[i])
+			continue;
+
+		byte *mask_ptr = getMaskBuffer(x, y, i);
+		const byte *cachedMask = cachedStrip + (i - 1) * height;
+		for (int h = 0; h < height; h++)
+			mask_ptr[h * _numStrips] = cachedMask[h];
+	}
+}
+
+void Gdi::storeCachedStrip(int stripnr, const byte *dstPtr, int dstPitch, int x, int y, int height,
+						   int numzbuf, const byte *zplane_list[9]) {
+	const uint32 size = height * 8 + MAX(numzbuf - 1, 0) * height;
+	if (_stripCache.size + size > kStripCacheMaxSize)
+		return;
+
+	byte *cachedStrip = (byte *)malloc(size);
+	if (!cachedStrip)
+		return;
+
+	if (stripnr >= (int)_stripCache.strips.size())
+		_stripCache.strips.resize(stripnr + 1, nullptr);
+	assert(!_stripCache.strips[stripnr]);
+	_stripCache.strips[stripnr] = cachedStrip;
+	_stripCache.size += size;
+
+	for (int h = 0; h < height; h++) {
+		memcpy(cachedStrip, dstPtr, 8);
+		dstPtr += dstPitch;
+		cachedStrip += 8;
+	}
+
+	for (int i = 1; i < numzbuf; i++) {
+		if (!zplane_list[i])
+			continue;
+
+		const byte *mask_ptr = getMaskBuffer(x, y, i);
+		byte *cachedMask = cachedStrip + (i - 1) * height;
+		for (int h = 0; h < height; h++)
+			cachedMask[h] = mask_ptr[h * _numStrips];
+	}
+}
+
 bool Gdi::drawStrip(byte *dstPtr, VirtScreen *vs, int x, int y, const int width, const int height,
 					int stripnr, const byte *smap_ptr) {
 	// Do some input verification and make sure the strip/strip offset
@@ -23,6 +23,7 @@
 #define SCUMM_GFX_H
 
 #include "common/system.h"
+#include "common/array.h"
 #include "common/list.h"
 
 #include "graphics/surface.h"
@@ -304,6 +305,36 @@ protected:
 	/** Flag which is true when an object is being rendered, false otherwise. */
 	bool _objectMode;
 
+	/**
+	 * The room background strips and their z-plane masks, as decoded by
+	 * drawBitmap(). The room image does not change while the room is
+	 * loaded, so scrolling and redrawing copy them instead of decoding the
+	 * strips again.
+	 */
+	struct RoomStripCache {
+		const byte *room;             /**< Room image the strips were decoded from */
+		int height;
+		int numZBuffers;
+		byte roomPalette[256];        /**< Room palette map the strips were decoded with */
+		Common::Array<byte *> strips; /**< Pixels and masks of each strip, or null */
+		uint32 size;                  /**< Memory used by the strips, in bytes */
+	} _stripCache;
+
+	/** False for the renderers which do not decode the room strips in drawStrip() and decodeMask(). */
+	bool _stripCacheEnabled;
+
+public:
+	/** Maximum memory used by the decoded room strips, in bytes. */
+	static const uint32 kStripCacheMaxSize = 1024 * 1024;
+
+	struct StripCacheStats {
+		uint32 decoded;  /**< Room strips decoded */
+		uint32 cached;   /**< Room strips copied from the cache */
+	};
+
+protected:
+	StripCacheStats _stripCacheStats;
+
 public:
 	/** Flag which is true when loading objects or titles for distaff, in PCEngine version of Loom. */
 	bool _distaff;
@@ -339,6 +370,13 @@ protected:
 	/* Misc */
 	int getZPlanes(const byte *smap_ptr, const byte *zplane_list[9], bool bmapImage) const;
 
+	/* Room strip cache */
+	void prepareStripCache(const byte *room, int height, int numzbuf);
+	void loadCachedStrip(const byte *cachedStrip, byte *dstPtr, int dstPitch, int x, int y, int height,
+	                     int numzbuf, const byte *zplane_list[9]);
+	void storeCachedStrip(int stripnr, const byte *dstPtr, int dstPitch, int x, int y, int height,
+	                      int numzbuf, const byte *zplane_list[9]);
+
 	virtual bool drawStrip(byte *dstPtr, VirtScreen *vs,
 					int x, int y, const int width, const int height,
 					int stripnr, const byte *smap_ptr);
@@ -377,10 +415,16 @@ public:
 
 	void resetBackground(int top, int bottom, int strip);
 
+	/** Drops the decoded room strips. */
+	void clearStripCache();
+	const StripCacheStats &getStripCacheStats() const { return _stripCacheStats; }
+	uint32 getStripCacheSize() const { return _stripCache.size; }
+
 	enum DrawBitmapFlags {
-		dbAllowMaskOr   = 1 << 0,
-		dbDrawMaskOnAll = 1 << 1,
-		dbObjectMode    = 2 << 2
+		dbAllowMaskOr    = 1 << 0,
+		dbDrawMaskOnAll  = 1 << 1,
+		dbObjectMode     = 2 << 2,
+		dbRoomBackground = 1 << 4  /**< The room image is drawn, its strips may be cached */
 	};
 };
 
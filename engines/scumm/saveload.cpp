@@ -844,6 +844,7 @@ bool ScummEngine::loadState(int slot, bool compat, Common::String &filename) {
 
 	// Load the static room data
 	setupRoomSubBlocks();
+	_gdi->clearStripCache();
 
 	if (_game.version < 7) {
 		camera._last.x = camera._cur.x;
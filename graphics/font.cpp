@@ -105,6 +105,24 @@ int getStringWidthImpl(const Font &font, const StringType &str) {
 	return space;
 }
 
+template<class StringType>
+bool drawTextLineImpl(const Font &font, Surface *dst, const StringType &str, int x, int y, int leftX, int rightX, uint32 color) {
+	Common::Rect bbox;
+	return font.drawTextLine(dst, str, x, y, leftX, rightX, color, nullptr, bbox);
+}
+
+template<class StringType>
+bool drawTextLineImpl(const Font &font, ManagedSurface *dst, const StringType &str, int x, int y, int leftX, int rightX, uint32 color) {
+	const uint32 transColor = dst->getTransparentColor();
+	Common::Rect bbox;
+	if (!font.drawTextLine(dst->surfacePtr(), str, x, y, leftX, rightX, color, dst->hasTransparentColor() ? &transColor : nullptr, bbox))
+		return false;
+
+	if (!bbox.isEmpty())
+		dst->addDirtyRect(bbox);
+	return true;
+}
+
 template<class SurfaceType, class StringType>
 void drawStringImpl(const Font &font, SurfaceType *dst, const StringType &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) {
 	// The logic in getBoundingImpl is the same as we use here. In case we
@@ -120,6 +138,9 @@ void drawStringImpl(const Font &font, SurfaceType *dst, const StringType &str, i
 		x = x + w - width;
 	x += deltax;
 
+	if (drawTextLineImpl(font, dst, str, x, y, leftX, rightX, color))
+		return;
+
 	typename StringType::unsigned_type last = 0;
 	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
 		const typename StringType::unsigned_type cur = *i;
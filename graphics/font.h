@@ -236,6 +236,31 @@ public:
 	/** @overload */
 	void drawString(ManagedSurface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align = kTextAlignLeft, int deltax = 0, bool useEllipsis = false) const;
 
+	/**
+	 * Draw a line of text in one go. This is used by drawString, after the
+	 * line has been shortened and aligned. Fonts which can draw a whole line
+	 * faster than char by char override this, the default implementation
+	 * returns false to let drawString draw the chars one by one.
+	 *
+	 * Like drawString, only the chars ending between @p leftX and @p rightX
+	 * are drawn.
+	 *
+	 * @param dst     The surface on which to draw the line.
+	 * @param str     The line to draw.
+	 * @param x       The x position of the first char.
+	 * @param y       The y position of the line.
+	 * @param leftX   The left end of the text area.
+	 * @param rightX  The right end of the text area.
+	 * @param color   The color with which to draw the line.
+	 * @param transparentColor  The transparent color of @p dst, if it has one.
+	 * @param bbox    Set to the area which was drawn.
+	 *
+	 * @return Whether the line was drawn.
+	 */
+	virtual bool drawTextLine(Surface *dst, const Common::String &str, int x, int y, int leftX, int rightX, uint32 color, const uint32 *transparentColor, Common::Rect &bbox) const { return false; }
+	/** @overload */
+	virtual bool drawTextLine(Surface *dst, const Common::U32String &str, int x, int y, int leftX, int rightX, uint32 color, const uint32 *transparentColor, Common::Rect &bbox) const { return false; }
+
 	/**
 	 * Compute and return the width of the string @p str when rendered using this font.
 	 *
@@ -38,6 +38,8 @@
 #include "common/stream.h"
 #include "common/memstream.h"
 #include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/list.h"
 #include "common/ptr.h"
 #include "common/compression/unzip.h"
 
@@ -177,6 +179,9 @@ public:
 	void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const override;
 	void drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const override;
 
+	bool drawTextLine(Surface *dst, const Common::String &str, int x, int y, int leftX, int rightX, uint32 color, const uint32 *transparentColor, Common::Rect &bbox) const override;
+	bool drawTextLine(Surface *dst, const Common::U32String &str, int x, int y, int leftX, int rightX, uint32 color, const uint32 *transparentColor, Common::Rect &bbox) const override;
+
 private:
 	bool _initialized;
 	FT_StreamRec_ _stream;
@@ -201,6 +206,68 @@ private:
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
+	/**
+	 * The glyph images are packed into pages of an atlas, row by row, so
+	 * that the glyphs of a line are close to each other in memory.
+	 */
+	enum {
+		kAtlasPageSize = 256
+	};
+
+	mutable Common::Array<Surface *> _atlasPages;
+	mutable Surface *_atlasPage;
+	mutable int _atlasX, _atlasY, _atlasRowHeight;
+	Surface allocateGlyphImage(int w, int h) const;
+
+	/**
+	 * Recently drawn lines are kept as an alpha mask of all their glyphs,
+	 * so that drawing them again is a single blit.
+	 */
+	enum {
+		kLineCacheMemory = 256 * 1024
+	};
+
+	struct LineKey {
+		Common::U32String text;
+		int leftX, rightX;
+
+		bool operator==(const LineKey &other) const {
+			return leftX == other.leftX && rightX == other.rightX && text == other.text;
+		}
+	};
+
+	struct LineKeyHash {
+		uint operator()(const LineKey &key) const {
+			return Common::Hash<Common::U32String>()(key.text) ^ (key.leftX * 31 + key.rightX) * 0x9E3779B1;
+		}
+	};
+
+	typedef Common::List<LineKey> LineList;
+
+	struct Line {
+		Surface mask;
+		int xOffset, yOffset;
+		LineList::iterator lru;
+	};
+
+	/**
+	 * Memory charged to the cache for a line. Every entry costs at least its
+	 * key and bookkeeping, so lines with an empty mask are limited as well.
+	 */
+	static uint32 lineMemory(const LineKey &key, const Line &line) {
+		return line.mask.w * line.mask.h + key.text.size() * sizeof(Common::u32char_type_t) + sizeof(LineKey) + sizeof(Line);
+	}
+
+	typedef Common::HashMap<LineKey, Line, LineKeyHash> LineCache;
+	mutable LineCache _lines;
+	mutable LineList _lineOrder;
+	mutable uint32 _lineCacheMemory;
+
+	template<class StringType>
+	bool drawTextLineImpl(Surface *dst, const StringType &str, int x, int y, int leftX, int rightX, uint32 color, const uint32 *transparentColor, Common::Rect &bbox) const;
+	void renderLine(Line &line, const Common::U32String &text, int leftX, int rightX) const;
+	void drawMask(Surface *dst, const Surface &mask, int x, int y, uint32 color, const uint32 *transparentColor) const;
+
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
@@ -221,7 +288,8 @@ TTFFont::TTFFont()
 	: _initialized(false), _stream(), _face(), _ttfFile(0), _width(0), _height(0), _ascent(0),
 	  _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
 	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false),
-	  _disposeAfterUse(DisposeAfterUse::NO) {
+	  _disposeAfterUse(DisposeAfterUse::NO), _atlasPage(nullptr), _atlasX(0), _atlasY(0),
+	  _atlasRowHeight(0), _lineCacheMemory(0) {
 }
 
 TTFFont::~TTFFont() {
@@ -232,11 +300,17 @@ TTFFont::~TTFFont() {
 			delete _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	for (LineCache::iterator i = _lines.begin(), end = _lines.end(); i != end; ++i)
+		i->_value.mask.free();
+
+	// The glyph images point into the atlas pages
+	for (uint i = 0; i < _atlasPages.size(); i++) {
+		_atlasPages[i]->free();
+		delete _atlasPages[i];
+	}
 }
 
 
@@ -622,6 +696,20 @@ static void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
 					dstFormat.colorToARGB(*rDst, dA, dR, dG, dB);
 				}
 
+				if (dA == 255) {
+					// Most text is drawn on opaque pixels, which does not
+					// need the floating point math below
+					const uint invA = 255 - sA;
+					dR = (sR * sA + dR * invA) / 255;
+					dG = (sG * sA + dG * invA) / 255;
+					dB = (sB * sA + dB * invA) / 255;
+					*rDst = dstFormat.ARGBToColor(255, dR, dG, dB);
+
+					++rDst;
+					++src;
+					continue;
+				}
+
 				double sAn = (double)sA / 255.0;
 				double dAn = (double)dA / 255.0;
 				double oAn = sAn + dAn * (1.0 - sAn);
@@ -643,6 +731,54 @@ static void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
 	}
 }
 
+/**
+ * renderGlyph for 32 bit formats with 8 bits per channel. It blends all
+ * channels of a pixel at once, two at a time in 16 bit lanes.
+ */
+static void renderGlyph32(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
+		const int srcPitch, const int w, const int h, uint32 color,
+		const PixelFormat &dstFormat, const uint32 *transparentColor) {
+	const uint32 alphaMask = dstFormat.aBits() ? 0xFF << dstFormat.aShift : 0;
+	const uint32 colorMask = (0xFF << dstFormat.rShift) | (0xFF << dstFormat.gShift) | (0xFF << dstFormat.bShift) | alphaMask;
+	const uint32 srcRB = color & 0xFF00FF;
+	const uint32 srcAG = (color >> 8) & 0xFF00FF;
+
+	for (int y = 0; y < h; ++y) {
+		uint32 *rDst = (uint32 *)dstPos;
+
+		for (int x = 0; x < w; ++x) {
+			const uint sA = srcPos[x];
+			if (sA == 255) {
+				rDst[x] = color;
+			} else if (sA) {
+				const uint32 d = rDst[x];
+				if ((d & alphaMask) != alphaMask || (transparentColor && d == *transparentColor)) {
+					renderGlyph<uint32>((uint8 *)&rDst[x], dstPitch, &srcPos[x], srcPitch, 1, 1, color, dstFormat, transparentColor);
+					continue;
+				}
+
+				const uint invA = 255 - sA;
+				uint32 rb = srcRB * sA + (d & 0xFF00FF) * invA;
+				uint32 ag = srcAG * sA + ((d >> 8) & 0xFF00FF) * invA;
+
+				// Divide each lane by 255
+				rb = ((rb + ((rb >> 8) & 0xFF00FF) + 0x10001) >> 8) & 0xFF00FF;
+				ag = (ag + ((ag >> 8) & 0xFF00FF) + 0x10001) & 0xFF00FF00;
+				rDst[x] = ((rb | ag) & colorMask) | alphaMask;
+			}
+		}
+
+		dstPos += dstPitch;
+		srcPos += srcPitch;
+	}
+}
+
+static bool isRGBA8888Like(const PixelFormat &format) {
+	return format.bytesPerPixel == 4 && format.rLoss == 0 && format.gLoss == 0 && format.bLoss == 0 &&
+		(format.aLoss == 0 || format.aLoss == 8) && !(format.rShift & 7) && !(format.gShift & 7) &&
+		!(format.bShift & 7) && !(format.aShift & 7);
+}
+
 } // End of anonymous namespace
 
 void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
@@ -662,7 +798,7 @@ void TTFFont::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 col
 	dst->addDirtyRect(charBox);
 }
 
-void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
+void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color,
 		const uint32 *transparentColor) const {
 	assureCached(chr);
 	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
@@ -670,19 +806,20 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 		return;
 
 	const Glyph &glyph = glyphEntry->_value;
+	drawMask(dst, glyph.image, x + glyph.xOffset, y + glyph.yOffset, color, transparentColor);
+}
 
-	x += glyph.xOffset;
-	y += glyph.yOffset;
-
+void TTFFont::drawMask(Surface *dst, const Surface &mask, int x, int y, uint32 color,
+		const uint32 *transparentColor) const {
 	if (x > dst->w)
 		return;
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
+	int w = mask.w;
+	int h = mask.h;
 
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
+	const uint8 *srcPos = (const uint8 *)mask.getPixels();
 
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
@@ -698,7 +835,7 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * mask.pitch;
 		h += y;
 		y = 0;
 	}
@@ -727,15 +864,170 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += mask.pitch;
 		}
 	} else if (dst->format.bytesPerPixel == 1) {
-		renderGlyph<uint8>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint8>(dstPos, dst->pitch, srcPos, mask.pitch, w, h, color, dst->format, transparentColor);
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, mask.pitch, w, h, color, dst->format, transparentColor);
+	} else if (isRGBA8888Like(dst->format)) {
+		renderGlyph32(dstPos, dst->pitch, srcPos, mask.pitch, w, h, color, dst->format, transparentColor);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, mask.pitch, w, h, color, dst->format, transparentColor);
+	}
+}
+
+bool TTFFont::drawTextLine(Surface *dst, const Common::String &str, int x, int y, int leftX, int rightX, uint32 color,
+		const uint32 *transparentColor, Common::Rect &bbox) const {
+	return drawTextLineImpl(dst, str, x, y, leftX, rightX, color, transparentColor, bbox);
+}
+
+bool TTFFont::drawTextLine(Surface *dst, const Common::U32String &str, int x, int y, int leftX, int rightX, uint32 color,
+		const uint32 *transparentColor, Common::Rect &bbox) const {
+	return drawTextLineImpl(dst, str, x, y, leftX, rightX, color, transparentColor, bbox);
+}
+
+template<class StringType>
+bool TTFFont::drawTextLineImpl(Surface *dst, const StringType &str, int x, int y, int leftX, int rightX, uint32 color,
+		const uint32 *transparentColor, Common::Rect &bbox) const {
+	// Without anti-aliasing, overlapping glyphs can not be merged into one
+	// mask. Those are drawn char by char.
+	if (dst->format.bytesPerPixel == 1)
+		return false;
+
+	// Which chars are drawn only depends on the text area relative to the
+	// first char
+	LineKey key;
+	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i)
+		key.text += (typename StringType::unsigned_type)*i;
+	key.leftX = leftX - x;
+	key.rightX = rightX - x;
+
+	LineCache::iterator entry = _lines.find(key);
+	Line uncached;
+	const Line *line;
+	if (entry != _lines.end()) {
+		_lineOrder.erase(entry->_value.lru);
+		_lineOrder.push_front(key);
+		entry->_value.lru = _lineOrder.begin();
+		line = &entry->_value;
+	} else {
+		renderLine(uncached, key.text, key.leftX, key.rightX);
+		const uint32 size = lineMemory(key, uncached);
+
+		// Lines too big to share the cache with others are not kept
+		if (size <= kLineCacheMemory / 4) {
+			// Make room, least recently used first
+			while (_lineCacheMemory + size > kLineCacheMemory) {
+				LineCache::iterator oldest = _lines.find(_lineOrder.back());
+				_lineCacheMemory -= lineMemory(oldest->_key, oldest->_value);
+				oldest->_value.mask.free();
+				_lines.erase(oldest);
+				_lineOrder.pop_back();
+			}
+
+			_lineOrder.push_front(key);
+			uncached.lru = _lineOrder.begin();
+			_lineCacheMemory += size;
+			_lines[key] = uncached;
+			line = &_lines[key];
+		} else {
+			line = &uncached;
+		}
+	}
+
+	drawMask(dst, line->mask, x + line->xOffset, y + line->yOffset, color, transparentColor);
+	bbox = Common::Rect(line->xOffset, line->yOffset, line->xOffset + line->mask.w, line->yOffset + line->mask.h);
+	bbox.translate(x, y);
+
+	if (line == &uncached)
+		uncached.mask.free();
+	return true;
+}
+
+void TTFFont::renderLine(Line &line, const Common::U32String &text, int leftX, int rightX) const {
+	// The same layout as Font::drawString uses, with the first char at 0
+	Common::Array<const Glyph *> glyphs;
+	Common::Array<int> positions;
+	Common::Rect area;
+
+	int x = 0;
+	uint32 last = 0;
+	for (uint i = 0; i < text.size(); ++i) {
+		const uint32 cur = text[i];
+		x += getKerningOffset(last, cur);
+		last = cur;
+
+		Common::Rect charBox = getBoundingBox(cur);
+		if (x + charBox.right > rightX)
+			break;
+		if (x + charBox.right >= leftX && !charBox.isEmpty()) {
+			glyphs.push_back(&_glyphs.find(cur)->_value);
+			positions.push_back(x);
+			charBox.translate(x, 0);
+			if (area.isEmpty())
+				area = charBox;
+			else
+				area.extend(charBox);
+		}
+
+		x += getCharWidth(cur);
+	}
+
+	line.xOffset = area.left;
+	line.yOffset = area.top;
+	if (area.isEmpty())
+		return;
+
+	// Where glyphs overlap, the coverage adds up like drawing them one
+	// after the other would do
+	line.mask.create(area.width(), area.height(), PixelFormat::createFormatCLUT8());
+	for (uint i = 0; i < glyphs.size(); ++i) {
+		const Surface &image = glyphs[i]->image;
+		const int gx = positions[i] + glyphs[i]->xOffset - area.left;
+		const int gy = glyphs[i]->yOffset - area.top;
+
+		for (int cy = 0; cy < image.h; ++cy) {
+			const uint8 *src = (const uint8 *)image.getBasePtr(0, cy);
+			uint8 *dst = (uint8 *)line.mask.getBasePtr(gx, gy + cy);
+
+			for (int cx = 0; cx < image.w; ++cx) {
+				const uint a = dst[cx], b = src[cx];
+				dst[cx] = a + b - (a * b + 127) / 255;
+			}
+		}
+	}
+}
+
+Surface TTFFont::allocateGlyphImage(int w, int h) const {
+	if (w <= 0 || h <= 0)
+		return Surface();
+
+	// Glyphs too big for a page get one of their own
+	if (w > kAtlasPageSize || h > kAtlasPageSize) {
+		Surface *page = new Surface();
+		page->create(w, h, PixelFormat::createFormatCLUT8());
+		_atlasPages.push_back(page);
+		return *page;
+	}
+
+	if (_atlasX + w > kAtlasPageSize) {
+		_atlasX = 0;
+		_atlasY += _atlasRowHeight;
+		_atlasRowHeight = 0;
+	}
+
+	if (!_atlasPage || _atlasY + h > kAtlasPageSize) {
+		_atlasPage = new Surface();
+		_atlasPage->create(kAtlasPageSize, kAtlasPageSize, PixelFormat::createFormatCLUT8());
+		_atlasPages.push_back(_atlasPage);
+		_atlasX = _atlasY = _atlasRowHeight = 0;
 	}
+
+	Surface image = _atlasPage->getSubArea(Common::Rect(_atlasX, _atlasY, _atlasX + w, _atlasY + h));
+	_atlasX += w;
+	_atlasRowHeight = MAX(_atlasRowHeight, h);
+	return image;
 }
 
 bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
@@ -802,8 +1094,12 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		bitmap = &_face->glyph->bitmap;
 	}
 
+	if (bitmap->pixel_mode != FT_PIXEL_MODE_MONO && bitmap->pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
+		return false;
+	}
 
-	glyph.image.create(bitmap->width, bitmap->rows, PixelFormat::createFormatCLUT8());
+	glyph.image = allocateGlyphImage(bitmap->width, bitmap->rows);
 
 	const uint8 *src = bitmap->buffer;
 	int srcPitch = bitmap->pitch;
@@ -814,8 +1110,7 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 
 	uint8 *dst = (uint8 *)glyph.image.getPixels();
 
-	switch (bitmap->pixel_mode) {
-	case FT_PIXEL_MODE_MONO:
+	if (bitmap->pixel_mode == FT_PIXEL_MODE_MONO) {
 		for (int y = 0; y < (int)bitmap->rows; ++y) {
 			const uint8 *curSrc = src;
 			uint8 mask = 0;
@@ -825,28 +1120,20 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 					mask = *curSrc++;
 
 				if (mask & 0x80)
-					*dst = 255;
+					dst[x] = 255;
 
 				mask <<= 1;
-				++dst;
 			}
 
+			dst += glyph.image.pitch;
 			src += srcPitch;
 		}
-		break;
-
-	case FT_PIXEL_MODE_GRAY:
+	} else {
 		for (int y = 0; y < (int)bitmap->rows; ++y) {
 			memcpy(dst, src, bitmap->width);
 			dst += glyph.image.pitch;
 			src += srcPitch;
 		}
-		break;
-
-	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
-		glyph.image.free();
-		return false;
 	}
 
 #if FAKE_BOLD == 1
@@ -19,6 +19,7 @@
  */
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Graphics {
 
@@ -83,17 +84,30 @@ bool Palette::contains(const Palette& p) const {
 	return p._size <= _size && !memcmp(_data, p._data, p._size * 3);
 }
 
+static inline uint32 naiveDistance(const byte *color, byte cr, byte cg, byte cb) {
+	int r = color[0] - cr;
+	int g = color[1] - cg;
+	int b = color[2] - cb;
+
+	return 3 * r * r + 5 * g * g + 2 * b * b;
+}
+
+static inline uint32 weightedDistance(const byte *color, byte cr, byte cg, byte cb) {
+	int rmean = (color[0] + cr) / 2;
+	int r = color[0] - cr;
+	int g = color[1] - cg;
+	int b = color[2] - cb;
+
+	return (((512 + rmean) * r * r) >> 8) + 4 * g * g + (((767 - rmean) * b * b) >> 8);
+}
+
 byte Palette::findBestColor(byte cr, byte cg, byte cb, bool useNaiveAlg) const {
 	uint bestColor = 0;
 	uint32 min = 0xFFFFFFFF;
 
 	if (useNaiveAlg) {
 		for (uint i = 0; i < _size; i++) {
-			int r = _data[3 * i + 0] - cr;
-			int g = _data[3 * i + 1] - cg;
-			int b = _data[3 * i + 2] - cb;
-
-			uint32 distWeighted = 3 * r * r + 5 * g * g + 2 * b * b;
+			uint32 distWeighted = naiveDistance(_data + 3 * i, cr, cg, cb);
 			if (distWeighted < min) {
 				bestColor = i;
 				min = distWeighted;
@@ -101,12 +115,7 @@ byte Palette::findBestColor(byte cr, byte cg, byte cb, bool useNaiveAlg) const {
 		}
 	} else {
 		for (uint i = 0; i < _size; ++i) {
-			int rmean = (_data[3 * i + 0] + cr) / 2;
-			int r = _data[3 * i + 0] - cr;
-			int g = _data[3 * i + 1] - cg;
-			int b = _data[3 * i + 2] - cb;
-
-			uint32 distSquared = (((512 + rmean) * r * r) >> 8) + 4 * g * g + (((767 - rmean) * b * b) >> 8);
+			uint32 distSquared = weightedDistance(_data + 3 * i, cr, cg, cb);
 			if (distSquared < min) {
 				bestColor = i;
 				min = distSquared;
@@ -159,28 +168,141 @@ bool PaletteLookup::setPalette(const byte *palette, uint len)  {
 
 	_paletteSize = len;
 	_palette.set(palette, 0, len);
-	_colorHash.clear();
+	clearCells();
 
 	return true;
 }
 
+void PaletteLookup::clearCells() {
+	for (int i = 0; i < 2; i++) {
+		if (!_cells[i].empty())
+			memset(_cells[i].data(), 0xFF, kCellCount * sizeof(uint32));
+		_candidates[i].clear();
+	}
+}
+
+uint32 PaletteLookup::buildCell(uint cell, bool useNaiveAlg) {
+	const int cellSize = 1 << (8 - kCellBits);
+	const int mask = (1 << kCellBits) - 1;
+	const int first[3] = {
+		(int)((cell >> (2 * kCellBits)) & mask) * cellSize,
+		(int)((cell >> kCellBits) & mask) * cellSize,
+		(int)(cell & mask) * cellSize
+	};
+
+	// Both distances are sums of weighted squares of the component
+	// differences. For the weighted one, the red and blue weights depend on
+	// the colors, but are between 2 and 3.
+	static const uint32 minWeights[2][3] = { { 2, 4, 2 }, { 3, 5, 2 } };
+	static const uint32 maxWeights[2][3] = { { 3, 4, 3 }, { 3, 5, 2 } };
+
+	// Find the closest and the farthest any color in the cell can be from
+	// each palette entry
+	const uint size = _palette.size();
+	const byte *data = _palette.data();
+	uint32 minDist[PALETTE_COUNT], maxDist[PALETTE_COUNT];
+	uint32 bestMaxDist = 0xFFFFFFFF;
+	for (uint i = 0; i < size; i++) {
+		minDist[i] = maxDist[i] = 0;
+		for (int c = 0; c < 3; c++) {
+			int v = data[3 * i + c];
+			int below = first[c] - v;
+			int above = v - (first[c] + cellSize - 1);
+			uint32 nearest = MAX(0, MAX(below, above));
+			uint32 farthest = MAX(ABS(below), ABS(above));
+			minDist[i] += minWeights[useNaiveAlg][c] * nearest * nearest;
+			maxDist[i] += maxWeights[useNaiveAlg][c] * farthest * farthest;
+		}
+		bestMaxDist = MIN(bestMaxDist, maxDist[i]);
+	}
+
+	// Whatever entry is closer than all others to a color in the cell, it
+	// can't be farther than bestMaxDist. Entries which are always farther
+	// are skipped, the others are kept in order so that ties go the same
+	// way as with a full search.
+	Common::Array<byte> &candidates = _candidates[useNaiveAlg];
+	uint32 offset = candidates.size();
+	for (uint i = 0; i < size; i++) {
+		if (minDist[i] <= bestMaxDist)
+			candidates.push_back(i);
+	}
+
+	return ((candidates.size() - offset - 1) << 24) | offset;
+}
+
 byte PaletteLookup::findBestColor(byte cr, byte cg, byte cb, bool useNaiveAlg) {
 	if (_paletteSize == 0) {
 		warning("PaletteLookup::findBestColor(): Palette was not set");
 		return 0;
 	}
 
-	uint32 color = cr << 16 | cg << 8 | cb;
+	Common::Array<uint32> &cells = _cells[useNaiveAlg];
+	if (cells.empty())
+		cells.resize(kCellCount, kNoCell);
+
+	const int shift = 8 - kCellBits;
+	uint cell = ((cr >> shift) << (2 * kCellBits)) | ((cg >> shift) << kCellBits) | (cb >> shift);
+	if (cells[cell] == kNoCell)
+		cells[cell] = buildCell(cell, useNaiveAlg);
 
-	if (_colorHash.contains(color))
-		return _colorHash[color];
+	const byte *candidates = &_candidates[useNaiveAlg][cells[cell] & 0xFFFFFF];
+	uint count = (cells[cell] >> 24) + 1;
+	if (count == 1)
+		return candidates[0];
 
-	uint bestColor = _palette.findBestColor(cr, cg, cb, useNaiveAlg);
-	_colorHash[color] = bestColor;
+	const byte *data = _palette.data();
+	uint bestColor = candidates[0];
+	uint32 min = 0xFFFFFFFF;
+	for (uint i = 0; i < count; i++) {
+		uint32 dist = useNaiveAlg ? naiveDistance(data + 3 * candidates[i], cr, cg, cb) : weightedDistance(data + 3 * candidates[i], cr, cg, cb);
+		if (dist < min) {
+			bestColor = candidates[i];
+			min = dist;
+		}
+	}
 
 	return bestColor;
 }
 
+void PaletteLookup::mapSurface(const Surface &src, Surface &dst, bool useNaiveAlg) {
+	assert(dst.format.bytesPerPixel == 1 && dst.w >= src.w && dst.h >= src.h);
+
+	const PixelFormat &format = src.format;
+	for (int y = 0; y < src.h; y++) {
+		const byte *in = (const byte *)src.getBasePtr(0, y);
+		byte *out = (byte *)dst.getBasePtr(0, y);
+
+		// Neighboring pixels often have the same color
+		uint32 lastColor = 0;
+		byte lastIndex = 0;
+		for (int x = 0; x < src.w; x++) {
+			uint32 color;
+			switch (format.bytesPerPixel) {
+			case 2:
+				color = *(const uint16 *)in;
+				break;
+			case 3:
+				color = READ_UINT24(in);
+				break;
+			case 4:
+				color = *(const uint32 *)in;
+				break;
+			default:
+				error("PaletteLookup::mapSurface(): Unsupported pixel format %s", format.toString().c_str());
+			}
+			in += format.bytesPerPixel;
+
+			if (x == 0 || color != lastColor) {
+				byte r, g, b;
+				format.colorToRGB(color, r, g, b);
+				lastColor = color;
+				lastIndex = findBestColor(r, g, b, useNaiveAlg);
+			}
+			*out++ = lastIndex;
+		}
+	}
+}
+
 uint32 *PaletteLookup::createMap(const byte *srcPalette, uint len, bool useNaiveAlg) {
 	if (len <= _paletteSize && memcmp(_palette.data(), srcPalette, len * 3) == 0)
 		return nullptr;
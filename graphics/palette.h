@@ -22,10 +22,13 @@
 #ifndef GRAPHICS_PALETTE_H
 #define GRAPHICS_PALETTE_H
 
+#include "common/array.h"
 #include "common/hashmap.h"
 
 namespace Graphics {
 
+struct Surface;
+
 /**
  * Constants available for use in paletted code
  */
@@ -176,12 +179,29 @@ public:
 	 * @brief This method returns closest color from the palette
 	 *        and it uses cache for faster lookups
 	 *
+	 * The RGB color space is split into cells, each of which remembers
+	 * which palette entries can be the closest one to any color inside it.
+	 * The lists are built on first use of a cell, and thrown away when the
+	 * palette changes. Results are the same as those of
+	 * Palette::findBestColor().
+	 *
 	 * @param useNaiveAlg            if true, use a simpler algorithm
 	 *
 	 * @return the palette index
 	 */
 	byte findBestColor(byte r, byte g, byte b, bool useNaiveAlg = false);
 
+	/**
+	 * @brief Convert a whole true color surface to palette indices,
+	 *        using findBestColor() for each pixel.
+	 *
+	 * @param src           the true color surface
+	 * @param dst           the CLUT8 surface to store the indices into, of
+	 *                      at least the size of src
+	 * @param useNaiveAlg   if true, use a simpler algorithm
+	 */
+	void mapSurface(const Surface &src, Surface &dst, bool useNaiveAlg = false);
+
 	/**
 	 * @brief This method creates a map from the given palette
 	 *        that can be used by crossBlitMap().
@@ -195,9 +215,25 @@ public:
 	uint32 *createMap(const byte *srcPalette, uint len, bool useNaiveAlg = false);
 
 private:
+	enum {
+		kCellBits = 5,                         ///< Bits of each color component selecting a cell
+		kCellCount = 1 << (3 * kCellBits),
+		kNoCell = 0xFFFFFFFF
+	};
+
 	Palette _palette;
 	uint _paletteSize;
-	Common::HashMap<int, byte> _colorHash;
+
+	/**
+	 * For both algorithms, each cell is either kNoCell, or the number of
+	 * candidates minus one in the top 8 bits and the offset of the first
+	 * one in _candidates below.
+	 */
+	Common::Array<uint32> _cells[2];
+	Common::Array<byte> _candidates[2];
+
+	void clearCells();
+	uint32 buildCell(uint cell, bool useNaiveAlg);
 };
 
 } //  // end of namespace Graphics
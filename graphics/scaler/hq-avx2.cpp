@@ -0,0 +1,81 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/scaler/hq.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+/**
+ * Set the given flag in the lanes where the YUV values differ by more than
+ * the thresholds used by diffYUV().
+ */
+static FORCEINLINE __m256i diffFlag(__m256i yuv1, __m256i yuv2, uint32 flag) {
+	const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(yuv1, yuv2), _mm256_subs_epu8(yuv2, yuv1));
+	const __m256i over = _mm256_subs_epu8(diff, _mm256_set1_epi32(0x00300706));
+	return _mm256_andnot_si256(_mm256_cmpeq_epi32(over, _mm256_setzero_si256()), _mm256_set1_epi32(flag));
+}
+
+void HQScaler::classifyAVX2(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width) {
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const __m256i w1 = _mm256_loadu_si256((const __m256i *)(prev + x - 1));
+		const __m256i w2 = _mm256_loadu_si256((const __m256i *)(prev + x));
+		const __m256i w3 = _mm256_loadu_si256((const __m256i *)(prev + x + 1));
+		const __m256i w4 = _mm256_loadu_si256((const __m256i *)(cur + x - 1));
+		const __m256i w5 = _mm256_loadu_si256((const __m256i *)(cur + x));
+		const __m256i w6 = _mm256_loadu_si256((const __m256i *)(cur + x + 1));
+		const __m256i w7 = _mm256_loadu_si256((const __m256i *)(next + x - 1));
+		const __m256i w8 = _mm256_loadu_si256((const __m256i *)(next + x));
+		const __m256i w9 = _mm256_loadu_si256((const __m256i *)(next + x + 1));
+
+		__m256i f = diffFlag(w5, w1, 0x0001);
+		f = _mm256_or_si256(f, diffFlag(w5, w2, 0x0002));
+		f = _mm256_or_si256(f, diffFlag(w5, w3, 0x0004));
+		f = _mm256_or_si256(f, diffFlag(w5, w4, 0x0008));
+		f = _mm256_or_si256(f, diffFlag(w5, w6, 0x0010));
+		f = _mm256_or_si256(f, diffFlag(w5, w7, 0x0020));
+		f = _mm256_or_si256(f, diffFlag(w5, w8, 0x0040));
+		f = _mm256_or_si256(f, diffFlag(w5, w9, 0x0080));
+		f = _mm256_or_si256(f, diffFlag(w2, w6, kDiff26));
+		f = _mm256_or_si256(f, diffFlag(w6, w8, kDiff68));
+		f = _mm256_or_si256(f, diffFlag(w8, w4, kDiff84));
+		f = _mm256_or_si256(f, diffFlag(w4, w2, kDiff42));
+
+		_mm_storeu_si128((__m128i *)(flags + x), _mm_packs_epi32(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1)));
+	}
+
+	classifyGeneric(prev + x, cur + x, next + x, flags + x, width - x);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,93 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/scaler/hq.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+/**
+ * Set the given flag in the lanes where the YUV values differ by more than
+ * the thresholds used by diffYUV().
+ */
+static FORCEINLINE uint32x4_t diffFlag(uint32x4_t yuv1, uint32x4_t yuv2, uint32 flag) {
+	const uint8x16_t diff = vabdq_u8(vreinterpretq_u8_u32(yuv1), vreinterpretq_u8_u32(yuv2));
+	const uint32x4_t over = vreinterpretq_u32_u8(vcgtq_u8(diff, vreinterpretq_u8_u32(vdupq_n_u32(0x00300706))));
+	return vandq_u32(vtstq_u32(over, over), vdupq_n_u32(flag));
+}
+
+void HQScaler::classifyNEON(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width) {
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		const uint32x4_t w1 = vld1q_u32(prev + x - 1);
+		const uint32x4_t w2 = vld1q_u32(prev + x);
+		const uint32x4_t w3 = vld1q_u32(prev + x + 1);
+		const uint32x4_t w4 = vld1q_u32(cur + x - 1);
+		const uint32x4_t w5 = vld1q_u32(cur + x);
+		const uint32x4_t w6 = vld1q_u32(cur + x + 1);
+		const uint32x4_t w7 = vld1q_u32(next + x - 1);
+		const uint32x4_t w8 = vld1q_u32(next + x);
+		const uint32x4_t w9 = vld1q_u32(next + x + 1);
+
+		uint32x4_t f = diffFlag(w5, w1, 0x0001);
+		f = vorrq_u32(f, diffFlag(w5, w2, 0x0002));
+		f = vorrq_u32(f, diffFlag(w5, w3, 0x0004));
+		f = vorrq_u32(f, diffFlag(w5, w4, 0x0008));
+		f = vorrq_u32(f, diffFlag(w5, w6, 0x0010));
+		f = vorrq_u32(f, diffFlag(w5, w7, 0x0020));
+		f = vorrq_u32(f, diffFlag(w5, w8, 0x0040));
+		f = vorrq_u32(f, diffFlag(w5, w9, 0x0080));
+		f = vorrq_u32(f, diffFlag(w2, w6, kDiff26));
+		f = vorrq_u32(f, diffFlag(w6, w8, kDiff68));
+		f = vorrq_u32(f, diffFlag(w8, w4, kDiff84));
+		f = vorrq_u32(f, diffFlag(w4, w2, kDiff42));
+
+		vst1_u16(flags + x, vmovn_u32(f));
+	}
+
+	classifyGeneric(prev + x, cur + x, next + x, flags + x, width - x);
+}
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
@@ -21,6 +21,7 @@
 #include "graphics/scaler/hq.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
+#include "common/system.h"
 
 // RGB-to-YUV lookup table
 
@@ -173,8 +174,6 @@ void HQScaler::initLUT(Graphics::PixelFormat format) {
 #define PIXEL11_90	*(q+1+nextlineDst) = interpolate_2_3_3(w5, w6, w8);
 #define PIXEL11_100	*(q+1+nextlineDst) = interpolate_14_1_1(w5, w6, w8);
 
-#define YUV(x)	(sizeof(Pixel) == 2 ? RGBtoYUV[w ## x] : ConvertYUV<ColorMask>(w ## x, RGBtoYUV))
-
 /**
  * Convert 32 bit RGB values to Yuv
  */
@@ -193,13 +192,68 @@ static inline uint32 ConvertYUV(uint32 x, const uint32 *RGBtoYUV) {
 	return RGBtoYUV[r | g | b];
 }
 
+/**
+ * Convert a row of pixels to YUV, including the pixels on both sides.
+ */
+template<typename ColorMask>
+static inline void convertRowYUV(const typename ColorMask::PixelType *p, uint32 *yuv, int width, const uint32 *RGBtoYUV) {
+	for (int x = -1; x <= width; x++)
+		yuv[x] = ColorMask::kBytesPerPixel == 2 ? RGBtoYUV[p[x]] : ConvertYUV<ColorMask>(p[x], RGBtoYUV);
+}
+
+/**
+ * Spread the Y, u and v bytes of a YUV value to 16 bits each.
+ */
+static inline uint64 spreadYUV(uint32 yuv) {
+	return (yuv & 0xFF) | ((yuv & 0xFF00) << 8) | ((uint64)(yuv & 0xFF0000) << 16);
+}
+
+/**
+ * Check two spread YUV values just like diffYUV() does, but without any
+ * branches.
+ */
+static inline uint16 diffSpreadYUV(uint64 yuv1, uint64 yuv2, uint16 flag) {
+	// Each component becomes 256 plus the difference, between 1 and 511.
+	// Adding the constants below sets the top bit of a component if it is
+	// above 256 plus the threshold, or at least 256 minus the threshold.
+	const uint64 diff = (yuv1 + 0x010001000100ULL) - yuv2;
+	const uint64 above = diff + (0x8000 - 257 - 0x30ULL) * 0x100000000ULL + (0x8000 - 257 - 7ULL) * 0x10000ULL + (0x8000 - 257 - 6ULL);
+	const uint64 notBelow = diff + (0x8000 - 256 + 0x30ULL) * 0x100000000ULL + (0x8000 - 256 + 7ULL) * 0x10000ULL + (0x8000 - 256 + 6ULL);
+	return ((above | ~notBelow) & 0x800080008000ULL) ? flag : 0;
+}
+
+static inline uint16 classifyPixel(const uint32 *prev, const uint32 *cur, const uint32 *next) {
+	const uint64 w1 = spreadYUV(prev[-1]), w2 = spreadYUV(prev[0]), w3 = spreadYUV(prev[1]);
+	const uint64 w4 = spreadYUV(cur[-1]), w5 = spreadYUV(cur[0]), w6 = spreadYUV(cur[1]);
+	const uint64 w7 = spreadYUV(next[-1]), w8 = spreadYUV(next[0]), w9 = spreadYUV(next[1]);
+
+	return diffSpreadYUV(w5, w1, 0x0001) | diffSpreadYUV(w5, w2, 0x0002) |
+		diffSpreadYUV(w5, w3, 0x0004) | diffSpreadYUV(w5, w4, 0x0008) |
+		diffSpreadYUV(w5, w6, 0x0010) | diffSpreadYUV(w5, w7, 0x0020) |
+		diffSpreadYUV(w5, w8, 0x0040) | diffSpreadYUV(w5, w9, 0x0080) |
+		diffSpreadYUV(w2, w6, HQScaler::kDiff26) | diffSpreadYUV(w6, w8, HQScaler::kDiff68) |
+		diffSpreadYUV(w8, w4, HQScaler::kDiff84) | diffSpreadYUV(w4, w2, HQScaler::kDiff42);
+}
+
+HQScaler::ClassifyFunc HQScaler::classifyFunc = nullptr;
+
+void HQScaler::classifyGeneric(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width) {
+	for (int x = 0; x < width; x++)
+		flags[x] = classifyPixel(prev + x, cur + x, next + x);
+}
+
+#define DIFF_2_6 (pixelFlags & HQScaler::kDiff26)
+#define DIFF_6_8 (pixelFlags & HQScaler::kDiff68)
+#define DIFF_8_4 (pixelFlags & HQScaler::kDiff84)
+#define DIFF_4_2 (pixelFlags & HQScaler::kDiff42)
+
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (https://web.archive.org/web/20090204033742/http://www.hiend3d.com/hq2x.html).
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV) {
+static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV, uint32 *yuvRows, uint16 *flags) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int w1, w2, w3, w4, w5, w6, w7, w8, w9;
@@ -221,7 +275,18 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	// The YUV values of the rows above, at and below the current one
+	uint32 *yuvPrev = yuvRows + 1;
+	uint32 *yuvCur = yuvPrev + width + 2;
+	uint32 *yuvNext = yuvCur + width + 2;
+	convertRowYUV<ColorMask>(p - nextlineSrc, yuvPrev, width, RGBtoYUV);
+	convertRowYUV<ColorMask>(p, yuvCur, width, RGBtoYUV);
+
 	while (height--) {
+		convertRowYUV<ColorMask>(p + nextlineSrc, yuvNext, width, RGBtoYUV);
+		HQScaler::classifyFunc(yuvPrev, yuvCur, yuvNext, flags, width);
+		const uint16 *f = flags;
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -238,16 +303,8 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			const int pixelFlags = *f++;
+			const int pattern = pixelFlags & 0xFF;
 
 			switch (pattern) {
 			case 0:
@@ -382,7 +439,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 18:
 			case 50:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_20
@@ -395,7 +452,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_22
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_20
@@ -405,7 +462,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 76:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_20
@@ -414,7 +471,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 10:
 			case 138:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_20
@@ -470,7 +527,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 22:
 			case 54:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -483,7 +540,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_22
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -493,7 +550,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 108:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -502,7 +559,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 11:
 			case 139:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -513,7 +570,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 19:
 			case 51:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_11
 					PIXEL01_10
 				} else {
@@ -526,7 +583,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 146:
 			case 178:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 					PIXEL11_12
 				} else {
@@ -538,7 +595,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 84:
 			case 85:
 				PIXEL00_20
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL01_11
 					PIXEL11_10
 				} else {
@@ -551,7 +608,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 113:
 				PIXEL00_20
 				PIXEL01_22
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL10_12
 					PIXEL11_10
 				} else {
@@ -563,7 +620,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 204:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 					PIXEL11_11
 				} else {
@@ -573,7 +630,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 73:
 			case 77:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_12
 					PIXEL10_10
 				} else {
@@ -585,7 +642,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 42:
 			case 170:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 					PIXEL10_11
 				} else {
@@ -597,7 +654,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 14:
 			case 142:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 					PIXEL01_12
 				} else {
@@ -657,12 +714,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 26:
 			case 31:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -673,13 +730,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 82:
 			case 214:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -689,12 +746,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 248:
 				PIXEL00_21
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -702,13 +759,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 74:
 			case 107:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -716,7 +773,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 27:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -727,7 +784,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 86:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -739,7 +796,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_21
 				PIXEL01_22
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -748,7 +805,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 106:
 				PIXEL00_10
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -757,7 +814,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 30:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -769,7 +826,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_22
 				PIXEL01_10
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -778,7 +835,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 120:
 				PIXEL00_21
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -786,7 +843,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 75:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -868,12 +925,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 58:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -883,13 +940,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 83:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -898,25 +955,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 92:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 202:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -924,13 +981,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 78:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -938,12 +995,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 154:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -953,13 +1010,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 114:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -968,34 +1025,34 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 89:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 90:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1003,7 +1060,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 55:
 			case 23:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_11
 					PIXEL01_0
 				} else {
@@ -1016,7 +1073,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 182:
 			case 150:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 					PIXEL11_12
 				} else {
@@ -1028,7 +1085,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 213:
 			case 212:
 				PIXEL00_20
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL01_11
 					PIXEL11_0
 				} else {
@@ -1041,7 +1098,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 240:
 				PIXEL00_20
 				PIXEL01_22
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL10_12
 					PIXEL11_0
 				} else {
@@ -1053,7 +1110,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 232:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 					PIXEL11_11
 				} else {
@@ -1063,7 +1120,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 109:
 			case 105:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_12
 					PIXEL10_0
 				} else {
@@ -1075,7 +1132,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 171:
 			case 43:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL10_11
 				} else {
@@ -1087,7 +1144,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 143:
 			case 15:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL01_12
 				} else {
@@ -1100,7 +1157,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 124:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1108,7 +1165,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 203:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -1119,7 +1176,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 62:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1131,7 +1188,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_11
 				PIXEL01_10
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1139,7 +1196,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 118:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1151,7 +1208,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_12
 				PIXEL01_22
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1160,7 +1217,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 110:
 				PIXEL00_10
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1168,7 +1225,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 155:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -1228,24 +1285,24 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 220:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 158:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1254,13 +1311,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 234:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1269,25 +1326,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 242:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 59:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1298,12 +1355,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 121:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1311,26 +1368,26 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 87:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 79:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1338,88 +1395,88 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 122:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 94:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 218:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 91:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1450,12 +1507,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 186:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1465,13 +1522,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 115:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1480,25 +1537,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 93:
 				PIXEL00_12
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 206:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1509,7 +1566,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 201:
 				PIXEL00_12
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1518,7 +1575,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 174:
 			case 46:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
@@ -1530,7 +1587,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 179:
 			case 147:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1543,7 +1600,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_11
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1563,12 +1620,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 126:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1576,21 +1633,21 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 219:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 125:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_12
 					PIXEL10_0
 				} else {
@@ -1602,7 +1659,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 221:
 				PIXEL00_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL01_11
 					PIXEL11_0
 				} else {
@@ -1612,7 +1669,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_10
 				break;
 			case 207:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL01_12
 				} else {
@@ -1625,7 +1682,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 238:
 				PIXEL00_10
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 					PIXEL11_11
 				} else {
@@ -1635,7 +1692,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 190:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 					PIXEL11_12
 				} else {
@@ -1645,7 +1702,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_11
 				break;
 			case 187:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL10_11
 				} else {
@@ -1658,7 +1715,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 243:
 				PIXEL00_11
 				PIXEL01_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL10_12
 					PIXEL11_0
 				} else {
@@ -1667,7 +1724,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 119:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_11
 					PIXEL01_0
 				} else {
@@ -1681,7 +1738,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 233:
 				PIXEL00_12
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1690,7 +1747,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 175:
 			case 47:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
@@ -1702,7 +1759,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 183:
 			case 151:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1715,7 +1772,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_11
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1724,25 +1781,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 250:
 				PIXEL00_10
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 123:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1750,12 +1807,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 95:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1765,13 +1822,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 222:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1780,12 +1837,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 252:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1794,25 +1851,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 249:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 235:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1820,13 +1877,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 111:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1834,12 +1891,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 63:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1848,12 +1905,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_21
 				break;
 			case 159:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1863,13 +1920,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 215:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1877,13 +1934,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 246:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1891,17 +1948,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 254:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1910,43 +1967,43 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 253:
 				PIXEL00_12
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
 				}
 				break;
 			case 251:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 239:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1954,17 +2011,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 127:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1972,12 +2029,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 191:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1986,18 +2043,18 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 223:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -2005,35 +2062,35 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 247:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
 				}
 				break;
 			case 255:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -2053,6 +2110,11 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		}
 		p += nextlineSrc - width;
 		q += (nextlineDst - width) * 2;
+
+		uint32 *yuvTmp = yuvPrev;
+		yuvPrev = yuvCur;
+		yuvCur = yuvNext;
+		yuvNext = yuvTmp;
 	}
 }
 
@@ -2116,7 +2178,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV) {
+static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV, uint32 *yuvRows, uint16 *flags) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int  w1, w2, w3, w4, w5, w6, w7, w8, w9;
@@ -2139,7 +2201,18 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	// The YUV values of the rows above, at and below the current one
+	uint32 *yuvPrev = yuvRows + 1;
+	uint32 *yuvCur = yuvPrev + width + 2;
+	uint32 *yuvNext = yuvCur + width + 2;
+	convertRowYUV<ColorMask>(p - nextlineSrc, yuvPrev, width, RGBtoYUV);
+	convertRowYUV<ColorMask>(p, yuvCur, width, RGBtoYUV);
+
 	while (height--) {
+		convertRowYUV<ColorMask>(p + nextlineSrc, yuvNext, width, RGBtoYUV);
+		HQScaler::classifyFunc(yuvPrev, yuvCur, yuvNext, flags, width);
+		const uint16 *f = flags;
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -2156,16 +2229,8 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			const int pixelFlags = *f++;
+			const int pattern = pixelFlags & 0xFF;
 
 			switch (pattern) {
 			case 0:
@@ -2365,7 +2430,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 18:
 			case 50:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_1M
 					PIXEL12_C
@@ -2388,7 +2453,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_1M
@@ -2405,7 +2470,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_2
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_1M
 					PIXEL21_C
@@ -2418,7 +2483,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 10:
 			case 138:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL10_C
@@ -2511,7 +2576,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 22:
 			case 54:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2534,7 +2599,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -2551,7 +2616,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_2
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2564,7 +2629,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 11:
 			case 139:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2582,7 +2647,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 19:
 			case 51:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_1M
@@ -2601,7 +2666,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 146:
 			case 178:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_1M
 					PIXEL12_C
@@ -2620,7 +2685,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 84:
 			case 85:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -2639,7 +2704,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 112:
 			case 113:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -2658,7 +2723,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 200:
 			case 204:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_1M
 					PIXEL21_C
@@ -2677,7 +2742,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 73:
 			case 77:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_1M
@@ -2696,7 +2761,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 42:
 			case 170:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL10_C
@@ -2715,7 +2780,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 14:
 			case 142:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL02_1R
@@ -2822,7 +2887,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 26:
 			case 31:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -2830,7 +2895,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -2845,7 +2910,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 82:
 			case 214:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -2856,7 +2921,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -2870,7 +2935,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL01_1
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -2878,7 +2943,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -2888,7 +2953,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 74:
 			case 107:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -2899,7 +2964,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -2909,7 +2974,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 27:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2927,7 +2992,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 86:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2949,7 +3014,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -2965,7 +3030,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2978,7 +3043,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 30:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -3000,7 +3065,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -3016,7 +3081,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -3028,7 +3093,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 75:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -3177,13 +3242,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 58:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -3198,7 +3263,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 83:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -3208,7 +3273,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1M
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -3221,20 +3286,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 202:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -3244,7 +3309,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -3253,7 +3318,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 78:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -3263,7 +3328,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -3272,13 +3337,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 154:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -3293,7 +3358,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 114:
 				PIXEL00_1M
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -3303,7 +3368,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -3316,26 +3381,26 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 90:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -3343,13 +3408,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -3357,7 +3422,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 55:
 			case 23:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_C
@@ -3376,7 +3441,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 182:
 			case 150:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -3395,7 +3460,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 213:
 			case 212:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -3414,7 +3479,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 241:
 			case 240:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -3433,7 +3498,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 236:
 			case 232:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -3452,7 +3517,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 109:
 			case 105:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_C
@@ -3471,7 +3536,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 171:
 			case 43:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -3490,7 +3555,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 143:
 			case 15:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL02_1R
@@ -3513,7 +3578,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -3525,7 +3590,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 203:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -3543,7 +3608,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 62:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -3565,7 +3630,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -3577,7 +3642,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 118:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -3599,7 +3664,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -3615,7 +3680,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1R
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -3627,7 +3692,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 155:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -3737,12 +3802,12 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -3753,12 +3818,12 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 158:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -3774,7 +3839,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 234:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -3783,7 +3848,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -3797,7 +3862,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 242:
 				PIXEL00_1M
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -3805,7 +3870,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1L
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -3816,7 +3881,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 59:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -3825,7 +3890,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -3842,7 +3907,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -3851,7 +3916,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -3859,7 +3924,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 87:
 				PIXEL00_1L
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -3872,14 +3937,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL20_1M
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 79:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -3891,7 +3956,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1R
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -3900,20 +3965,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 122:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -3922,19 +3987,19 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 94:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -3945,38 +4010,38 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 218:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -3987,7 +4052,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 91:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -3996,20 +4061,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -4060,13 +4125,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 186:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -4081,7 +4146,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 115:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -4091,7 +4156,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -4104,20 +4169,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 206:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -4127,7 +4192,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -4143,7 +4208,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -4153,7 +4218,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 174:
 			case 46:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -4171,7 +4236,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 147:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -4193,7 +4258,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -4223,7 +4288,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 126:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -4233,7 +4298,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL12_3
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -4245,7 +4310,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 219:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -4257,7 +4322,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -4268,7 +4333,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 125:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_C
@@ -4286,7 +4351,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 221:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -4304,7 +4369,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL20_1M
 				break;
 			case 207:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL02_1R
@@ -4322,7 +4387,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 238:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -4340,7 +4405,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_1
 				break;
 			case 190:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -4358,7 +4423,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL21_1
 				break;
 			case 187:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -4376,7 +4441,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 243:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -4394,7 +4459,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				break;
 			case 119:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_C
@@ -4419,7 +4484,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -4429,7 +4494,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 175:
 			case 47:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -4447,7 +4512,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 151:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -4469,7 +4534,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -4480,7 +4545,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL01_C
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -4488,7 +4553,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -4497,7 +4562,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 123:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -4508,7 +4573,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -4518,7 +4583,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 95:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -4526,7 +4591,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -4540,7 +4605,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 222:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -4551,7 +4616,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -4565,7 +4630,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -4573,7 +4638,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -4585,13 +4650,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -4600,7 +4665,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 235:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -4611,7 +4676,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -4620,7 +4685,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 111:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -4630,7 +4695,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -4640,13 +4705,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 63:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -4660,7 +4725,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 159:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -4668,7 +4733,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -4682,7 +4747,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 215:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -4691,7 +4756,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -4701,7 +4766,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 246:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -4713,7 +4778,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -4721,7 +4786,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 254:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -4729,14 +4794,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL02_4
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
 					PIXEL10_3
 					PIXEL20_4
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -4753,20 +4818,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 251:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -4775,7 +4840,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -4784,7 +4849,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_2
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -4793,7 +4858,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 239:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -4803,7 +4868,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -4812,7 +4877,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 127:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -4821,7 +4886,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -4829,7 +4894,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL12_3
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -4839,13 +4904,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 191:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -4858,14 +4923,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 223:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
 					PIXEL00_4
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -4876,7 +4941,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -4887,7 +4952,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 247:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -4897,20 +4962,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 255:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -4918,13 +4983,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -4944,6 +5009,11 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		}
 		p += nextlineSrc - width;
 		q += (nextlineDst - width) * 3;
+
+		uint32 *yuvTmp = yuvPrev;
+		yuvPrev = yuvCur;
+		yuvCur = yuvNext;
+		yuvNext = yuvTmp;
 	}
 }
 
@@ -4951,9 +5021,23 @@ HQScaler::HQScaler(const Graphics::PixelFormat &format) : Scaler(format),
 #ifdef USE_NASM
 	_hqx_params(nullptr),
 #endif
-	_RGBtoYUV(nullptr) {
+	_RGBtoYUV(nullptr), _yuvRows(nullptr), _flags(nullptr), _rowWidth(0) {
 	_factor = 2;
 
+	// Pick the classification the CPU can run fastest
+	if (!classifyFunc) {
+		classifyFunc = classifyGeneric;
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) classifyFunc = classifyNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) classifyFunc = classifySSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) classifyFunc = classifyAVX2;
+#endif
+	}
+
 	if (format.bytesPerPixel == 2) {
 		initLUT(format);
 	} else {
@@ -4968,6 +5052,8 @@ HQScaler::HQScaler(const Graphics::PixelFormat &format) : Scaler(format),
 HQScaler::~HQScaler() {
 	delete[] _RGBtoYUV;
 	_RGBtoYUV = nullptr;
+	delete[] _yuvRows;
+	delete[] _flags;
 
 #ifdef USE_NASM
 	delete _hqx_params;
@@ -4987,19 +5073,19 @@ void HQScaler::HQ3x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 void HQScaler::HQ2x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	if (_format.gLoss == 2)
 		HQ2x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 	else
 		HQ2x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 }
 
 void HQScaler::HQ3x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	if (_format.gLoss == 2)
 		HQ3x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 	else
 		HQ3x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 }
 #endif
 
@@ -5007,15 +5093,15 @@ void HQScaler::HQ2x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 	if (_format.aLoss == 0) {
 		if (_format.aShift == 0) {
 			HQ2x_implementation<Graphics::ColorMasks<-8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 		} else {
 			HQ2x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 		}
 	} else {
 		assert((_format.rMax() | _format.gMax() | _format.bMax()) <= 0xffffff);
 		HQ2x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 	}
 }
 
@@ -5023,20 +5109,33 @@ void HQScaler::HQ3x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 	if (_format.aLoss == 0) {
 		if (_format.aShift == 0) {
 			HQ3x_implementation<Graphics::ColorMasks<-8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 		} else {
 			HQ3x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 		}
 	} else {
 		assert((_format.rMax() | _format.gMax() | _format.bMax()) <= 0xffffff);
 		HQ3x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _yuvRows, _flags);
 	}
 }
 
+void HQScaler::allocateRows(int width) {
+	if (width <= _rowWidth)
+		return;
+
+	delete[] _yuvRows;
+	delete[] _flags;
+	_yuvRows = new uint32[3 * (width + 2)];
+	_flags = new uint16[width];
+	_rowWidth = width;
+}
+
 void HQScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height, int x, int y) {
+	allocateRows(width);
+
 	if (_format.bytesPerPixel == 2) {
 		switch (_factor) {
 		case 2:
@@ -33,6 +33,42 @@ public:
 	~HQScaler();
 	uint increaseFactor() override;
 	uint decreaseFactor() override;
+
+	/**
+	 * Flags telling how a pixel compares to its neighbors. The low 8 bits
+	 * are set for each of the neighbors, from the top left one to the bottom
+	 * right one, whose YUV value differs noticeably from the one of the
+	 * pixel. The others are set for the pairs of direct neighbors which
+	 * differ from each other.
+	 */
+	enum {
+		kDiff26 = 0x100,
+		kDiff68 = 0x200,
+		kDiff84 = 0x400,
+		kDiff42 = 0x800
+	};
+
+	/**
+	 * Compute the flags of a row of pixels from the YUV values of the row
+	 * and of the rows above and below it. Each row has one more value on
+	 * both sides.
+	 */
+	typedef void (*ClassifyFunc)(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width);
+
+	/** The classification used by all HQ scalers, picked when the first one is created. */
+	static ClassifyFunc classifyFunc;
+
+	static void classifyGeneric(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width);
+#ifdef SCUMMVM_NEON
+	static void classifyNEON(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void classifySSE2(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void classifyAVX2(const uint32 *prev, const uint32 *cur, const uint32 *next, uint16 *flags, int width);
+#endif
+
 protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height, int x, int y) override;
@@ -43,7 +79,13 @@ protected:
 	inline void HQ2x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
 	inline void HQ3x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height);
 
+	/** Make room for the YUV values and the flags of rows of the given width. */
+	void allocateRows(int width);
+
 	uint32 *_RGBtoYUV;
+	uint32 *_yuvRows;
+	uint16 *_flags;
+	int _rowWidth;
 #ifdef USE_NASM
 	hqx_parameters *_hqx_params;
 #endif
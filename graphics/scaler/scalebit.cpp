@@ -89,6 +89,21 @@ static inline void stage_scale4x(void* dst0, void* dst1, void* dst2, void* dst3,
 #define SCSRC(i) (src+(i)*src_slice)
 #define SCMID(i) (mid[(i)])
 
+/**
+ * Space kept on both sides of the rows of the Scale4x buffer bitmap. The
+ * Scale2x stages read one pixel past both ends of each row.
+ */
+#define SCMARGIN 8
+
+/**
+ * Repeat the first and the last pixel of a row of the buffer bitmap into
+ * its margins.
+ */
+static inline void stage_pad(unsigned char* row, unsigned pixel, unsigned pixel_per_row) {
+	memcpy(row - pixel, row, pixel);
+	memcpy(row + pixel_per_row * pixel, row + (pixel_per_row - 1) * pixel, pixel);
+}
+
 /**
  * Apply the Scale2x effect on a bitmap.
  * The destination bitmap is filled with the scaled version of the source bitmap.
@@ -166,8 +181,8 @@ static void scale3x(void* void_dst, unsigned dst_slice, const void* void_src, un
  * The destination bitmap must be manually allocated before calling the function,
  * note that the resulting size is exactly 4x4 times the size of the source bitmap.
  * \note This function requires also a small buffer bitmap used internally to store
- * intermediate results. This bitmap must have at least a horizontal size in bytes of 2*width*pixel,
- * and a vertical size of 6 rows. The memory of this buffer must not be allocated
+ * intermediate results. This bitmap must have at least a horizontal size in bytes of 2*width*pixel
+ * plus SCMARGIN on both sides, and a vertical size of 6 rows. The memory of this buffer must not be allocated
  * in video memory because it's also read and not only written. Generally
  * a heap (malloc) or a stack (alloca) buffer is the best choices.
  * @param void_dst Pointer at the first pixel of the destination bitmap.
@@ -191,19 +206,24 @@ static void scale4x_buf(void* void_dst, unsigned dst_slice, void* void_mid, unsi
 	count = height;
 
 	/* set the 6 buffer pointers */
-	mid[0] = (unsigned char*)void_mid;
+	mid[0] = (unsigned char*)void_mid + SCMARGIN;
 	mid[1] = mid[0] + mid_slice;
 	mid[2] = mid[1] + mid_slice;
 	mid[3] = mid[2] + mid_slice;
 	mid[4] = mid[3] + mid_slice;
 	mid[5] = mid[4] + mid_slice;
 
+	/* pad the rows used as the center ones by stage_scale4x(), so that the result does not depend on what the buffer held before */
 	stage_scale2x(SCMID(0), SCMID(1), SCSRC(0), SCSRC(1), SCSRC(2), pixel, width);
 	stage_scale2x(SCMID(2), SCMID(3), SCSRC(1), SCSRC(2), SCSRC(3), pixel, width);
+	stage_pad(SCMID(2), pixel, 2 * width);
+	stage_pad(SCMID(3), pixel, 2 * width);
 	while (count) {
 		unsigned char* tmp;
 
 		stage_scale2x(SCMID(4), SCMID(5), SCSRC(2), SCSRC(3), SCSRC(4), pixel, width);
+		stage_pad(SCMID(4), pixel, 2 * width);
+		stage_pad(SCMID(5), pixel, 2 * width);
 		stage_scale4x(SCDST(0), SCDST(1), SCDST(2), SCDST(3), SCMID(1), SCMID(2), SCMID(3), SCMID(4), pixel, width);
 
 		dst = SCDST(4);
@@ -246,7 +266,7 @@ static void scale4x(void* void_dst, unsigned dst_slice, const void* void_src, un
 	unsigned mid_slice;
 	void* mid;
 
-	mid_slice = 2 * pixel * width; /* required space for 1 row buffer */
+	mid_slice = 2 * pixel * width + 2 * SCMARGIN; /* required space for 1 row buffer */
 
 	mid_slice = (mid_slice + 0x7) & ~0x7; /* align to 8 bytes */
 
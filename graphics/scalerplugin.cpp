@@ -52,8 +52,18 @@ void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 		} else {
 			Normal1x<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 		}
-	} else {
+	} else if (_bandHeight <= 0 || height <= _bandHeight) {
 		scaleIntern(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+		finishScale(srcPtr, srcPitch, width, height, x, y);
+	} else {
+		// The scalers read the rows around the band straight from the
+		// source, so each band comes out just like it would as a part of
+		// the whole rect.
+		for (int row = 0; row < height; row += _bandHeight) {
+			scaleIntern(srcPtr + row * srcPitch, srcPitch, dstPtr + row * _factor * dstPitch, dstPitch,
+			            width, MIN(_bandHeight, height - row), x, y + row);
+		}
+		finishScale(srcPtr, srcPitch, width, height, x, y);
 	}
 }
 
@@ -119,8 +129,15 @@ void SourceScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstP
 		buffer += _bufferedOutput.pitch;
 		dstPtr += dstPitch;
 	}
+}
 
-	// Update old src
+void SourceScaler::finishScale(const uint8 *srcPtr, uint32 srcPitch, int width, int height, int x, int y) {
+	if (!_enable)
+		return;
+
+	// Update old src. This has to wait until all bands are done, as the
+	// scaler compares the rows around each band as well.
+	int offset = (_padding + x) * _format.bytesPerPixel + (_padding + y) * srcPitch;
 	byte *oldSrc = _oldSrc + offset;
 	while (height--) {
 		memcpy(oldSrc, srcPtr, width * _format.bytesPerPixel);
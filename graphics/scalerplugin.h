@@ -27,7 +27,7 @@
 
 class Scaler {
 public:
-	Scaler(const Graphics::PixelFormat &format) : _format(format) {}
+	Scaler(const Graphics::PixelFormat &format) : _format(format), _bandHeight(0) {}
 	virtual ~Scaler() {}
 
 	/**
@@ -45,6 +45,18 @@ public:
 	void scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	           uint32 dstPitch, int width, int height, int x, int y);
 
+	/**
+	 * Scale rects taller than the given number of rows in horizontal bands.
+	 * The rows a band is made of, both in the source and in the
+	 * destination, then stay in the cache until the band is done. The result
+	 * is the same as when scaling the whole rect at once.
+	 *
+	 * @param rows The maximum height of a band, or 0 to scale rects at once.
+	 */
+	void setBandHeight(int rows) { _bandHeight = rows; }
+
+	int getBandHeight() const { return _bandHeight; }
+
 	/**
 	 * Increase the factor of scaling.
 	 * @return The new factor
@@ -101,8 +113,17 @@ protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                         uint32 dstPitch, int width, int height, int x, int y) = 0;
 
+	/**
+	 * Called once the whole rect passed to scale() is done, after
+	 * scaleIntern() was called for each of its bands.
+	 */
+	virtual void finishScale(const uint8 *srcPtr, uint32 srcPitch, int width, int height, int x, int y) {}
+
 	uint _factor;
 	Graphics::PixelFormat _format;
+
+private:
+	int _bandHeight;
 };
 
 /**
@@ -127,6 +148,8 @@ protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                         uint32 dstPitch, int width, int height, int x, int y) final;
 
+	virtual void finishScale(const uint8 *srcPtr, uint32 srcPitch, int width, int height, int x, int y) final;
+
 	/**
 	 * Scalers must implement this function. It will be called by oldSrcScale.
 	 * If by comparing the src and oldsrc images it is discovered that no change
@@ -357,6 +357,7 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_drawCallAllocator[1].initialize(drawCallMemorySize);
 	_debugRectsEnabled = false;
 	_profilingEnabled = false;
+	_tileSize = 0;
 
 	TinyGL::Internal::tglBlitResetScissorRect();
 }
@@ -39,6 +39,12 @@ void destroyContext(ContextHandle *handle);
 void setContext(ContextHandle *handle);
 void presentBuffer();
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas);
+/**
+ * Rasterize the draw calls of a frame tile by tile instead of one after the
+ * other over the whole buffer, when dirty rects are disabled. A tile size of
+ * 0 disables it, which is the default for new contexts.
+ */
+void setTiledRendering(int tileSize);
 void getSurfaceRef(Graphics::Surface &surface);
 Graphics::Surface *copyFromFrameBuffer(const Graphics::PixelFormat &dstFormat);
 
@@ -28,7 +28,7 @@
 namespace TinyGL {
 
 void GLContext::issueDrawCall(DrawCall *drawCall) {
-	if (_enableDirtyRectangles && drawCall->getDirtyRegion().isEmpty())
+	if (needsDirtyRegions() && drawCall->getDirtyRegion().isEmpty())
 		return;
 	_drawCallsQueue.push_back(drawCall);
 }
@@ -251,15 +251,90 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
+void GLContext::presentBufferTiled(Common::List<Common::Rect> &dirtyAreas) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	// Draw the frame at once if a draw call which cannot be split covers several tiles.
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		if ((*it)->isSplittable())
+			continue;
+
+		Common::Rect region = (*it)->getDirtyRegion();
+		region.clip(renderRect);
+		if (region.isEmpty())
+			continue;
+
+		if (region.left / _tileSize != (region.right - 1) / _tileSize || region.top / _tileSize != (region.bottom - 1) / _tileSize) {
+			presentBufferSimple(dirtyAreas);
+			return;
+		}
+	}
+
+	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
+
+	const int tilesX = (renderRect.width() + _tileSize - 1) / _tileSize;
+	const int tilesY = (renderRect.height() + _tileSize - 1) / _tileSize;
+	_tileDrawCalls.resize(tilesX * tilesY);
+	for (uint i = 0; i < _tileDrawCalls.size(); i++) {
+		_tileDrawCalls[i].resize(0);
+	}
+
+	// Bin the draw calls by the tiles they cover, each tile keeps their order.
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		Common::Rect region = (*it)->getDirtyRegion();
+		region.clip(renderRect);
+		if (region.isEmpty())
+			continue;
+
+		for (int y = region.top / _tileSize; y <= (region.bottom - 1) / _tileSize; y++) {
+			for (int x = region.left / _tileSize; x <= (region.right - 1) / _tileSize; x++) {
+				_tileDrawCalls[y * tilesX + x].push_back(*it);
+			}
+		}
+	}
+
+	// Rasterize each tile on its own, while its part of the buffers is in the cache.
+	// Tiles do not depend on each other, so the order they are drawn in does not matter.
+	for (int y = 0; y < tilesY; y++) {
+		for (int x = 0; x < tilesX; x++) {
+			const Common::Array<DrawCall *> &drawCalls = _tileDrawCalls[y * tilesX + x];
+			const Common::Rect tile(x * _tileSize, y * _tileSize,
+			                        MIN<int>((x + 1) * _tileSize, renderRect.right),
+			                        MIN<int>((y + 1) * _tileSize, renderRect.bottom));
+			for (uint i = 0; i < drawCalls.size(); i++) {
+				drawCalls[i]->execute(tile, true);
+			}
+		}
+	}
+
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		delete *it;
+	}
+
+	_drawCallsQueue.clear();
+
+	disposeResources();
+
+	_drawCallAllocator[_currentAllocatorIndex].reset();
+}
+
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	GLContext *c = gl_get_context();
 	if (c->_enableDirtyRectangles) {
 		c->presentBufferDirtyRects(dirtyAreas);
+	} else if (c->_tileSize > 0) {
+		c->presentBufferTiled(dirtyAreas);
 	} else {
 		c->presentBufferSimple(dirtyAreas);
 	}
 }
 
+void setTiledRendering(int tileSize) {
+	GLContext *c = gl_get_context();
+	assert(tileSize >= 0);
+	c->_tileSize = tileSize;
+}
+
 void presentBuffer() {
 	Common::List<Common::Rect> dirtyAreas;
 	presentBuffer(dirtyAreas);
@@ -294,7 +369,7 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
 	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	if (c->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -349,7 +424,6 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 	c->draw_triangle_front = (gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (gl_draw_triangle_func)_drawTriangleBack;
 
-	int n = c->vertex_n;
 	int cnt = c->vertex_cnt;
 
 	switch (c->begin_type) {
@@ -397,21 +471,22 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 		}
 		break;
 	case TGL_QUADS:
+		// The vertices are left as they were, as the draw call may be executed again
 		for(int i = 0; i < cnt; i += 4) {
+			int edgeFlag0 = c->vertex[i].edge_flag;
+			int edgeFlag2 = c->vertex[i + 2].edge_flag;
 			c->vertex[i + 2].edge_flag = 0;
 			c->gl_draw_triangle(&c->vertex[i], &c->vertex[i + 1], &c->vertex[i + 2]);
-			c->vertex[i + 2].edge_flag = 1;
+			c->vertex[i + 2].edge_flag = edgeFlag2;
 			c->vertex[i + 0].edge_flag = 0;
 			c->gl_draw_triangle(&c->vertex[i], &c->vertex[i + 2], &c->vertex[i + 3]);
+			c->vertex[i + 0].edge_flag = edgeFlag0;
 		}
 		break;
 	case TGL_QUAD_STRIP:
-		for( ; n >= 4; n -= 2) {
-			c->gl_draw_triangle(&c->vertex[0], &c->vertex[1], &c->vertex[2]);
-			c->gl_draw_triangle(&c->vertex[1], &c->vertex[3], &c->vertex[2]);
-			for (int i = 0; i < 2; i++) {
-				c->vertex[i] = c->vertex[i + 2];
-			}
+		for(int i = 0; i + 3 < cnt; i += 2) {
+			c->gl_draw_triangle(&c->vertex[i], &c->vertex[i + 1], &c->vertex[i + 2]);
+			c->gl_draw_triangle(&c->vertex[i + 1], &c->vertex[i + 3], &c->vertex[i + 2]);
 		}
 		break;
 	case TGL_POLYGON: {
@@ -576,7 +651,7 @@ BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transf
 	tglIncBlitImageRef(image);
 	_blitState = captureState();
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (gl_get_context()->_enableDirtyRectangles) {
+	if (gl_get_context()->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -616,6 +691,14 @@ void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool resto
 	Internal::tglBlitResetScissorRect();
 }
 
+bool BlittingDrawCall::isSplittable() const {
+	// The blitting functions only move the source rectangle along with the
+	// clipped destination for blits which are neither flipped nor transformed.
+	if (_transform._flipHorizontally || _transform._flipVertically)
+		return false;
+	return _transform._destinationRectangle.width() == 0 && _transform._destinationRectangle.height() == 0 && _transform._rotation == 0;
+}
+
 BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
 	BlittingState state;
 	TinyGL::GLContext *c = gl_get_context();
@@ -693,7 +776,7 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->needsDirtyRegions()) {
 		_dirtyRegion = c->renderRect;
 	}
 }
@@ -57,6 +57,8 @@ public:
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
+	// Whether executing the draw call on parts of the buffer draws the same pixels as executing it at once
+	virtual bool isSplittable() const { return true; }
 protected:
 	Common::Rect _dirtyRegion;
 private:
@@ -170,6 +172,7 @@ public:
 	bool operator==(const BlittingDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual bool isSplittable() const;
 
 	BlittingMode getBlittingMode() const { return _mode; }
 
@@ -467,6 +467,10 @@ struct GLContext {
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
+	// Tiled rendering
+	int _tileSize;
+	Common::Array<Common::Array<DrawCall *> > _tileDrawCalls;
+
 	void gl_vertex_transform(GLVertex *v);
 	void gl_calc_fog_factor(GLVertex *v);
 
@@ -523,6 +527,10 @@ public:
 
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
+	void presentBufferTiled(Common::List<Common::Rect> &dirtyAreas);
+
+	// The draw calls need their dirty regions to be replayed on parts of the buffer
+	bool needsDirtyRegions() const { return _enableDirtyRectangles || _tileSize > 0; }
 
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
@@ -50,34 +50,32 @@ void FrameBuffer::putPixelNoTexture(int fbOffset, uint *pz, byte *ps, int _a,
                                     int x, int y, uint &z, uint &r, uint &g, uint &b, uint &a,
                                     int &dzdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                     uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-
-	if (kStippleEnabled && !applyStipplePattern(x + _a, y, _polygonStipplePattern)) {
-		return;
-	}
-
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
-			return;
+	// Pixels which are not drawn still step the interpolated values
+	if ((!kEnableScissor || !scissorPixel(x + _a, y)) &&
+	    (!kStippleEnabled || applyStipplePattern(x + _a, y, _polygonStipplePattern))) {
+		bool stencilResult = true;
+		if (kStencilEnabled) {
+			stencilResult = stencilTest(ps[_a]);
+			if (!stencilResult) {
+				stencilOp(false, true, ps + _a);
+			}
+		}
+		if (stencilResult) {
+			bool depthTestResult;
+			if (kDepthTestEnabled) {
+				depthTestResult = compareDepth(z, pz[_a]);
+			} else {
+				depthTestResult = true;
+			}
+			if (kStencilEnabled) {
+				stencilOp(true, depthTestResult, ps + _a);
+			}
+			if (depthTestResult) {
+				writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>
+				          (fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8),
+				          z, fog, fog_r, fog_g, fog_b);
+			}
 		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>
-		          (fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8),
-		          z, fog, fog_r, fog_g, fog_b);
 	}
 	z += dzdx;
 	if (kFogMode) {
@@ -98,40 +96,40 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
                                   uint &r, uint &g, uint &b, uint &a,
                                   int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                   uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
-			return;
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		bool stencilResult = true;
+		if (kStencilEnabled) {
+			stencilResult = stencilTest(ps[_a]);
+			if (!stencilResult) {
+				stencilOp(false, true, ps + _a);
+			}
 		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
-		uint8 c_a, c_r, c_g, c_b;
-		texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
-		if (kLightsMode) {
-			uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
-			uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
-			uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
-			uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
-			c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
-			c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
-			c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
-			c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+		if (stencilResult) {
+			bool depthTestResult;
+			if (kDepthTestEnabled) {
+				depthTestResult = compareDepth(z, pz[_a]);
+			} else {
+				depthTestResult = true;
+			}
+			if (kStencilEnabled) {
+				stencilOp(true, depthTestResult, ps + _a);
+			}
+			if (depthTestResult) {
+				uint8 c_a, c_r, c_g, c_b;
+				texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
+				if (kLightsMode) {
+					uint l_a = (a >> (ZB_POINT_ALPHA_BITS - 8));
+					uint l_r = (r >> (ZB_POINT_RED_BITS - 8));
+					uint l_g = (g >> (ZB_POINT_GREEN_BITS - 8));
+					uint l_b = (b >> (ZB_POINT_BLUE_BITS - 8));
+					c_a = (c_a * l_a) >> (ZB_POINT_ALPHA_BITS - 8);
+					c_r = (c_r * l_r) >> (ZB_POINT_RED_BITS - 8);
+					c_g = (c_g * l_g) >> (ZB_POINT_GREEN_BITS - 8);
+					c_b = (c_b * l_b) >> (ZB_POINT_BLUE_BITS - 8);
+				}
+				writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>(fbOffset + _a, c_a, c_r, c_g, c_b, z, fog, fog_r, fog_g, fog_b);
+			}
 		}
-		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>(fbOffset + _a, c_a, c_r, c_g, c_b, z, fog, fog_r, fog_g, fog_b);
 	}
 	z += dzdx;
 	s += dsdx;
@@ -149,32 +147,32 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
 
 template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kStippleEnabled, bool kDepthTestEnabled>
 void FrameBuffer::putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-
 	/*if (kStippleEnabled && !applyStipplePattern(x + _a, y, _polygonStipplePattern)) {
 		return;
 	}*/
 
-	if (kStencilEnabled) {
-		bool stencilResult = stencilTest(ps[_a]);
-		if (!stencilResult) {
-			stencilOp(false, true, ps + _a);
-			return;
+	if (!kEnableScissor || !scissorPixel(x + _a, y)) {
+		bool stencilResult = true;
+		if (kStencilEnabled) {
+			stencilResult = stencilTest(ps[_a]);
+			if (!stencilResult) {
+				stencilOp(false, true, ps + _a);
+			}
+		}
+		if (stencilResult) {
+			bool depthTestResult;
+			if (kDepthTestEnabled) {
+				depthTestResult = compareDepth(z, pz[_a]);
+			} else {
+				depthTestResult = true;
+			}
+			if (kStencilEnabled) {
+				stencilOp(true, depthTestResult, ps + _a);
+			}
+			if (kDepthWrite && depthTestResult) {
+				pz[_a] = z;
+			}
 		}
-	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (kDepthWrite && depthTestResult) {
-		pz[_a] = z;
 	}
 	z += dzdx;
 }
@@ -229,6 +227,9 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		p2 = tp;
 	}
 
+	if (kEnableScissor && (p2->y < _clipRectangle.top || p0->y >= _clipRectangle.bottom))
+		return;
+
 	// we compute dXdx and dXdy for all interpolated values
 
 	fdx1 = (float)(p1->x - p0->x);
@@ -446,7 +447,12 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && y >= _clipRectangle.bottom) {
+				// the remaining lines are all below the scissor rectangle
+				return;
+			} else if (kEnableScissor && (y < _clipRectangle.top || (x2 >> 16) < _clipRectangle.left || x1 >= _clipRectangle.right)) {
+				// the whole line would be scissored, only follow the edges
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -0,0 +1,191 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Graphics {
+
+namespace {
+
+/** The row parameters, in registers. */
+struct RowConstantsAVX2 {
+	__m256i mul[4], neg[4];
+	__m128i loss[3], shift[3];
+	__m256i aMask16, aMask32;
+
+	RowConstantsAVX2(const YUVToRGBManager::RowParams &params) {
+		const int16 muls[4] = { params.crRMul, params.crGMul, params.cbGMul, params.cbBMul };
+		for (int i = 0; i < 4; i++) {
+			mul[i] = _mm256_set1_epi16(ABS(muls[i]));
+			neg[i] = _mm256_set1_epi16(muls[i] < 0 ? -1 : 0);
+		}
+		loss[0] = _mm_cvtsi32_si128(params.rLoss);
+		loss[1] = _mm_cvtsi32_si128(params.gLoss);
+		loss[2] = _mm_cvtsi32_si128(params.bLoss);
+		shift[0] = _mm_cvtsi32_si128(params.rShift);
+		shift[1] = _mm_cvtsi32_si128(params.gShift);
+		shift[2] = _mm_cvtsi32_si128(params.bShift);
+		aMask16 = _mm256_set1_epi16((int16)params.aMask);
+		aMask32 = _mm256_set1_epi32(params.aMask);
+	}
+};
+
+} // End of anonymous namespace
+
+static FORCEINLINE __m256i chromaDelta(__m256i c, __m256i mul, __m256i neg) {
+	__m256i sign = _mm256_srai_epi16(c, 15);
+	const __m256i delta = _mm256_mulhi_epi16(_mm256_slli_epi16(_mm256_abs_epi16(c), 2), mul);
+	sign = _mm256_xor_si256(sign, neg);
+	return _mm256_sub_epi16(_mm256_xor_si256(delta, sign), sign);
+}
+
+template<bool itu>
+static FORCEINLINE __m256i scaleComponent(__m256i x, __m128i loss) {
+	if (itu) {
+		x = _mm256_sub_epi16(_mm256_min_epi16(_mm256_max_epi16(x, _mm256_set1_epi16(16)), _mm256_set1_epi16(235)), _mm256_set1_epi16(16));
+		x = _mm256_mulhi_epu16(_mm256_slli_epi16(x, 2), _mm256_set1_epi16(19078));
+	} else {
+		x = _mm256_min_epi16(_mm256_max_epi16(x, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+	}
+	return _mm256_srl_epi16(x, loss);
+}
+
+static FORCEINLINE __m256i packPixels32(__m128i r, __m128i g, __m128i b, const RowConstantsAVX2 &k) {
+	__m256i p = _mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(r), k.shift[0]), _mm256_sll_epi32(_mm256_cvtepu16_epi32(g), k.shift[1]));
+	return _mm256_or_si256(p, _mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(b), k.shift[2]), k.aMask32));
+}
+
+/** Convert 16 pixels, from their luminance and the contributions of the chroma values. */
+template<bool itu, typename PixelInt>
+static FORCEINLINE void putPixels(byte *dst, __m256i y, __m256i crR, __m256i crbG, __m256i cbB, const RowConstantsAVX2 &k) {
+	const __m256i r = scaleComponent<itu>(_mm256_add_epi16(y, crR), k.loss[0]);
+	const __m256i g = scaleComponent<itu>(_mm256_add_epi16(y, crbG), k.loss[1]);
+	const __m256i b = scaleComponent<itu>(_mm256_add_epi16(y, cbB), k.loss[2]);
+
+	if (sizeof(PixelInt) == 2) {
+		__m256i p = _mm256_or_si256(_mm256_sll_epi16(r, k.shift[0]), _mm256_sll_epi16(g, k.shift[1]));
+		p = _mm256_or_si256(p, _mm256_or_si256(_mm256_sll_epi16(b, k.shift[2]), k.aMask16));
+		_mm256_storeu_si256((__m256i *)dst, p);
+	} else {
+		_mm256_storeu_si256((__m256i *)dst, packPixels32(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b), k));
+		_mm256_storeu_si256((__m256i *)(dst + 32), packPixels32(_mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1), _mm256_extracti128_si256(b, 1), k));
+	}
+}
+
+/** Load 16 bytes as 16-bit lanes. */
+static FORCEINLINE __m256i loadBytes(const byte *src) {
+	return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)src));
+}
+
+template<bool itu, typename PixelInt>
+static int convertRow444(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	const RowConstantsAVX2 k(params);
+	const __m256i bias = _mm256_set1_epi16(128);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const __m256i u = _mm256_sub_epi16(loadBytes(uSrc + x), bias);
+		const __m256i v = _mm256_sub_epi16(loadBytes(vSrc + x), bias);
+		const __m256i crR = chromaDelta(v, k.mul[0], k.neg[0]);
+		const __m256i crbG = _mm256_add_epi16(chromaDelta(v, k.mul[1], k.neg[1]), chromaDelta(u, k.mul[2], k.neg[2]));
+		const __m256i cbB = chromaDelta(u, k.mul[3], k.neg[3]);
+
+		putPixels<itu, PixelInt>(dst + x * sizeof(PixelInt), loadBytes(ySrc + x), crR, crbG, cbB, k);
+	}
+	return x;
+}
+
+/**
+ * Duplicate each of the 16 lanes, the unpacking works within the 128-bit
+ * halves, so these are swapped back in order.
+ */
+static FORCEINLINE void duplicateLanes(__m256i x, __m256i &lo, __m256i &hi) {
+	const __m256i a = _mm256_unpacklo_epi16(x, x);
+	const __m256i b = _mm256_unpackhi_epi16(x, x);
+	lo = _mm256_permute2x128_si256(a, b, 0x20);
+	hi = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+template<bool itu, typename PixelInt>
+static int convertRow422(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	const RowConstantsAVX2 k(params);
+	const __m256i bias = _mm256_set1_epi16(128);
+
+	int x = 0;
+	for (; x + 32 <= width; x += 32) {
+		const __m256i u = _mm256_sub_epi16(loadBytes(uSrc + (x >> 1)), bias);
+		const __m256i v = _mm256_sub_epi16(loadBytes(vSrc + (x >> 1)), bias);
+		const __m256i crR = chromaDelta(v, k.mul[0], k.neg[0]);
+		const __m256i crbG = _mm256_add_epi16(chromaDelta(v, k.mul[1], k.neg[1]), chromaDelta(u, k.mul[2], k.neg[2]));
+		const __m256i cbB = chromaDelta(u, k.mul[3], k.neg[3]);
+
+		// Each chroma value is used for two pixels
+		__m256i crRLo, crRHi, crbGLo, crbGHi, cbBLo, cbBHi;
+		duplicateLanes(crR, crRLo, crRHi);
+		duplicateLanes(crbG, crbGLo, crbGHi);
+		duplicateLanes(cbB, cbBLo, cbBHi);
+
+		putPixels<itu, PixelInt>(dst + x * sizeof(PixelInt), loadBytes(ySrc + x), crRLo, crbGLo, cbBLo, k);
+		putPixels<itu, PixelInt>(dst + (x + 16) * sizeof(PixelInt), loadBytes(ySrc + x + 16), crRHi, crbGHi, cbBHi, k);
+	}
+	return x;
+}
+
+void YUVToRGBManager::convertRow444AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	int x;
+	if (params.bytesPerPixel == 2)
+		x = (params.scale == kScaleITU) ? convertRow444<true, uint16>(dst, ySrc, uSrc, vSrc, width, params) : convertRow444<false, uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		x = (params.scale == kScaleITU) ? convertRow444<true, uint32>(dst, ySrc, uSrc, vSrc, width, params) : convertRow444<false, uint32>(dst, ySrc, uSrc, vSrc, width, params);
+
+	if (x < width)
+		convertRow444Generic(dst + x * params.bytesPerPixel, ySrc + x, uSrc + x, vSrc + x, width - x, params);
+}
+
+void YUVToRGBManager::convertRow422AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	int x;
+	if (params.bytesPerPixel == 2)
+		x = (params.scale == kScaleITU) ? convertRow422<true, uint16>(dst, ySrc, uSrc, vSrc, width, params) : convertRow422<false, uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		x = (params.scale == kScaleITU) ? convertRow422<true, uint32>(dst, ySrc, uSrc, vSrc, width, params) : convertRow422<false, uint32>(dst, ySrc, uSrc, vSrc, width, params);
+
+	if (x < width)
+		convertRow422Generic(dst + x * params.bytesPerPixel, ySrc + x, uSrc + (x >> 1), vSrc + (x >> 1), width - x, params);
+}
+
+} // End of namespace Graphics
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
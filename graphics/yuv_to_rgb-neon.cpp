@@ -0,0 +1,199 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/yuv_to_rgb.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace Graphics {
+
+namespace {
+
+/** The row parameters, in registers. */
+struct RowConstantsNEON {
+	int16x8_t mul[4], neg[4];
+	int16x8_t loss[3], shift16[3];
+	int32x4_t shift32[3];
+	uint16x8_t aMask16;
+	uint32x4_t aMask32;
+
+	RowConstantsNEON(const YUVToRGBManager::RowParams &params) {
+		const int16 muls[4] = { params.crRMul, params.crGMul, params.cbGMul, params.cbBMul };
+		for (int i = 0; i < 4; i++) {
+			mul[i] = vdupq_n_s16(ABS(muls[i]));
+			neg[i] = vdupq_n_s16(muls[i] < 0 ? -1 : 0);
+		}
+
+		// Shifting by negative counts shifts to the right
+		const byte losses[3] = { params.rLoss, params.gLoss, params.bLoss };
+		const byte shifts[3] = { params.rShift, params.gShift, params.bShift };
+		for (int i = 0; i < 3; i++) {
+			loss[i] = vdupq_n_s16(-losses[i]);
+			shift16[i] = vdupq_n_s16(shifts[i]);
+			shift32[i] = vdupq_n_s32(shifts[i]);
+		}
+		aMask16 = vdupq_n_u16((uint16)params.aMask);
+		aMask32 = vdupq_n_u32(params.aMask);
+	}
+};
+
+} // End of anonymous namespace
+
+/**
+ * The contribution of chroma values (minus 128) to a component. The
+ * doubling multiplication gives (|c| * |mul|) >> 14 for |c| shifted by 1.
+ */
+static FORCEINLINE int16x8_t chromaDelta(int16x8_t c, int16x8_t mul, int16x8_t neg) {
+	const int16x8_t delta = vqdmulhq_s16(vshlq_n_s16(vabsq_s16(c), 1), mul);
+	const int16x8_t sign = veorq_s16(vshrq_n_s16(c, 15), neg);
+	return vsubq_s16(veorq_s16(delta, sign), sign);
+}
+
+template<bool itu>
+static FORCEINLINE uint16x8_t scaleComponent(int16x8_t x, int16x8_t loss) {
+	if (itu) {
+		x = vsubq_s16(vminq_s16(vmaxq_s16(x, vdupq_n_s16(16)), vdupq_n_s16(235)), vdupq_n_s16(16));
+		x = vqdmulhq_s16(vshlq_n_s16(x, 1), vdupq_n_s16(19078));
+	} else {
+		x = vminq_s16(vmaxq_s16(x, vdupq_n_s16(0)), vdupq_n_s16(255));
+	}
+	return vshlq_u16(vreinterpretq_u16_s16(x), loss);
+}
+
+static FORCEINLINE uint32x4_t packPixels32(uint16x4_t r, uint16x4_t g, uint16x4_t b, const RowConstantsNEON &k) {
+	uint32x4_t p = vorrq_u32(vshlq_u32(vmovl_u16(r), k.shift32[0]), vshlq_u32(vmovl_u16(g), k.shift32[1]));
+	return vorrq_u32(p, vorrq_u32(vshlq_u32(vmovl_u16(b), k.shift32[2]), k.aMask32));
+}
+
+/** Convert 8 pixels, from their luminance and the contributions of the chroma values. */
+template<bool itu, typename PixelInt>
+static FORCEINLINE void putPixels(byte *dst, int16x8_t y, int16x8_t crR, int16x8_t crbG, int16x8_t cbB, const RowConstantsNEON &k) {
+	const uint16x8_t r = scaleComponent<itu>(vaddq_s16(y, crR), k.loss[0]);
+	const uint16x8_t g = scaleComponent<itu>(vaddq_s16(y, crbG), k.loss[1]);
+	const uint16x8_t b = scaleComponent<itu>(vaddq_s16(y, cbB), k.loss[2]);
+
+	if (sizeof(PixelInt) == 2) {
+		uint16x8_t p = vorrq_u16(vshlq_u16(r, k.shift16[0]), vshlq_u16(g, k.shift16[1]));
+		p = vorrq_u16(p, vorrq_u16(vshlq_u16(b, k.shift16[2]), k.aMask16));
+		vst1q_u16((uint16 *)dst, p);
+	} else {
+		vst1q_u32((uint32 *)dst, packPixels32(vget_low_u16(r), vget_low_u16(g), vget_low_u16(b), k));
+		vst1q_u32((uint32 *)(dst + 16), packPixels32(vget_high_u16(r), vget_high_u16(g), vget_high_u16(b), k));
+	}
+}
+
+/** Load 8 bytes as 16-bit lanes. */
+static FORCEINLINE int16x8_t loadBytes(const byte *src) {
+	return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src)));
+}
+
+template<bool itu, typename PixelInt>
+static int convertRow444(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	const RowConstantsNEON k(params);
+	const int16x8_t bias = vdupq_n_s16(128);
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const int16x8_t u = vsubq_s16(loadBytes(uSrc + x), bias);
+		const int16x8_t v = vsubq_s16(loadBytes(vSrc + x), bias);
+		const int16x8_t crR = chromaDelta(v, k.mul[0], k.neg[0]);
+		const int16x8_t crbG = vaddq_s16(chromaDelta(v, k.mul[1], k.neg[1]), chromaDelta(u, k.mul[2], k.neg[2]));
+		const int16x8_t cbB = chromaDelta(u, k.mul[3], k.neg[3]);
+
+		putPixels<itu, PixelInt>(dst + x * sizeof(PixelInt), loadBytes(ySrc + x), crR, crbG, cbB, k);
+	}
+	return x;
+}
+
+template<bool itu, typename PixelInt>
+static int convertRow422(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	const RowConstantsNEON k(params);
+	const int16x8_t bias = vdupq_n_s16(128);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const int16x8_t u = vsubq_s16(loadBytes(uSrc + (x >> 1)), bias);
+		const int16x8_t v = vsubq_s16(loadBytes(vSrc + (x >> 1)), bias);
+		const int16x8_t crR = chromaDelta(v, k.mul[0], k.neg[0]);
+		const int16x8_t crbG = vaddq_s16(chromaDelta(v, k.mul[1], k.neg[1]), chromaDelta(u, k.mul[2], k.neg[2]));
+		const int16x8_t cbB = chromaDelta(u, k.mul[3], k.neg[3]);
+
+		// Each chroma value is used for two pixels
+		const int16x8x2_t crRs = vzipq_s16(crR, crR);
+		const int16x8x2_t crbGs = vzipq_s16(crbG, crbG);
+		const int16x8x2_t cbBs = vzipq_s16(cbB, cbB);
+
+		putPixels<itu, PixelInt>(dst + x * sizeof(PixelInt), loadBytes(ySrc + x), crRs.val[0], crbGs.val[0], cbBs.val[0], k);
+		putPixels<itu, PixelInt>(dst + (x + 8) * sizeof(PixelInt), loadBytes(ySrc + x + 8), crRs.val[1], crbGs.val[1], cbBs.val[1], k);
+	}
+	return x;
+}
+
+void YUVToRGBManager::convertRow444NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	int x;
+	if (params.bytesPerPixel == 2)
+		x = (params.scale == kScaleITU) ? convertRow444<true, uint16>(dst, ySrc, uSrc, vSrc, width, params) : convertRow444<false, uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		x = (params.scale == kScaleITU) ? convertRow444<true, uint32>(dst, ySrc, uSrc, vSrc, width, params) : convertRow444<false, uint32>(dst, ySrc, uSrc, vSrc, width, params);
+
+	if (x < width)
+		convertRow444Generic(dst + x * params.bytesPerPixel, ySrc + x, uSrc + x, vSrc + x, width - x, params);
+}
+
+void YUVToRGBManager::convertRow422NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	int x;
+	if (params.bytesPerPixel == 2)
+		x = (params.scale == kScaleITU) ? convertRow422<true, uint16>(dst, ySrc, uSrc, vSrc, width, params) : convertRow422<false, uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		x = (params.scale == kScaleITU) ? convertRow422<true, uint32>(dst, ySrc, uSrc, vSrc, width, params) : convertRow422<false, uint32>(dst, ySrc, uSrc, vSrc, width, params);
+
+	if (x < width)
+		convertRow422Generic(dst + x * params.bytesPerPixel, ySrc + x, uSrc + (x >> 1), vSrc + (x >> 1), width - x, params);
+}
+
+} // End of namespace Graphics
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,191 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Graphics {
+
+namespace {
+
+/** The row parameters, in registers. */
+struct RowConstantsSSE2 {
+	__m128i mul[4], neg[4];
+	__m128i loss[3], shift[3];
+	__m128i aMask16, aMask32;
+
+	RowConstantsSSE2(const YUVToRGBManager::RowParams &params) {
+		const int16 muls[4] = { params.crRMul, params.crGMul, params.cbGMul, params.cbBMul };
+		for (int i = 0; i < 4; i++) {
+			mul[i] = _mm_set1_epi16(ABS(muls[i]));
+			neg[i] = _mm_set1_epi16(muls[i] < 0 ? -1 : 0);
+		}
+		loss[0] = _mm_cvtsi32_si128(params.rLoss);
+		loss[1] = _mm_cvtsi32_si128(params.gLoss);
+		loss[2] = _mm_cvtsi32_si128(params.bLoss);
+		shift[0] = _mm_cvtsi32_si128(params.rShift);
+		shift[1] = _mm_cvtsi32_si128(params.gShift);
+		shift[2] = _mm_cvtsi32_si128(params.bShift);
+		aMask16 = _mm_set1_epi16((int16)params.aMask);
+		aMask32 = _mm_set1_epi32(params.aMask);
+	}
+};
+
+} // End of anonymous namespace
+
+/**
+ * The contribution of chroma values (minus 128) to a component, computed as
+ * (|c| * |mul|) >> 14 with the sign of c times the one of mul.
+ */
+static FORCEINLINE __m128i chromaDelta(__m128i c, __m128i mul, __m128i neg) {
+	__m128i sign = _mm_srai_epi16(c, 15);
+	const __m128i abs = _mm_sub_epi16(_mm_xor_si128(c, sign), sign);
+	const __m128i delta = _mm_mulhi_epi16(_mm_slli_epi16(abs, 2), mul);
+	sign = _mm_xor_si128(sign, neg);
+	return _mm_sub_epi16(_mm_xor_si128(delta, sign), sign);
+}
+
+/** Clip the components, scale them for kScaleITU and drop the lost bits. */
+template<bool itu>
+static FORCEINLINE __m128i scaleComponent(__m128i x, __m128i loss) {
+	if (itu) {
+		x = _mm_sub_epi16(_mm_min_epi16(_mm_max_epi16(x, _mm_set1_epi16(16)), _mm_set1_epi16(235)), _mm_set1_epi16(16));
+		x = _mm_mulhi_epu16(_mm_slli_epi16(x, 2), _mm_set1_epi16(19078));
+	} else {
+		x = _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(255));
+	}
+	return _mm_srl_epi16(x, loss);
+}
+
+/** Convert 8 pixels, from their luminance and the contributions of the chroma values. */
+template<bool itu, typename PixelInt>
+static FORCEINLINE void putPixels(byte *dst, __m128i y, __m128i crR, __m128i crbG, __m128i cbB, const RowConstantsSSE2 &k) {
+	const __m128i r = scaleComponent<itu>(_mm_add_epi16(y, crR), k.loss[0]);
+	const __m128i g = scaleComponent<itu>(_mm_add_epi16(y, crbG), k.loss[1]);
+	const __m128i b = scaleComponent<itu>(_mm_add_epi16(y, cbB), k.loss[2]);
+
+	if (sizeof(PixelInt) == 2) {
+		__m128i p = _mm_or_si128(_mm_sll_epi16(r, k.shift[0]), _mm_sll_epi16(g, k.shift[1]));
+		p = _mm_or_si128(p, _mm_or_si128(_mm_sll_epi16(b, k.shift[2]), k.aMask16));
+		_mm_storeu_si128((__m128i *)dst, p);
+	} else {
+		const __m128i zero = _mm_setzero_si128();
+		__m128i lo = _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), k.shift[0]), _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), k.shift[1]));
+		__m128i hi = _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), k.shift[0]), _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), k.shift[1]));
+		lo = _mm_or_si128(lo, _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(b, zero), k.shift[2]), k.aMask32));
+		hi = _mm_or_si128(hi, _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(b, zero), k.shift[2]), k.aMask32));
+		_mm_storeu_si128((__m128i *)dst, lo);
+		_mm_storeu_si128((__m128i *)(dst + 16), hi);
+	}
+}
+
+/** Load 8 bytes as 16-bit lanes. */
+static FORCEINLINE __m128i loadBytes(const byte *src) {
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+}
+
+template<bool itu, typename PixelInt>
+static int convertRow444(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	const RowConstantsSSE2 k(params);
+	const __m128i bias = _mm_set1_epi16(128);
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const __m128i u = _mm_sub_epi16(loadBytes(uSrc + x), bias);
+		const __m128i v = _mm_sub_epi16(loadBytes(vSrc + x), bias);
+		const __m128i crR = chromaDelta(v, k.mul[0], k.neg[0]);
+		const __m128i crbG = _mm_add_epi16(chromaDelta(v, k.mul[1], k.neg[1]), chromaDelta(u, k.mul[2], k.neg[2]));
+		const __m128i cbB = chromaDelta(u, k.mul[3], k.neg[3]);
+
+		putPixels<itu, PixelInt>(dst + x * sizeof(PixelInt), loadBytes(ySrc + x), crR, crbG, cbB, k);
+	}
+	return x;
+}
+
+template<bool itu, typename PixelInt>
+static int convertRow422(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	const RowConstantsSSE2 k(params);
+	const __m128i bias = _mm_set1_epi16(128);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const __m128i u = _mm_sub_epi16(loadBytes(uSrc + (x >> 1)), bias);
+		const __m128i v = _mm_sub_epi16(loadBytes(vSrc + (x >> 1)), bias);
+		const __m128i crR = chromaDelta(v, k.mul[0], k.neg[0]);
+		const __m128i crbG = _mm_add_epi16(chromaDelta(v, k.mul[1], k.neg[1]), chromaDelta(u, k.mul[2], k.neg[2]));
+		const __m128i cbB = chromaDelta(u, k.mul[3], k.neg[3]);
+
+		// Each chroma value is used for two pixels
+		putPixels<itu, PixelInt>(dst + x * sizeof(PixelInt), loadBytes(ySrc + x),
+		                         _mm_unpacklo_epi16(crR, crR), _mm_unpacklo_epi16(crbG, crbG), _mm_unpacklo_epi16(cbB, cbB), k);
+		putPixels<itu, PixelInt>(dst + (x + 8) * sizeof(PixelInt), loadBytes(ySrc + x + 8),
+		                         _mm_unpackhi_epi16(crR, crR), _mm_unpackhi_epi16(crbG, crbG), _mm_unpackhi_epi16(cbB, cbB), k);
+	}
+	return x;
+}
+
+void YUVToRGBManager::convertRow444SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	int x;
+	if (params.bytesPerPixel == 2)
+		x = (params.scale == kScaleITU) ? convertRow444<true, uint16>(dst, ySrc, uSrc, vSrc, width, params) : convertRow444<false, uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		x = (params.scale == kScaleITU) ? convertRow444<true, uint32>(dst, ySrc, uSrc, vSrc, width, params) : convertRow444<false, uint32>(dst, ySrc, uSrc, vSrc, width, params);
+
+	if (x < width)
+		convertRow444Generic(dst + x * params.bytesPerPixel, ySrc + x, uSrc + x, vSrc + x, width - x, params);
+}
+
+void YUVToRGBManager::convertRow422SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	int x;
+	if (params.bytesPerPixel == 2)
+		x = (params.scale == kScaleITU) ? convertRow422<true, uint16>(dst, ySrc, uSrc, vSrc, width, params) : convertRow422<false, uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		x = (params.scale == kScaleITU) ? convertRow422<true, uint32>(dst, ySrc, uSrc, vSrc, width, params) : convertRow422<false, uint32>(dst, ySrc, uSrc, vSrc, width, params);
+
+	if (x < width)
+		convertRow422Generic(dst + x * params.bytesPerPixel, ySrc + x, uSrc + (x >> 1), vSrc + (x >> 1), width - x, params);
+}
+
+} // End of namespace Graphics
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
@@ -82,6 +82,9 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/array.h"
+#include "common/system.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
@@ -100,13 +103,47 @@ public:
 	const int16 *getColorTable() const { return _colorTab; }
 	const byte *getClipTable() const { return _clipTable; }
 
+	/** Whether the rows can be converted without the tables, with the same result. */
+	bool hasRowParams() const { return _hasRowParams; }
+	const YUVToRGBManager::RowParams &getRowParams() const { return _rowParams; }
+
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
 	int16 _colorTab[4 * 256]; // 2048 bytes
 	byte _clipTable[3 * 768];
+
+	bool _hasRowParams;
+	YUVToRGBManager::RowParams _rowParams;
 };
 
+/**
+ * Find the multiplier giving the values of a chroma table, which are the
+ * chroma value minus 128 multiplied by a factor and truncated, plus an offset.
+ */
+static bool findChromaMultiplier(const int16 *table, int offset, int16 &mul) {
+	const int last = table[255] - offset;
+	const int estimate = ABS(last) * 16384 / 127;
+
+	for (int m = MAX(estimate - 256, 1); m <= MIN(estimate + 256, 32767); m++) {
+		bool match = true;
+		for (int i = 0; i < 256 && match; i++) {
+			const int c = i - 128;
+			int value = (ABS(c) * m) >> 14;
+			if ((c < 0) != (last < 0))
+				value = -value;
+			match = (table[i] - offset == value);
+		}
+
+		if (match) {
+			mul = (last < 0) ? -m : m;
+			return true;
+		}
+	}
+
+	return false;
+}
+
 YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
 	_format = format;
 	_scale = scale;
@@ -179,10 +216,50 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 		Cb_g_tab[i] = (int16) (-(0.114 / 0.331) * CB);
 		Cb_b_tab[i] = (int16) ( (0.587 / 0.331) * CB) + b_offset + 256;
 	}
+
+	// The row conversions compute the same values with integer multiplications
+	_rowParams.scale = scale;
+	_rowParams.bytesPerPixel = format.bytesPerPixel;
+	_rowParams.rLoss = format.rLoss;
+	_rowParams.gLoss = format.gLoss;
+	_rowParams.bLoss = format.bLoss;
+	_rowParams.rShift = format.rShift;
+	_rowParams.gShift = format.gShift;
+	_rowParams.bShift = format.bShift;
+	_rowParams.aMask = (0xFF >> format.aLoss) << format.aShift;
+
+	_hasRowParams = findChromaMultiplier(Cr_r_tab, r_offset + 256, _rowParams.crRMul) &&
+	                findChromaMultiplier(Cr_g_tab, g_offset + 256, _rowParams.crGMul) &&
+	                findChromaMultiplier(Cb_g_tab, 0, _rowParams.cbGMul) &&
+	                findChromaMultiplier(Cb_b_tab, b_offset + 256, _rowParams.cbBMul);
 }
 
+YUVToRGBManager::RowFunc YUVToRGBManager::convertRow444Func = nullptr;
+YUVToRGBManager::RowFunc YUVToRGBManager::convertRow422Func = nullptr;
+
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
+
+	if (!convertRow444Func) {
+#ifdef SCUMMVM_NEON
+		if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) {
+			convertRow444Func = convertRow444NEON;
+			convertRow422Func = convertRow422NEON;
+		}
+#endif
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) {
+			convertRow444Func = convertRow444SSE2;
+			convertRow422Func = convertRow422SSE2;
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) {
+			convertRow444Func = convertRow444AVX2;
+			convertRow422Func = convertRow422AVX2;
+		}
+#endif
+	}
 }
 
 YUVToRGBManager::~YUVToRGBManager() {
@@ -198,6 +275,62 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+static inline int scaleComponent(int value, YUVToRGBManager::LuminanceScale scale) {
+	if (scale == YUVToRGBManager::kScaleFull)
+		return CLIP(value, 0, 255);
+
+	// The same as (x - 16) * 255 / 219 for all x in [16, 235]
+	return ((CLIP(value, 16, 235) - 16) * 19078) >> 14;
+}
+
+static inline int chromaDelta(int c, int16 mul) {
+	const int delta = (ABS(c - 128) * ABS(mul)) >> 14;
+	return ((c < 128) != (mul < 0)) ? -delta : delta;
+}
+
+template<typename PixelInt>
+static inline void putRowPixel(byte *dst, int y, int cr_r, int crb_g, int cb_b, const YUVToRGBManager::RowParams &params) {
+	*((PixelInt *)dst) = (PixelInt)((scaleComponent(y + cr_r, params.scale) >> params.rLoss) << params.rShift |
+	                                (scaleComponent(y + crb_g, params.scale) >> params.gLoss) << params.gShift |
+	                                (scaleComponent(y + cb_b, params.scale) >> params.bLoss) << params.bShift |
+	                                params.aMask);
+}
+
+template<typename PixelInt>
+static void convertRow444(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	for (int x = 0; x < width; x++) {
+		const int cr_r = chromaDelta(vSrc[x], params.crRMul);
+		const int crb_g = chromaDelta(vSrc[x], params.crGMul) + chromaDelta(uSrc[x], params.cbGMul);
+		const int cb_b = chromaDelta(uSrc[x], params.cbBMul);
+		putRowPixel<PixelInt>(dst + x * sizeof(PixelInt), ySrc[x], cr_r, crb_g, cb_b, params);
+	}
+}
+
+template<typename PixelInt>
+static void convertRow422(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVToRGBManager::RowParams &params) {
+	for (int x = 0; x < width; x += 2) {
+		const int cr_r = chromaDelta(vSrc[x >> 1], params.crRMul);
+		const int crb_g = chromaDelta(vSrc[x >> 1], params.crGMul) + chromaDelta(uSrc[x >> 1], params.cbGMul);
+		const int cb_b = chromaDelta(uSrc[x >> 1], params.cbBMul);
+		putRowPixel<PixelInt>(dst + x * sizeof(PixelInt), ySrc[x], cr_r, crb_g, cb_b, params);
+		putRowPixel<PixelInt>(dst + (x + 1) * sizeof(PixelInt), ySrc[x + 1], cr_r, crb_g, cb_b, params);
+	}
+}
+
+void YUVToRGBManager::convertRow444Generic(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	if (params.bytesPerPixel == 2)
+		convertRow444<uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		convertRow444<uint32>(dst, ySrc, uSrc, vSrc, width, params);
+}
+
+void YUVToRGBManager::convertRow422Generic(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params) {
+	if (params.bytesPerPixel == 2)
+		convertRow422<uint16>(dst, ySrc, uSrc, vSrc, width, params);
+	else
+		convertRow422<uint32>(dst, ySrc, uSrc, vSrc, width, params);
+}
+
 #define PUT_PIXEL(s, d) \
 	L = &clipTable[(s)]; \
 	*((PixelInt *)(d)) = ((L[cr_r] << r_shift) | (L[crb_g] << g_shift) | (L[cb_b] << b_shift) | a_mask)
@@ -239,18 +372,29 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 }
 
 void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
 	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	convert444((byte *)dst->getPixels(), dst->pitch, dst->format, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+void YUVToRGBManager::convert444(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst);
+	assert(dstFormat.bytesPerPixel == 2 || dstFormat.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVToRGBLookup *lookup = getLookup(dstFormat, scale);
+
+	if (convertRow444Func && lookup->hasRowParams()) {
+		for (int h = 0; h < yHeight; h++)
+			convertRow444Func(dst + h * dstPitch, ySrc + h * yPitch, uSrc + h * uvPitch, vSrc + h * uvPitch, yWidth, lookup->getRowParams());
+		return;
+	}
 
 	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	if (dstFormat.bytesPerPixel == 2)
+		convertYUV444ToRGB<uint16>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint32>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
@@ -295,19 +439,30 @@ void convertYUV422ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 }
 
 void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
 	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	convert422((byte *)dst->getPixels(), dst->pitch, dst->format, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+void YUVToRGBManager::convert422(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst);
+	assert(dstFormat.bytesPerPixel == 2 || dstFormat.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 	assert((yWidth & 1) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVToRGBLookup *lookup = getLookup(dstFormat, scale);
+
+	if (convertRow422Func && lookup->hasRowParams()) {
+		for (int h = 0; h < yHeight; h++)
+			convertRow422Func(dst + h * dstPitch, ySrc + h * yPitch, uSrc + h * uvPitch, vSrc + h * uvPitch, yWidth, lookup->getRowParams());
+		return;
+	}
 
 	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV422ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	if (dstFormat.bytesPerPixel == 2)
+		convertYUV422ToRGB<uint16>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV422ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV422ToRGB<uint32>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
@@ -355,20 +510,32 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 }
 
 void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
 	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	convert420((byte *)dst->getPixels(), dst->pitch, dst->format, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+void YUVToRGBManager::convert420(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst);
+	assert(dstFormat.bytesPerPixel == 2 || dstFormat.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVToRGBLookup *lookup = getLookup(dstFormat, scale);
+
+	if (convertRow422Func && lookup->hasRowParams()) {
+		// Each row of chroma values is used for two rows of pixels
+		for (int h = 0; h < yHeight; h++)
+			convertRow422Func(dst + h * dstPitch, ySrc + h * yPitch, uSrc + (h >> 1) * uvPitch, vSrc + (h >> 1) * uvPitch, yWidth, lookup->getRowParams());
+		return;
+	}
 
 	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	if (dstFormat.bytesPerPixel == 2)
+		convertYUV420ToRGB<uint16>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 #define PUT_PIXELA(s, a, d) \
@@ -509,25 +676,63 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
+/**
+ * Interpolate the chroma values of a row of a YUV410 image the same way
+ * convertYUV410ToRGB() does, to convert them as a YUV444 row.
+ */
+static void interpolateYUV410Row(byte *uDst, byte *vDst, const byte *uSrc, const byte *vSrc, int y, int yWidth, int uvPitch) {
+	int quarterWidth = yWidth >> 2;
+	int yDiff = y & 3;
+
+	for (int x = 0; x < quarterWidth; x++) {
+		int index = (y >> 2) * uvPitch + x;
+
+		READ_QUAD(uSrc, u);
+		READ_QUAD(vSrc, v);
+
+		for (int xDiff = 0; xDiff < 4; xDiff++) {
+			byte u, v;
+			DO_INTERPOLATION(u);
+			DO_INTERPOLATION(v);
+			*uDst++ = u;
+			*vDst++ = v;
+		}
+	}
+}
+
 #undef READ_QUAD
 #undef DO_INTERPOLATION
 #undef DO_YUV410_PIXEL
 
 void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
 	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	convert410((byte *)dst->getPixels(), dst->pitch, dst->format, scale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+void YUVToRGBManager::convert410(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst);
+	assert(dstFormat.bytesPerPixel == 2 || dstFormat.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 	assert((yWidth & 3) == 0);
 	assert((yHeight & 3) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVToRGBLookup *lookup = getLookup(dstFormat, scale);
+
+	if (convertRow444Func && lookup->hasRowParams()) {
+		Common::Array<byte> uRow(yWidth), vRow(yWidth);
+		for (int h = 0; h < yHeight; h++) {
+			interpolateYUV410Row(uRow.data(), vRow.data(), uSrc, vSrc, h, yWidth, uvPitch);
+			convertRow444Func(dst + h * dstPitch, ySrc + h * yPitch, uRow.data(), vRow.data(), yWidth, lookup->getRowParams());
+		}
+		return;
+	}
 
 	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	if (dstFormat.bytesPerPixel == 2)
+		convertYUV410ToRGB<uint16>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV410ToRGB<uint32>(dst, dstPitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
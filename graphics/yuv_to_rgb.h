@@ -68,6 +68,18 @@ public:
 	 */
 	void convert444(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV444 image to RGB pixels in a buffer, such as a texture of
+	 * the backend, instead of a surface.
+	 *
+	 * @param dst       the pixels to write to
+	 * @param dstPitch  the pitch of the destination pixels
+	 * @param dstFormat the format of the destination pixels (2 or 4 bytes per pixel)
+	 *
+	 * @see convert444()
+	 */
+	void convert444(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 	/**
 	 * Convert a YUV422 image to an RGB surface
 	 *
@@ -83,6 +95,13 @@ public:
 	 */
 	void convert422(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV422 image to RGB pixels in a buffer.
+	 *
+	 * @see convert422(), convert444()
+	 */
+	void convert422(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 	/**
 	 * Convert a YUV420 image to an RGB surface
 	 *
@@ -98,6 +117,13 @@ public:
 	 */
 	void convert420(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV420 image to RGB pixels in a buffer.
+	 *
+	 * @see convert420(), convert444()
+	 */
+	void convert420(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
 	/**
 	 * Convert a YUV420 image with Alpha component to an ARGB surface
 	 *
@@ -135,6 +161,58 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Convert a YUV410 image to RGB pixels in a buffer.
+	 *
+	 * @see convert410(), convert444()
+	 */
+	void convert410(byte *dst, int dstPitch, const Graphics::PixelFormat &dstFormat, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
+	/**
+	 * The values for converting pixels without the lookup tables.
+	 *
+	 * The contribution of a chroma value c (minus 128) to a color component
+	 * is (|c| * mul) >> 14, with the sign of c times the one of mul. The
+	 * multipliers are picked to give exactly the values of the tables.
+	 */
+	struct RowParams {
+		int16 crRMul, crGMul, cbGMul, cbBMul;
+		LuminanceScale scale;
+		byte bytesPerPixel;
+		byte rLoss, gLoss, bLoss;
+		byte rShift, gShift, bShift;
+		uint32 aMask;
+	};
+
+	/**
+	 * Convert a row of pixels, with a u and v value for each pixel (444),
+	 * or for each two pixels (422 and 420, the width has to be even).
+	 */
+	typedef void (*RowFunc)(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+
+	/**
+	 * The row conversions used instead of the lookup tables, picked when
+	 * the manager is created. Without SIMD instructions, these are 0 and
+	 * the lookup tables are used.
+	 */
+	static RowFunc convertRow444Func;
+	static RowFunc convertRow422Func;
+
+	static void convertRow444Generic(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+	static void convertRow422Generic(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+#ifdef SCUMMVM_NEON
+	static void convertRow444NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+	static void convertRow422NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void convertRow444SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+	static void convertRow422SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void convertRow444AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+	static void convertRow422AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const RowParams &params);
+#endif
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -22,6 +22,7 @@
 // NB: This is really only necessary if USE_READLINE is defined
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
+#include "common/archive.h"
 #include "common/file.h"
 #include "common/debug.h"
 #include "common/debug-channels.h"
@@ -29,7 +30,6 @@
 
 #ifndef DISABLE_MD5
 #include "common/md5.h"
-#include "common/archive.h"
 #include "common/macresman.h"
 #include "common/stream.h"
 #endif
@@ -76,6 +76,7 @@ Debugger::Debugger() {
 	registerCmd("clear",			WRAP_METHOD(Debugger, cmdClearLog));
 	registerCmd("cls",			WRAP_METHOD(Debugger, cmdClearLog)); // alias
 	registerCmd("exec",				WRAP_METHOD(Debugger, cmdExecFile));
+	registerCmd("archive_stats",	WRAP_METHOD(Debugger, cmdArchiveStats));
 
 	registerCmd("debuglevel",		WRAP_METHOD(Debugger, cmdDebugLevel));
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
@@ -819,6 +820,22 @@ bool Debugger::cmdClearLog(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmdArchiveStats(int argc, const char **argv) {
+	if (argc > 1 && !strcmp(argv[1], "reset")) {
+		SearchMan.resetLookupStats();
+		debugPrintf("Archive lookup statistics reset\n");
+		return true;
+	}
+
+	Common::SearchSet::LookupStatsList stats;
+	SearchMan.getLookupStats(stats);
+
+	debugPrintf("Lookups  Misses  Archive\n");
+	for (Common::SearchSet::LookupStatsList::const_iterator i = stats.begin(); i != stats.end(); ++i)
+		debugPrintf("%7u %7u  %s\n", i->lookups, i->misses, i->name.c_str());
+	return true;
+}
+
 bool Debugger::cmdExecFile(int argc, const char **argv) {
 	if (argc <= 1) {
 		debugPrintf("Expected to get the file with debug commands\n");
@@ -213,6 +213,7 @@ void MassAddDialog::handleTickle() {
 		//
 		// However, we only add games which are not already in the config file.
 		DetectedGames candidates = detectionResults.listRecognizedGames();
+		bool gamesAdded = false;
 		for (DetectedGames::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
 			const DetectedGame &result = *cand;
 
@@ -245,15 +246,14 @@ void MassAddDialog::handleTickle() {
 				}
 			}
 			_games.push_back(result);
-
-			_list->append(result.description);
-		}
-
-		for (DetectedGame &game : _games) {
-			game.isSelected = true;
+			_games.back().isSelected = true;
+			gamesAdded = true;
 		}
 
-		updateGameList();
+		// Rebuilding the list gets slow with many games, so only do it when
+		// this directory contributed any.
+		if (gamesAdded)
+			updateGameList();
 
 		// Recurse into all subdirs
 		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
@@ -19,6 +19,8 @@
  *
  */
 
+#include "common/array.h"
+#include "common/bitarray.h"
 #include "common/list.h"
 #include "common/scummsys.h"
 
@@ -73,6 +75,46 @@ inline uint16 makeQuickTimeDitherColor(byte r, byte g, byte b) {
 
 } // End of anonymous namespace
 
+void Codec::blocksToRects(const Common::BitArray &blocks, uint blocksPerRow, uint blockWidth, uint blockHeight,
+                          uint width, uint height, Common::List<Common::Rect> &rects) {
+	typedef Common::List<Common::Rect>::iterator RectIterator;
+
+	rects.clear();
+
+	// The rectangles ending in the previous row of blocks, from left to right
+	Common::Array<RectIterator> open, next;
+
+	const uint rows = blocks.size() / blocksPerRow;
+	for (uint by = 0; by < rows && by * blockHeight < height; by++) {
+		const uint top = by * blockHeight;
+		const uint bottom = MIN(top + blockHeight, height);
+		uint o = 0;
+
+		next.clear();
+		for (uint bx = 0; bx < blocksPerRow && bx * blockWidth < width; bx++) {
+			if (!blocks.get(by * blocksPerRow + bx))
+				continue;
+
+			const uint left = bx * blockWidth;
+			while (bx + 1 < blocksPerRow && blocks.get(by * blocksPerRow + bx + 1))
+				bx++;
+			const uint right = MIN((bx + 1) * blockWidth, width);
+
+			while (o < open.size() && (uint)open[o]->left < left)
+				o++;
+
+			if (o < open.size() && (uint)open[o]->left == left && (uint)open[o]->right == right) {
+				open[o]->bottom = bottom;
+				next.push_back(open[o++]);
+			} else {
+				rects.push_back(Common::Rect(left, top, right, bottom));
+				next.push_back(--rects.end());
+			}
+		}
+		open.swap(next);
+	}
+}
+
 byte *Codec::createQuickTimeDitherTable(const byte *palette, uint colorCount) {
 	byte *buf = new byte[0x10000]();
 
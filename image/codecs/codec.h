@@ -22,12 +22,16 @@
 #ifndef IMAGE_CODECS_CODEC_H
 #define IMAGE_CODECS_CODEC_H
 
+#include "common/list.h"
+#include "common/rect.h"
+
 #include "graphics/surface.h"
 #include "graphics/pixelformat.h"
 
 #include "image/codec-options.h"
 
 namespace Common {
+class BitArray;
 class SeekableReadStream;
 }
 
@@ -123,6 +127,22 @@ public:
 	 */
 	virtual void setCodecAccuracy(CodecAccuracy accuracy) {}
 
+	/**
+	 * Get the areas of the surface changed by the last decodeFrame() call.
+	 *
+	 * By default, this returns 0, meaning that the whole surface has to
+	 * be treated as changed.
+	 */
+	virtual const Common::List<Common::Rect> *getDirtyRects() const { return 0; }
+
+	/**
+	 * Turn a bitmap of changed blocks into rectangles clipped to the
+	 * given size. Runs of changed blocks in a row of blocks are merged
+	 * with the same runs in the rows below.
+	 */
+	static void blocksToRects(const Common::BitArray &blocks, uint blocksPerRow, uint blockWidth, uint blockHeight,
+	                          uint width, uint height, Common::List<Common::Rect> &rects);
+
 	/**
 	 * Create a dither table, as used by QuickTime codecs.
 	 */
@@ -428,6 +428,8 @@ const Graphics::Surface *QTRLEDecoder::decodeFrame(Common::SeekableReadStream &s
 	uint16 startLine = 0;
 	uint16 height = _height;
 
+	_dirtyRects.clear();
+
 	// check if this frame is even supposed to change
 	if (stream.size() < 8)
 		return _surface;
@@ -484,6 +486,10 @@ const Graphics::Surface *QTRLEDecoder::decodeFrame(Common::SeekableReadStream &s
 		error("Unsupported QTRLE bits per pixel %d", _bitsPerPixel);
 	}
 
+	// Only the lines given in the header can change
+	if (startLine < _height)
+		_dirtyRects.push_back(Common::Rect(0, startLine, _width, MIN<uint32>(startLine + height, _height)));
+
 	return _surface;
 }
 
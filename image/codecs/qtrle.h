@@ -45,10 +45,12 @@ public:
 	bool hasDirtyPalette() const override { return _dirtyPalette; }
 	bool canDither(DitherType type) const override;
 	void setDither(DitherType type, const byte *palette) override;
+	const Common::List<Common::Rect> *getDirtyRects() const override { return &_dirtyRects; }
 
 private:
 	byte _bitsPerPixel;
 	Graphics::Surface *_surface;
+	Common::List<Common::Rect> _dirtyRects;
 	uint16 _width, _height;
 	uint32 _paddedWidth;
 	byte *_ditherPalette;
@@ -62,6 +62,11 @@ RPZADecoder::~RPZADecoder() {
 	if (totalBlocks < 0) \
 		error("rpza block counter just went negative (this should not happen)") \
 
+#define CHANGE_BLOCK() \
+	if (totalBlocks > 0) \
+		changedBlocks.set(blockWidth * blockHeight - totalBlocks); \
+	ADVANCE_BLOCK()
+
 struct BlockDecoderRaw {
 	static inline void drawFillBlock(uint16 *blockPtr, uint16 pitch, uint16 color, const byte *colorMap) {
 		blockPtr[0] = color;
@@ -205,7 +210,7 @@ struct BlockDecoderDither {
 };
 
 template<typename PixelInt, typename BlockDecoder>
-static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt *ptr, uint16 pitch, uint16 blockWidth, uint16 blockHeight, const byte *colorMap) {
+static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt *ptr, uint16 pitch, uint16 blockWidth, uint16 blockHeight, const byte *colorMap, Common::BitArray &changedBlocks) {
 	uint16 colorA = 0, colorB = 0;
 	uint16 color4[4];
 
@@ -262,7 +267,7 @@ static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt
 
 			while (numBlocks--) {
 				BlockDecoder::drawFillBlock(blockPtr, pitch, colorA, colorMap);
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -302,7 +307,7 @@ static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt
 				stream.read(indexes, 4);
 
 				BlockDecoder::drawBlendBlock(blockPtr, pitch, color4, indexes, colorMap);
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -315,7 +320,7 @@ static inline void decodeFrameTmpl(Common::SeekableReadStream &stream, PixelInt
 				colors[i + 1] = stream.readUint16BE();
 
 			BlockDecoder::drawRawBlock(blockPtr, pitch, colors, colorMap);
-			ADVANCE_BLOCK();
+			CHANGE_BLOCK();
 			break;
 		}
 
@@ -336,13 +341,17 @@ const Graphics::Surface *RPZADecoder::decodeFrame(Common::SeekableReadStream &st
 		// Adjust width/height to be the right ones
 		_surface->w = _width;
 		_surface->h = _height;
+
+		_changedBlocks.set_size(_blockWidth * _blockHeight);
 	}
 
+	_changedBlocks.clear();
 	if (_colorMap)
-		decodeFrameTmpl<byte, BlockDecoderDither>(stream, (byte *)_surface->getPixels(), _surface->pitch, _blockWidth, _blockHeight, _colorMap);
+		decodeFrameTmpl<byte, BlockDecoderDither>(stream, (byte *)_surface->getPixels(), _surface->pitch, _blockWidth, _blockHeight, _colorMap, _changedBlocks);
 	else
-		decodeFrameTmpl<uint16, BlockDecoderRaw>(stream, (uint16 *)_surface->getPixels(), _surface->pitch / 2, _blockWidth, _blockHeight, _colorMap);
+		decodeFrameTmpl<uint16, BlockDecoderRaw>(stream, (uint16 *)_surface->getPixels(), _surface->pitch / 2, _blockWidth, _blockHeight, _colorMap, _changedBlocks);
 
+	blocksToRects(_changedBlocks, _blockWidth, 4, 4, _width, _height, _dirtyRects);
 	return _surface;
 }
 
@@ -22,6 +22,7 @@
 #ifndef IMAGE_CODECS_RPZA_H
 #define IMAGE_CODECS_RPZA_H
 
+#include "common/bitarray.h"
 #include "graphics/pixelformat.h"
 #include "image/codecs/codec.h"
 
@@ -45,10 +46,13 @@ public:
 	bool hasDirtyPalette() const override { return _dirtyPalette; }
 	bool canDither(DitherType type) const override;
 	void setDither(DitherType type, const byte *palette) override;
+	const Common::List<Common::Rect> *getDirtyRects() const override { return &_dirtyRects; }
 
 private:
 	Graphics::PixelFormat _format;
 	Graphics::Surface *_surface;
+	Common::BitArray _changedBlocks;
+	Common::List<Common::Rect> _dirtyRects;
 	byte *_ditherPalette;
 	bool _dirtyPalette;
 	byte *_colorMap;
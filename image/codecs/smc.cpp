@@ -44,9 +44,18 @@ namespace Image {
 	} \
 }
 
+#define CHANGE_BLOCK() \
+{ \
+	uint32 changedBlock = rowPtr / (_surface->w * 4) * blocksPerRow + pixelPtr / 4; \
+	if (changedBlock < _changedBlocks.size()) \
+		_changedBlocks.set(changedBlock); \
+	ADVANCE_BLOCK(); \
+}
+
 SMCDecoder::SMCDecoder(uint16 width, uint16 height) {
 	_surface = new Graphics::Surface();
 	_surface->create(width, height, Graphics::PixelFormat::createFormatCLUT8());
+	_changedBlocks.set_size(((width + 3) / 4) * ((height + 3) / 4));
 }
 
 SMCDecoder::~SMCDecoder() {
@@ -80,7 +89,13 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 	if (chunkSize != stream.size())
 		warning("MOV chunk size != SMC chunk size (%d != %d); ignoring SMC chunk size", chunkSize, (int)stream.size());
 
-	int32 totalBlocks = ((_surface->w + 3) / 4) * ((_surface->h + 3) / 4);
+	const uint32 blocksPerRow = (_surface->w + 3) / 4;
+	int32 totalBlocks = blocksPerRow * ((_surface->h + 3) / 4);
+
+	// Anything may have changed if the frame turns out to be broken
+	_changedBlocks.clear();
+	_dirtyRects.clear();
+	_dirtyRects.push_back(Common::Rect(_surface->w, _surface->h));
 
 	uint32 pixelSize = _surface->w * _surface->h;
 
@@ -141,7 +156,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 					blockPtr += rowInc;
 					prevBlockPtr += rowInc;
 				}
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -191,7 +206,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 					blockPtr += rowInc;
 					prevBlockPtr += rowInc;
 				}
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -212,7 +227,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 
 					blockPtr += rowInc;
 				}
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -262,7 +277,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 
 					blockPtr += rowInc;
 				}
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -309,7 +324,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 					}
 					blockPtr += rowInc;
 				}
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -378,7 +393,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 
 					blockPtr += rowInc;
 				}
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -398,7 +413,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 
 					blockPtr += rowInc;
 				}
-				ADVANCE_BLOCK();
+				CHANGE_BLOCK();
 			}
 			break;
 
@@ -411,6 +426,7 @@ const Graphics::Surface *SMCDecoder::decodeFrame(Common::SeekableReadStream &str
 		}
 	}
 
+	blocksToRects(_changedBlocks, blocksPerRow, 4, 4, _surface->w, _surface->h, _dirtyRects);
 	return _surface;
 }
 
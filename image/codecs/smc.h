@@ -22,6 +22,8 @@
 #ifndef IMAGE_CODECS_SMC_H
 #define IMAGE_CODECS_SMC_H
 
+#include "common/bitarray.h"
+
 #include "image/codecs/codec.h"
 
 namespace Image {
@@ -45,9 +47,12 @@ public:
 
 	const Graphics::Surface *decodeFrame(Common::SeekableReadStream &stream) override;
 	Graphics::PixelFormat getPixelFormat() const override { return Graphics::PixelFormat::createFormatCLUT8(); }
+	const Common::List<Common::Rect> *getDirtyRects() const override { return &_dirtyRects; }
 
 private:
 	Graphics::Surface *_surface;
+	Common::BitArray _changedBlocks;
+	Common::List<Common::Rect> _dirtyRects;
 
 	// SMC color tables
 	byte _colorPairs[COLORS_PER_TABLE * CPAIR];
@@ -0,0 +1,267 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+#include "audio/rate_intern.h"
+#include "audio/audiostream.h"
+
+#include "common/system.h"
+#include "common/mutex.h"
+#include "common/debug.h"
+
+#include "helper.h"
+#include "../null_osystem.h"
+#include "../instrset_detect.h"
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kOutputRate = 44100,
+		kBufferSamples = 512
+	};
+
+	Audio::MixerImpl *createMixer(bool nonBlocking) {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(kOutputRate, true, kBufferSamples, nonBlocking);
+		mixer->setReady(true);
+		return mixer;
+	}
+
+	Audio::SoundHandle playSine(Audio::Mixer *mixer, int id, int time = 1) {
+		Audio::SoundHandle handle;
+		mixer->playStream(Audio::Mixer::kSFXSoundType, &handle, createSineStream<int16>(22050, time, nullptr, false, false), id);
+		return handle;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+
+		// The null backend cannot be asked for the CPU features
+		Audio::StereoMix::mixFunc = Audio::StereoMix::mixGeneric;
+		Audio::SincFilter::dotFunc = Audio::SincFilter::dotGeneric;
+#ifdef SCUMMVM_NEON
+		Audio::StereoMix::mixFunc = Audio::StereoMix::mixNEON;
+		Audio::SincFilter::dotFunc = Audio::SincFilter::dotNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			Audio::StereoMix::mixFunc = Audio::StereoMix::mixSSE2;
+			Audio::SincFilter::dotFunc = Audio::SincFilter::dotSSE2;
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			Audio::StereoMix::mixFunc = Audio::StereoMix::mixAVX2;
+			Audio::SincFilter::dotFunc = Audio::SincFilter::dotAVX2;
+		}
+#endif
+	}
+
+	void test_nonblocking_handle_state() {
+		if (!g_system)
+			return;
+
+		Audio::MixerImpl *mixer = createMixer(true);
+		TS_ASSERT(mixer->isNonBlocking());
+
+		// The engine side must see its own requests immediately, before the
+		// mixer thread got a chance to process them.
+		Audio::SoundHandle handle = playSine(mixer, 42);
+		TS_ASSERT(mixer->isSoundHandleActive(handle));
+		TS_ASSERT(mixer->isSoundIDActive(42));
+		TS_ASSERT_EQUALS(mixer->getSoundID(handle), 42);
+		TS_ASSERT(mixer->hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+		TS_ASSERT_EQUALS(mixer->getChannelRate(handle), 22050u);
+
+		mixer->setChannelVolume(handle, 100);
+		mixer->setChannelBalance(handle, -20);
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle), 100);
+		TS_ASSERT_EQUALS(mixer->getChannelBalance(handle), -20);
+		TS_ASSERT_EQUALS(mixer->getElapsedTime(handle).totalNumberOfFrames(), 0);
+
+		byte buffer[kBufferSamples * 4];
+		mixer->mixCallback(buffer, sizeof(buffer));
+		TS_ASSERT(mixer->getElapsedTime(handle).totalNumberOfFrames() >= 0);
+		TS_ASSERT(mixer->isSoundHandleActive(handle));
+
+		mixer->stopHandle(handle);
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+		TS_ASSERT(!mixer->isSoundIDActive(42));
+		mixer->mixCallback(buffer, sizeof(buffer));
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+
+		// Channels which run out of data are released by the mixer thread
+		handle = playSine(mixer, -1);
+		for (int i = 0; i < 4 * kOutputRate / kBufferSamples; i++)
+			mixer->mixCallback(buffer, sizeof(buffer));
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+
+		delete mixer;
+	}
+
+	void test_nonblocking_output_matches_blocking() {
+		if (!g_system)
+			return;
+
+		Audio::MixerImpl *mixers[2] = { createMixer(false), createMixer(true) };
+		Audio::SoundHandle handles[2][3];
+		byte buffers[2][kBufferSamples * 4];
+
+		for (int m = 0; m < 2; m++) {
+			for (int c = 0; c < 3; c++)
+				handles[m][c] = playSine(mixers[m], c);
+			mixers[m]->setChannelVolume(handles[m][0], 64);
+			mixers[m]->setChannelBalance(handles[m][1], 127);
+			mixers[m]->setVolumeForSoundType(Audio::Mixer::kSFXSoundType, 200);
+		}
+
+		for (int i = 0; i < 32; i++) {
+			for (int m = 0; m < 2; m++) {
+				if (i == 8)
+					mixers[m]->pauseHandle(handles[m][2], true);
+				if (i == 16)
+					mixers[m]->stopID(1);
+				if (i == 24)
+					mixers[m]->setChannelRate(handles[m][0], 11025);
+				mixers[m]->mixCallback(buffers[m], sizeof(buffers[m]));
+			}
+			TS_ASSERT_EQUALS(memcmp(buffers[0], buffers[1], sizeof(buffers[0])), 0);
+		}
+
+		for (int m = 0; m < 2; m++) {
+			TS_ASSERT(!mixers[m]->isSoundIDActive(1));
+			mixers[m]->stopAll();
+			TS_ASSERT(!mixers[m]->hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+			delete mixers[m];
+		}
+	}
+
+	void test_nonblocking_without_callbacks() {
+		if (!g_system)
+			return;
+
+		// Without any mixer callback, requests pile up in the queue until
+		// they overflow the command ring. The callback must still apply
+		// them in order, so the last volume set wins.
+		Audio::MixerImpl *mixer = createMixer(true);
+		Audio::SoundHandle handle = playSine(mixer, -1);
+		for (int i = 0; i < 4096; i++)
+			mixer->setChannelVolume(handle, (4095 - i) & 0xFF);
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle), 0);
+		TS_ASSERT(mixer->isSoundHandleActive(handle));
+
+		byte buffer[kBufferSamples * 4];
+		byte silence[kBufferSamples * 4];
+		memset(silence, 0, sizeof(silence));
+		mixer->mixCallback(buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(memcmp(buffer, silence, sizeof(buffer)), 0);
+
+		// The same again, this time applied by stopping the channel
+		for (int i = 0; i < 4096; i++)
+			mixer->setChannelVolume(handle, i & 0xFF);
+		TS_ASSERT(mixer->isSoundHandleActive(handle));
+		mixer->stopHandle(handle);
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+		delete mixer;
+	}
+
+	void test_mixer_stress() {
+#if TEST_THREADS_ARE_AVAILABLE
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const int iters = 20000;
+#else
+		const int iters = 200;
+#endif
+
+		// Hammers the engine-facing API while a second thread runs the
+		// mixer callbacks, and reports how long the callbacks take in
+		// both modes. Streams are freed right after stopping them, like
+		// engines do, so stopping must not return while they are mixed.
+		for (int nonBlocking = 0; nonBlocking < 2; nonBlocking++) {
+			MixerThread mixerThread(createMixer(nonBlocking != 0));
+			Audio::Mixer *engineMixer = mixerThread.mixer;
+			Audio::SoundHandle handles[16];
+			Audio::AudioStream *streams[16];
+			for (int c = 0; c < 16; c++) {
+				streams[c] = Audio::makeSilentAudioStream(22050, false);
+				engineMixer->playStream(Audio::Mixer::kSFXSoundType, &handles[c], streams[c], c, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO);
+			}
+
+			void *thread = Common::start_test_thread(runMixerThread, &mixerThread);
+			TS_ASSERT(thread);
+			if (!thread)
+				return;
+
+			uint32 start = g_system->getMillis();
+			for (int i = 0; i < iters; i++) {
+				for (int j = 0; j < 64; j++) {
+					const int c = j & 15;
+					engineMixer->isSoundHandleActive(handles[c]);
+					engineMixer->getSoundElapsedTime(handles[c]);
+					engineMixer->setChannelVolume(handles[c], j * 4);
+					if ((j & 7) == 0) {
+						engineMixer->stopHandle(handles[c]);
+						delete streams[c];
+						streams[c] = Audio::makeSilentAudioStream(22050, false);
+						engineMixer->playStream(Audio::Mixer::kSFXSoundType, &handles[c], streams[c], c, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO);
+					}
+				}
+			}
+			uint32 engineTime = g_system->getMillis() - start;
+
+			{
+				Common::StackLock lock(mixerThread.mutex);
+				mixerThread.done = true;
+			}
+			Common::join_test_thread(thread);
+
+			debug("%s mixer: engine side %u ms, %u callbacks in %u ms, worst callback %u ms",
+			      nonBlocking ? "Non-blocking" : "Blocking", engineTime, mixerThread.callbacks, mixerThread.callbackTime, mixerThread.maxCallbackTime);
+
+			engineMixer->stopAll();
+			for (int c = 0; c < 16; c++)
+				delete streams[c];
+			delete mixerThread.mixer;
+		}
+#endif
+	}
+
+private:
+	struct MixerThread {
+		MixerThread(Audio::MixerImpl *m) : mixer(m), done(false), callbacks(0), callbackTime(0), maxCallbackTime(0) {}
+
+		Audio::MixerImpl *mixer;
+		Common::Mutex mutex;
+		bool done;
+		uint32 callbacks;
+		uint32 callbackTime;
+		uint32 maxCallbackTime;
+	};
+
+	static void runMixerThread(void *arg) {
+		MixerThread *thread = (MixerThread *)arg;
+		byte buffer[kBufferSamples * 4];
+
+		while (true) {
+			{
+				Common::StackLock lock(thread->mutex);
+				if (thread->done)
+					break;
+			}
+
+			uint32 start = g_system->getMillis();
+			thread->mixer->mixCallback(buffer, sizeof(buffer));
+			uint32 time = g_system->getMillis() - start;
+
+			thread->callbacks++;
+			thread->callbackTime += time;
+			thread->maxCallbackTime = MAX(thread->maxCallbackTime, time);
+		}
+	}
+};
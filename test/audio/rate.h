@@ -0,0 +1,250 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate_intern.h"
+#include "audio/mixer.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+
+#include "common/system.h"
+#include "common/debug.h"
+
+#include <math.h>
+
+#include "../null_osystem.h"
+#include "../instrset_detect.h"
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kNumFrames = 1027
+	};
+
+	uint32 _seed;
+
+	int16 randomSample() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	// A 16-bit sine stream with the given frequency and amplitude
+	Audio::AudioStream *makeSine(int rate, double freq, int amplitude, int frames, bool stereo = false) {
+		const int channels = stereo ? 2 : 1;
+		int16 *data = (int16 *)malloc(frames * channels * sizeof(int16));
+		for (int i = 0; i < frames; i++) {
+			for (int c = 0; c < channels; c++)
+				data[i * channels + c] = (int16)(sin(2 * M_PI * freq * i / rate) * amplitude);
+		}
+		return Audio::makeRawStream((const byte *)data, frames * channels * sizeof(int16), rate,
+		                            Audio::FLAG_16BITS | (stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+		                            | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                            );
+	}
+
+	// Returns the largest deviation from the ideal output sine, ignoring
+	// the first and last frames which are affected by the stream edges.
+	int measureSineError(Audio::ResamplerQuality quality, int inRate, int outRate, double freq) {
+		const int amplitude = 16000;
+		const int outFrames = outRate / 4;
+		Audio::AudioStream *input = makeSine(inRate, freq, amplitude, inRate / 2);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false, false, false, quality);
+
+		int16 *out = new int16[outFrames]();
+		TS_ASSERT_EQUALS(converter->convert(*input, out, outFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outFrames);
+
+		// The linear converter lags one input frame behind
+		const double delay = (quality == Audio::kResamplerLinear) ? 1.0 : 0.0;
+		int maxError = 0;
+		for (int i = outFrames / 8; i < outFrames - outFrames / 8; i++) {
+			const double t = (double)i * inRate / outRate - delay;
+			const int expected = (int)(sin(2 * M_PI * freq * t / inRate) * amplitude);
+			maxError = MAX(maxError, ABS(out[i] - expected));
+		}
+
+		delete[] out;
+		delete converter;
+		delete input;
+		return maxError;
+	}
+
+	void checkDotFunc(Audio::SincFilter::DotFunc func) {
+		_seed = 3;
+		int16 a[128], b[128];
+		for (int len = 8; len <= 128; len += 8) {
+			for (int i = 0; i < len; i++) {
+				a[i] = randomSample() >> 2;
+				b[i] = randomSample();
+			}
+			TS_ASSERT_EQUALS(func(a, b, len), Audio::SincFilter::dotGeneric(a, b, len));
+		}
+	}
+
+	void checkMixFunc(Audio::StereoMix::MixFunc func) {
+		_seed = 1;
+		int16 src[kNumFrames * 2], dstRef[kNumFrames * 2], dst[kNumFrames * 2];
+
+		const Audio::st_volume_t volumes[] = { 0, 1, 127, 128, 255, Audio::Mixer::kMaxMixerVolume };
+
+		for (int pass = 0; pass < 8; pass++) {
+			for (int i = 0; i < kNumFrames * 2; i++) {
+				// Include the extreme values, which exercise the saturation
+				src[i] = (pass & 1) ? (int16)((randomSample() & 1) ? -32768 : 32767) : randomSample();
+				dstRef[i] = dst[i] = randomSample();
+			}
+
+			for (int l = 0; l < ARRAYSIZE(volumes); l++) {
+				for (int r = 0; r < ARRAYSIZE(volumes); r++) {
+					// Odd frame counts and offsets exercise the scalar tail
+					const uint count = kNumFrames - (l + r);
+					Audio::StereoMix::mixGeneric(dstRef, src, count, volumes[l], volumes[r]);
+					func(dst, src, count, volumes[l], volumes[r]);
+					TS_ASSERT_EQUALS(memcmp(dst, dstRef, sizeof(dst)), 0);
+				}
+			}
+		}
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+
+		// The null backend cannot be asked for the CPU features
+		Audio::StereoMix::mixFunc = Audio::StereoMix::mixGeneric;
+		Audio::SincFilter::dotFunc = Audio::SincFilter::dotGeneric;
+#ifdef SCUMMVM_NEON
+		Audio::StereoMix::mixFunc = Audio::StereoMix::mixNEON;
+		Audio::SincFilter::dotFunc = Audio::SincFilter::dotNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			Audio::StereoMix::mixFunc = Audio::StereoMix::mixSSE2;
+			Audio::SincFilter::dotFunc = Audio::SincFilter::dotSSE2;
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			Audio::StereoMix::mixFunc = Audio::StereoMix::mixAVX2;
+			Audio::SincFilter::dotFunc = Audio::SincFilter::dotAVX2;
+		}
+#endif
+	}
+
+	void test_mix_stereo_generic() {
+		int16 src[4] = { 1000, -1000, 32767, -32768 };
+		int16 dst[4] = { 0, 0, 32000, -32000 };
+
+		Audio::StereoMix::mixGeneric(dst, src, 2, 128, Audio::Mixer::kMaxMixerVolume);
+		TS_ASSERT_EQUALS(dst[0], 500);
+		TS_ASSERT_EQUALS(dst[1], -1000);
+		TS_ASSERT_EQUALS(dst[2], 32767);
+		TS_ASSERT_EQUALS(dst[3], -32768);
+
+		// Scaling rounds towards zero
+		int16 src2[2] = { -1, -255 };
+		int16 dst2[2] = { 0, 0 };
+		Audio::StereoMix::mixGeneric(dst2, src2, 1, 1, 1);
+		TS_ASSERT_EQUALS(dst2[0], 0);
+		TS_ASSERT_EQUALS(dst2[1], 0);
+	}
+
+	void test_mix_stereo_simd() {
+#ifdef SCUMMVM_NEON
+		checkMixFunc(Audio::StereoMix::mixNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkMixFunc(Audio::StereoMix::mixSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkMixFunc(Audio::StereoMix::mixAVX2);
+#endif
+	}
+
+	void test_sinc_dot_simd() {
+#ifdef SCUMMVM_NEON
+		checkDotFunc(Audio::SincFilter::dotNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			checkDotFunc(Audio::SincFilter::dotSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			checkDotFunc(Audio::SincFilter::dotAVX2);
+#endif
+	}
+
+	void test_sinc_quality() {
+		// The filter banks are cached behind a mutex
+		if (!g_system)
+			return;
+
+		const int rates[][2] = { { 11025, 48000 }, { 22050, 44100 }, { 22050, 48000 }, { 48000, 22050 } };
+		for (int i = 0; i < ARRAYSIZE(rates); i++) {
+			const double freq = 1000.0;
+			const int linearError = measureSineError(Audio::kResamplerLinear, rates[i][0], rates[i][1], freq);
+			const int fastError = measureSineError(Audio::kResamplerSincFast, rates[i][0], rates[i][1], freq);
+			const int bestError = measureSineError(Audio::kResamplerSincBest, rates[i][0], rates[i][1], freq);
+
+			TS_ASSERT_LESS_THAN(fastError, 200);
+			TS_ASSERT_LESS_THAN(bestError, 60);
+			TS_ASSERT_LESS_THAN_EQUALS(bestError, linearError);
+		}
+	}
+
+	void test_sinc_drains_stream() {
+		if (!g_system)
+			return;
+
+		// All of the input has to come out, including the filter latency
+		Audio::AudioStream *input = makeSine(22050, 500.0, 8000, 22050, true);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, true, true, false, Audio::kResamplerSincFast);
+
+		int16 out[1024 * 2];
+		int total = 0;
+		while (!input->endOfStream() || converter->needsDraining()) {
+			memset(out, 0, sizeof(out));
+			const int count = converter->convert(*input, out, 1024, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			if (count == 0)
+				break;
+			total += count;
+		}
+
+		TS_ASSERT(ABS(total - 44100) <= 2);
+		delete converter;
+		delete input;
+	}
+
+	void test_resampler_speed() {
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const int seconds = 60;
+#else
+		const int seconds = 1;
+#endif
+		const char *names[] = { "linear", "sinc (fast)", "sinc (best)" };
+
+		for (int quality = Audio::kResamplerLinear; quality <= Audio::kResamplerSincBest; quality++) {
+			Audio::AudioStream *input = Audio::makeLoopingAudioStream(dynamic_cast<Audio::RewindableAudioStream *>(makeSine(22050, 440.0, 8000, 22050, true)), 0);
+			Audio::RateConverter *converter = Audio::makeRateConverter(22050, 48000, true, true, false, (Audio::ResamplerQuality)quality);
+			int16 out[1024 * 2];
+
+			const uint32 start = g_system->getMillis();
+			for (int i = 0; i < seconds * 48000 / 1024; i++)
+				converter->convert(*input, out, 1024, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			const uint32 time = g_system->getMillis() - start;
+
+			debug("Resampling %d s of stereo 22050 Hz audio to 48000 Hz with the %s converter: %u ms", seconds, names[quality], time);
+			delete converter;
+			delete input;
+		}
+	}
+};
@@ -0,0 +1,146 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "common/system.h"
+#include "common/compression/deflate.h"
+
+#include "../null_osystem.h"
+
+class GZipReadStreamTestSuite : public CxxTest::TestSuite {
+	Common::Array<byte> _data;
+	byte *_compressed;
+	uint32 _compressedSize;
+
+	/** Something between text and binary which compresses fairly well. */
+	void generateData(uint32 size) {
+		Common::RandomSource rnd("gzipreadstream");
+		rnd.setSeed(42);
+		_data.resize(size);
+		for (uint32 i = 0; i < size; ) {
+			uint32 run = MIN<uint32>(rnd.getRandomNumberRng(1, 64), size - i);
+			if (i > 1024 && rnd.getRandomBit()) {
+				uint32 from = i - rnd.getRandomNumberRng(1, 1024);
+				for (uint32 j = 0; j < run; j++)
+					_data[i + j] = _data[from + j];
+			} else {
+				for (uint32 j = 0; j < run; j++)
+					_data[i + j] = rnd.getRandomNumber(31) + 'a';
+			}
+			i += run;
+		}
+
+		Common::MemoryWriteStreamDynamic *compressed = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *stream = Common::wrapCompressedWriteStream(compressed);
+		stream->write(_data.data(), size);
+		stream->finalize();
+		_compressedSize = compressed->size();
+		_compressed = compressed->getData();
+		delete stream;
+	}
+
+	Common::SeekableReadStream *openStream(bool indexed, uint32 maxMemory = 4 * 1024 * 1024) {
+		Common::SeekableReadStream *compressed = new Common::MemoryReadStream(_compressed, _compressedSize);
+		if (indexed)
+			return Common::wrapIndexedCompressedReadStream(compressed, 64 * 1024, maxMemory);
+		return Common::wrapCompressedReadStream(compressed);
+	}
+
+	/** Seek to random places and read a bit there. Returns false on any mismatch. */
+	bool seekAround(Common::SeekableReadStream *stream, uint32 seeks) {
+		Common::RandomSource rnd("gzipreadstream");
+		rnd.setSeed(1234);
+		byte buffer[256];
+		bool ok = true;
+
+		for (uint32 i = 0; i < seeks; i++) {
+			uint32 pos = rnd.getRandomNumber(_data.size() - sizeof(buffer));
+			stream->seek(pos);
+			ok = ok && stream->pos() == pos;
+			ok = ok && stream->read(buffer, sizeof(buffer)) == sizeof(buffer);
+			ok = ok && memcmp(buffer, &_data[pos], sizeof(buffer)) == 0;
+		}
+		return ok;
+	}
+
+public:
+	GZipReadStreamTestSuite() : _compressed(nullptr), _compressedSize(0) {}
+
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+		if (g_system && !_compressed)
+			generateData(4 * 1024 * 1024);
+	}
+
+	~GZipReadStreamTestSuite() {
+		free(_compressed);
+	}
+
+	void test_indexed_seeks() {
+		if (!g_system)
+			return;
+
+		Common::SeekableReadStream *stream = openStream(true);
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), (int64)_data.size());
+
+		// Read everything at once first, then jump around
+		Common::Array<byte> contents(_data.size());
+		TS_ASSERT_EQUALS(stream->read(contents.data(), contents.size()), _data.size());
+		TS_ASSERT(contents == _data);
+		TS_ASSERT(seekAround(stream, 50));
+
+		stream->seek(-100, SEEK_END);
+		TS_ASSERT_EQUALS(stream->readByte(), _data[_data.size() - 100]);
+		stream->seek(10);
+		TS_ASSERT_EQUALS(stream->readByte(), _data[10]);
+		delete stream;
+
+		// Jumping around before reading everything
+		stream = openStream(true);
+		TS_ASSERT(seekAround(stream, 50));
+		stream->seek(0, SEEK_END);
+		byte b;
+		TS_ASSERT_EQUALS(stream->read(&b, 1), 0U);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+		delete stream;
+	}
+
+	void test_checkpoint_memory_cap() {
+		if (!g_system)
+			return;
+
+		// Room for a few checkpoints only, which get thinned out
+		Common::SeekableReadStream *stream = openStream(true, 200 * 1024);
+		TS_ASSERT(seekAround(stream, 20));
+		stream->seek(_data.size() - 1);
+		TS_ASSERT_EQUALS(stream->readByte(), _data.back());
+		TS_ASSERT(seekAround(stream, 50));
+		delete stream;
+	}
+
+	void test_random_seek_speed() {
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const uint32 seeks = 200;
+#else
+		const uint32 seeks = 10;
+#endif
+
+		const char *names[2] = { "plain", "indexed" };
+		for (int indexed = 0; indexed < 2; indexed++) {
+			Common::SeekableReadStream *stream = openStream(indexed != 0);
+			uint32 start = g_system->getMillis();
+			TS_ASSERT(seekAround(stream, seeks));
+			debug("%u random seeks in %u KB of %s compressed data: %u ms", seeks, _data.size() / 1024, names[indexed], g_system->getMillis() - start);
+			delete stream;
+		}
+	}
+};
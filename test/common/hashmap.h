@@ -1,10 +1,52 @@
 #include <cxxtest/TestSuite.h>
 
 #include "common/hashmap.h"
+#include "common/flat-hashmap.h"
 #include "common/hash-str.h"
+#include "common/system.h"
+#include "common/debug.h"
+
+#include "../null_osystem.h"
 
 class HashMapTestSuite : public CxxTest::TestSuite
 {
+	uint32 _seed;
+
+	uint32 randomNumber() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	template<class Map>
+	uint32 timeInsert(Map &map, const Common::Array<Common::String> &keys) {
+		const uint32 start = g_system->getMillis();
+		for (uint i = 0; i < keys.size(); i++)
+			map[keys[i]] = i;
+		return g_system->getMillis() - start;
+	}
+
+	template<class Map>
+	uint32 timeLookup(const Map &map, const Common::Array<Common::String> &keys, int rounds, uint &found) {
+		const uint32 start = g_system->getMillis();
+		for (int r = 0; r < rounds; r++) {
+			for (uint i = 0; i < keys.size(); i++)
+				found += map.contains(keys[i]) ? 1 : 0;
+		}
+		return g_system->getMillis() - start;
+	}
+
+	template<class Map>
+	uint32 timeErase(Map &map, const Common::Array<Common::String> &keys) {
+		const uint32 start = g_system->getMillis();
+		for (uint i = 0; i < keys.size(); i += 2)
+			map.erase(keys[i]);
+		for (uint i = 0; i < keys.size(); i += 2)
+			map[keys[i]] = i;
+		for (uint i = 1; i < keys.size(); i += 2)
+			map.erase(keys[i]);
+		return g_system->getMillis() - start;
+	}
+
 	public:
 	void test_empty_clear() {
 		Common::HashMap<int, int> container;
@@ -231,4 +273,176 @@ class HashMapTestSuite : public CxxTest::TestSuite
 }
 
 	// TODO: Add test cases for iterators, find, ...
+
+	void test_flat_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("FOO"));
+		TS_ASSERT_EQUALS(container2.getVal("Quux"), "blub");
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(!container2.contains("foo"));
+	}
+
+	void test_flat_lookup() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+		container.setVal(2, 45);
+		TS_ASSERT_EQUALS(container[0], 17);
+		TS_ASSERT_EQUALS(container[1], -1);
+		TS_ASSERT_EQUALS(container[2], 45);
+		TS_ASSERT_EQUALS(container.size(), 3u);
+
+		const Common::FlatHashMap<int, int> &containerRef = container;
+		int val = 0;
+		TS_ASSERT(containerRef.tryGetVal(2, val));
+		TS_ASSERT_EQUALS(val, 45);
+		TS_ASSERT(!containerRef.tryGetVal(3, val));
+		TS_ASSERT_EQUALS(containerRef.getValOrDefault(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getValOrDefault(0, -10), 17);
+		TS_ASSERT_EQUALS(containerRef.getValOrDefault(17, -10), -10);
+		TS_ASSERT_EQUALS(containerRef.find(3), containerRef.end());
+		TS_ASSERT_EQUALS(containerRef.find(1)->_value, -1);
+	}
+
+	void test_flat_collision() {
+		// Keys with a common stride share the low bits of their identity
+		// hash, and erasing them has to keep the rest of the probe
+		// sequence reachable.
+		Common::FlatHashMap<int, int> h;
+		for (int i = 0; i < 64; i++)
+			h[i * 1024 + 5] = i;
+		for (int i = 0; i < 64; i += 3)
+			h.erase(i * 1024 + 5);
+		for (int i = 0; i < 64; i++) {
+			TS_ASSERT_EQUALS(h.contains(i * 1024 + 5), (i % 3) != 0);
+			if (i % 3)
+				TS_ASSERT_EQUALS(h[i * 1024 + 5], i);
+		}
+		for (Common::FlatHashMap<int, int>::iterator i = h.begin(); i != h.end(); i = h.begin())
+			h.erase(i);
+		TS_ASSERT(h.empty());
+	}
+
+	void test_flat_same_hash() {
+		// More entries with the same hash than a probe distance fits into
+		// the metadata byte must not keep growing the table.
+		struct ConstantHash {
+			uint operator()(int) const { return 42; }
+		};
+		Common::FlatHashMap<int, int, ConstantHash> h;
+		for (int i = 0; i < 1000; i++)
+			h[i] = -i;
+		for (int i = 0; i < 1000; i += 2)
+			h.erase(i);
+		TS_ASSERT_EQUALS(h.size(), 500U);
+		for (int i = 0; i < 1000; i++) {
+			TS_ASSERT_EQUALS(h.contains(i), (i % 2) != 0);
+			if (i % 2)
+				TS_ASSERT_EQUALS(h[i], -i);
+		}
+	}
+
+	void test_flat_iterator_copy() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 5; i++)
+			container[i] = i * 10;
+		container.erase(0);
+		container.erase(container.find(1));
+
+		Common::FlatHashMap<int, int> copy(container), assigned;
+		assigned[99] = 1;
+		assigned = container;
+		container[0] = 0;
+
+		int found = 0;
+		for (Common::FlatHashMap<int, int>::const_iterator j = assigned.begin(); j != assigned.end(); ++j) {
+			TS_ASSERT_EQUALS(j->_value, j->_key * 10);
+			TS_ASSERT(!(found & (1 << j->_key)));
+			found |= 1 << j->_key;
+		}
+		TS_ASSERT_EQUALS(found, 16+8+4);
+		TS_ASSERT_EQUALS(copy.size(), 3u);
+		TS_ASSERT(!copy.contains(0));
+		TS_ASSERT(!assigned.contains(99));
+	}
+
+	void test_flat_matches_hashmap() {
+		// Random inserts and erases must leave both containers with the
+		// same content.
+		Common::HashMap<uint32, uint32> reference;
+		Common::FlatHashMap<uint32, uint32> flat;
+		_seed = 1;
+
+		for (int i = 0; i < 50000; i++) {
+			const uint32 key = randomNumber() % 4096;
+			if (randomNumber() % 3 == 0) {
+				reference.erase(key);
+				flat.erase(key);
+			} else {
+				reference[key] = i;
+				flat[key] = i;
+			}
+			if ((i % 5000) == 0)
+				flat.reserve(flat.size() * 2);
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+		for (Common::HashMap<uint32, uint32>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(flat.getValOrDefault(i->_key, 0xFFFFFFFF), i->_value);
+		uint count = 0;
+		for (Common::FlatHashMap<uint32, uint32>::const_iterator i = flat.begin(); i != flat.end(); ++i, ++count)
+			TS_ASSERT(reference.contains(i->_key));
+		TS_ASSERT_EQUALS(count, reference.size());
+	}
+
+	void test_hashmap_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const uint numKeys = 1000000;
+		const int rounds = 20;
+#else
+		const uint numKeys = 20000;
+		const int rounds = 5;
+#endif
+
+		Common::Array<Common::String> keys;
+		keys.reserve(numKeys);
+		for (uint i = 0; i < numKeys; i++)
+			keys.push_back(Common::String::format("data/room%u/object%u.dat", i / 64, i));
+
+		uint found = 0;
+		Common::HashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> hashMap;
+		Common::FlatHashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> flatMap;
+
+		const uint32 hashInsert = timeInsert(hashMap, keys);
+		const uint32 flatInsert = timeInsert(flatMap, keys);
+		const uint32 hashLookup = timeLookup(hashMap, keys, rounds, found);
+		const uint32 flatLookup = timeLookup(flatMap, keys, rounds, found);
+		const uint32 hashErase = timeErase(hashMap, keys);
+		const uint32 flatErase = timeErase(flatMap, keys);
+
+		TS_ASSERT_EQUALS(found, 2 * rounds * numKeys);
+		TS_ASSERT_EQUALS(hashMap.size(), flatMap.size());
+
+		debug("%u string keys, HashMap vs FlatHashMap: insert %u/%u ms, %d lookup rounds %u/%u ms, erase %u/%u ms",
+		      numKeys, hashInsert, flatInsert, rounds, hashLookup, flatLookup, hashErase, flatErase);
+	}
 };
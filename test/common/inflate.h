@@ -0,0 +1,349 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/crc.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/compression/deflate.h"
+
+#include "../null_osystem.h"
+
+namespace {
+
+/**
+ * Writes a deflate bit stream. Huffman codes are stored starting with their
+ * most significant bit, everything else starting with the least significant.
+ */
+class DeflateBitWriter {
+	Common::MemoryWriteStreamDynamic _stream;
+	uint32 _bits;
+	int _count;
+
+public:
+	DeflateBitWriter() : _stream(DisposeAfterUse::YES), _bits(0), _count(0) {}
+
+	void putBits(uint32 value, int count) {
+		_bits |= value << _count;
+		_count += count;
+		while (_count >= 8) {
+			_stream.writeByte(_bits & 0xFF);
+			_bits >>= 8;
+			_count -= 8;
+		}
+	}
+
+	void putCode(uint32 code, int length) {
+		while (length--)
+			putBits((code >> length) & 1, 1);
+	}
+
+	/** A literal of a fixed Huffman code block. */
+	void putLiteral(byte literal) {
+		if (literal < 144)
+			putCode(0x30 + literal, 8);
+		else
+			putCode(0x190 + literal - 144, 9);
+	}
+
+	/** A match of 3..10 bytes up to 4 bytes back in a fixed Huffman code block. */
+	void putMatch(uint length, uint distance) {
+		putCode(length - 2, 7);
+		putCode(distance - 1, 5);
+	}
+
+	/** A match of 258 bytes up to 4 bytes back in a fixed Huffman code block. */
+	void putLongestMatch(uint distance) {
+		putCode(0xC5, 8);
+		putCode(distance - 1, 5);
+	}
+
+	void putEndOfBlock() {
+		putCode(0, 7);
+	}
+
+	void putStored(const char *data, bool last) {
+		putBits(last ? 1 : 0, 1);
+		putBits(0, 2);
+		if (_count)
+			putBits(0, 8 - _count);
+		uint16 len = strlen(data);
+		putBits(len, 16);
+		putBits((uint16)~len, 16);
+		for (uint16 i = 0; i < len; i++)
+			putBits((byte)data[i], 8);
+	}
+
+	const byte *getData() {
+		if (_count)
+			putBits(0, 8 - _count);
+		return _stream.getData();
+	}
+
+	uint32 size() const { return _stream.size(); }
+};
+
+struct ZipMember {
+	uint32 offset, compressedSize, size, crc;
+};
+
+} // End of anonymous namespace
+
+class InflateTestSuite : public CxxTest::TestSuite {
+	const Common::Path _themeFile;
+
+	/** Find the deflated members by walking the local headers of a zip file. */
+	void listDeflatedMembers(const byte *zip, uint32 zipSize, Common::Array<ZipMember> &members) {
+		uint32 offset = 0;
+		while (offset + 30 <= zipSize && READ_LE_UINT32(zip + offset) == 0x04034b50) {
+			ZipMember member;
+			member.crc = READ_LE_UINT32(zip + offset + 14);
+			member.compressedSize = READ_LE_UINT32(zip + offset + 18);
+			member.size = READ_LE_UINT32(zip + offset + 22);
+			member.offset = offset + 30 + READ_LE_UINT16(zip + offset + 26) + READ_LE_UINT16(zip + offset + 28);
+			if (READ_LE_UINT16(zip + offset + 8) == 8)
+				members.push_back(member);
+			offset = member.offset + member.compressedSize;
+		}
+	}
+
+	byte *loadFile(const Common::Path &path, uint32 &size) {
+		Common::SeekableReadStream *file = Common::FSNode(path).createReadStream();
+		if (!file)
+			return nullptr;
+		size = file->size();
+		byte *data = (byte *)malloc(size);
+		file->read(data, size);
+		delete file;
+		return data;
+	}
+
+	/** Decompress all members with the given decompressor, returns the time taken. */
+	uint32 inflateMembers(const byte *zip, const Common::Array<ZipMember> &members, bool builtin, uint32 iterations) {
+		uint32 start = g_system->getMillis();
+		for (uint32 i = 0; i < iterations; i++) {
+			for (uint j = 0; j < members.size(); j++) {
+				const ZipMember &member = members[j];
+				Common::SeekableReadStream *compressed = new Common::MemoryReadStream(zip + member.offset, member.compressedSize);
+				Common::SeekableReadStream *stream = builtin ?
+					Common::wrapBuiltinDeflateReadStream(compressed, DisposeAfterUse::YES, member.size) :
+					Common::wrapDeflateReadStream(compressed, DisposeAfterUse::YES, member.size);
+				byte *data = (byte *)malloc(member.size);
+				stream->read(data, member.size);
+				free(data);
+				delete stream;
+			}
+		}
+		return g_system->getMillis() - start;
+	}
+
+public:
+	InflateTestSuite() : _themeFile("test/engine-data/scummmodern.zip") {}
+
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+	void test_mixed_blocks() {
+		// A fixed code block, a stored block and another fixed code block.
+		// The stored block has to pick up the bytes which were already
+		// pulled into the bit buffer.
+		DeflateBitWriter writer;
+		writer.putBits(0, 1);
+		writer.putBits(1, 2);
+		const char *text = "Inflate this";
+		for (const char *c = text; *c; c++)
+			writer.putLiteral(*c);
+		writer.putMatch(4, 4);
+		writer.putLiteral('!');
+		writer.putMatch(10, 1);
+		writer.putMatch(7, 3);
+		writer.putLiteral(0xE9);
+		writer.putEndOfBlock();
+		writer.putStored("-- stored data --", false);
+		writer.putBits(1, 1);
+		writer.putBits(1, 2);
+		writer.putLiteral('.');
+		writer.putMatch(3, 1);
+		writer.putEndOfBlock();
+
+		const byte *data = writer.getData();
+		uint32 dataSize = writer.size();
+		const char *expected = "Inflate thisthis!!!!!!!!!!!!!!!!!!\xE9-- stored data --....";
+		uint32 expectedSize = strlen(expected);
+
+		for (int builtin = 0; builtin < 2; builtin++) {
+			Common::SeekableReadStream *compressed = new Common::MemoryReadStream(data, dataSize);
+			Common::SeekableReadStream *stream = builtin ?
+				Common::wrapBuiltinDeflateReadStream(compressed) :
+				Common::wrapDeflateReadStream(compressed);
+			TS_ASSERT(stream);
+			if (!stream)
+				continue;
+
+			char buffer[64];
+			uint32 size = stream->read(buffer, sizeof(buffer));
+			TS_ASSERT_EQUALS(size, expectedSize);
+			TS_ASSERT(!stream->err());
+			TS_ASSERT(stream->eos());
+			TS_ASSERT_EQUALS(memcmp(buffer, expected, MIN(size, expectedSize)), 0);
+			delete stream;
+		}
+	}
+
+	void test_match_at_window_end() {
+		// Longest matches which end exactly at the end of the 32 KB window,
+		// with the block going on after it
+		const uint32 windowSize = 32768;
+		const uint32 matches = (windowSize - 2) / 258;
+		DeflateBitWriter writer;
+		writer.putBits(1, 1);
+		writer.putBits(1, 2);
+		writer.putLiteral('a');
+		writer.putLiteral('b');
+		for (uint32 i = 0; i < matches; i++)
+			writer.putLongestMatch(1);
+		const char *tail = "and the block goes on after the window";
+		for (const char *c = tail; *c; c++)
+			writer.putLiteral(*c);
+		writer.putEndOfBlock();
+
+		const byte *data = writer.getData();
+		uint32 dataSize = writer.size();
+		uint32 tailSize = strlen(tail);
+		uint32 expectedSize = 2 + matches * 258 + tailSize;
+		TS_ASSERT_EQUALS(expectedSize - tailSize, windowSize);
+
+		byte *expected = (byte *)malloc(expectedSize);
+		expected[0] = 'a';
+		memset(expected + 1, 'b', windowSize - 1);
+		memcpy(expected + windowSize, tail, tailSize);
+		byte *buffer = (byte *)malloc(expectedSize + 1);
+
+		for (int builtin = 0; builtin < 2; builtin++) {
+			Common::SeekableReadStream *compressed = new Common::MemoryReadStream(data, dataSize);
+			Common::SeekableReadStream *stream = builtin ?
+				Common::wrapBuiltinDeflateReadStream(compressed) :
+				Common::wrapDeflateReadStream(compressed);
+			TS_ASSERT(stream);
+			if (!stream)
+				continue;
+
+			uint32 size = stream->read(buffer, expectedSize + 1);
+			TS_ASSERT_EQUALS(size, expectedSize);
+			TS_ASSERT(!stream->err());
+			TS_ASSERT(stream->eos());
+			TS_ASSERT_EQUALS(memcmp(buffer, expected, MIN(size, expectedSize)), 0);
+			delete stream;
+		}
+
+		free(buffer);
+		free(expected);
+	}
+
+	void test_theme_archive() {
+		if (!g_system)
+			return;
+
+		uint32 zipSize;
+		byte *zip = loadFile(_themeFile, zipSize);
+		if (!zip)
+			return;
+
+		Common::Array<ZipMember> members;
+		listDeflatedMembers(zip, zipSize, members);
+		TS_ASSERT(!members.empty());
+
+		Common::CRC32 crc;
+		for (uint i = 0; i < members.size(); i++) {
+			const ZipMember &member = members[i];
+			Common::SeekableReadStream *stream = Common::wrapBuiltinDeflateReadStream(
+				new Common::MemoryReadStream(zip + member.offset, member.compressedSize), DisposeAfterUse::YES, member.size);
+
+			byte *data = (byte *)malloc(member.size);
+			TS_ASSERT_EQUALS(stream->read(data, member.size), member.size);
+			TS_ASSERT_EQUALS(crc.crcFast(data, member.size), member.crc);
+
+			// Seeking back restarts the decompression
+			uint32 middle = member.size / 2;
+			stream->seek(middle);
+			TS_ASSERT_EQUALS(stream->readByte(), data[middle]);
+			stream->seek(0);
+			TS_ASSERT_EQUALS(stream->readByte(), data[0]);
+
+			free(data);
+			delete stream;
+		}
+
+		free(zip);
+	}
+
+	void test_gzip_savegame() {
+		if (!g_system)
+			return;
+
+		uint32 dataSize;
+		byte *data = loadFile("test/engine-data/encoding.dat", dataSize);
+		if (!data)
+			return;
+
+		// Savegames are written with wrapCompressedWriteStream(), the
+		// built-in decompressor has to read them back just like the zlib
+		// based one does.
+		Common::MemoryWriteStreamDynamic *saveFile = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *saveStream = Common::wrapCompressedWriteStream(saveFile);
+		saveStream->write(data, dataSize);
+		saveStream->finalize();
+		uint32 saveSize = saveFile->size();
+		byte *save = saveFile->getData();
+		delete saveStream;
+
+		Common::SeekableReadStream *stream = Common::wrapBuiltinCompressedReadStream(new Common::MemoryReadStream(save, saveSize, DisposeAfterUse::YES));
+		TS_ASSERT(stream);
+		if (stream) {
+			TS_ASSERT_EQUALS(stream->size(), (int64)dataSize);
+			byte *contents = (byte *)malloc(dataSize);
+			TS_ASSERT_EQUALS(stream->read(contents, dataSize), dataSize);
+			TS_ASSERT_EQUALS(memcmp(contents, data, dataSize), 0);
+			free(contents);
+			delete stream;
+		}
+
+		free(data);
+	}
+
+	void test_inflate_speed() {
+		if (!g_system)
+			return;
+
+		uint32 zipSize;
+		byte *zip = loadFile(_themeFile, zipSize);
+		if (!zip)
+			return;
+
+#ifdef SLOW_TESTS
+		const uint32 iterations = 200;
+#else
+		const uint32 iterations = 2;
+#endif
+
+		Common::Array<ZipMember> members;
+		listDeflatedMembers(zip, zipSize, members);
+		uint64 totalSize = 0;
+		for (uint i = 0; i < members.size(); i++)
+			totalSize += members[i].size;
+		totalSize *= iterations;
+
+		// Without zlib, both end up in the built-in decompressor
+		const char *names[2] = { "wrapDeflateReadStream", "built-in inflate" };
+		for (int builtin = 0; builtin < 2; builtin++) {
+			uint32 time = MAX<uint32>(inflateMembers(zip, members, builtin != 0, iterations), 1);
+			debug("Inflating %u KB with %s: %u ms, %u MB/s", (uint)(totalSize / 1024), names[builtin], time, (uint)(totalSize / 1000 / time));
+		}
+
+		free(zip);
+	}
+};
@@ -0,0 +1,152 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bufferedstream.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+namespace {
+
+struct CountingDeleter {
+	int *_released;
+	CountingDeleter(int *released) : _released(released) {}
+	void operator()(const byte *ptr) { free(const_cast<byte *>(ptr)); (*_released)++; }
+};
+
+} // End of anonymous namespace
+
+class MappedFileReadStreamTestSuite : public CxxTest::TestSuite {
+	const Common::Path _dataFile;
+
+	/**
+	 * Load random "resources" the way engines do: seek to the resource and
+	 * read it into its own stream.
+	 */
+	uint32 loadResources(Common::SeekableReadStream *stream, uint32 iterations) {
+		Common::RandomSource rnd("mappedfile");
+		rnd.setSeed(12345);
+		uint32 fileSize = stream->size();
+		uint32 checksum = 0;
+
+		for (uint32 i = 0; i < iterations; i++) {
+			uint32 size = rnd.getRandomNumberRng(1, 16384);
+			uint32 offset = rnd.getRandomNumber(fileSize - size);
+			stream->seek(offset);
+
+			Common::SeekableReadStream *resource = stream->readStream(size);
+			for (uint32 j = 0; j < size; j += 64)
+				checksum = checksum * 31 + resource->readByte();
+			resource->seek(size - 1);
+			checksum += resource->readByte();
+			delete resource;
+		}
+
+		return checksum;
+	}
+
+public:
+	MappedFileReadStreamTestSuite() : _dataFile("test/engine-data/encoding.dat") {}
+
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+	void test_views() {
+		int released = 0;
+		byte *data = (byte *)malloc(256);
+		for (int i = 0; i < 256; i++)
+			data[i] = i;
+
+		Common::SeekableReadStream *stream = new Common::MappedFileReadStream(
+			Common::SharedPtr<const byte>(data, CountingDeleter(&released)), 256);
+
+		stream->seek(16);
+		Common::SeekableReadStream *view = stream->readStream(32);
+		TS_ASSERT_EQUALS(stream->pos(), 48);
+		TS_ASSERT_EQUALS(view->size(), 32);
+		TS_ASSERT_EQUALS(view->readByte(), 16);
+
+		// Views of views still share the same data
+		view->seek(8);
+		Common::SeekableReadStream *subView = view->readStream(4);
+		TS_ASSERT_EQUALS(subView->readUint32BE(), 0x18191A1BU);
+
+		// Short reads are clamped and flag the end of the stream
+		stream->seek(250);
+		Common::SeekableReadStream *tail = stream->readStream(16);
+		TS_ASSERT_EQUALS(tail->size(), 6);
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+		delete view;
+		delete tail;
+		TS_ASSERT_EQUALS(released, 0);
+
+		TS_ASSERT_EQUALS(subView->readByte(), 0);
+		TS_ASSERT(subView->eos());
+		delete subView;
+		TS_ASSERT_EQUALS(released, 1);
+	}
+
+	void test_mapped_file() {
+		if (!g_system)
+			return;
+
+		Common::FSNode node(_dataFile);
+		if (!node.exists())
+			return;
+
+		Common::SeekableReadStream *regular = node.createReadStream();
+		Common::SeekableReadStream *mapped = node.createReadStream(Common::kReadStreamMapped);
+		TS_ASSERT(regular);
+		TS_ASSERT(mapped);
+		if (!regular || !mapped)
+			return;
+
+		TS_ASSERT_EQUALS(regular->size(), mapped->size());
+		TS_ASSERT_EQUALS(loadResources(regular, 100), loadResources(mapped, 100));
+
+		delete regular;
+		delete mapped;
+	}
+
+	void test_resource_loading_speed() {
+		if (!g_system)
+			return;
+
+		Common::FSNode node(_dataFile);
+		if (!node.exists())
+			return;
+
+#ifdef SLOW_TESTS
+		const uint32 iterations = 200000;
+#else
+		const uint32 iterations = 2000;
+#endif
+
+		Common::SeekableReadStream *streams[3] = {
+			node.createReadStream(),
+			Common::wrapBufferedSeekableReadStream(node.createReadStream(), 4096, DisposeAfterUse::YES),
+			node.createReadStream(Common::kReadStreamMapped)
+		};
+		const char *names[3] = { "stdio", "buffered", "mapped" };
+
+		uint32 checksums[3];
+		for (int i = 0; i < 3; i++) {
+			uint32 start = g_system->getMillis();
+			checksums[i] = loadResources(streams[i], iterations);
+			debug("Loading %u resources from %s stream: %u ms", iterations, names[i], g_system->getMillis() - start);
+			delete streams[i];
+		}
+
+		TS_ASSERT_EQUALS(checksums[0], checksums[1]);
+		TS_ASSERT_EQUALS(checksums[0], checksums[2]);
+	}
+};
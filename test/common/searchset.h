@@ -0,0 +1,181 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+namespace {
+
+/**
+ * Archive keeping its members in memory. Each member contains its own
+ * name followed by the name of the archive, which tells where a stream
+ * came from.
+ */
+class TestArchive : public Common::Archive {
+	typedef Common::HashMap<Common::Path, bool, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> MemberMap;
+
+	Common::String _name;
+	MemberMap _members;
+	bool _listable;
+
+public:
+	TestArchive(const Common::String &name, bool listable = true) : _name(name), _listable(listable) {}
+
+	void addMember(const char *path) { _members[Common::Path(path)] = true; }
+
+	bool hasFile(const Common::Path &path) const override {
+		return _members.contains(path);
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		if (!_listable)
+			return 0;
+
+		for (MemberMap::const_iterator i = _members.begin(); i != _members.end(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(i->_key, *this)));
+		return _members.size();
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return Common::ArchiveMemberPtr();
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(path, *this));
+	}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return nullptr;
+
+		Common::String contents = path.toString() + "@" + _name;
+		byte *data = (byte *)malloc(contents.size());
+		memcpy(data, contents.c_str(), contents.size());
+		return new Common::MemoryReadStream(data, contents.size(), DisposeAfterUse::YES);
+	}
+};
+
+Common::String readOrigin(Common::SeekableReadStream *stream) {
+	if (!stream)
+		return Common::String();
+
+	Common::String contents = stream->readString(0, stream->size());
+	delete stream;
+	return contents;
+}
+
+} // End of anonymous namespace
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+	void fill(Common::SearchSet &set, bool listable) {
+		TestArchive *high = new TestArchive("high");
+		high->addMember("shared.dat");
+		high->addMember("dir/high.dat");
+
+		TestArchive *mid = new TestArchive("mid", listable);
+		mid->addMember("SHARED.DAT");
+		mid->addMember("mid.dat");
+
+		TestArchive *low = new TestArchive("low");
+		low->addMember("shared.dat");
+		low->addMember("mid.dat");
+		low->addMember("low.dat");
+
+		set.add("low", low, 0);
+		set.add("high", high, 2);
+		set.add("mid", mid, 1);
+	}
+
+	void checkLookups(Common::SearchSet &set) {
+		TS_ASSERT(set.hasFile("shared.dat"));
+		TS_ASSERT(set.hasFile("DIR/HIGH.DAT"));
+		TS_ASSERT(set.hasFile("low.dat"));
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT(!set.hasFile(""));
+
+		TS_ASSERT_EQUALS(readOrigin(set.createReadStreamForMember("Shared.dat")), "Shared.dat@high");
+		TS_ASSERT_EQUALS(readOrigin(set.createReadStreamForMember("mid.dat")), "mid.dat@mid");
+		TS_ASSERT_EQUALS(readOrigin(set.createReadStreamForMember("low.dat")), "low.dat@low");
+		TS_ASSERT(!set.createReadStreamForMember("missing.dat"));
+
+		Common::Archive *container = nullptr;
+		TS_ASSERT(set.getMember("mid.dat", &container));
+		TS_ASSERT_EQUALS(container, set.getArchive("mid"));
+		TS_ASSERT(!set.getMember("missing.dat", &container));
+	}
+
+public:
+	void test_linear_lookup() {
+		Common::SearchSet set;
+		fill(set, true);
+		checkLookups(set);
+	}
+
+	void test_indexed_lookup() {
+		Common::SearchSet set;
+		fill(set, true);
+		set.enablePathIndex();
+		checkLookups(set);
+
+		// Misses are answered by the index without asking any archive
+		set.resetLookupStats();
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT(!set.createReadStreamForMember("missing.dat"));
+		TS_ASSERT(set.hasFile("low.dat"));
+
+		Common::SearchSet::LookupStatsList stats;
+		set.getLookupStats(stats);
+		TS_ASSERT_EQUALS(stats.size(), 3U);
+		Common::SearchSet::LookupStatsList::const_iterator i = stats.begin();
+		TS_ASSERT_EQUALS(i->name, "high");
+		TS_ASSERT_EQUALS(i->lookups, 0U);
+		++i;
+		TS_ASSERT_EQUALS(i->name, "mid");
+		TS_ASSERT_EQUALS(i->lookups, 0U);
+		++i;
+		TS_ASSERT_EQUALS(i->name, "low");
+		TS_ASSERT_EQUALS(i->lookups, 1U);
+		TS_ASSERT_EQUALS(i->misses, 0U);
+	}
+
+	void test_unlisted_archive() {
+		// Archives which do not list their members, and everything behind
+		// them, must still be searched one by one.
+		Common::SearchSet set;
+		fill(set, false);
+		set.enablePathIndex();
+		checkLookups(set);
+
+		set.resetLookupStats();
+		TS_ASSERT(!set.hasFile("missing.dat"));
+
+		Common::SearchSet::LookupStatsList stats;
+		set.getLookupStats(stats);
+		Common::SearchSet::LookupStatsList::const_iterator i = stats.begin();
+		TS_ASSERT_EQUALS(i->lookups, 0U);
+		++i;
+		TS_ASSERT_EQUALS(i->lookups, 1U);
+		TS_ASSERT_EQUALS(i->misses, 1U);
+	}
+
+	void test_index_invalidation() {
+		Common::SearchSet set;
+		fill(set, true);
+		set.enablePathIndex();
+		TS_ASSERT(!set.hasFile("new.dat"));
+
+		TestArchive *extra = new TestArchive("extra");
+		extra->addMember("new.dat");
+		extra->addMember("shared.dat");
+		set.add("extra", extra, 3);
+		TS_ASSERT(set.hasFile("new.dat"));
+		TS_ASSERT_EQUALS(readOrigin(set.createReadStreamForMember("shared.dat")), "shared.dat@extra");
+
+		set.setPriority("extra", -1);
+		TS_ASSERT_EQUALS(readOrigin(set.createReadStreamForMember("shared.dat")), "shared.dat@high");
+
+		set.remove("high");
+		TS_ASSERT(!set.hasFile("dir/high.dat"));
+		TS_ASSERT_EQUALS(readOrigin(set.createReadStreamForMember("shared.dat")), "shared.dat@mid");
+
+		set.clear();
+		TS_ASSERT(!set.hasFile("shared.dat"));
+	}
+};
@@ -0,0 +1,271 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/crc.h"
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/compression/unzip.h"
+
+#include "../null_osystem.h"
+
+namespace {
+
+struct FreeDeleter {
+	void operator()(const byte *ptr) { free(const_cast<byte *>(ptr)); }
+};
+
+} // End of anonymous namespace
+
+class ZipTestSuite : public CxxTest::TestSuite {
+	struct Member {
+		const char *name;
+		Common::Array<byte> data;
+		bool deflate;
+		bool badCrc;
+	};
+
+	Common::Array<Member> _members;
+
+	void addMember(const char *name, uint32 size, bool deflate) {
+		Member member;
+		member.name = name;
+		member.deflate = deflate;
+		member.badCrc = false;
+		member.data.resize(size);
+		for (uint32 i = 0; i < size; i++)
+			member.data[i] = (byte)(i * 7 + strlen(name));
+		_members.push_back(member);
+	}
+
+	/**
+	 * Write the members into a zip file. Deflated members are made of stored
+	 * deflate blocks, so that no compressor is needed.
+	 */
+	byte *buildZip(uint32 &zipSize) {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		Common::CRC32 crc;
+		Common::Array<uint32> headerOffsets, crcs, compressedSizes;
+
+		for (uint i = 0; i < _members.size(); i++) {
+			const Member &member = _members[i];
+			Common::MemoryWriteStreamDynamic compressed(DisposeAfterUse::YES);
+			if (member.deflate) {
+				uint32 left = member.data.size();
+				const byte *src = member.data.data();
+				do {
+					uint16 blockSize = MIN<uint32>(left, 0xFFFF);
+					left -= blockSize;
+					compressed.writeByte(left ? 0 : 1);
+					compressed.writeUint16LE(blockSize);
+					compressed.writeUint16LE(~blockSize);
+					compressed.write(src, blockSize);
+					src += blockSize;
+				} while (left);
+			} else {
+				compressed.write(member.data.data(), member.data.size());
+			}
+
+			headerOffsets.push_back(zip.pos());
+			crcs.push_back(crc.crcFast(member.data.data(), member.data.size()) ^ (member.badCrc ? 1 : 0));
+			compressedSizes.push_back(compressed.size());
+
+			zip.writeUint32LE(0x04034b50);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(member.deflate ? 8 : 0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(crcs[i]);
+			zip.writeUint32LE(compressedSizes[i]);
+			zip.writeUint32LE(member.data.size());
+			zip.writeUint16LE(strlen(member.name));
+			zip.writeUint16LE(3);
+			zip.write(member.name, strlen(member.name));
+			zip.write("xyz", 3);
+			zip.write(compressed.getData(), compressed.size());
+		}
+
+		uint32 centralDir = zip.pos();
+		for (uint i = 0; i < _members.size(); i++) {
+			const Member &member = _members[i];
+			zip.writeUint32LE(0x02014b50);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(member.deflate ? 8 : 0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(crcs[i]);
+			zip.writeUint32LE(compressedSizes[i]);
+			zip.writeUint32LE(member.data.size());
+			zip.writeUint16LE(strlen(member.name));
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(headerOffsets[i]);
+			zip.write(member.name, strlen(member.name));
+		}
+
+		uint32 centralDirSize = zip.pos() - centralDir;
+		zip.writeUint32LE(0x06054b50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(_members.size());
+		zip.writeUint16LE(_members.size());
+		zip.writeUint32LE(centralDirSize);
+		zip.writeUint32LE(centralDir);
+		zip.writeUint16LE(0);
+
+		zipSize = zip.size();
+		return zip.getData();
+	}
+
+	void checkMembers(Common::Archive *archive) {
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		for (uint i = 0; i < _members.size(); i++) {
+			const Member &member = _members[i];
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(member.name);
+			TS_ASSERT(stream);
+			if (!stream)
+				continue;
+
+			TS_ASSERT_EQUALS(stream->size(), (int64)member.data.size());
+			Common::Array<byte> contents(member.data.size());
+			TS_ASSERT_EQUALS(stream->read(contents.data(), contents.size()), member.data.size());
+			TS_ASSERT(contents == member.data);
+
+			// Opening the member again must not disturb the first stream
+			Common::SeekableReadStream *again = archive->createReadStreamForMember(member.name);
+			TS_ASSERT(again);
+			uint32 middle = member.data.size() / 2;
+			stream->seek(middle);
+			TS_ASSERT_EQUALS(again->readByte(), member.data[0]);
+			TS_ASSERT_EQUALS(stream->readByte(), member.data[middle]);
+			delete again;
+			delete stream;
+		}
+
+		TS_ASSERT(!archive->createReadStreamForMember("missing.dat"));
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+
+		_members.clear();
+		addMember("small.dat", 100, false);
+		addMember("small-deflated.dat", 100, true);
+		addMember("big.dat", 200000, false);
+		addMember("big-deflated.dat", 200000, true);
+	}
+
+	void test_zip_members() {
+		if (!g_system)
+			return;
+
+		uint32 zipSize;
+		byte *zipData = buildZip(zipSize);
+		Common::Archive *archive = Common::makeZipArchive(new Common::MemoryReadStream(zipData, zipSize, DisposeAfterUse::YES));
+		checkMembers(archive);
+		delete archive;
+	}
+
+	void test_mapped_zip_members() {
+		if (!g_system)
+			return;
+
+		uint32 zipSize;
+		byte *zipData = buildZip(zipSize);
+		Common::SharedPtr<const byte> mapping(zipData, FreeDeleter());
+		Common::Archive *archive = Common::makeZipArchive(new Common::MappedFileReadStream(mapping, zipSize));
+		checkMembers(archive);
+
+		// Stored members are views into the mapping
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("small.dat");
+		TS_ASSERT(dynamic_cast<Common::MappedFileReadStream *>(stream));
+		delete stream;
+
+		delete archive;
+	}
+
+	void test_member_outlives_archive() {
+		if (!g_system)
+			return;
+
+		uint32 zipSize;
+		byte *zipData = buildZip(zipSize);
+		Common::Archive *archive = Common::makeZipArchive(new Common::MemoryReadStream(zipData, zipSize, DisposeAfterUse::YES));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("big.dat");
+		Common::SeekableReadStream *deflated = archive->createReadStreamForMember("big-deflated.dat");
+		delete archive;
+
+		// Big members are read straight from the zip file
+		TS_ASSERT(!dynamic_cast<Common::MemoryReadStream *>(stored));
+		TS_ASSERT(!dynamic_cast<Common::MemoryReadStream *>(deflated));
+
+		TS_ASSERT(stored && deflated);
+		if (stored && deflated) {
+			stored->seek(12345);
+			deflated->seek(12345);
+			TS_ASSERT_EQUALS(stored->readByte(), _members[2].data[12345]);
+			TS_ASSERT_EQUALS(deflated->readByte(), _members[3].data[12345]);
+		}
+		delete stored;
+		delete deflated;
+	}
+
+	void test_streamed_member_crc() {
+		if (!g_system)
+			return;
+
+		addMember("corrupt-deflated.dat", 200000, true);
+		_members[4].badCrc = true;
+
+		uint32 zipSize;
+		byte *zipData = buildZip(zipSize);
+		Common::Archive *archive = Common::makeZipArchive(new Common::MemoryReadStream(zipData, zipSize, DisposeAfterUse::YES));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::Array<byte> contents(200000);
+		const char *names[2] = { "big-deflated.dat", "corrupt-deflated.dat" };
+		for (int i = 0; i < 2; i++) {
+			const Common::Array<byte> &data = _members[3 + i].data;
+
+			// Read through, the CRC is checked at the end
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(names[i]);
+			TS_ASSERT(stream);
+			if (!stream)
+				continue;
+			TS_ASSERT_EQUALS(stream->read(contents.data(), 100000), 100000U);
+			TS_ASSERT(!stream->err());
+			TS_ASSERT(stream->seek(150000));
+			TS_ASSERT_EQUALS(stream->read(contents.data() + 150000, 50000), 50000U);
+			TS_ASSERT_EQUALS(stream->err(), i == 1);
+			delete stream;
+
+			// Seek back and forth, the whole member is checked once
+			stream = archive->createReadStreamForMember(names[i]);
+			stream->seek(1000);
+			for (uint32 pos = 190000; pos > 0; pos -= 10000) {
+				TS_ASSERT(stream->seek(pos));
+				TS_ASSERT_EQUALS(stream->readByte(), data[pos]);
+			}
+			TS_ASSERT_EQUALS(stream->err(), i == 1);
+			delete stream;
+		}
+
+		delete archive;
+	}
+};
@@ -0,0 +1,167 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/hashmap.h"
+#include "common/random.h"
+#include "common/system.h"
+
+#include "graphics/palette.h"
+#include "graphics/surface.h"
+
+#include "../null_osystem.h"
+
+class PaletteLookupTestSuite : public CxxTest::TestSuite {
+	byte _palette[3 * 256];
+
+	void randomPalette(Common::RandomSource &rnd, uint size) {
+		for (uint i = 0; i < 3 * size; i++)
+			_palette[i] = rnd.getRandomNumber(255);
+	}
+
+	/**
+	 * Compare the lookup with a full search for random colors. The lookup
+	 * keeps all 256 entries, with the ones past a shorter palette left over.
+	 */
+	bool checkColors(Common::RandomSource &rnd, Graphics::PaletteLookup &lookup, uint count) {
+		Graphics::Palette palette(_palette, 256);
+		bool ok = true;
+		for (uint i = 0; i < count; i++) {
+			uint32 color = rnd.getRandomNumber(0xFFFFFF);
+			byte r = color >> 16, g = color >> 8, b = color;
+			for (int naive = 0; naive < 2; naive++)
+				ok = ok && lookup.findBestColor(r, g, b, naive != 0) == palette.findBestColor(r, g, b, naive != 0);
+		}
+		return ok;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+	void test_find_best_color() {
+		if (!g_system)
+			return;
+
+		Common::RandomSource rnd("palette");
+		rnd.setSeed(42);
+
+		randomPalette(rnd, 256);
+		Graphics::PaletteLookup lookup(_palette, 256);
+		TS_ASSERT(checkColors(rnd, lookup, 20000));
+
+		// Few colors and duplicate entries, the first one has to win
+		randomPalette(rnd, 16);
+		memcpy(_palette + 3 * 8, _palette + 3 * 2, 3);
+		TS_ASSERT(lookup.setPalette(_palette, 16));
+		TS_ASSERT(!lookup.setPalette(_palette, 16));
+		TS_ASSERT(checkColors(rnd, lookup, 20000));
+
+		// A gray ramp, where most cells have a single candidate
+		for (uint i = 0; i < 256; i++)
+			_palette[3 * i] = _palette[3 * i + 1] = _palette[3 * i + 2] = i;
+		TS_ASSERT(lookup.setPalette(_palette, 256));
+		TS_ASSERT(checkColors(rnd, lookup, 20000));
+		TS_ASSERT_EQUALS(lookup.findBestColor(0, 0, 0), 0);
+		TS_ASSERT_EQUALS(lookup.findBestColor(255, 255, 255), 255);
+	}
+
+	void test_map_surface() {
+		if (!g_system)
+			return;
+
+		Common::RandomSource rnd("palette");
+		rnd.setSeed(1234);
+		randomPalette(rnd, 256);
+		Graphics::Palette palette(_palette, 256);
+		Graphics::PaletteLookup lookup(_palette, 256);
+
+		const Graphics::PixelFormat formats[3] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (int f = 0; f < 3; f++) {
+			Graphics::Surface src, dst;
+			src.create(37, 11, formats[f]);
+			dst.create(40, 11, Graphics::PixelFormat::createFormatCLUT8());
+
+			for (int y = 0; y < src.h; y++) {
+				for (int x = 0; x < src.w; x++) {
+					// Runs of the same color, as in most images
+					if (x % 4 == 0)
+						src.setPixel(x, y, formats[f].RGBToColor(rnd.getRandomNumber(255), rnd.getRandomNumber(255), rnd.getRandomNumber(255)));
+					else
+						src.setPixel(x, y, src.getPixel(x - 1, y));
+				}
+			}
+
+			lookup.mapSurface(src, dst);
+
+			bool ok = true;
+			for (int y = 0; y < src.h; y++) {
+				for (int x = 0; x < src.w; x++) {
+					byte r, g, b;
+					formats[f].colorToRGB(src.getPixel(x, y), r, g, b);
+					ok = ok && *(const byte *)dst.getBasePtr(x, y) == palette.findBestColor(r, g, b);
+				}
+			}
+			TS_ASSERT(ok);
+
+			src.free();
+			dst.free();
+		}
+	}
+
+	void test_lookup_speed() {
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const uint32 colors = 1000000;
+#else
+		const uint32 colors = 20000;
+#endif
+
+		Common::RandomSource rnd("palette");
+		rnd.setSeed(42);
+		randomPalette(rnd, 256);
+
+		// Colors of a photo-like image: mostly close to the previous one
+		Common::Array<uint32> input(colors);
+		int r = 128, g = 128, b = 128;
+		for (uint32 i = 0; i < colors; i++) {
+			r = CLIP<int>(r + (int)rnd.getRandomNumber(8) - 4, 0, 255);
+			g = CLIP<int>(g + (int)rnd.getRandomNumber(8) - 4, 0, 255);
+			b = CLIP<int>(b + (int)rnd.getRandomNumber(8) - 4, 0, 255);
+			input[i] = r << 16 | g << 8 | b;
+		}
+
+		// The way PaletteLookup used to remember its results
+		Graphics::Palette palette(_palette, 256);
+		Common::HashMap<int, byte> hash;
+		uint32 start = g_system->getMillis();
+		uint32 hashSum = 0;
+		for (uint32 i = 0; i < colors; i++) {
+			uint32 color = input[i];
+			if (!hash.contains(color))
+				hash[color] = palette.findBestColor(color >> 16, color >> 8, color);
+			hashSum += hash[color];
+		}
+		uint32 hashTime = g_system->getMillis() - start;
+
+		Graphics::PaletteLookup lookup(_palette, 256);
+		start = g_system->getMillis();
+		uint32 lookupSum = 0;
+		for (uint32 i = 0; i < colors; i++)
+			lookupSum += lookup.findBestColor(input[i] >> 16, input[i] >> 8, input[i]);
+		uint32 lookupTime = g_system->getMillis() - start;
+
+		TS_ASSERT_EQUALS(hashSum, lookupSum);
+		debug("Mapping %u colors: %u ms with a hash map, %u ms with PaletteLookup", colors, hashTime, lookupTime);
+	}
+};
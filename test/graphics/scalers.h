@@ -0,0 +1,298 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/debug.h"
+#include "common/random.h"
+#include "common/system.h"
+
+#include "graphics/scalerplugin.h"
+#ifdef USE_HQ_SCALERS
+#include "graphics/scaler/hq.h"
+#include "graphics/scaler/intern.h"
+#endif
+
+#include "../null_osystem.h"
+
+// The scaler plugins are static, get them without the plugin manager
+extern PluginObject *g_NORMAL_getObject();
+#ifdef USE_SCALERS
+extern PluginObject *g_DOTMATRIX_getObject();
+extern PluginObject *g_PM_getObject();
+extern PluginObject *g_SAI_getObject();
+extern PluginObject *g_SUPERSAI_getObject();
+extern PluginObject *g_SUPEREAGLE_getObject();
+extern PluginObject *g_ADVMAME_getObject();
+extern PluginObject *g_TV_getObject();
+#ifdef USE_HQ_SCALERS
+extern PluginObject *g_HQ_getObject();
+#endif
+#ifdef USE_EDGE_SCALERS
+extern PluginObject *g_EDGE_getObject();
+#endif
+#endif
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 320,
+		kHeight = 200,
+		kPadding = 4
+	};
+
+	Common::Array<ScalerPluginObject *> _plugins;
+
+	/** Something looking like a game screen: areas of plain color, gradients and edges. */
+	void drawScreen(Graphics::Surface &surface, int frame) {
+		const Graphics::PixelFormat &format = surface.format;
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				uint32 color;
+				if ((x / 40 + y / 25 + frame) % 3 == 0)
+					color = format.RGBToColor(x * 255 / surface.w, y * 255 / surface.h, 128);
+				else if ((x * x + y * y) % 97 < 30)
+					color = format.RGBToColor(255, 255, 255);
+				else
+					color = format.RGBToColor((x / 8) * 32, (y / 8) * 16, (x + y) & 0xC0);
+				surface.setPixel(x, y, color);
+			}
+		}
+	}
+
+	/** Scale the inner part of a padded surface into a new surface. */
+	void scaleScreen(Scaler *scaler, const Graphics::Surface &src, Graphics::Surface &dst) {
+		const Graphics::Surface inner = src.getSubArea(Common::Rect(kPadding, kPadding, kPadding + kWidth, kPadding + kHeight));
+		scaler->scale((const uint8 *)inner.getPixels(), inner.pitch, (uint8 *)dst.getPixels(), dst.pitch,
+		              inner.w, inner.h, 0, 0);
+	}
+
+	bool sameSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+
+#ifdef USE_HQ_SCALERS
+		// The null OSystem has no graphics manager to ask for the CPU features
+		if (!HQScaler::classifyFunc) {
+			HQScaler::classifyFunc = HQScaler::classifyGeneric;
+#ifdef SCUMMVM_NEON
+			HQScaler::classifyFunc = HQScaler::classifyNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2)
+				HQScaler::classifyFunc = HQScaler::classifySSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8)
+				HQScaler::classifyFunc = HQScaler::classifyAVX2;
+#endif
+		}
+#endif
+
+		if (_plugins.empty()) {
+			_plugins.push_back((ScalerPluginObject *)g_NORMAL_getObject());
+#ifdef USE_SCALERS
+			_plugins.push_back((ScalerPluginObject *)g_DOTMATRIX_getObject());
+			_plugins.push_back((ScalerPluginObject *)g_PM_getObject());
+			_plugins.push_back((ScalerPluginObject *)g_SAI_getObject());
+			_plugins.push_back((ScalerPluginObject *)g_SUPERSAI_getObject());
+			_plugins.push_back((ScalerPluginObject *)g_SUPEREAGLE_getObject());
+			_plugins.push_back((ScalerPluginObject *)g_ADVMAME_getObject());
+			_plugins.push_back((ScalerPluginObject *)g_TV_getObject());
+#ifdef USE_HQ_SCALERS
+			_plugins.push_back((ScalerPluginObject *)g_HQ_getObject());
+#endif
+#ifdef USE_EDGE_SCALERS
+			_plugins.push_back((ScalerPluginObject *)g_EDGE_getObject());
+#endif
+#endif
+		}
+	}
+
+	~ScalerTestSuite() {
+		for (uint i = 0; i < _plugins.size(); i++)
+			delete _plugins[i];
+	}
+
+	void test_bands() {
+		const Graphics::PixelFormat formats[2] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (int f = 0; f < 2; f++) {
+			Graphics::Surface src;
+			src.create(kWidth + 2 * kPadding, kHeight + 2 * kPadding, formats[f]);
+
+			for (uint i = 0; i < _plugins.size(); i++) {
+				ScalerPluginObject *plugin = _plugins[i];
+				const Common::Array<uint> &factors = plugin->getFactors();
+				for (uint j = 0; j < factors.size(); j++) {
+					Scaler *scalers[2] = { plugin->createInstance(formats[f]), plugin->createInstance(formats[f]) };
+					Graphics::Surface dst[2];
+					for (int k = 0; k < 2; k++) {
+						scalers[k]->setFactor(factors[j]);
+						dst[k].create(kWidth * factors[j], kHeight * factors[j], formats[f]);
+						if (plugin->useOldSource()) {
+							scalers[k]->setSource((const byte *)src.getPixels(), src.pitch, kWidth, kHeight, kPadding);
+							scalers[k]->enableSource(true);
+						}
+					}
+					scalers[1]->setBandHeight(7);
+
+					// A second frame makes the scalers using the old source
+					// compare both
+					for (int frame = 0; frame < 2; frame++) {
+						drawScreen(src, frame);
+						for (int k = 0; k < 2; k++)
+							scaleScreen(scalers[k], src, dst[k]);
+						TSM_ASSERT(plugin->getName(), sameSurfaces(dst[0], dst[1]));
+					}
+
+					for (int k = 0; k < 2; k++) {
+						dst[k].free();
+						delete scalers[k];
+					}
+				}
+			}
+
+			src.free();
+		}
+	}
+
+#ifdef USE_HQ_SCALERS
+	void test_hq_classify() {
+		if (!g_system)
+			return;
+
+		// Rows of YUV values close to each other, so that all thresholds
+		// are hit on both sides
+		Common::RandomSource rnd("scalers");
+		rnd.setSeed(42);
+		const int width = 999;
+		Common::Array<uint32> rows[3];
+		for (int i = 0; i < 3; i++) {
+			rows[i].resize(width + 2);
+			for (int x = 0; x < width + 2; x++) {
+				uint32 y = 80 + rnd.getRandomNumber(100);
+				uint32 u = 100 + rnd.getRandomNumber(16);
+				uint32 v = 100 + rnd.getRandomNumber(14);
+				rows[i][x] = (y << 16) | (u << 8) | v;
+			}
+		}
+		const uint32 *prev = &rows[0][1], *cur = &rows[1][1], *next = &rows[2][1];
+
+		Common::Array<uint16> expected(width);
+		for (int x = 0; x < width; x++) {
+			static const int neighbors[8][2] = { { 0, -1 }, { 0, 0 }, { 0, 1 }, { 1, -1 }, { 1, 1 }, { 2, -1 }, { 2, 0 }, { 2, 1 } };
+			const uint32 *w[3] = { prev + x, cur + x, next + x };
+			uint16 flags = 0;
+			for (int i = 0; i < 8; i++) {
+				if (diffYUV(w[1][0], w[neighbors[i][0]][neighbors[i][1]]))
+					flags |= 1 << i;
+			}
+			if (diffYUV(w[0][0], w[1][1])) flags |= HQScaler::kDiff26;
+			if (diffYUV(w[1][1], w[2][0])) flags |= HQScaler::kDiff68;
+			if (diffYUV(w[2][0], w[1][-1])) flags |= HQScaler::kDiff84;
+			if (diffYUV(w[1][-1], w[0][0])) flags |= HQScaler::kDiff42;
+			expected[x] = flags;
+		}
+
+		Common::Array<HQScaler::ClassifyFunc> funcs;
+		funcs.push_back(HQScaler::classifyGeneric);
+#ifdef SCUMMVM_NEON
+		funcs.push_back(HQScaler::classifyNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			funcs.push_back(HQScaler::classifySSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			funcs.push_back(HQScaler::classifyAVX2);
+#endif
+
+		for (uint i = 0; i < funcs.size(); i++) {
+			Common::Array<uint16> flags(width);
+			funcs[i](prev, cur, next, flags.data(), width);
+			TS_ASSERT(flags == expected);
+		}
+
+		// The whole scaler has to give the same result with each of them
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::Surface src;
+		src.create(kWidth + 2 * kPadding, kHeight + 2 * kPadding, format);
+		drawScreen(src, 0);
+
+		HQScaler::ClassifyFunc oldFunc = HQScaler::classifyFunc;
+		for (uint factor = 2; factor <= 3; factor++) {
+			Graphics::Surface dst[2];
+			for (uint i = 0; i < funcs.size(); i++) {
+				HQScaler::classifyFunc = funcs[i];
+				HQScaler scaler(format);
+				scaler.setFactor(factor);
+				Graphics::Surface &out = dst[i ? 1 : 0];
+				if (!out.getPixels())
+					out.create(kWidth * factor, kHeight * factor, format);
+				scaleScreen(&scaler, src, out);
+				if (i)
+					TS_ASSERT(sameSurfaces(dst[0], dst[1]));
+			}
+			dst[0].free();
+			dst[1].free();
+		}
+		HQScaler::classifyFunc = oldFunc;
+		src.free();
+	}
+#endif
+
+	void test_scaler_speed() {
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const int frames = 100;
+#else
+		const int frames = 1;
+#endif
+
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		Graphics::Surface src;
+		src.create(kWidth + 2 * kPadding, kHeight + 2 * kPadding, format);
+		drawScreen(src, 0);
+
+		for (uint i = 0; i < _plugins.size(); i++) {
+			ScalerPluginObject *plugin = _plugins[i];
+			const Common::Array<uint> &factors = plugin->getFactors();
+			for (uint j = 0; j < factors.size(); j++) {
+				Scaler *scaler = plugin->createInstance(format);
+				scaler->setFactor(factors[j]);
+				Graphics::Surface dst;
+				dst.create(kWidth * factors[j], kHeight * factors[j], format);
+
+				uint32 times[2];
+				for (int bands = 0; bands < 2; bands++) {
+					scaler->setBandHeight(bands ? 16 : 0);
+					uint32 start = g_system->getMillis();
+					for (int frame = 0; frame < frames; frame++)
+						scaleScreen(scaler, src, dst);
+					times[bands] = g_system->getMillis() - start;
+				}
+				debug("Scaling %d frames with %s at %ux: %u ms, in bands %u ms", frames, plugin->getName(), factors[j], times[0], times[1]);
+
+				dst.free();
+				delete scaler;
+			}
+		}
+
+		src.free();
+	}
+};
@@ -0,0 +1,221 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+
+#ifdef USE_TINYGL
+#include "graphics/tinygl/tinygl.h"
+#endif
+
+#include "../null_osystem.h"
+
+class TinyGLTestSuite : public CxxTest::TestSuite {
+#ifdef USE_TINYGL
+	enum {
+		kWidth = 320,
+		kHeight = 200,
+		kTextureSize = 32
+	};
+
+	TinyGL::ContextHandle *_context;
+	TGLuint _texture;
+	TinyGL::BlitImage *_blitImage;
+
+	void createContext(bool dirtyRects) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		_context = TinyGL::createContext(kWidth, kHeight, format, 256, true, dirtyRects);
+		TinyGL::setContext(_context);
+
+		// A checkerboard, for the textures and the blits
+		Graphics::Surface image;
+		image.create(kTextureSize, kTextureSize, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		for (int y = 0; y < kTextureSize; y++) {
+			for (int x = 0; x < kTextureSize; x++) {
+				const bool odd = ((x / 4) ^ (y / 4)) & 1;
+				image.setPixel(x, y, image.format.ARGBToColor(odd ? 160 : 255, odd ? 250 : x * 8, odd ? 40 : y * 8, 128));
+			}
+		}
+
+		tglGenTextures(1, &_texture);
+		tglBindTexture(TGL_TEXTURE_2D, _texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, kTextureSize, kTextureSize, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, image.getPixels());
+
+		_blitImage = tglGenBlitImage();
+		tglUploadBlitImage(_blitImage, image, 0, false);
+		image.free();
+	}
+
+	void destroyContext() {
+		tglDeleteTextures(1, &_texture);
+		tglDeleteBlitImage(_blitImage);
+		TinyGL::destroyContext(_context);
+	}
+
+	void drawCube(float x, float y, float z, float angle) {
+		// The faces of a cube, as triangle strips
+		static const float faces[6][4][3] = {
+			{ { -1, -1,  1 }, {  1, -1,  1 }, { -1,  1,  1 }, {  1,  1,  1 } },
+			{ {  1, -1, -1 }, { -1, -1, -1 }, {  1,  1, -1 }, { -1,  1, -1 } },
+			{ { -1, -1, -1 }, { -1, -1,  1 }, { -1,  1, -1 }, { -1,  1,  1 } },
+			{ {  1, -1,  1 }, {  1, -1, -1 }, {  1,  1,  1 }, {  1,  1, -1 } },
+			{ { -1,  1,  1 }, {  1,  1,  1 }, { -1,  1, -1 }, {  1,  1, -1 } },
+			{ { -1, -1, -1 }, {  1, -1, -1 }, { -1, -1,  1 }, {  1, -1,  1 } }
+		};
+
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglTranslatef(x, y, z);
+		tglRotatef(angle, 1.0f, 0.0f, 0.0f);
+		tglRotatef(angle * 0.7f, 0.0f, 1.0f, 0.0f);
+
+		for (int f = 0; f < 6; f++) {
+			tglBegin(TGL_TRIANGLE_STRIP);
+			for (int v = 0; v < 4; v++) {
+				tglColor3f(0.2f + f * 0.15f, 1.0f - v * 0.2f, 0.5f);
+				tglTexCoord2f(v & 1, v >> 1);
+				tglVertex3f(faces[f][v][0], faces[f][v][1], faces[f][v][2]);
+			}
+			tglEnd();
+		}
+	}
+
+	/**
+	 * A scene like the ones of the 3D engines: textured and shaded cubes,
+	 * blended quads, a quad strip and blits over the rendering.
+	 */
+	void drawScene(int frame, int cubes) {
+		tglViewport(0, 0, kWidth, kHeight);
+		tglEnable(TGL_DEPTH_TEST);
+		tglDisable(TGL_LIGHTING);
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.6f, 1.6f, -1.0f, 1.0f, 1.0f, 100.0f);
+
+		for (int i = 0; i < cubes; i++) {
+			if (i & 1) {
+				tglEnable(TGL_TEXTURE_2D);
+				tglBindTexture(TGL_TEXTURE_2D, _texture);
+			} else {
+				tglDisable(TGL_TEXTURE_2D);
+			}
+			drawCube((i % 7) * 1.5f - 4.5f, (i / 7 % 5) * 1.4f - 2.8f, -8.0f - (i % 3) * 2.0f, frame * 7.0f + i * 31.0f);
+		}
+		tglDisable(TGL_TEXTURE_2D);
+
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglBegin(TGL_QUADS);
+		for (int i = 0; i < 4; i++) {
+			tglColor4f(1.0f, 0.5f, 0.2f * i, 0.4f);
+			tglVertex3f(-3.0f + i + frame * 0.05f, -2.0f, -5.0f);
+			tglVertex3f(-1.0f + i + frame * 0.05f, -2.0f, -5.0f);
+			tglVertex3f(-1.0f + i, 1.0f, -5.0f);
+			tglVertex3f(-3.0f + i, 1.0f, -5.0f);
+		}
+		tglEnd();
+
+		tglBegin(TGL_QUAD_STRIP);
+		for (int i = 0; i < 8; i++) {
+			tglColor4f(0.2f, 1.0f, 1.0f, 0.6f);
+			tglVertex3f(-4.0f + i, 1.5f + (i & 1) * 0.3f, -6.0f);
+			tglVertex3f(-4.0f + i, 2.5f, -6.0f);
+		}
+		tglEnd();
+		tglDisable(TGL_BLEND);
+
+		tglBlit(_blitImage, 10 + frame, 150);
+		TinyGL::BlitTransform transform(200, 20);
+		transform.sourceRectangle(4, 4, 24, 20);
+		transform.tint(0.7f);
+		tglBlit(_blitImage, transform);
+
+		// Flipped blits crossing tile edges
+		TinyGL::BlitTransform flipped(60 + frame, 90);
+		flipped.flip(true, true);
+		tglBlit(_blitImage, flipped);
+	}
+
+	bool sameSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+#endif
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+	void test_tiled_rendering() {
+#ifdef USE_TINYGL
+		// Tiles of different sizes, also not dividing the buffer
+		const int tileSizes[4] = { 0, 16, 64, 72 };
+		Graphics::Surface expected[3];
+
+		for (int t = 0; t < 4; t++) {
+			createContext(false);
+			TinyGL::setTiledRendering(tileSizes[t]);
+
+			for (int frame = 0; frame < 3; frame++) {
+				drawScene(frame, 20);
+				TinyGL::presentBuffer();
+
+				Graphics::Surface surface;
+				TinyGL::getSurfaceRef(surface);
+				if (t == 0)
+					expected[frame].copyFrom(surface);
+				else
+					TSM_ASSERT(Common::String::format("Frame %d with %d pixel tiles", frame, tileSizes[t]).c_str(), sameSurfaces(expected[frame], surface));
+			}
+
+			destroyContext();
+		}
+
+		for (int frame = 0; frame < 3; frame++)
+			expected[frame].free();
+#endif
+	}
+
+	void test_tiled_rendering_speed() {
+#ifdef USE_TINYGL
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const int frames = 500;
+#else
+		const int frames = 5;
+#endif
+
+		const int tileSizes[4] = { 0, 32, 64, 128 };
+		for (int t = 0; t < 4; t++) {
+			createContext(false);
+			TinyGL::setTiledRendering(tileSizes[t]);
+
+			uint32 start = g_system->getMillis();
+			for (int frame = 0; frame < frames; frame++) {
+				drawScene(frame, 35);
+				TinyGL::presentBuffer();
+			}
+			debug("Rendering %d frames with %d pixel tiles: %u ms", frames, tileSizes[t], g_system->getMillis() - start);
+
+			destroyContext();
+		}
+#endif
+	}
+};
@@ -0,0 +1,194 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/system.h"
+
+#include "graphics/font.h"
+#include "graphics/surface.h"
+#include "graphics/fonts/ttf.h"
+
+#include "../null_osystem.h"
+
+class TTFFontTestSuite : public CxxTest::TestSuite {
+	Graphics::Font *_font;
+
+	Graphics::Font *loadFont(int size) {
+#ifdef USE_FREETYPE2
+		Common::SeekableReadStream *file = Common::FSNode("test/engine-data/FreeSans.ttf").createReadStream();
+		if (!file)
+			return nullptr;
+		return Graphics::loadTTFFont(file, DisposeAfterUse::YES, size);
+#else
+		return nullptr;
+#endif
+	}
+
+	/** A background with varying colors, so that the blending shows. */
+	void fillBackground(Graphics::Surface &surface) {
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				if (surface.format.isCLUT8())
+					surface.setPixel(x, y, (x + y) & 0x7F);
+				else
+					surface.setPixel(x, y, surface.format.RGBToColor(x * 2, 255 - y * 4, (x * y) & 0xFF));
+			}
+		}
+	}
+
+	/** Draw a string char by char, the way Font::drawString used to. */
+	void drawChars(Graphics::Surface &surface, const Common::U32String &str, int x, int y, int rightX, uint32 color) {
+		uint32 last = 0;
+		for (uint i = 0; i < str.size(); i++) {
+			x += _font->getKerningOffset(last, str[i]);
+			last = str[i];
+			if (x + _font->getBoundingBox(str[i]).right > rightX)
+				break;
+			_font->drawChar(&surface, str[i], x, y, color);
+			x += _font->getCharWidth(str[i]);
+		}
+	}
+
+	/** Compare two surfaces, allowing for a rounding difference where glyphs overlap. */
+	bool similarSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		const int tolerance = a.format.bytesPerPixel == 2 ? 8 : 2;
+		for (int y = 0; y < a.h; y++) {
+			for (int x = 0; x < a.w; x++) {
+				uint32 colorA = a.getPixel(x, y), colorB = b.getPixel(x, y);
+				if (a.format.isCLUT8()) {
+					if (colorA != colorB)
+						return false;
+					continue;
+				}
+
+				byte rA, gA, bA, rB, gB, bB;
+				a.format.colorToRGB(colorA, rA, gA, bA);
+				b.format.colorToRGB(colorB, rB, gB, bB);
+				if (ABS(rA - rB) > tolerance || ABS(gA - gB) > tolerance || ABS(bA - bB) > tolerance)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	bool sameSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	TTFFontTestSuite() : _font(nullptr) {}
+
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+		if (g_system && !_font)
+			_font = loadFont(14);
+	}
+
+	~TTFFontTestSuite() {
+		delete _font;
+	}
+
+	void test_draw_string() {
+		if (!_font)
+			return;
+
+		const Graphics::PixelFormat formats[3] = {
+			Graphics::PixelFormat::createFormatCLUT8(),
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const Common::U32String text("AVAST! Wavy \"quoted\" text, fjord & Tydfil.");
+
+		for (int f = 0; f < 3; f++) {
+			const uint32 color = formats[f].isCLUT8() ? 200 : formats[f].RGBToColor(250, 20, 120);
+			Graphics::Surface surfaces[3];
+			for (int i = 0; i < 3; i++) {
+				surfaces[i].create(120, 40, formats[f]);
+				fillBackground(surfaces[i]);
+			}
+
+			// Whole strings, then clipped on both sides and by the surface
+			const int positions[3][2] = { { 2, 5 }, { -7, 25 }, { 30, -6 } };
+			for (int p = 0; p < 3; p++) {
+				const int x = positions[p][0], y = positions[p][1];
+				drawChars(surfaces[0], text, x, y, x + 1000, color);
+				_font->drawString(&surfaces[1], text, x, y, 1000, color);
+			}
+			drawChars(surfaces[0], text, 4, 16, 4 + 60 + 1, color);
+			_font->drawString(&surfaces[1], text, 4, 16, 60, color);
+			TS_ASSERT(similarSurfaces(surfaces[0], surfaces[1]));
+
+			// The second time the lines come from the cache
+			for (int p = 0; p < 3; p++)
+				_font->drawString(&surfaces[2], text, positions[p][0], positions[p][1], 1000, color);
+			_font->drawString(&surfaces[2], text, 4, 16, 60, color);
+			TS_ASSERT(sameSurfaces(surfaces[1], surfaces[2]));
+
+			for (int i = 0; i < 3; i++)
+				surfaces[i].free();
+		}
+	}
+
+	void test_line_cache_eviction() {
+		if (!_font)
+			return;
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		const uint32 color = format.RGBToColor(255, 255, 255);
+		Graphics::Surface first, again;
+		first.create(300, 30, format);
+		again.create(300, 30, format);
+		fillBackground(first);
+		fillBackground(again);
+
+		_font->drawString(&first, "Line number 0", 0, 0, 300, color);
+		for (int i = 1; i < 2000; i++) {
+			Common::String line = Common::String::format("Line number %d", i);
+			_font->drawString(&again, line, 0, 0, 300, color);
+			fillBackground(again);
+		}
+		_font->drawString(&again, "Line number 0", 0, 0, 300, color);
+		TS_ASSERT(sameSurfaces(first, again));
+
+		first.free();
+		again.free();
+	}
+
+	void test_draw_string_speed() {
+		if (!_font)
+			return;
+
+#ifdef SLOW_TESTS
+		const int iterations = 10000;
+#else
+		const int iterations = 100;
+#endif
+
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const uint32 color = format.RGBToColor(255, 255, 255);
+		const Common::U32String text("The quick brown fox jumps over the lazy dog");
+		Graphics::Surface surface;
+		surface.create(400, 30, format);
+		fillBackground(surface);
+
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < iterations; i++)
+			drawChars(surface, text, 2, 4, 400, color);
+		uint32 charTime = g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		for (int i = 0; i < iterations; i++)
+			_font->drawString(&surface, text, 2, 4, 398, color);
+		uint32 stringTime = g_system->getMillis() - start;
+
+		debug("Drawing a line %d times: %u ms char by char, %u ms with drawString", iterations, charTime, stringTime);
+		surface.free();
+	}
+};
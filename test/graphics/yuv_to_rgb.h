@@ -0,0 +1,191 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/debug.h"
+#include "common/random.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "../null_osystem.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	typedef Graphics::YUVToRGBManager Manager;
+
+	struct Variant {
+		const char *name;
+		Manager::RowFunc row444, row422;
+	};
+	Common::Array<Variant> _variants;
+
+	enum {
+		kWidth = 100,
+		kHeight = 36
+	};
+
+	/** The planes of an image, with chroma values at both ends of the range in the first rows. */
+	byte _y[kWidth * kHeight], _u[kWidth * kHeight], _v[kWidth * kHeight];
+
+	void addVariant(const char *name, Manager::RowFunc row444, Manager::RowFunc row422) {
+		Variant variant;
+		variant.name = name;
+		variant.row444 = row444;
+		variant.row422 = row422;
+		_variants.push_back(variant);
+	}
+
+	void setVariant(const Variant &variant) {
+		Manager::convertRow444Func = variant.row444;
+		Manager::convertRow422Func = variant.row422;
+	}
+
+	/** Convert the image with all subsamplings, one above the other. */
+	void convertAll(Graphics::Surface &dst, Manager::LuminanceScale scale) {
+		const int pitch = kWidth;
+		for (int i = 0; i < 4; i++) {
+			byte *pixels = (byte *)dst.getBasePtr(0, i * kHeight);
+			switch (i) {
+			case 0:
+				YUVToRGBMan.convert444(pixels, dst.pitch, dst.format, scale, _y, _u, _v, kWidth, kHeight, pitch, pitch);
+				break;
+			case 1:
+				YUVToRGBMan.convert422(pixels, dst.pitch, dst.format, scale, _y, _u, _v, kWidth, kHeight, pitch, pitch);
+				break;
+			case 2:
+				YUVToRGBMan.convert420(pixels, dst.pitch, dst.format, scale, _y, _u, _v, kWidth, kHeight, pitch, pitch);
+				break;
+			default:
+				YUVToRGBMan.convert410(pixels, dst.pitch, dst.format, scale, _y, _u, _v, kWidth, kHeight, pitch, pitch);
+				break;
+			}
+		}
+	}
+
+	bool sameSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+
+		// The null OSystem has no graphics manager to ask for the CPU features
+		if (_variants.empty()) {
+			addVariant("tables", nullptr, nullptr);
+			addVariant("generic", Manager::convertRow444Generic, Manager::convertRow422Generic);
+#ifdef SCUMMVM_NEON
+			addVariant("NEON", Manager::convertRow444NEON, Manager::convertRow422NEON);
+#endif
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2)
+				addVariant("SSE2", Manager::convertRow444SSE2, Manager::convertRow422SSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8)
+				addVariant("AVX2", Manager::convertRow444AVX2, Manager::convertRow422AVX2);
+#endif
+
+			Common::RandomSource rnd("yuv_to_rgb");
+			rnd.setSeed(42);
+			for (int i = 0; i < kWidth * kHeight; i++) {
+				_y[i] = rnd.getRandomNumber(255);
+				_u[i] = (i < 256) ? i : rnd.getRandomNumber(255);
+				_v[i] = (i < 256) ? 255 - i : rnd.getRandomNumber(255);
+			}
+
+			// Create the manager with row conversions set, so that it
+			// does not ask for the CPU features
+			if (!Manager::convertRow444Func)
+				setVariant(_variants.back());
+			Manager::instance();
+		}
+	}
+
+	void test_convert() {
+		if (!g_system)
+			return;
+
+		const Manager::RowFunc row444 = Manager::convertRow444Func, row422 = Manager::convertRow422Func;
+
+		const Graphics::PixelFormat formats[4] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0)
+		};
+		const Manager::LuminanceScale scales[2] = { Manager::kScaleFull, Manager::kScaleITU };
+
+		for (int f = 0; f < 4; f++) {
+			for (int s = 0; s < 2; s++) {
+				Graphics::Surface expected, surface;
+				expected.create(kWidth, kHeight * 4, formats[f]);
+				surface.create(kWidth, kHeight * 4, formats[f]);
+
+				setVariant(_variants[0]);
+				convertAll(expected, scales[s]);
+				for (uint i = 1; i < _variants.size(); i++) {
+					setVariant(_variants[i]);
+					memset(surface.getPixels(), 0, surface.pitch * surface.h);
+					convertAll(surface, scales[s]);
+					TSM_ASSERT(_variants[i].name, sameSurfaces(expected, surface));
+				}
+
+				// Converting into a surface writes the same pixels
+				memset(surface.getPixels(), 0, surface.pitch * surface.h);
+				YUVToRGBMan.convert420(&surface, scales[s], _y, _u, _v, kWidth, kHeight, kWidth, kWidth);
+				TS_ASSERT(!memcmp(surface.getBasePtr(0, 0), expected.getBasePtr(0, 2 * kHeight), surface.pitch * kHeight));
+
+				expected.free();
+				surface.free();
+			}
+		}
+
+		Manager::convertRow444Func = row444;
+		Manager::convertRow422Func = row422;
+	}
+
+	void test_convert_speed() {
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const int frames = 1000;
+#else
+		const int frames = 10;
+#endif
+
+		const Manager::RowFunc row444 = Manager::convertRow444Func, row422 = Manager::convertRow422Func;
+
+		// Convert a 640x480 YUV420 frame, the most common one in videos
+		const int width = 640, height = 480;
+		Common::Array<byte> y(width * height), u(width * height / 4), v(width * height / 4);
+		for (int i = 0; i < width * height; i++)
+			y[i] = _y[i % (kWidth * kHeight)];
+		for (int i = 0; i < width * height / 4; i++) {
+			u[i] = _u[i % (kWidth * kHeight)];
+			v[i] = _v[i % (kWidth * kHeight)];
+		}
+
+		Graphics::Surface surface;
+		surface.create(width, height, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		for (uint i = 0; i < _variants.size(); i++) {
+			setVariant(_variants[i]);
+			uint32 start = g_system->getMillis();
+			for (int frame = 0; frame < frames; frame++)
+				YUVToRGBMan.convert420(&surface, Manager::kScaleITU, y.data(), u.data(), v.data(), width, height, width, width / 2);
+			debug("Converting %d YUV420 frames with %s: %u ms", frames, _variants[i].name, g_system->getMillis() - start);
+		}
+		surface.free();
+
+		Manager::convertRow444Func = row444;
+		Manager::convertRow422Func = row422;
+	}
+};
@@ -1,5 +1,9 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_abort
 
+#if defined(POSIX)
+#include <pthread.h>
+#endif
+
 #define USE_NULL_DRIVER 1
 #define NULL_DRIVER_USE_FOR_TEST 1
 #include "null_osystem.h"
@@ -17,6 +21,41 @@ void Common::install_null_g_system() {
 	g_system = OSystem_NULL_create(silenceLogs);
 }
 
+#if defined(POSIX)
+namespace {
+
+struct TestThread {
+	pthread_t thread;
+	void (*proc)(void *);
+	void *arg;
+};
+
+void *runTestThread(void *data) {
+	TestThread *thread = (TestThread *)data;
+	thread->proc(thread->arg);
+	return nullptr;
+}
+
+} // End of anonymous namespace
+
+void *Common::start_test_thread(void (*proc)(void *), void *arg) {
+	TestThread *thread = new TestThread();
+	thread->proc = proc;
+	thread->arg = arg;
+	if (pthread_create(&thread->thread, nullptr, runTestThread, thread) != 0) {
+		delete thread;
+		return nullptr;
+	}
+	return thread;
+}
+
+void Common::join_test_thread(void *data) {
+	TestThread *thread = (TestThread *)data;
+	pthread_join(thread->thread, nullptr);
+	delete thread;
+}
+#endif
+
 void OSystem_NULL::quit() {
 	abort();
 }
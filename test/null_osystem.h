@@ -7,5 +7,17 @@ void install_null_g_system();
 #else
 #define NULL_OSYSTEM_IS_AVAILABLE 0
 #endif
+
+#if defined(POSIX)
+/**
+ * Runs proc(arg) on a new thread. The mutexes of the null OSystem are real
+ * mutexes in that case. Returns nullptr if the thread could not be created.
+ */
+void *start_test_thread(void (*proc)(void *), void *arg);
+void join_test_thread(void *thread);
+#define TEST_THREADS_ARE_AVAILABLE 1
+#else
+#define TEST_THREADS_ARE_AVAILABLE 0
+#endif
 }
 #endif
@@ -0,0 +1,166 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "common/debug.h"
+#include "common/random.h"
+#include "common/system.h"
+
+#include "video/bink_dsp.h"
+
+#include "../null_osystem.h"
+
+class BinkDSPTestSuite : public CxxTest::TestSuite {
+#ifdef USE_BINK
+	Common::Array<Video::BinkDSP> _variants;
+	Common::Array<const char *> _names;
+
+	/**
+	 * Coefficients like the ones of intra and inter blocks: mostly low
+	 * frequencies, sometimes only the DC value.
+	 */
+	void randomBlock(Common::RandomSource &rnd, int32 *block) {
+		memset(block, 0, 64 * sizeof(int32));
+		const uint type = rnd.getRandomNumber(3);
+		block[0] = (int32)rnd.getRandomNumber(2 * 2048) - 2048;
+		if (type == 0)
+			return;
+
+		const uint count = type == 3 ? 64 : rnd.getRandomNumber(15);
+		const int32 range = type == 2 ? 32768 : 4096;
+		for (uint i = 0; i < count; i++) {
+			const uint pos = type == 3 ? i : rnd.getRandomNumber(63);
+			block[pos] = (int32)rnd.getRandomNumber(range) - range / 2;
+		}
+	}
+
+	void randomPixels(Common::RandomSource &rnd, byte *pixels, uint size) {
+		for (uint i = 0; i < size; i++)
+			pixels[i] = rnd.getRandomNumber(255);
+	}
+#endif
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+
+#ifdef USE_BINK
+		// The null OSystem has no graphics manager to ask for the CPU features
+		if (_variants.empty()) {
+			Video::BinkDSP dsp;
+			Video::initBinkDSPGeneric(dsp);
+			_variants.push_back(dsp);
+			_names.push_back("generic");
+#ifdef SCUMMVM_NEON
+			Video::initBinkDSPNEON(dsp);
+			_variants.push_back(dsp);
+			_names.push_back("NEON");
+#endif
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2) {
+				Video::initBinkDSPSSE2(dsp);
+				_variants.push_back(dsp);
+				_names.push_back("SSE2");
+			}
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8) {
+				Video::initBinkDSPAVX2(dsp);
+				_variants.push_back(dsp);
+				_names.push_back("AVX2");
+			}
+#endif
+		}
+#endif
+	}
+
+	void test_idct() {
+#ifdef USE_BINK
+		Common::RandomSource rnd("bink");
+		rnd.setSeed(42);
+
+		const uint pitch = 13;
+		for (int pass = 0; pass < 2000; pass++) {
+			int32 block[64];
+			randomBlock(rnd, block);
+			int16 residue[64];
+			for (uint i = 0; i < 64; i++)
+				residue[i] = (int16)rnd.getRandomNumber(1023) - 512;
+			byte background[8 * pitch];
+			randomPixels(rnd, background, sizeof(background));
+
+			int32 expectedIDCT[64];
+			byte expectedPut[8 * pitch], expectedAdd[8 * pitch], expectedResidue[8 * pitch];
+			for (uint i = 0; i < _variants.size(); i++) {
+				const Video::BinkDSP &dsp = _variants[i];
+
+				int32 idct[64];
+				memcpy(idct, block, sizeof(idct));
+				dsp.idct(idct);
+
+				byte put[8 * pitch], add[8 * pitch], res[8 * pitch];
+				memcpy(put, background, sizeof(put));
+				memcpy(add, background, sizeof(add));
+				memcpy(res, background, sizeof(res));
+				dsp.idctPut(put + 1, pitch, block);
+				dsp.idctAdd(add + 2, pitch, block);
+				dsp.addResidue(res + 3, pitch, residue);
+
+				if (i == 0) {
+					memcpy(expectedIDCT, idct, sizeof(idct));
+					memcpy(expectedPut, put, sizeof(put));
+					memcpy(expectedAdd, add, sizeof(add));
+					memcpy(expectedResidue, res, sizeof(res));
+				} else {
+					TSM_ASSERT(_names[i], !memcmp(idct, expectedIDCT, sizeof(idct)));
+					TSM_ASSERT(_names[i], !memcmp(put, expectedPut, sizeof(put)));
+					TSM_ASSERT(_names[i], !memcmp(add, expectedAdd, sizeof(add)));
+					TSM_ASSERT(_names[i], !memcmp(res, expectedResidue, sizeof(res)));
+				}
+			}
+
+			// The bytes outside of the block are left alone
+			for (uint y = 0; y < 8; y++) {
+				TS_ASSERT(!memcmp(expectedPut + y * pitch + 9, background + y * pitch + 9, pitch - 9));
+				TS_ASSERT_EQUALS(expectedPut[y * pitch], background[y * pitch]);
+			}
+		}
+#endif
+	}
+
+	void test_idct_speed() {
+#ifdef USE_BINK
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const uint blocks = 1000000;
+#else
+		const uint blocks = 20000;
+#endif
+
+		Common::RandomSource rnd("bink");
+		rnd.setSeed(1234);
+		Common::Array<int32> coeffs(64 * 256);
+		for (uint i = 0; i < 256; i++)
+			randomBlock(rnd, &coeffs[64 * i]);
+
+		// Decode into a plane, like a 640x480 frame of 8x8 blocks does
+		const uint pitch = 640;
+		Common::Array<byte> plane(pitch * 480);
+		for (uint i = 0; i < _variants.size(); i++) {
+			uint32 start = g_system->getMillis();
+			for (uint b = 0; b < blocks; b++) {
+				byte *dest = &plane[((b / 80) % 60) * 8 * pitch + (b % 80) * 8];
+				if (b & 1)
+					_variants[i].idctAdd(dest, pitch, &coeffs[64 * (b & 255)]);
+				else
+					_variants[i].idctPut(dest, pitch, &coeffs[64 * (b & 255)]);
+			}
+			debug("Transforming %u Bink blocks with %s: %u ms", blocks, _names[i], g_system->getMillis() - start);
+		}
+#endif
+	}
+};
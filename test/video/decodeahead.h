@@ -0,0 +1,212 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+
+#include "video/dxa_decoder.h"
+
+#include "../null_osystem.h"
+#include "helper.h"
+
+namespace {
+
+/**
+ * A decoder which processes its frames, as e.g. QuickTime does when scaling.
+ */
+class InvertingDXADecoder : public Video::DXADecoder {
+public:
+	InvertingDXADecoder(bool canDecodeAhead = true) : _canDecodeAhead(canDecodeAhead) {}
+	~InvertingDXADecoder() { _inverted.free(); }
+
+protected:
+	const Graphics::Surface *processFrame(const Graphics::Surface *frame) override {
+		if (!frame)
+			return frame;
+
+		_inverted.copyFrom(*frame);
+		for (int y = 0; y < _inverted.h; y++) {
+			byte *row = (byte *)_inverted.getBasePtr(0, y);
+			for (int x = 0; x < _inverted.w * _inverted.format.bytesPerPixel; x++)
+				row[x] = ~row[x];
+		}
+		return &_inverted;
+	}
+
+	bool canDecodeAhead() const override { return _canDecodeAhead; }
+
+private:
+	Graphics::Surface _inverted;
+	bool _canDecodeAhead;
+};
+
+} // End of anonymous namespace
+
+class VideoDecodeAheadTestSuite : public CxxTest::TestSuite {
+	bool sameSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		if (a.w != b.w || a.h != b.h || a.format != b.format)
+			return false;
+
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	bool sameRects(const Common::List<Common::Rect> &a, const Common::List<Common::Rect> &b) {
+		Common::List<Common::Rect>::const_iterator itA = a.begin(), itB = b.begin();
+		for (; itA != a.end() && itB != b.end(); ++itA, ++itB) {
+			if (*itA != *itB)
+				return false;
+		}
+		return itA == a.end() && itB == b.end();
+	}
+
+	/**
+	 * Decode the next frame with both decoders, and check that they
+	 * report the same.
+	 */
+	bool sameNextFrame(Video::VideoDecoder &decoder, Video::VideoDecoder &ahead) {
+		bool ok = decoder.getCurFrame() == ahead.getCurFrame() &&
+		          decoder.getTimeToNextFrame() == ahead.getTimeToNextFrame() &&
+		          decoder.endOfVideo() == ahead.endOfVideo();
+		if (decoder.endOfVideo())
+			return ok;
+
+		const Graphics::Surface *frame = decoder.decodeNextFrame();
+		const Graphics::Surface *aheadFrame = ahead.decodeNextFrame();
+		ok = ok && frame && aheadFrame && sameSurfaces(*frame, *aheadFrame);
+		ok = ok && sameRects(decoder.getFrameDirtyRects(), ahead.getFrameDirtyRects());
+
+		ok = ok && decoder.hasDirtyPalette() == ahead.hasDirtyPalette();
+		if (decoder.hasDirtyPalette())
+			ok = ok && !memcmp(decoder.getPalette(), ahead.getPalette(), 3 * 256);
+
+		return ok && decoder.getCurFrame() == ahead.getCurFrame();
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+	void test_decode_ahead() {
+		if (!g_system)
+			return;
+
+		const uint frames = 40;
+		Video::DXADecoder decoder, ahead;
+		TS_ASSERT(decoder.loadStream(createDXA(0, frames)));
+		TS_ASSERT(ahead.loadStream(createDXA(0, frames)));
+		ahead.setDecodeAhead(4);
+
+		// Fill the queue at different times, and sometimes not at all
+		for (uint i = 0; i < 20; i++) {
+			if (i % 5 != 4)
+				TS_ASSERT_EQUALS(ahead.decodeAhead(1000), i == 0 ? 4U : i % 5 == 0 ? 2U : 1U);
+			TS_ASSERT(sameNextFrame(decoder, ahead));
+		}
+		TS_ASSERT_EQUALS(ahead.getDecodeAheadStats().queuedFrames, 2U);
+		TS_ASSERT_EQUALS(ahead.getDecodeAheadStats().maxQueuedFrames, 4U);
+
+		// Queued frames are dropped when rewinding
+		TS_ASSERT(decoder.rewind());
+		TS_ASSERT(ahead.rewind());
+		TS_ASSERT_EQUALS(ahead.getDecodeAheadStats().queuedFrames, 0U);
+		while (!decoder.endOfVideo() || !ahead.endOfVideo()) {
+			ahead.decodeAhead(1000);
+			if (!sameNextFrame(decoder, ahead)) {
+				TS_FAIL("Frames differ after rewinding");
+				break;
+			}
+		}
+
+		// The queue is filled up to the end of the video only
+		const Video::VideoDecoder::DecodeAheadStats &stats = ahead.getDecodeAheadStats();
+		TS_ASSERT_EQUALS(stats.queuedFrames, 0U);
+		TS_ASSERT_EQUALS(ahead.decodeAhead(1000), 0U);
+		TS_ASSERT_EQUALS(stats.decodedFrames, 22U + frames);
+		TS_ASSERT_EQUALS(stats.lateFrames, 0U);
+	}
+
+	void test_decode_ahead_processed_frames() {
+		if (!g_system)
+			return;
+
+		// Frames decoded ahead are processed like the others
+		const uint frames = 12;
+		InvertingDXADecoder decoder, ahead;
+		TS_ASSERT(decoder.loadStream(createDXA(0, frames)));
+		TS_ASSERT(ahead.loadStream(createDXA(0, frames)));
+		TS_ASSERT(ahead.setDecodeAhead(4));
+		while (!decoder.endOfVideo() || !ahead.endOfVideo()) {
+			ahead.decodeAhead(1000);
+			if (!sameNextFrame(decoder, ahead)) {
+				TS_FAIL("Processed frames differ");
+				break;
+			}
+		}
+		TS_ASSERT_EQUALS(ahead.getDecodeAheadStats().lateFrames, 0U);
+
+		// Decoders may refuse to decode ahead
+		InvertingDXADecoder refusing(false);
+		TS_ASSERT(refusing.loadStream(createDXA(0, frames)));
+		TS_ASSERT(!refusing.setDecodeAhead(4));
+		TS_ASSERT_EQUALS(refusing.decodeAhead(1000), 0U);
+		TS_ASSERT(refusing.decodeNextFrame());
+	}
+
+	void test_decode_ahead_end_time() {
+		if (!g_system)
+			return;
+
+		Video::DXADecoder decoder;
+		TS_ASSERT(decoder.loadStream(createDXA(0, 20)));
+		decoder.setDecodeAhead(8);
+		decoder.setEndFrame(5);
+		decoder.start();
+
+		// Frames past the end are not decoded ahead
+		TS_ASSERT_EQUALS(decoder.decodeAhead(1000), 6U);
+		uint shown = 0;
+		while (!decoder.endOfVideo()) {
+			TS_ASSERT(decoder.decodeNextFrame());
+			shown++;
+		}
+		TS_ASSERT_EQUALS(shown, 6U);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 5);
+	}
+
+	void test_decode_ahead_speed() {
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const uint frames = 1000;
+#else
+		const uint frames = 50;
+#endif
+
+		// Decode between frames, as delayMillis() does, and see how
+		// many frames still have to be decoded when they are needed
+		Video::DXADecoder decoder;
+		TS_ASSERT(decoder.loadStream(createDXA(0x40, frames)));
+		decoder.setDecodeAhead(3);
+
+		uint32 start = g_system->getMillis();
+		while (!decoder.endOfVideo()) {
+			decoder.decodeAhead(10);
+			TS_ASSERT(decoder.decodeNextFrame());
+		}
+
+		const Video::VideoDecoder::DecodeAheadStats &stats = decoder.getDecodeAheadStats();
+		TS_ASSERT_EQUALS(stats.decodedFrames, frames);
+		debug("Decoding %u frames ahead: %u late, at most %u queued, %u ms decoding (at most %u ms per frame), %u ms in total",
+		      frames, stats.lateFrames, stats.maxQueuedFrames, stats.totalDecodeTime, stats.maxDecodeTime, g_system->getMillis() - start);
+	}
+};
@@ -0,0 +1,214 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitarray.h"
+#include "common/debug.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "common/system.h"
+
+#include "graphics/surface.h"
+
+#include "image/codecs/rpza.h"
+
+#include "video/dxa_decoder.h"
+
+#include "../null_osystem.h"
+#include "helper.h"
+
+class VideoDirtyRectsTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 160,
+		kHeight = 96
+	};
+
+	bool sameSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Play a video by copying only the changed areas, and check that the
+	 * result always looks like the decoded frame.
+	 */
+	bool playVideo(Video::VideoDecoder &decoder, uint32 &bytes, uint32 &wholeBytes) {
+		Graphics::Surface screen;
+		screen.create(decoder.getWidth(), decoder.getHeight(), decoder.getPixelFormat());
+		bool ok = true;
+
+		bytes = wholeBytes = 0;
+		while (!decoder.endOfVideo()) {
+			const Graphics::Surface *frame = decoder.decodeNextFrame();
+			if (!frame)
+				continue;
+
+			bytes += decoder.copyFrameDirtyRects(*frame, screen, 0, 0);
+			wholeBytes += frame->w * frame->h * frame->format.bytesPerPixel;
+			ok = ok && sameSurfaces(screen, *frame);
+		}
+
+		screen.free();
+		return ok;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		if (!g_system)
+			Common::install_null_g_system();
+#endif
+	}
+
+	void test_blocks_to_rects() {
+		Common::RandomSource rnd("dirtyrects");
+		rnd.setSeed(42);
+
+		// Sizes which are not multiples of the blocks are clipped
+		const uint blocksPerRow = 13, rows = 11, blockWidth = 4, blockHeight = 8;
+		const uint width = blocksPerRow * blockWidth - 3, height = rows * blockHeight - 5;
+
+		for (int pass = 0; pass < 20; pass++) {
+			Common::BitArray blocks(blocksPerRow * rows);
+			for (uint i = 0; i < blocksPerRow * rows; i++) {
+				// Mostly runs and rectangles of blocks
+				if ((i % blocksPerRow) / 4 == (pass + i / blocksPerRow / 3) % 4 || rnd.getRandomNumber(9) == 0)
+					blocks.set(i);
+			}
+
+			Common::List<Common::Rect> rects;
+			Image::Codec::blocksToRects(blocks, blocksPerRow, blockWidth, blockHeight, width, height, rects);
+
+			// Each pixel of a changed block has to be in exactly one rect
+			Common::Array<byte> coverage(width * height);
+			for (Common::List<Common::Rect>::const_iterator it = rects.begin(); it != rects.end(); ++it) {
+				TS_ASSERT(it->left >= 0 && it->top >= 0 && it->right <= (int)width && it->bottom <= (int)height);
+				TS_ASSERT(!it->isEmpty());
+				for (int y = it->top; y < it->bottom; y++)
+					for (int x = it->left; x < it->right; x++)
+						coverage[y * width + x]++;
+			}
+
+			bool ok = true;
+			for (uint y = 0; y < height; y++)
+				for (uint x = 0; x < width; x++)
+					ok = ok && coverage[y * width + x] == (blocks.get((y / blockHeight) * blocksPerRow + x / blockWidth) ? 1 : 0);
+			TS_ASSERT(ok);
+			TS_ASSERT(rects.size() < blocksPerRow * rows / 4);
+		}
+
+		// The same run in all rows is a single rect
+		Common::BitArray column(blocksPerRow * rows);
+		for (uint y = 0; y < rows; y++) {
+			column.set(y * blocksPerRow + 2);
+			column.set(y * blocksPerRow + 3);
+		}
+		Common::List<Common::Rect> rects;
+		Image::Codec::blocksToRects(column, blocksPerRow, blockWidth, blockHeight, width, height, rects);
+		TS_ASSERT_EQUALS(rects.size(), 1U);
+		TS_ASSERT(rects.front() == Common::Rect(8, 0, 16, height));
+	}
+
+	void test_dxa_dirty_rects() {
+		if (!g_system)
+			return;
+
+		// Unscaled, and with doubled rows
+		const byte flags[2] = { 0, 0x40 };
+		for (int f = 0; f < 2; f++) {
+			Video::DXADecoder decoder;
+			TS_ASSERT(decoder.loadStream(createDXA(flags[f], 30)));
+			decoder.start();
+
+			uint32 bytes, wholeBytes;
+			TS_ASSERT(playVideo(decoder, bytes, wholeBytes));
+			TS_ASSERT(bytes < wholeBytes / 4);
+
+			// The first frame after rewinding is always whole
+			TS_ASSERT(decoder.rewind());
+			const Graphics::Surface *frame = decoder.decodeNextFrame();
+			TS_ASSERT(frame);
+			TS_ASSERT_EQUALS(decoder.getFrameDirtyRects().size(), 1U);
+			TS_ASSERT(decoder.getFrameDirtyRects().front() == Common::Rect(frame->w, frame->h));
+			frame = decoder.decodeNextFrame();
+			TS_ASSERT(frame);
+			TS_ASSERT(decoder.getFrameDirtyRects().front() != Common::Rect(frame->w, frame->h));
+		}
+	}
+
+	void test_rpza_dirty_rects() {
+		Common::RandomSource rnd("dirtyrects");
+		rnd.setSeed(1234);
+
+		Image::RPZADecoder codec(kWidth, kHeight);
+		const uint blocks = (kWidth / 4) * (kHeight / 4);
+
+		for (int frame = 0; frame < 5; frame++) {
+			// Fill all blocks first, then some of them
+			Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+			Common::BitArray filled(blocks);
+			uint filledCount = 0;
+			for (uint i = 0; i < blocks; i++) {
+				if (frame == 0 || rnd.getRandomNumber(7) == 0) {
+					out.writeByte(0xA0);
+					out.writeUint16BE(0x1000 * frame + i);
+					filled.set(i);
+					filledCount++;
+				} else {
+					out.writeByte(0x80);
+				}
+			}
+
+			Common::MemoryWriteStreamDynamic chunk(DisposeAfterUse::YES);
+			chunk.writeByte(0xE1);
+			chunk.writeUint16BE((out.size() + 4) >> 8);
+			chunk.writeByte((out.size() + 4) & 0xFF);
+			chunk.write(out.getData(), out.size());
+			Common::MemoryReadStream stream(chunk.getData(), chunk.size());
+
+			const Graphics::Surface *surface = codec.decodeFrame(stream);
+			const Common::List<Common::Rect> *rects = codec.getDirtyRects();
+			TS_ASSERT(surface && rects);
+
+			// The rects cover exactly the filled blocks
+			uint32 area = 0;
+			bool ok = true;
+			for (Common::List<Common::Rect>::const_iterator it = rects->begin(); it != rects->end(); ++it) {
+				area += it->width() * it->height();
+				for (int y = it->top; y < it->bottom; y += 4)
+					for (int x = it->left; x < it->right; x += 4)
+						ok = ok && filled.get((y / 4) * (kWidth / 4) + x / 4);
+			}
+			TS_ASSERT(ok);
+			TS_ASSERT_EQUALS(area, filledCount * 16);
+			if (frame == 0)
+				TS_ASSERT_EQUALS(rects->size(), 1U);
+		}
+	}
+
+	void test_copied_bytes() {
+		if (!g_system)
+			return;
+
+#ifdef SLOW_TESTS
+		const uint frames = 1000;
+#else
+		const uint frames = 50;
+#endif
+
+		const char *names[2] = { "DXA", "DXA with doubled rows" };
+		const byte flags[2] = { 0, 0x40 };
+		for (int f = 0; f < 2; f++) {
+			Video::DXADecoder decoder;
+			TS_ASSERT(decoder.loadStream(createDXA(flags[f], frames)));
+			decoder.start();
+
+			uint32 bytes, wholeBytes;
+			uint32 start = g_system->getMillis();
+			TS_ASSERT(playVideo(decoder, bytes, wholeBytes));
+			debug("Playing %u frames of %s: %u bytes copied per frame with the whole frame, %u with dirty rects (%u ms)",
+			      frames, names[f], wholeBytes / frames, bytes / frames, g_system->getMillis() - start);
+		}
+	}
+};
@@ -0,0 +1,107 @@
+#ifndef TEST_VIDEO_HELPER_H
+#define TEST_VIDEO_HELPER_H
+
+#include "common/array.h"
+#include "common/memstream.h"
+
+enum {
+	kDXAWidth = 160,
+	kDXAHeight = 96
+};
+
+/** Store data in a zlib stream without compressing it. */
+static void writeZlib(Common::WriteStream &out, const Common::Array<byte> &data) {
+	Common::MemoryWriteStreamDynamic zlib(DisposeAfterUse::YES);
+	zlib.writeByte(0x78);
+	zlib.writeByte(0x01);
+
+	uint32 pos = 0;
+	do {
+		uint16 size = MIN<uint32>(data.size() - pos, 0xFFFF);
+		zlib.writeByte(pos + size == data.size() ? 1 : 0);
+		zlib.writeUint16LE(size);
+		zlib.writeUint16LE(~size);
+		zlib.write(data.data() + pos, size);
+		pos += size;
+	} while (pos < data.size());
+
+	uint32 a = 1, b = 0;
+	for (uint32 i = 0; i < data.size(); i++) {
+		a = (a + data[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	zlib.writeUint32BE((b << 16) | a);
+
+	out.writeUint32BE(zlib.size());
+	out.write(zlib.getData(), zlib.size());
+}
+
+/** A background with a square moving over it, and a blinking corner. */
+static void drawDXAFrame(Common::Array<byte> &pixels, uint frame) {
+	for (uint y = 0; y < kDXAHeight; y++)
+		for (uint x = 0; x < kDXAWidth; x++)
+			pixels[y * kDXAWidth + x] = (x / 16 + y / 16) & 1 ? 10 : 20;
+
+	const uint left = (frame * 3) % (kDXAWidth - 24), top = (frame * 2) % (kDXAHeight - 24);
+	for (uint y = top; y < top + 24; y++)
+		for (uint x = left; x < left + 24; x++)
+			pixels[y * kDXAWidth + x] = 30 + frame % 5;
+
+	if (frame & 1)
+		for (uint y = 0; y < 8; y++)
+			pixels[y * kDXAWidth + kDXAWidth - 8 + y] = 40;
+}
+
+/** A DXA video of drawFrame(), with the changed blocks of each frame. */
+static Common::SeekableReadStream *createDXA(byte flags, uint frames) {
+	Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+	out.writeUint32BE(MKTAG('D','E','X','A'));
+	out.writeByte(flags);
+	out.writeUint16BE(frames);
+	out.writeSint32BE(100);
+	out.writeUint16BE(kDXAWidth);
+	out.writeUint16BE(kDXAHeight);
+	out.writeUint32BE(MKTAG('N','U','L','L'));
+
+	Common::Array<byte> prev(kDXAWidth * kDXAHeight), cur(kDXAWidth * kDXAHeight);
+	for (uint frame = 0; frame < frames; frame++) {
+		drawDXAFrame(cur, frame);
+
+		if (frame == 0) {
+			out.writeUint32BE(MKTAG('C','M','A','P'));
+			for (uint i = 0; i < 256 * 3; i++)
+				out.writeByte(i / 3);
+		} else {
+			out.writeUint32BE(MKTAG('N','U','L','L'));
+		}
+
+		out.writeUint32BE(MKTAG('F','R','A','M'));
+		if (frame == 0) {
+			out.writeByte(2);
+			writeZlib(out, cur);
+		} else {
+			Common::Array<byte> blocks;
+			for (uint by = 0; by < kDXAHeight; by += 4) {
+				for (uint bx = 0; bx < kDXAWidth; bx += 4) {
+					bool same = true;
+					for (uint y = by; y < by + 4; y++)
+						same = same && !memcmp(&prev[y * kDXAWidth + bx], &cur[y * kDXAWidth + bx], 4);
+
+					blocks.push_back(same ? 0 : 3);
+					if (!same)
+						for (uint y = by; y < by + 4; y++)
+							for (uint x = bx; x < bx + 4; x++)
+								blocks.push_back(cur[y * kDXAWidth + x]);
+				}
+			}
+			out.writeByte(12);
+			writeZlib(out, blocks);
+		}
+
+		prev = cur;
+	}
+
+	return new Common::MemoryReadStream(out.getData(), out.size(), DisposeAfterUse::YES);
+}
+
+#endif
@@ -31,10 +31,12 @@
 #define VIDEO_BINK_DECODER_H
 
 #include "common/array.h"
+#include "common/bitarray.h"
 #include "common/bitstream.h"
 #include "common/rational.h"
 
 #include "video/video_decoder.h"
+#include "video/bink_dsp.h"
 
 #include "graphics/surface.h"
 
@@ -157,6 +159,7 @@ private:
 		int getCurFrame() const override { return _curFrame; }
 		int getFrameCount() const override { return _frameCount; }
 		const Graphics::Surface *decodeNextFrame() override { return _surface; }
+		const Common::List<Common::Rect> *getFrameDirtyRects() const override { return &_dirtyRects; }
 		bool isSeekable() const  override{ return true; }
 		bool seek(const Audio::Timestamp &time) override { return true; }
 		bool rewind() override;
@@ -275,6 +278,11 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		BinkDSP _dsp; ///< The block transforms for the CPU.
+
+		Common::BitArray _changedBlocks;       ///< The Y plane blocks not skipped in the current frame.
+		Common::List<Common::Rect> _dirtyRects; ///< The areas changed by the current frame.
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -286,6 +294,9 @@ private:
 		/** Decode a plane. */
 		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
 
+		/** Mark a square of blocks of a plane as changed. */
+		void markChangedBlocks(uint32 blockX, uint32 blockY, uint32 size, bool isChroma);
+
 		/** Read/Initialize a bundle for decoding a plane. */
 		void readBundle(VideoFrame &video, Source source);
 
@@ -330,11 +341,6 @@ private:
 		void readDCS         (VideoFrame &video, Bundle &bundle);
 		void readDCTCoeffs   (VideoFrame &video, int32 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
-
-		// Bink video IDCT
-		void IDCT(int32 *block);
-		void IDCTPut(DecodeContext &ctx, int32 *block);
-		void IDCTAdd(DecodeContext &ctx, int32 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
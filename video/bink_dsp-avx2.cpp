@@ -0,0 +1,172 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "video/bink_dsp.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Video {
+
+static FORCEINLINE __m256i mulShift(__m256i x, int32 c) {
+	return _mm256_srai_epi32(_mm256_mullo_epi32(x, _mm256_set1_epi32(c)), 11);
+}
+
+/** The 1D IDCT of IDCT_TRANSFORM, on all eight columns or rows at once. */
+static FORCEINLINE void idct8(const __m256i *s, __m256i *d) {
+	const __m256i a0 = _mm256_add_epi32(s[0], s[4]);
+	const __m256i a1 = _mm256_sub_epi32(s[0], s[4]);
+	const __m256i a2 = _mm256_add_epi32(s[2], s[6]);
+	const __m256i a3 = mulShift(_mm256_sub_epi32(s[2], s[6]), 2896);
+	const __m256i a4 = _mm256_add_epi32(s[5], s[3]);
+	const __m256i a5 = _mm256_sub_epi32(s[5], s[3]);
+	const __m256i a6 = _mm256_add_epi32(s[1], s[7]);
+	const __m256i a7 = _mm256_sub_epi32(s[1], s[7]);
+	const __m256i b0 = _mm256_add_epi32(a4, a6);
+	const __m256i b1 = mulShift(_mm256_add_epi32(a5, a7), 3784);
+	const __m256i b2 = _mm256_add_epi32(_mm256_sub_epi32(mulShift(a5, -5352), b0), b1);
+	const __m256i b3 = _mm256_sub_epi32(mulShift(_mm256_sub_epi32(a6, a4), 2896), b2);
+	const __m256i b4 = _mm256_sub_epi32(_mm256_add_epi32(mulShift(a7, 2217), b3), b1);
+
+	const __m256i c0 = _mm256_add_epi32(a0, a2);
+	const __m256i c1 = _mm256_sub_epi32(_mm256_add_epi32(a1, a3), a2);
+	const __m256i c2 = _mm256_add_epi32(_mm256_sub_epi32(a1, a3), a2);
+	const __m256i c3 = _mm256_sub_epi32(a0, a2);
+
+	d[0] = _mm256_add_epi32(c0, b0);
+	d[1] = _mm256_add_epi32(c1, b2);
+	d[2] = _mm256_add_epi32(c2, b3);
+	d[3] = _mm256_sub_epi32(c3, b4);
+	d[4] = _mm256_add_epi32(c3, b4);
+	d[5] = _mm256_sub_epi32(c2, b3);
+	d[6] = _mm256_sub_epi32(c1, b2);
+	d[7] = _mm256_sub_epi32(c0, b0);
+}
+
+static FORCEINLINE void transpose8(__m256i *r) {
+	__m256i t[8], u[8];
+	for (int i = 0; i < 8; i += 2) {
+		t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+		t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+	}
+	for (int i = 0; i < 8; i += 4) {
+		u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+		u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+		u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+		u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+	}
+	for (int i = 0; i < 4; i++) {
+		r[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+		r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+	}
+}
+
+/** The 2D IDCT of a block, with a row of the result in each of out[]. */
+static FORCEINLINE void idct2D(const int32 *block, __m256i *out) {
+	__m256i s[8];
+	for (int i = 0; i < 8; i++)
+		s[i] = _mm256_loadu_si256((const __m256i *)(block + 8 * i));
+
+	idct8(s, out);
+	transpose8(out);
+	idct8(out, s);
+
+	// MUNGE_ROW
+	for (int i = 0; i < 8; i++)
+		out[i] = _mm256_srai_epi32(_mm256_add_epi32(s[i], _mm256_set1_epi32(0x7F)), 8);
+	transpose8(out);
+}
+
+/** Truncate the values of two rows to bytes, in the low and high 64 bits. */
+static FORCEINLINE __m128i truncateRows(__m256i row1, __m256i row2) {
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	row1 = _mm256_and_si256(row1, mask);
+	row2 = _mm256_and_si256(row2, mask);
+	const __m128i words1 = _mm_packs_epi32(_mm256_castsi256_si128(row1), _mm256_extracti128_si256(row1, 1));
+	const __m128i words2 = _mm_packs_epi32(_mm256_castsi256_si128(row2), _mm256_extracti128_si256(row2, 1));
+	return _mm_packus_epi16(words1, words2);
+}
+
+static void idctAVX2(int32 *block) {
+	__m256i out[8];
+	idct2D(block, out);
+
+	for (int i = 0; i < 8; i++)
+		_mm256_storeu_si256((__m256i *)(block + 8 * i), out[i]);
+}
+
+static void idctPutAVX2(byte *dest, uint32 pitch, const int32 *block) {
+	__m256i out[8];
+	idct2D(block, out);
+
+	for (int i = 0; i < 8; i += 2, dest += 2 * pitch) {
+		const __m128i pixels = truncateRows(out[i], out[i + 1]);
+		_mm_storel_epi64((__m128i *)dest, pixels);
+		_mm_storel_epi64((__m128i *)(dest + pitch), _mm_unpackhi_epi64(pixels, pixels));
+	}
+}
+
+static void idctAddAVX2(byte *dest, uint32 pitch, const int32 *block) {
+	__m256i out[8];
+	idct2D(block, out);
+
+	for (int i = 0; i < 8; i += 2, dest += 2 * pitch) {
+		const __m128i pixels = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)dest), _mm_loadl_epi64((const __m128i *)(dest + pitch)));
+		const __m128i sum = _mm_add_epi8(pixels, truncateRows(out[i], out[i + 1]));
+		_mm_storel_epi64((__m128i *)dest, sum);
+		_mm_storel_epi64((__m128i *)(dest + pitch), _mm_unpackhi_epi64(sum, sum));
+	}
+}
+
+static void addResidueAVX2(byte *dest, uint32 pitch, const int16 *block) {
+	const __m256i mask = _mm256_set1_epi16(0xFF);
+	for (int i = 0; i < 8; i += 2, dest += 2 * pitch, block += 16) {
+		const __m256i words = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)block), mask);
+		const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+		const __m128i pixels = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)dest), _mm_loadl_epi64((const __m128i *)(dest + pitch)));
+		const __m128i sum = _mm_add_epi8(pixels, bytes);
+		_mm_storel_epi64((__m128i *)dest, sum);
+		_mm_storel_epi64((__m128i *)(dest + pitch), _mm_unpackhi_epi64(sum, sum));
+	}
+}
+
+void initBinkDSPAVX2(BinkDSP &dsp) {
+	dsp.idct = idctAVX2;
+	dsp.idctPut = idctPutAVX2;
+	dsp.idctAdd = idctAddAVX2;
+	dsp.addResidue = addResidueAVX2;
+}
+
+} // End of namespace Video
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
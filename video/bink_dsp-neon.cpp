@@ -0,0 +1,180 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "video/bink_dsp.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__)
+
+namespace Video {
+
+static FORCEINLINE int32x4_t mulShift(int32x4_t x, int32 c) {
+	return vshrq_n_s32(vmulq_n_s32(x, c), 11);
+}
+
+/** The 1D IDCT of IDCT_TRANSFORM, on four columns or rows at once. */
+static FORCEINLINE void idct8(const int32x4_t *s, int32x4_t *d) {
+	const int32x4_t a0 = vaddq_s32(s[0], s[4]);
+	const int32x4_t a1 = vsubq_s32(s[0], s[4]);
+	const int32x4_t a2 = vaddq_s32(s[2], s[6]);
+	const int32x4_t a3 = mulShift(vsubq_s32(s[2], s[6]), 2896);
+	const int32x4_t a4 = vaddq_s32(s[5], s[3]);
+	const int32x4_t a5 = vsubq_s32(s[5], s[3]);
+	const int32x4_t a6 = vaddq_s32(s[1], s[7]);
+	const int32x4_t a7 = vsubq_s32(s[1], s[7]);
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = mulShift(vaddq_s32(a5, a7), 3784);
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(mulShift(a5, -5352), b0), b1);
+	const int32x4_t b3 = vsubq_s32(mulShift(vsubq_s32(a6, a4), 2896), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(mulShift(a7, 2217), b3), b1);
+
+	const int32x4_t c0 = vaddq_s32(a0, a2);
+	const int32x4_t c1 = vsubq_s32(vaddq_s32(a1, a3), a2);
+	const int32x4_t c2 = vaddq_s32(vsubq_s32(a1, a3), a2);
+	const int32x4_t c3 = vsubq_s32(a0, a2);
+
+	d[0] = vaddq_s32(c0, b0);
+	d[1] = vaddq_s32(c1, b2);
+	d[2] = vaddq_s32(c2, b3);
+	d[3] = vsubq_s32(c3, b4);
+	d[4] = vaddq_s32(c3, b4);
+	d[5] = vsubq_s32(c2, b3);
+	d[6] = vsubq_s32(c1, b2);
+	d[7] = vsubq_s32(c0, b0);
+}
+
+static FORCEINLINE void transpose4(int32x4_t &r0, int32x4_t &r1, int32x4_t &r2, int32x4_t &r3) {
+	const int32x4x2_t t01 = vtrnq_s32(r0, r1);
+	const int32x4x2_t t23 = vtrnq_s32(r2, r3);
+	r0 = vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0]));
+	r1 = vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1]));
+	r2 = vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0]));
+	r3 = vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]));
+}
+
+/**
+ * The 2D IDCT of a block. The rows of the result are in out[2 * i] for
+ * the left half and in out[2 * i + 1] for the right half.
+ */
+static FORCEINLINE void idct2D(const int32 *block, int32x4_t *out) {
+	// Columns, for the left and the right half of the rows
+	int32x4_t s[8], temp[16];
+	for (int h = 0; h < 2; h++) {
+		for (int i = 0; i < 8; i++)
+			s[i] = vld1q_s32(block + 8 * i + 4 * h);
+
+		int32x4_t d[8];
+		idct8(s, d);
+		for (int i = 0; i < 8; i++)
+			temp[2 * i + h] = d[i];
+	}
+
+	// Rows, four at once
+	for (int g = 0; g < 2; g++) {
+		for (int h = 0; h < 2; h++) {
+			for (int i = 0; i < 4; i++)
+				s[4 * h + i] = temp[2 * (4 * g + i) + h];
+			transpose4(s[4 * h], s[4 * h + 1], s[4 * h + 2], s[4 * h + 3]);
+		}
+
+		int32x4_t d[8];
+		idct8(s, d);
+
+		// MUNGE_ROW
+		for (int i = 0; i < 8; i++)
+			d[i] = vshrq_n_s32(vaddq_s32(d[i], vdupq_n_s32(0x7F)), 8);
+
+		for (int h = 0; h < 2; h++) {
+			transpose4(d[4 * h], d[4 * h + 1], d[4 * h + 2], d[4 * h + 3]);
+			for (int i = 0; i < 4; i++)
+				out[2 * (4 * g + i) + h] = d[4 * h + i];
+		}
+	}
+}
+
+/** Truncate the values of a row to bytes. */
+static FORCEINLINE uint8x8_t truncateRow(int32x4_t left, int32x4_t right) {
+	return vreinterpret_u8_s8(vmovn_s16(vcombine_s16(vmovn_s32(left), vmovn_s32(right))));
+}
+
+static void idctNEON(int32 *block) {
+	int32x4_t out[16];
+	idct2D(block, out);
+
+	for (int i = 0; i < 16; i++)
+		vst1q_s32(block + 4 * i, out[i]);
+}
+
+static void idctPutNEON(byte *dest, uint32 pitch, const int32 *block) {
+	int32x4_t out[16];
+	idct2D(block, out);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, truncateRow(out[2 * i], out[2 * i + 1]));
+}
+
+static void idctAddNEON(byte *dest, uint32 pitch, const int32 *block) {
+	int32x4_t out[16];
+	idct2D(block, out);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), truncateRow(out[2 * i], out[2 * i + 1])));
+}
+
+static void addResidueNEON(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), vreinterpret_u8_s8(vmovn_s16(vld1q_s16(block)))));
+}
+
+void initBinkDSPNEON(BinkDSP &dsp) {
+	dsp.idct = idctNEON;
+	dsp.idctPut = idctPutNEON;
+	dsp.idctAdd = idctAddNEON;
+	dsp.addResidue = addResidueNEON;
+}
+
+} // End of namespace Video
+
+#if !defined(__aarch64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__)
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,195 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "video/bink_dsp.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Video {
+
+/**
+ * Multiply 32-bit lanes by a constant and shift them right by 11 bits.
+ * SSE2 only has 32x32 bit multiplications giving 64-bit results, the low
+ * 32 bits of these are the same as with signed operands.
+ */
+static FORCEINLINE __m128i mulShift(__m128i x, int32 c) {
+	const __m128i k = _mm_set1_epi32(c);
+	const __m128i even = _mm_mul_epu32(x, k);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), k);
+	const __m128i product = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	return _mm_srai_epi32(product, 11);
+}
+
+/** The 1D IDCT of IDCT_TRANSFORM, on four columns or rows at once. */
+static FORCEINLINE void idct8(const __m128i *s, __m128i *d) {
+	const __m128i a0 = _mm_add_epi32(s[0], s[4]);
+	const __m128i a1 = _mm_sub_epi32(s[0], s[4]);
+	const __m128i a2 = _mm_add_epi32(s[2], s[6]);
+	const __m128i a3 = mulShift(_mm_sub_epi32(s[2], s[6]), 2896);
+	const __m128i a4 = _mm_add_epi32(s[5], s[3]);
+	const __m128i a5 = _mm_sub_epi32(s[5], s[3]);
+	const __m128i a6 = _mm_add_epi32(s[1], s[7]);
+	const __m128i a7 = _mm_sub_epi32(s[1], s[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = mulShift(_mm_add_epi32(a5, a7), 3784);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(mulShift(a5, -5352), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(mulShift(_mm_sub_epi32(a6, a4), 2896), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(mulShift(a7, 2217), b3), b1);
+
+	const __m128i c0 = _mm_add_epi32(a0, a2);
+	const __m128i c1 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i c2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+	const __m128i c3 = _mm_sub_epi32(a0, a2);
+
+	d[0] = _mm_add_epi32(c0, b0);
+	d[1] = _mm_add_epi32(c1, b2);
+	d[2] = _mm_add_epi32(c2, b3);
+	d[3] = _mm_sub_epi32(c3, b4);
+	d[4] = _mm_add_epi32(c3, b4);
+	d[5] = _mm_sub_epi32(c2, b3);
+	d[6] = _mm_sub_epi32(c1, b2);
+	d[7] = _mm_sub_epi32(c0, b0);
+}
+
+static FORCEINLINE void transpose4(__m128i &r0, __m128i &r1, __m128i &r2, __m128i &r3) {
+	const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	r0 = _mm_unpacklo_epi64(t0, t1);
+	r1 = _mm_unpackhi_epi64(t0, t1);
+	r2 = _mm_unpacklo_epi64(t2, t3);
+	r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+/**
+ * The 2D IDCT of a block. The rows of the result are in out[2 * i] for
+ * the left half and in out[2 * i + 1] for the right half.
+ */
+static FORCEINLINE void idct2D(const int32 *block, __m128i *out) {
+	// Columns, for the left and the right half of the rows
+	__m128i s[8], temp[16];
+	for (int h = 0; h < 2; h++) {
+		for (int i = 0; i < 8; i++)
+			s[i] = _mm_loadu_si128((const __m128i *)(block + 8 * i + 4 * h));
+
+		__m128i d[8];
+		idct8(s, d);
+		for (int i = 0; i < 8; i++)
+			temp[2 * i + h] = d[i];
+	}
+
+	// Rows, four at once
+	for (int g = 0; g < 2; g++) {
+		for (int h = 0; h < 2; h++) {
+			for (int i = 0; i < 4; i++)
+				s[4 * h + i] = temp[2 * (4 * g + i) + h];
+			transpose4(s[4 * h], s[4 * h + 1], s[4 * h + 2], s[4 * h + 3]);
+		}
+
+		__m128i d[8];
+		idct8(s, d);
+
+		// MUNGE_ROW
+		for (int i = 0; i < 8; i++)
+			d[i] = _mm_srai_epi32(_mm_add_epi32(d[i], _mm_set1_epi32(0x7F)), 8);
+
+		for (int h = 0; h < 2; h++) {
+			transpose4(d[4 * h], d[4 * h + 1], d[4 * h + 2], d[4 * h + 3]);
+			for (int i = 0; i < 4; i++)
+				out[2 * (4 * g + i) + h] = d[4 * h + i];
+		}
+	}
+}
+
+/** Truncate the values of a row to bytes, in the low half. */
+static FORCEINLINE __m128i truncateRow(__m128i left, __m128i right) {
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i words = _mm_packs_epi32(_mm_and_si128(left, mask), _mm_and_si128(right, mask));
+	return _mm_packus_epi16(words, words);
+}
+
+static void idctSSE2(int32 *block) {
+	__m128i out[16];
+	idct2D(block, out);
+
+	for (int i = 0; i < 16; i++)
+		_mm_storeu_si128((__m128i *)(block + 4 * i), out[i]);
+}
+
+static void idctPutSSE2(byte *dest, uint32 pitch, const int32 *block) {
+	__m128i out[16];
+	idct2D(block, out);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		_mm_storel_epi64((__m128i *)dest, truncateRow(out[2 * i], out[2 * i + 1]));
+}
+
+static void idctAddSSE2(byte *dest, uint32 pitch, const int32 *block) {
+	__m128i out[16];
+	idct2D(block, out);
+
+	for (int i = 0; i < 8; i++, dest += pitch) {
+		const __m128i pixels = _mm_loadl_epi64((const __m128i *)dest);
+		_mm_storel_epi64((__m128i *)dest, _mm_add_epi8(pixels, truncateRow(out[2 * i], out[2 * i + 1])));
+	}
+}
+
+static void addResidueSSE2(byte *dest, uint32 pitch, const int16 *block) {
+	const __m128i mask = _mm_set1_epi16(0xFF);
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8) {
+		const __m128i words = _mm_and_si128(_mm_loadu_si128((const __m128i *)block), mask);
+		const __m128i pixels = _mm_loadl_epi64((const __m128i *)dest);
+		_mm_storel_epi64((__m128i *)dest, _mm_add_epi8(pixels, _mm_packus_epi16(words, words)));
+	}
+}
+
+void initBinkDSPSSE2(BinkDSP &dsp) {
+	dsp.idct = idctSSE2;
+	dsp.idctPut = idctPutSSE2;
+	dsp.idctAdd = idctAddSSE2;
+	dsp.addResidue = addResidueSSE2;
+}
+
+} // End of namespace Video
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
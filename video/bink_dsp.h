@@ -0,0 +1,68 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef USE_BINK
+
+#ifndef VIDEO_BINK_DSP_H
+#define VIDEO_BINK_DSP_H
+
+namespace Video {
+
+/**
+ * The transforms of the Bink video decoder which work on whole 8x8 blocks,
+ * with variants for different CPU features. All variants give exactly the
+ * same results.
+ *
+ * Like the reference decoder, pixel values are truncated to 8 bits, not
+ * clamped.
+ */
+struct BinkDSP {
+	/** Apply the IDCT to a block of coefficients, in place. */
+	void (*idct)(int32 *block);
+	/** Apply the IDCT to a block of coefficients and store the pixels. */
+	void (*idctPut)(byte *dest, uint32 pitch, const int32 *block);
+	/** Apply the IDCT to a block of coefficients and add it to the pixels. */
+	void (*idctAdd)(byte *dest, uint32 pitch, const int32 *block);
+	/** Add a block of residue to the pixels. */
+	void (*addResidue)(byte *dest, uint32 pitch, const int16 *block);
+};
+
+/** Set up the fastest variants for the CPU. */
+void initBinkDSP(BinkDSP &dsp);
+
+void initBinkDSPGeneric(BinkDSP &dsp);
+#ifdef SCUMMVM_NEON
+void initBinkDSPNEON(BinkDSP &dsp);
+#endif
+#ifdef SCUMMVM_SSE2
+void initBinkDSPSSE2(BinkDSP &dsp);
+#endif
+#ifdef SCUMMVM_AVX2
+void initBinkDSPAVX2(BinkDSP &dsp);
+#endif
+
+} // End of namespace Video
+
+#endif // VIDEO_BINK_DSP_H
+
+#endif // USE_BINK
@@ -33,6 +33,8 @@
 
 #include "common/compression/deflate.h"
 
+#include "image/codecs/codec.h"
+
 namespace Video {
 
 DXADecoder::DXADecoder() {
@@ -121,6 +123,8 @@ DXADecoder::DXAVideoTrack::DXAVideoTrack(Common::SeekableReadStream *stream) {
 		_scaledBuffer = new byte[_frameSize]();
 	}
 
+	_changedBlocks.set_size(((_width + 3) / 4) * ((_height + 3) / 4));
+
 #ifdef DXA_EXPERIMENT_MAXD
 	// Check for an extended header
 	if (flags & 1) {
@@ -199,6 +203,9 @@ void DXADecoder::DXAVideoTrack::decode12(int size) {
 			byte type = *dat++;
 			byte *b2 = _frameBuffer1 + bx + by * _width;
 
+			if (type != 0 && type != 5)
+				_changedBlocks.set((by / BLOCKH) * ((_width + BLOCKW - 1) / BLOCKW) + bx / BLOCKW);
+
 			switch (type) {
 			case 0:
 				break;
@@ -307,6 +314,9 @@ void DXADecoder::DXAVideoTrack::decode13(int size) {
 			uint8 type = *codeBuf++;
 			uint8 *b2 = (uint8 *)_frameBuffer1 + bx + by * _width;
 
+			if (type != 0)
+				_changedBlocks.set((by / BLOCKH) * ((_width + BLOCKW - 1) / BLOCKW) + bx / BLOCKW);
+
 			switch (type) {
 			case 0:
 				break;
@@ -469,6 +479,10 @@ const Graphics::Surface *DXADecoder::DXAVideoTrack::decodeNextFrame() {
 		_dirtyPalette = true;
 	}
 
+	// Without a frame, nothing changes
+	_dirtyRects.clear();
+	_changedBlocks.clear();
+
 	tag = _fileStream->readUint32BE();
 	if (tag == MKTAG('F','R','A','M')) {
 		byte type = _fileStream->readByte();
@@ -485,9 +499,11 @@ const Graphics::Surface *DXADecoder::DXAVideoTrack::decodeNextFrame() {
 		switch (type) {
 		case 2:
 			decodeZlib(_frameBuffer1, size, _frameSize);
+			_dirtyRects.push_back(Common::Rect(_width, _height));
 			break;
 		case 3:
 			decodeZlib(_frameBuffer2, size, _frameSize);
+			_dirtyRects.push_back(Common::Rect(_width, _height));
 			break;
 		case 12:
 			decode12(size);
@@ -507,6 +523,10 @@ const Graphics::Surface *DXADecoder::DXAVideoTrack::decodeNextFrame() {
 				}
 			}
 		}
+
+		// The rows of the blocks are doubled when scaling
+		if (type == 12 || type == 13)
+			Image::Codec::blocksToRects(_changedBlocks, (_width + BLOCKW - 1) / BLOCKW, BLOCKW, (_scaleMode == S_NONE) ? BLOCKH : BLOCKH * 2, _width, _height, _dirtyRects);
 	}
 
 	switch (_scaleMode) {
@@ -22,6 +22,7 @@
 #ifndef VIDEO_DXA_DECODER_H
 #define VIDEO_DXA_DECODER_H
 
+#include "common/bitarray.h"
 #include "common/rational.h"
 #include "graphics/pixelformat.h"
 #include "video/video_decoder.h"
@@ -70,6 +71,7 @@ private:
 		const Graphics::Surface *decodeNextFrame();
 		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
 		bool hasDirtyPalette() const { return _dirtyPalette; }
+		const Common::List<Common::Rect> *getFrameDirtyRects() const { return &_dirtyRects; }
 
 		void setFrameStartPos();
 
@@ -107,6 +109,9 @@ private:
 		mutable bool _dirtyPalette;
 		int _curFrame;
 		uint32 _frameStartOffset;
+
+		Common::BitArray _changedBlocks;
+		Common::List<Common::Rect> _dirtyRects;
 	};
 };
 
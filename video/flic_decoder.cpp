@@ -169,6 +169,8 @@ const Graphics::Surface *FlicDecoder::FlicVideoTrack::decodeNextFrame() {
 	/*uint32 frameSize = */ _fileStream->readUint32LE();
 	uint16 frameType = _fileStream->readUint16LE();
 
+	_frameDirtyRects.clear();
+
 	switch (frameType) {
 	case FRAME_TYPE:
 		handleFrame();
@@ -235,8 +237,7 @@ void FlicDecoder::FlicVideoTrack::handleFrame() {
 			break;
 		case FLI_BLACK:
 			_surface->fillRect(Common::Rect(0, 0, getWidth(), getHeight()), 0);
-			_dirtyRects.clear();
-			_dirtyRects.push_back(Common::Rect(0, 0, getWidth(), getHeight()));
+			markWholeFrameDirty();
 			break;
 		case FLI_BRUN:
 			decodeByteRun(data);
@@ -267,12 +268,22 @@ void FlicDecoder::FlicVideoTrack::copyDirtyRectsToBuffer(uint8 *dst, uint pitch)
 	clearDirtyRects();
 }
 
+void FlicDecoder::FlicVideoTrack::addDirtyRect(const Common::Rect &rect) {
+	_dirtyRects.push_back(rect);
+	_frameDirtyRects.push_back(rect);
+}
+
+void FlicDecoder::FlicVideoTrack::markWholeFrameDirty() {
+	_dirtyRects.clear();
+	_frameDirtyRects.clear();
+	addDirtyRect(Common::Rect(0, 0, getWidth(), getHeight()));
+}
+
 void FlicDecoder::FlicVideoTrack::copyFrame(uint8 *data) {
 	memcpy((byte *)_surface->getPixels(), data, getWidth() * getHeight());
 
 	// Redraw
-	_dirtyRects.clear();
-	_dirtyRects.push_back(Common::Rect(0, 0, getWidth(), getHeight()));
+	markWholeFrameDirty();
 }
 
 void FlicDecoder::FlicVideoTrack::decodeByteRun(uint8 *data) {
@@ -294,8 +305,7 @@ void FlicDecoder::FlicVideoTrack::decodeByteRun(uint8 *data) {
 	}
 
 	// Redraw
-	_dirtyRects.clear();
-	_dirtyRects.push_back(Common::Rect(0, 0, getWidth(), getHeight()));
+	markWholeFrameDirty();
 }
 
 #define OP_PACKETCOUNT   0
@@ -324,7 +334,7 @@ void FlicDecoder::FlicVideoTrack::decodeDeltaFLC(uint8 *data) {
 				break;
 			case OP_LASTPIXEL:
 				*((byte *)_surface->getBasePtr(getWidth() - 1, currentLine)) = (opcode & 0xFF);
-				_dirtyRects.push_back(Common::Rect(getWidth() - 1, currentLine, getWidth(), currentLine + 1));
+				addDirtyRect(Common::Rect(getWidth() - 1, currentLine, getWidth(), currentLine + 1));
 				break;
 			case OP_LINESKIPCOUNT:
 				currentLine += -(int16)opcode;
@@ -341,14 +351,14 @@ void FlicDecoder::FlicVideoTrack::decodeDeltaFLC(uint8 *data) {
 			if (rleCount > 0) {
 				memcpy((byte *)_surface->getBasePtr(column, currentLine), data, rleCount * 2);
 				data += rleCount * 2;
-				_dirtyRects.push_back(Common::Rect(column, currentLine, column + rleCount * 2, currentLine + 1));
+				addDirtyRect(Common::Rect(column, currentLine, column + rleCount * 2, currentLine + 1));
 			} else if (rleCount < 0) {
 				rleCount = -rleCount;
 				uint16 dataWord = READ_UINT16(data); data += 2;
 				for (int i = 0; i < rleCount; ++i) {
 					WRITE_UINT16((byte *)_surface->getBasePtr(column + i * 2, currentLine), dataWord);
 				}
-				_dirtyRects.push_back(Common::Rect(column, currentLine, column + rleCount * 2, currentLine + 1));
+				addDirtyRect(Common::Rect(column, currentLine, column + rleCount * 2, currentLine + 1));
 			}
 			column += rleCount * 2;
 		}
@@ -80,6 +80,8 @@ protected:
 		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
 		bool hasDirtyPalette() const { return _dirtyPalette; }
 
+		const Common::List<Common::Rect> *getFrameDirtyRects() const override { return &_frameDirtyRects; }
+
 		const Common::List<Common::Rect> *getDirtyRects() const { return &_dirtyRects; }
 		void clearDirtyRects() { _dirtyRects.clear(); }
 		void copyDirtyRectsToBuffer(uint8 *dst, uint pitch);
@@ -100,8 +102,11 @@ protected:
 		uint32 _frameDelay, _startFrameDelay;
 		uint32 _nextFrameStartTime;
 
-		Common::List<Common::Rect> _dirtyRects;
+		Common::List<Common::Rect> _dirtyRects;      ///< The areas changed since the engine last cleared them.
+		Common::List<Common::Rect> _frameDirtyRects; ///< The areas changed by the current frame.
 
+		void addDirtyRect(const Common::Rect &rect);
+		void markWholeFrameDirty();
 		void copyFrame(uint8 *data);
 		void decodeByteRun(uint8 *data);
 		void decodeDeltaFLC(uint8 *data);
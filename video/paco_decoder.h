@@ -81,6 +81,8 @@ protected:
 		const byte *getPalette() const override;
 		bool hasDirtyPalette() const override { return _dirtyPalette; }
 
+		const Common::List<Common::Rect> *getFrameDirtyRects() const override { return &_dirtyRects; }
+
 		const Common::List<Common::Rect> *getDirtyRects() const { return &_dirtyRects; }
 		void clearDirtyRects() { _dirtyRects.clear(); }
 		void copyDirtyRectsToBuffer(uint8 *dst, uint pitch);
@@ -87,9 +87,7 @@ void QuickTimeDecoder::close() {
 	}
 }
 
-const Graphics::Surface *QuickTimeDecoder::decodeNextFrame() {
-	const Graphics::Surface *frame = VideoDecoder::decodeNextFrame();
-
+const Graphics::Surface *QuickTimeDecoder::processFrame(const Graphics::Surface *frame) {
 	// Update audio buffers too
 	// (needs to be done after we find the next track)
 	updateAudioBuffer();
@@ -306,6 +304,10 @@ QuickTimeDecoder::VideoTrackHandler::VideoTrackHandler(QuickTimeDecoder *decoder
 	_curEdit = 0;
 	_curFrame = -1;
 	_delayedFrameToBufferTo = -1;
+	_lastCodec = 0;
+	_codecDirtyRects = 0;
+	_dirtyRects = 0;
+	_framesBuffered = 0;
 	enterNewEditListEntry(true, true); // might set _curFrame
 	if (decoder->_qtvrType == QTVRType::OBJECT)
 		_curFrame = getFrameCount() / 2;
@@ -523,6 +525,8 @@ uint32 QuickTimeDecoder::VideoTrackHandler::getNextFrameStartTime() const {
 }
 
 const Graphics::Surface *QuickTimeDecoder::VideoTrackHandler::decodeNextFrame() {
+	_dirtyRects = 0;
+
 	if (_decoder->_qtvrType == QTVRType::PANORAMA) {
 		if (!_isPanoConstructed)
 			return nullptr;
@@ -571,8 +575,15 @@ const Graphics::Surface *QuickTimeDecoder::VideoTrackHandler::decodeNextFrame()
 			return 0;
 	}
 
+	const uint32 framesBuffered = _framesBuffered;
 	const Graphics::Surface *frame = bufferNextFrame();
 
+	// The changes reported by the codec are only right when exactly the
+	// frame after the previous one was decoded, and shown as it is
+	if (!_reversed && !_forcedDitherPalette && _framesBuffered == framesBuffered + 1 &&
+	    _parent->scaleFactorX == 1 && _parent->scaleFactorY == 1)
+		_dirtyRects = _codecDirtyRects;
+
 	if (_reversed) {
 		if (_durationOverride >= 0) {
 			// Use our own duration overridden from a media seek
@@ -1003,6 +1014,11 @@ const Graphics::Surface *QuickTimeDecoder::VideoTrackHandler::bufferNextFrame()
 	const Graphics::Surface *frame = entry->_videoCodec->decodeFrame(*frameData);
 	delete frameData;
 
+	// A codec only knows the changes to its own previous frame
+	_codecDirtyRects = (entry->_videoCodec == _lastCodec) ? entry->_videoCodec->getDirtyRects() : 0;
+	_lastCodec = entry->_videoCodec;
+	_framesBuffered++;
+
 	// Update the palette
 	if (entry->_videoCodec->containsPalette()) {
 		// The codec itself contains a palette
@@ -67,7 +67,6 @@ public:
 	void close();
 	uint16 getWidth() const { return _width; }
 	uint16 getHeight() const { return _height; }
-	const Graphics::Surface *decodeNextFrame();
 	Audio::Timestamp getDuration() const { return Audio::Timestamp(0, _duration, _timeScale); }
 
 	void enableEditListBoundsCheckQuirk(bool enable) { _enableEditListBoundsCheckQuirk = enable; }
@@ -115,6 +114,7 @@ public:
 	NodeData getNodeData(uint32 nodeID);
 
 protected:
+	const Graphics::Surface *processFrame(const Graphics::Surface *frame) override;
 	Common::QuickTimeParser::SampleDesc *readSampleDesc(Common::QuickTimeParser::Track *track, uint32 format, uint32 descSize);
 
 private:
@@ -193,6 +193,7 @@ private:
 		Audio::Timestamp getFrameTime(uint frame) const;
 		const byte *getPalette() const;
 		bool hasDirtyPalette() const { return _curPalette; }
+		const Common::List<Common::Rect> *getFrameDirtyRects() const { return _dirtyRects; }
 		bool setReverse(bool reverse);
 		bool isReversed() const { return _reversed; }
 		bool canDither() const;
@@ -221,6 +222,12 @@ private:
 		mutable bool _dirtyPalette;
 		bool _reversed;
 
+		// Changes reported by the codecs, for frames following the previous one
+		Image::Codec *_lastCodec;
+		const Common::List<Common::Rect> *_codecDirtyRects;
+		const Common::List<Common::Rect> *_dirtyRects;
+		uint32 _framesBuffered;
+
 		float _panAngle;
 		float _tiltAngle;
 		float _fov;
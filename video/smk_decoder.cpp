@@ -44,6 +44,8 @@
 #include "audio/mixer.h"
 #include "audio/decoders/raw.h"
 
+#include "image/codecs/codec.h"
+
 namespace Video {
 
 enum SmkBlockTypes {
@@ -491,6 +493,10 @@ const Graphics::Surface *SmackerDecoder::forceSeekToFrame(uint frame) {
 		surface = decodeNextFrame();
 	}
 
+	// Only the last of the frames decoded here is returned
+	if (surface)
+		markWholeFrameDirty(*surface);
+
 	_lastTimeChange = videoTrack->getFrameTime(frame);
 	if (isPlaying()) {
 		_startTime = g_system->getMillis() - (_lastTimeChange.msecs() / getRate()).toInt();
@@ -790,6 +796,8 @@ void SmackerDecoder::SmackerVideoTrack::decodeFrame(SmackerBitStream &bs) {
 			break;
 		}
 	}
+
+	Image::Codec::blocksToRects(_dirtyBlocks, bw, 4, 4 * doubleY, getWidth(), getHeight(), _dirtyRects);
 }
 
 void SmackerDecoder::SmackerVideoTrack::unpackPalette(Common::SeekableReadStream *stream) {
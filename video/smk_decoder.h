@@ -112,6 +112,7 @@ protected:
 		const Graphics::Surface *decodeNextFrame() { return _surface; }
 		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
 		bool hasDirtyPalette() const { return _dirtyPalette; }
+		const Common::List<Common::Rect> *getFrameDirtyRects() const { return &_dirtyRects; }
 
 		void readTrees(SmackerBitStream &bs, uint32 mMapSize, uint32 mClrSize, uint32 fullSize, uint32 typeSize);
 		void increaseCurFrame() { _curFrame++; }
@@ -141,6 +142,7 @@ protected:
 		BigHuffmanTree *_TypeTree;
 
 		Common::BitArray _dirtyBlocks;
+		Common::List<Common::Rect> _dirtyRects;
 		Common::Rect _lastDirtyRect;
 
 		// Possible runs of blocks
@@ -28,6 +28,8 @@
 #include "common/file.h"
 #include "common/system.h"
 
+#include "graphics/surface.h"
+
 namespace Video {
 
 VideoDecoder::VideoDecoder() {
@@ -45,9 +47,17 @@ VideoDecoder::VideoDecoder() {
 	_endTimeSet = false;
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
+	_dirtyRectsTrack = 0;
+	_decodeAheadFrames = 0;
+	_shownFrame = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
 	_videoCodecAccuracy = Image::CodecAccuracy::Default;
+	resetDecodeAheadStats();
+}
+
+VideoDecoder::~VideoDecoder() {
+	freeFrameQueue();
 }
 
 void VideoDecoder::close() {
@@ -72,8 +82,11 @@ void VideoDecoder::close() {
 	_endTimeSet = false;
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
+	_frameDirtyRects.clear();
+	_dirtyRectsTrack = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
+	freeFrameQueue();
 }
 
 bool VideoDecoder::loadFile(const Common::Path &filename) {
@@ -114,10 +127,65 @@ bool VideoDecoder::needsUpdate() const {
 }
 
 void VideoDecoder::delayMillis(uint msecs) {
-	if (!needsUpdate())
-		g_system->delayMillis(MIN<uint>(msecs, getTimeToNextFrame()));
-	else
+	if (!needsUpdate()) {
+		uint32 delay = MIN<uint>(msecs, getTimeToNextFrame());
+
+		// Use the time for the frames to come, if there is any to spare
+		uint32 startTime = g_system->getMillis();
+		decodeAhead(delay);
+		uint32 elapsed = g_system->getMillis() - startTime;
+
+		if (elapsed < delay)
+			g_system->delayMillis(delay - elapsed);
+	} else {
 		g_system->delayMillis(1); /* This is needed to keep the mixer and timers active */
+	}
+}
+
+bool VideoDecoder::setDecodeAhead(uint frames) {
+	if (!canDecodeAhead())
+		frames = 0;
+
+	_decodeAheadFrames = frames;
+
+	// Frames already queued are still shown, only free unused surfaces
+	while (!_freeFrames.empty() && _freeFrames.size() + _frameQueue.size() > frames) {
+		_freeFrames.back()->surface->free();
+		delete _freeFrames.back()->surface;
+		delete _freeFrames.back();
+		_freeFrames.pop_back();
+	}
+
+	return frames != 0;
+}
+
+uint VideoDecoder::decodeAhead(uint32 maxMillis) {
+	uint32 startTime = g_system->getMillis();
+	uint frames = 0;
+
+	while (_frameQueue.size() < _decodeAheadFrames) {
+		// Don't start on a frame which is not expected to be done in time
+		uint32 elapsed = g_system->getMillis() - startTime;
+		uint32 averageTime = _decodeAheadStats.decodedFrames ? _decodeAheadStats.totalDecodeTime / _decodeAheadStats.decodedFrames : 0;
+		if (elapsed >= maxMillis || maxMillis - elapsed <= averageTime)
+			break;
+
+		if (!queueNextFrame())
+			break;
+
+		frames++;
+	}
+
+	return frames;
+}
+
+void VideoDecoder::resetDecodeAheadStats() {
+	_decodeAheadStats.decodedFrames = 0;
+	_decodeAheadStats.lateFrames = 0;
+	_decodeAheadStats.queuedFrames = _frameQueue.size();
+	_decodeAheadStats.maxQueuedFrames = _frameQueue.size();
+	_decodeAheadStats.totalDecodeTime = 0;
+	_decodeAheadStats.maxDecodeTime = 0;
 }
 
 void VideoDecoder::pauseVideo(bool pause) {
@@ -212,6 +280,15 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_canSetDither = false;
 	_canSetDefaultFormat = false;
 
+	if (!_frameQueue.empty())
+		return showQueuedFrame();
+
+	// The frame shown last is not needed anymore
+	if (_shownFrame) {
+		_freeFrames.push_back(_shownFrame);
+		_shownFrame = 0;
+	}
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -219,8 +296,11 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	if (!_nextVideoTrack)
 		return 0;
 
+	uint32 startTime = g_system->getMillis();
 	const Graphics::Surface *frame = _nextVideoTrack->decodeNextFrame();
 
+	updateDirtyRects(frame, _frameDirtyRects);
+
 	if (_nextVideoTrack->hasDirtyPalette()) {
 		_palette = _nextVideoTrack->getPalette();
 		_dirtyPalette = true;
@@ -229,7 +309,191 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	// Look for the next video track here for the next decode.
 	findNextVideoTrack();
 
-	return frame;
+	const Graphics::Surface *processed = processFrame(frame);
+	if (processed && processed != frame)
+		markWholeFrameDirty(*processed);
+
+	if (_decodeAheadFrames) {
+		_decodeAheadStats.lateFrames++;
+		addDecodeTime(g_system->getMillis() - startTime);
+	}
+
+	return processed;
+}
+
+uint32 VideoDecoder::copyFrameDirtyRects(const Graphics::Surface &frame, Graphics::Surface &dst, int x, int y) const {
+	uint32 bytes = 0;
+	for (Common::List<Common::Rect>::const_iterator it = _frameDirtyRects.begin(); it != _frameDirtyRects.end(); ++it) {
+		Common::Rect rect = *it;
+		rect.clip(Common::Rect(frame.w, frame.h));
+		rect.clip(Common::Rect(-x, -y, dst.w - x, dst.h - y));
+		if (rect.isEmpty())
+			continue;
+
+		dst.copyRectToSurface(frame, x + rect.left, y + rect.top, rect);
+		bytes += rect.width() * rect.height() * frame.format.bytesPerPixel;
+	}
+	return bytes;
+}
+
+uint32 VideoDecoder::copyFrameToScreen(const Graphics::Surface &frame, int x, int y) const {
+	uint32 bytes = 0;
+	for (Common::List<Common::Rect>::const_iterator it = _frameDirtyRects.begin(); it != _frameDirtyRects.end(); ++it) {
+		Common::Rect rect = *it;
+		rect.clip(Common::Rect(frame.w, frame.h));
+		if (rect.isEmpty())
+			continue;
+
+		g_system->copyRectToScreen(frame.getBasePtr(rect.left, rect.top), frame.pitch, x + rect.left, y + rect.top, rect.width(), rect.height());
+		bytes += rect.width() * rect.height() * frame.format.bytesPerPixel;
+	}
+	return bytes;
+}
+
+void VideoDecoder::markWholeFrameDirty(const Graphics::Surface &frame) {
+	_frameDirtyRects.clear();
+	_frameDirtyRects.push_back(Common::Rect(frame.w, frame.h));
+}
+
+void VideoDecoder::updateDirtyRects(const Graphics::Surface *frame, Common::List<Common::Rect> &dirtyRects) {
+	dirtyRects.clear();
+
+	// The changes reported by the track can only be used if the previous
+	// frame came from the same track
+	if (frame) {
+		const Common::List<Common::Rect> *trackRects = _nextVideoTrack->getFrameDirtyRects();
+		if (trackRects && _dirtyRectsTrack == _nextVideoTrack)
+			dirtyRects = *trackRects;
+		else
+			dirtyRects.push_back(Common::Rect(frame->w, frame->h));
+		_dirtyRectsTrack = _nextVideoTrack;
+	} else {
+		_dirtyRectsTrack = 0;
+	}
+}
+
+bool VideoDecoder::queueNextFrame() {
+	if (!_nextVideoTrack)
+		return false;
+
+	// Reversed tracks need the seeking done by the decoders when the
+	// frame is shown
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)*it)->isReversed())
+			return false;
+	}
+
+	// Frames past the end time are only decoded when asked for
+	if (_endTimeSet && _nextVideoTrack->getNextFrameStartTime() >= (uint)_endTime.msecs())
+		return false;
+
+	QueuedFrame *queued;
+	if (!_freeFrames.empty()) {
+		queued = _freeFrames.back();
+		_freeFrames.pop_back();
+	} else {
+		queued = new QueuedFrame();
+		queued->surface = new Graphics::Surface();
+	}
+
+	queued->startTime = _nextVideoTrack->getNextFrameStartTime();
+	queued->curFrame = getTracksCurFrame();
+	queued->track = _nextVideoTrack;
+	queued->trackFrame = _nextVideoTrack->getCurFrame();
+
+	readNextPacket();
+
+	uint32 startTime = g_system->getMillis();
+	const Graphics::Surface *frame = _nextVideoTrack->decodeNextFrame();
+
+	updateDirtyRects(frame, queued->dirtyRects);
+
+	queued->hasPalette = _nextVideoTrack->hasDirtyPalette();
+	if (queued->hasPalette)
+		memcpy(queued->palette, _nextVideoTrack->getPalette(), sizeof(queued->palette));
+
+	findNextVideoTrack();
+
+	const Graphics::Surface *processed = processFrame(frame);
+	if (processed && processed != frame) {
+		queued->dirtyRects.clear();
+		queued->dirtyRects.push_back(Common::Rect(processed->w, processed->h));
+	}
+	frame = processed;
+
+	addDecodeTime(g_system->getMillis() - startTime);
+
+	// The track may reuse its surface for the next frame
+	queued->hasSurface = frame != 0;
+	if (frame) {
+		Graphics::Surface *surface = queued->surface;
+		if (surface->w != frame->w || surface->h != frame->h || surface->format != frame->format) {
+			surface->free();
+			surface->create(frame->w, frame->h, frame->format);
+		}
+		surface->copyRectToSurface(*frame, 0, 0, Common::Rect(frame->w, frame->h));
+	}
+
+	_frameQueue.push_back(queued);
+	_decodeAheadStats.queuedFrames = _frameQueue.size();
+	_decodeAheadStats.maxQueuedFrames = MAX<uint32>(_decodeAheadStats.maxQueuedFrames, _frameQueue.size());
+	return true;
+}
+
+const Graphics::Surface *VideoDecoder::showQueuedFrame() {
+	if (_shownFrame)
+		_freeFrames.push_back(_shownFrame);
+
+	_shownFrame = _frameQueue.front();
+	_frameQueue.pop_front();
+	_decodeAheadStats.queuedFrames = _frameQueue.size();
+
+	_frameDirtyRects = _shownFrame->dirtyRects;
+
+	if (_shownFrame->hasPalette) {
+		memcpy(_queuedPalette, _shownFrame->palette, sizeof(_queuedPalette));
+		_palette = _queuedPalette;
+		_dirtyPalette = true;
+	}
+
+	return _shownFrame->hasSurface ? _shownFrame->surface : 0;
+}
+
+void VideoDecoder::flushFrameQueue() {
+	// The frame shown last stays valid until the next one
+	while (!_frameQueue.empty()) {
+		_freeFrames.push_back(_frameQueue.front());
+		_frameQueue.pop_front();
+	}
+
+	_decodeAheadStats.queuedFrames = 0;
+}
+
+void VideoDecoder::freeFrameQueue() {
+	flushFrameQueue();
+
+	if (_shownFrame) {
+		_freeFrames.push_back(_shownFrame);
+		_shownFrame = 0;
+	}
+
+	for (uint i = 0; i < _freeFrames.size(); i++) {
+		_freeFrames[i]->surface->free();
+		delete _freeFrames[i]->surface;
+		delete _freeFrames[i];
+	}
+
+	_freeFrames.clear();
+}
+
+bool VideoDecoder::frameQueueEndReached() const {
+	return _endTimeSet && isPlaying() && _frameQueue.front()->startTime >= (uint)_endTime.msecs();
+}
+
+void VideoDecoder::addDecodeTime(uint32 time) {
+	_decodeAheadStats.decodedFrames++;
+	_decodeAheadStats.totalDecodeTime += time;
+	_decodeAheadStats.maxDecodeTime = MAX(_decodeAheadStats.maxDecodeTime, time);
 }
 
 bool VideoDecoder::setReverse(bool reverse) {
@@ -237,6 +501,18 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// The tracks are ahead of the frames decoded ahead, move them back
+	// to the next one first
+	if (reverse && !_frameQueue.empty()) {
+		if (!isSeekable())
+			return false;
+
+		Audio::Timestamp seekTime(_frameQueue.front()->startTime, 1000);
+		flushFrameQueue();
+		if (!seekIntern(seekTime))
+			return false;
+	}
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -244,6 +520,7 @@ bool VideoDecoder::setReverse(bool reverse) {
 				return false;
 
 			_needsUpdate = true; // force an update
+			_dirtyRectsTrack = 0;
 		}
 	}
 
@@ -257,6 +534,14 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	// The tracks are already past the frames decoded ahead
+	if (!_frameQueue.empty())
+		return _frameQueue.front()->curFrame;
+
+	return getTracksCurFrame();
+}
+
+int VideoDecoder::getTracksCurFrame() const {
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -298,10 +583,16 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	if (endOfVideo() || _needsUpdate || (!_nextVideoTrack && _frameQueue.empty()))
 		return 0;
 
 	uint32 currentTime = getTime();
+
+	if (!_frameQueue.empty()) {
+		uint32 queuedFrameStartTime = _frameQueue.front()->startTime;
+		return queuedFrameStartTime > currentTime ? queuedFrameStartTime - currentTime : 0;
+	}
+
 	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
 
 	if (_nextVideoTrack->isReversed()) {
@@ -320,6 +611,9 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
+	if (!_frameQueue.empty() && !frameQueueEndReached())
+		return false;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
@@ -351,6 +645,8 @@ bool VideoDecoder::rewind() {
 	if (isPlaying())
 		stopAudio();
 
+	flushFrameQueue();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if (!(*it)->rewind())
 			return false;
@@ -361,6 +657,7 @@ bool VideoDecoder::rewind() {
 
 	_lastTimeChange = 0;
 	_startTime = g_system->getMillis();
+	_dirtyRectsTrack = 0;
 	resetPauseStartTime();
 	findNextVideoTrack();
 	return true;
@@ -385,6 +682,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (isPlaying())
 		stopAudio();
 
+	flushFrameQueue();
+
 	// Do the actual seeking
 	if (!seekIntern(time))
 		return false;
@@ -405,6 +704,7 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 
 	resetPauseStartTime();
 	findNextVideoTrack();
+	_dirtyRectsTrack = 0;
 	_needsUpdate = true;
 	return true;
 }
@@ -941,7 +1241,13 @@ void VideoDecoder::setEndFrame(uint frame) {
 }
 
 void VideoDecoder::resetStartTime() {
-	if (_nextVideoTrack) {
+	if (!_frameQueue.empty()) {
+		const QueuedFrame *queued = _frameQueue.front();
+		Audio::Timestamp curTime = queued->track->getFrameTime(queued->trackFrame);
+		if (isPlaying()) {
+			_startTime = g_system->getMillis() - (curTime.msecs() / _playbackRate).toInt();
+		}
+	} else if (_nextVideoTrack) {
 		Audio::Timestamp curTime = _nextVideoTrack->getFrameTime(_nextVideoTrack->getCurFrame());
 		if (isPlaying()) {
 			_startTime = g_system->getMillis() - (curTime.msecs() / _playbackRate).toInt();
@@ -1026,6 +1332,9 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is similar to endOfVideo(), except it doesn't take Audio into account (and returns true if not the end of the video)
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
+	if (!_frameQueue.empty() && !frameQueueEndReached())
+		return true;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() != Track::kTrackTypeVideo)
 			continue;
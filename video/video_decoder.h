@@ -25,8 +25,10 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/list.h"
 #include "common/path.h"
 #include "common/rational.h"
+#include "common/rect.h"
 #include "common/str.h"
 #include "graphics/pixelformat.h"
 #include "image/codec-options.h"
@@ -53,7 +55,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -333,9 +335,57 @@ public:
 	/**
 	 * Delay/sleep for the specified amount of milliseconds, or until the next
 	 * frame should be displayed.
+	 *
+	 * If frames are decoded ahead, the time is spent on decodeAhead() first.
 	 */
 	void delayMillis(uint msecs);
 
+	/**
+	 * Statistics about frames decoded ahead of time.
+	 */
+	struct DecodeAheadStats {
+		uint32 decodedFrames;   ///< Frames decoded since the last reset
+		uint32 lateFrames;      ///< Frames which were not decoded yet when they were needed
+		uint32 queuedFrames;    ///< Frames currently waiting to be shown
+		uint32 maxQueuedFrames; ///< Most frames waiting at the same time
+		uint32 totalDecodeTime; ///< Time spent decoding, in ms
+		uint32 maxDecodeTime;   ///< Longest time spent decoding a single frame, in ms
+	};
+
+	/**
+	 * Set how many frames may be decoded ahead of time, into surfaces owned
+	 * by the VideoDecoder. By default, this is 0 and every frame is decoded
+	 * in decodeNextFrame().
+	 *
+	 * Queued frames are returned by decodeNextFrame() in the order they were
+	 * decoded, and are dropped when seeking or rewinding. Reversed videos are
+	 * never decoded ahead, and neither are videos of decoders which cannot
+	 * decode ahead, see canDecodeAhead().
+	 *
+	 * @return whether frames will be decoded ahead
+	 */
+	bool setDecodeAhead(uint frames);
+
+	/**
+	 * Decode frames ahead of time until the queue set by setDecodeAhead() is
+	 * full, or until no other frame is expected to be decoded in the given
+	 * time. This is meant to be called while waiting for the next frame.
+	 *
+	 * @param maxMillis the time which may be spent decoding, in ms
+	 * @return the number of frames decoded
+	 */
+	uint decodeAhead(uint32 maxMillis);
+
+	/**
+	 * Get the statistics about decoding frames ahead of time.
+	 */
+	const DecodeAheadStats &getDecodeAheadStats() const { return _decodeAheadStats; }
+
+	/**
+	 * Reset the statistics about decoding frames ahead of time.
+	 */
+	void resetDecodeAheadStats();
+
 	/**
 	 * Return the time (in ms) until the next frame should be displayed.
 	 */
@@ -358,6 +408,9 @@ public:
 	 * Note that this will call readNextPacket() internally first before calling
 	 * the next video track's decodeNextFrame() function.
 	 *
+	 * If frames were decoded ahead, the first queued frame is returned
+	 * instead, and neither of them is called.
+	 *
 	 * @return a surface containing the decoded frame, or 0
 	 * @note Ownership of the returned surface stays with the VideoDecoder,
 	 *       hence the caller must *not* free it.
@@ -365,6 +418,38 @@ public:
 	 */
 	virtual const Graphics::Surface *decodeNextFrame();
 
+	/**
+	 * Get the areas of the frame which changed in the last call to
+	 * decodeNextFrame(), for tracks which report them. Otherwise, and for
+	 * the first frame after loading, seeking or rewinding, this is the
+	 * whole frame.
+	 *
+	 * @note The areas are only relative to the previous decoded frame.
+	 *       If a frame was decoded but not shown, the whole next frame
+	 *       has to be shown.
+	 */
+	const Common::List<Common::Rect> &getFrameDirtyRects() const { return _frameDirtyRects; }
+
+	/**
+	 * Copy the changed areas of the last decoded frame to the given surface.
+	 *
+	 * @param frame The surface returned by decodeNextFrame()
+	 * @param dst The surface to copy to
+	 * @param x, y The position of the frame on the destination surface
+	 * @return the number of bytes copied
+	 */
+	uint32 copyFrameDirtyRects(const Graphics::Surface &frame, Graphics::Surface &dst, int x, int y) const;
+
+	/**
+	 * Copy the changed areas of the last decoded frame to the screen,
+	 * using OSystem::copyRectToScreen().
+	 *
+	 * @param frame The surface returned by decodeNextFrame()
+	 * @param x, y The position of the frame on the screen
+	 * @return the number of bytes copied
+	 */
+	uint32 copyFrameToScreen(const Graphics::Surface &frame, int x, int y) const;
+
 	/**
 	 * Set the video to decode frames in reverse.
 	 *
@@ -644,6 +729,18 @@ protected:
 		 */
 		virtual bool hasDirtyPalette() const { return false; }
 
+		/**
+		 * Get the areas of the frame which changed in the last call to
+		 * decodeNextFrame(), and only those.
+		 *
+		 * This is separate from the getDirtyRects() lists some tracks keep
+		 * for their engines, which accumulate until the engine clears them.
+		 *
+		 * By default, this returns 0, meaning that the whole frame has to
+		 * be treated as changed.
+		 */
+		virtual const Common::List<Common::Rect> *getFrameDirtyRects() const { return 0; }
+
 		/**
 		 * Get the time the given frame should be shown.
 		 *
@@ -885,6 +982,26 @@ protected:
 	 */
 	virtual void readNextPacket() {}
 
+	/**
+	 * Process a frame right after a video track decoded it, whether it is
+	 * shown at once or decoded ahead of time.
+	 *
+	 * A subclass may override this to return a surface of its own instead,
+	 * e.g. a scaled copy, which must stay valid until the next call. The
+	 * whole frame is then treated as changed.
+	 *
+	 * By default, this returns the frame unchanged.
+	 */
+	virtual const Graphics::Surface *processFrame(const Graphics::Surface *frame) { return frame; }
+
+	/**
+	 * Whether frames can be decoded ahead of time.
+	 *
+	 * Decoding ahead skips decodeNextFrame(), so a subclass which overrides
+	 * it to do more than processFrame() does has to return false here.
+	 */
+	virtual bool canDecodeAhead() const { return true; }
+
 	/**
 	 * Define a track to be used by this class.
 	 *
@@ -996,6 +1113,40 @@ private:
 	mutable bool _dirtyPalette;
 	const byte *_palette;
 
+	// Areas changed by the last decoded frame, and the track it came from
+	Common::List<Common::Rect> _frameDirtyRects;
+	const VideoTrack *_dirtyRectsTrack;
+
+	// A frame decoded ahead of time
+	struct QueuedFrame {
+		Graphics::Surface *surface;
+		bool hasSurface;
+		bool hasPalette;
+		byte palette[3 * 256];
+		Common::List<Common::Rect> dirtyRects;
+		uint32 startTime;
+		int curFrame;
+		const VideoTrack *track;
+		int trackFrame;
+	};
+
+	// Frames decoded ahead, unused ones, and the one shown last
+	uint _decodeAheadFrames;
+	Common::List<QueuedFrame *> _frameQueue;
+	Common::Array<QueuedFrame *> _freeFrames;
+	QueuedFrame *_shownFrame;
+	byte _queuedPalette[3 * 256];
+	DecodeAheadStats _decodeAheadStats;
+
+	bool queueNextFrame();
+	const Graphics::Surface *showQueuedFrame();
+	void flushFrameQueue();
+	void freeFrameQueue();
+	bool frameQueueEndReached() const;
+	int getTracksCurFrame() const;
+	void updateDirtyRects(const Graphics::Surface *frame, Common::List<Common::Rect> &dirtyRects);
+	void addDecodeTime(uint32 time);
+
 	// Enforcement of not being able to set dither or set the default format
 	bool _canSetDither;
 	bool _canSetDefaultFormat;
@@ -1009,6 +1160,12 @@ protected:
 	bool hasFramesLeft() const;
 	bool hasAudio() const;
 
+	/**
+	 * Treat the whole frame as changed, e.g. when a subclass transforms
+	 * the frames of its tracks.
+	 */
+	void markWholeFrameDirty(const Graphics::Surface &frame);
+
 	Audio::Timestamp _lastTimeChange;
 	int32 _startTime;
 